@@ -1239,6 +1239,29 @@ void ModeAuto::do_nav_wp(const AP_Mission::Mission_Command& cmd)
             
         }
     copter.wp_nav->set_fast_waypoint(fast_waypoint);
+
+    // pass the waypoints which follow to wp_nav so it can plan the
+    // speed through this corner. Legs already known from the previous
+    // waypoint are kept, so only the newly visible ones are added
+    if (!fast_waypoint) {
+        copter.wp_nav->clear_next_legs();
+        return;
+    }
+    uint16_t next_index = cmd.index + 1;
+    uint8_t legs_seen = 0;
+    while (mission.get_next_nav_cmd(next_index, temp_cmd) &&
+           (temp_cmd.id == MAV_CMD_NAV_WAYPOINT) &&
+           (temp_cmd.content.location.lat != 0 || temp_cmd.content.location.lng != 0)) {
+        if (++legs_seen > copter.wp_nav->num_next_legs() &&
+            !copter.wp_nav->add_next_leg(loc_from_cmd(temp_cmd))) {
+            break;
+        }
+        if (temp_cmd.p1 != 0) {
+            // the vehicle stops at a waypoint with a delay
+            break;
+        }
+        next_index = temp_cmd.index + 1;
+    }
 }
 
 
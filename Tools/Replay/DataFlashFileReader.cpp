@@ -67,13 +67,17 @@ bool AP_LoggerFileReader::update(char type[5])
     if (read_input(hdr, 3) != 3) {
         return false;
     }
-    if (hdr[0] != HEAD_BYTE1 || hdr[1] != HEAD_BYTE2) {
+    if (hdr[0] != HEAD_BYTE1 || (hdr[1] != HEAD_BYTE2 && hdr[1] != HEAD_BYTE2_DELTA)) {
         printf("bad log header\n");
         return false;
     }
 
     packet_counts[hdr[2]]++;
 
+    if (hdr[1] == HEAD_BYTE2_DELTA) {
+        return update_delta(hdr, type);
+    }
+
     if (hdr[2] == LOG_FORMAT_MSG) {
         struct log_Format f;
         memcpy(&f, hdr, 3);
@@ -83,6 +87,7 @@ bool AP_LoggerFileReader::update(char type[5])
         memcpy(&formats[f.type], &f, sizeof(formats[f.type]));
         strncpy(type, "FMT", 3);
         type[3] = 0;
+        delta_codec.update((const uint8_t *)&f, sizeof(f));
 
         message_count++;
         return handle_log_format_msg(f);
@@ -103,6 +108,42 @@ bool AP_LoggerFileReader::update(char type[5])
         return false;
     }
 
+    strncpy(type, f.name, 4);
+    type[4] = 0;
+    delta_codec.update(msg, f.length);
+
+    message_count++;
+    return handle_msg(f,msg);
+}
+
+/*
+  read and decode a delta encoded message whose first three bytes are in hdr
+ */
+bool AP_LoggerFileReader::update_delta(const uint8_t hdr[3], char type[5])
+{
+    const struct log_Format &f = formats[hdr[2]];
+    if (f.length == 0 || delta_codec.message_length(hdr[2]) != f.length) {
+        ::printf("No delta format defined for type (%d)\n", hdr[2]);
+        exit(1);
+    }
+
+    uint8_t encoded[LOG_DELTA_HEADER_LEN + UINT8_MAX];
+    memcpy(encoded, hdr, 3);
+    if (read_input(&encoded[3], 1) != 1) {
+        return false;
+    }
+    const uint8_t encoded_length = encoded[3];
+    if (read_input(&encoded[LOG_DELTA_HEADER_LEN], encoded_length) != encoded_length) {
+        return false;
+    }
+
+    uint8_t msg[f.length];
+    if (delta_codec.decode(encoded, LOG_DELTA_HEADER_LEN + encoded_length, msg) != f.length) {
+        ::printf("Bad delta encoded message for type (%d)\n", hdr[2]);
+        return false;
+    }
+    delta_codec.update(msg, f.length);
+
     strncpy(type, f.name, 4);
     type[4] = 0;
 
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <AP_Logger/AP_Logger.h>
+#include <AP_Logger/LogDelta.h>
 
 #define LOGREADER_MAX_FORMATS 255 // must be >= highest MESSAGE
 
@@ -28,6 +29,10 @@ protected:
 private:
     ssize_t read_input(void *buf, size_t count);
 
+    // read and decode a delta encoded message
+    bool update_delta(const uint8_t hdr[3], char type[5]);
+    LogDeltaCodec delta_codec;
+
     uint64_t bytes_read = 0;
     uint32_t message_count = 0;
     uint64_t start_micros;
@@ -277,6 +277,9 @@ def load_env_vars(env):
         if k == 'ROMFS_FILES':
             env.ROMFS_FILES += v
             continue
+        if k == 'ROMFS_RAW_FILES':
+            env.ROMFS_RAW_FILES += v
+            continue
         if k in env:
             if isinstance(env[k], dict):
                 a = v.split('=')
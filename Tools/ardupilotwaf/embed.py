@@ -38,13 +38,11 @@ def embed_file(out, f, idx, embedded_name, uncompressed):
 
     compressed = tempfile.NamedTemporaryFile()
     if uncompressed:
-        # ensure nul termination
+        # ensure nul termination, the nul is not part of the file size
         if sys.version_info[0] >= 3:
-            nul = bytearray(0)
+            contents += bytes([0])
         else:
-            nul = chr(0)
-        if contents[-1] != nul:
-            contents += nul
+            contents += chr(0)
         compressed.write(contents)
     else:
         # compress it
@@ -62,8 +60,9 @@ def embed_file(out, f, idx, embedded_name, uncompressed):
     write_encode(out, '};\n\n');
     return True
 
-def create_embedded_h(filename, files, uncompressed=False):
-    '''create a ap_romfs_embedded.h file'''
+def create_embedded_h(filename, files, uncompressed=False, raw_files=[]):
+    '''create a ap_romfs_embedded.h file. Files named in raw_files are
+    stored uncompressed, so they can be used without being copied'''
 
     out = open(filename, "wb")
     write_encode(out, '''// generated embedded files for AP_ROMFS\n\n''')
@@ -73,19 +72,23 @@ def create_embedded_h(filename, files, uncompressed=False):
 
     for i in range(len(files)):
         (name, filename) = files[i]
-        if not embed_file(out, filename, i, name, uncompressed):
+        if not embed_file(out, filename, i, name, uncompressed or name in raw_files):
             return False
 
     write_encode(out, '''const AP_ROMFS::embedded_file AP_ROMFS::files[] = {\n''')
 
     for i in range(len(files)):
         (name, filename) = files[i]
-        if uncompressed:
+        if uncompressed or name in raw_files:
             ustr = ' (uncompressed)'
+            size = 'sizeof(ap_romfs_%u)-1' % i
+            compressed = 'false'
         else:
             ustr = ''
+            size = 'sizeof(ap_romfs_%u)' % i
+            compressed = 'true'
         print("Embedding file %s:%s%s" % (name, filename, ustr))
-        write_encode(out, '{ "%s", sizeof(ap_romfs_%u), ap_romfs_%u },\n' % (name, i, i))
+        write_encode(out, '{ "%s", %s, ap_romfs_%u, %s },\n' % (name, size, i, compressed))
     write_encode(out, '};\n')
     out.close()
     return True
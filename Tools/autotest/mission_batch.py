@@ -0,0 +1,669 @@
+#!/usr/bin/env python
+
+'''
+Headless batch (Monte-Carlo) mission evaluation on SITL physics
+
+Runs many sped-up SITL flights of one mission in parallel, one SITL
+instance per worker, with simulation parameters (wind, sensor noise,
+...) drawn from user supplied distributions. Each flight is flown
+without MAVProxy: the mission is uploaded over MAVLink, the vehicle is
+armed in GUIDED and the mission started with MAV_CMD_MISSION_START.
+
+Per-flight results are written to a CSV file and aggregated
+statistics (mean, std-dev, percentiles) are printed at the end:
+
+  - cross-track error against the planned mission legs (RMS and max)
+  - spray coverage of the planned swath and overspray area
+  - battery consumption (mAh)
+  - failsafe events and mission completion
+
+Example, 500 flights on all cores with gusty wind and IMU noise:
+
+./Tools/autotest/mission_batch.py \
+    --mission Tools/autotest/copter_mission.txt \
+    --params my-sprayer.parm \
+    --runs 500 --speedup 20 \
+    --wind-speed uniform:0:8 --wind-dir uniform:0:360 --wind-turb uniform:0:2 \
+    --vary SIM_ACC_RND=uniform:0:0.3 --vary SIM_GYR_RND=normal:0.02:0.01 \
+    --csv results.csv
+
+Distributions are given as "const:V", "uniform:MIN:MAX",
+"normal:MEAN:SIGMA" or "choice:A,B,C". A bare number is a constant.
+
+Build the SITL binary first, e.g. "./waf configure --board sitl && ./waf copter".
+'''
+
+from __future__ import print_function
+
+import csv
+import json
+import math
+import multiprocessing
+import optparse
+import os
+import random
+import re
+import shutil
+import signal
+import subprocess
+import sys
+import tempfile
+import time
+
+from pymavlink import mavutil, mavwp
+
+from pysim import util
+
+# SERVOn_FUNCTION value of the sprayer pump (SRV_Channel::k_sprayer_pump)
+SPRAYER_PUMP_FUNCTION = 22
+
+# copter modes which mean the mission was abandoned
+FAILSAFE_MODES = {
+    6: 'RTL',
+    9: 'LAND',
+    17: 'BRAKE',
+    21: 'SMART_RTL',
+}
+
+# stream rates needed to evaluate a flight; applied as defaults so no
+# GCS stream negotiation is needed
+STREAM_PARAMS = {
+    'SR0_POSITION': 10,
+    'SR0_EXT_STAT': 5,
+    'SR0_EXTRA3': 2,
+    'SR0_RC_CHAN': 10,
+}
+
+
+class Distribution(object):
+    '''a random distribution parsed from a command line string'''
+
+    def __init__(self, spec):
+        self.spec = spec
+        parts = spec.split(':')
+        try:
+            if len(parts) == 1:
+                self.kind = 'const'
+                self.args = [float(parts[0])]
+            elif parts[0] == 'const' and len(parts) == 2:
+                self.kind = 'const'
+                self.args = [float(parts[1])]
+            elif parts[0] in ('uniform', 'normal') and len(parts) == 3:
+                self.kind = parts[0]
+                self.args = [float(parts[1]), float(parts[2])]
+            elif parts[0] == 'choice' and len(parts) == 2:
+                self.kind = 'choice'
+                self.args = [float(x) for x in parts[1].split(',')]
+            else:
+                raise ValueError()
+        except ValueError:
+            raise ValueError("Bad distribution '%s'" % spec)
+
+    def sample(self, rng):
+        if self.kind == 'const':
+            return self.args[0]
+        if self.kind == 'uniform':
+            return rng.uniform(self.args[0], self.args[1])
+        if self.kind == 'normal':
+            return rng.gauss(self.args[0], self.args[1])
+        return rng.choice(self.args)
+
+
+def load_param_file(filename):
+    '''load a parameter file in the format used by --defaults'''
+    ret = {}
+    with open(filename) as f:
+        for line in f:
+            line = line.split('#')[0].strip()
+            if len(line) == 0:
+                continue
+            a = re.split(r'[\s,]+', line)
+            if len(a) < 2:
+                continue
+            ret[a[0].upper()] = float(a[1])
+    return ret
+
+
+class CoverageGrid(object):
+    '''set of painted cells on a local north/east grid'''
+
+    def __init__(self, cell_size):
+        self.cell_size = cell_size
+        self.cells = set()
+
+    def paint_segment(self, p0, p1, width):
+        '''paint all cells whose centre is within width/2 of segment p0-p1'''
+        half = 0.5 * width
+        cs = self.cell_size
+        imin = int(math.floor((min(p0[0], p1[0]) - half) / cs))
+        imax = int(math.ceil((max(p0[0], p1[0]) + half) / cs))
+        jmin = int(math.floor((min(p0[1], p1[1]) - half) / cs))
+        jmax = int(math.ceil((max(p0[1], p1[1]) + half) / cs))
+        for i in range(imin, imax+1):
+            for j in range(jmin, jmax+1):
+                c = ((i+0.5)*cs, (j+0.5)*cs)
+                if distance_to_segment(c, p0, p1) <= half:
+                    self.cells.add((i, j))
+
+    def area(self, cells=None):
+        if cells is None:
+            cells = self.cells
+        return len(cells) * self.cell_size * self.cell_size
+
+
+def distance_to_segment(p, a, b):
+    '''distance in metres from point p to segment a-b (all local NE)'''
+    dx = b[0] - a[0]
+    dy = b[1] - a[1]
+    len_sq = dx*dx + dy*dy
+    if len_sq <= 0:
+        return math.hypot(p[0]-a[0], p[1]-a[1])
+    t = ((p[0]-a[0])*dx + (p[1]-a[1])*dy) / len_sq
+    t = max(0.0, min(1.0, t))
+    return math.hypot(p[0] - (a[0] + t*dx), p[1] - (a[1] + t*dy))
+
+
+def local_ne(origin, lat, lng):
+    '''convert lat/lng in degrees to metres north/east of origin'''
+    dlat = math.radians(lat - origin[0])
+    dlng = math.radians(lng - origin[1])
+    return (dlat * util.RADIUS_OF_EARTH,
+            dlng * util.RADIUS_OF_EARTH * math.cos(math.radians(origin[0])))
+
+
+class MissionPlan(object):
+    '''the parts of a mission needed to score a flight against it'''
+
+    def __init__(self, filename):
+        self.loader = mavwp.MAVWPLoader()
+        self.loader.load(filename)
+        if self.loader.count() < 2:
+            raise ValueError("Mission %s has no items" % filename)
+        home = self.loader.wp(0)
+        self.origin = (home.x, home.y)
+
+        # planned legs, indexed by the sequence number of the item
+        # which ends the leg, plus whether the sprayer is on along it
+        self.legs = {}
+        have_sprayer_cmd = False
+        for i in range(self.loader.count()):
+            if self.loader.wp(i).command == mavutil.mavlink.MAV_CMD_DO_SPRAYER:
+                have_sprayer_cmd = True
+        spraying = not have_sprayer_cmd
+        prev = None
+        for i in range(1, self.loader.count()):
+            wp = self.loader.wp(i)
+            if wp.command == mavutil.mavlink.MAV_CMD_DO_SPRAYER:
+                spraying = wp.param1 > 0
+                continue
+            if wp.command != mavutil.mavlink.MAV_CMD_NAV_WAYPOINT:
+                continue
+            if wp.x == 0 and wp.y == 0:
+                # "current position" waypoint, no fixed leg
+                prev = None
+                continue
+            pos = local_ne(self.origin, wp.x, wp.y)
+            if prev is not None:
+                self.legs[i] = (prev, pos, spraying)
+            prev = pos
+
+    def count(self):
+        return self.loader.count()
+
+    def items(self):
+        return [self.loader.wp(i) for i in range(self.loader.count())]
+
+    def planned_coverage(self, cell_size, width):
+        grid = CoverageGrid(cell_size)
+        for (p0, p1, spraying) in self.legs.values():
+            if spraying:
+                grid.paint_segment(p0, p1, width)
+        return grid
+
+
+class FlightFailed(Exception):
+    pass
+
+
+class MissionRun(object):
+    '''a single SITL flight of the mission'''
+
+    def __init__(self, opts, run_index, instance, params, sampled):
+        self.opts = opts
+        self.plan = MissionPlan(opts.mission)
+        self.run_index = run_index
+        self.instance = instance
+        self.params = params
+        self.sampled = sampled
+        self.sitl = None
+        self.mav = None
+        self.workdir = None
+        self.sim_time_ms = 0
+
+    def progress(self, text):
+        if self.opts.verbose:
+            print("run %u (I%u): %s" % (self.run_index, self.instance, text))
+
+    def start_sitl(self):
+        self.workdir = tempfile.mkdtemp(prefix='mission_batch_%u_' % self.instance)
+        defaults = os.path.join(self.workdir, 'run.parm')
+        with open(defaults, 'w') as f:
+            for name in sorted(self.params.keys()):
+                f.write("%s %.7g\n" % (name, self.params[name]))
+        defaults_list = [defaults]
+        if self.opts.model_defaults:
+            defaults_list.insert(0, os.path.realpath(self.opts.model_defaults))
+        cmd = [os.path.realpath(self.opts.binary),
+               '-S', '-w',
+               '-I%u' % self.instance,
+               '--model', self.opts.model,
+               '--speedup', str(self.opts.speedup),
+               '--home', self.opts.home,
+               '--defaults', ','.join(defaults_list)]
+        self.progress("Running: %s" % util.cmd_as_shell(cmd))
+        self.logfile = open(os.path.join(self.workdir, 'sitl.log'), 'w')
+        self.sitl = subprocess.Popen(cmd,
+                                     cwd=self.workdir,
+                                     stdout=self.logfile,
+                                     stderr=subprocess.STDOUT)
+
+    def connect(self):
+        port = 5760 + 10*self.instance
+        tstart = time.time()
+        while True:
+            if self.sitl.poll() is not None:
+                raise FlightFailed("SITL exited with %d" % self.sitl.returncode)
+            try:
+                self.mav = mavutil.mavlink_connection('tcp:127.0.0.1:%u' % port,
+                                                      source_system=250,
+                                                      robust_parsing=True)
+                break
+            except Exception:
+                if time.time() - tstart > 60:
+                    raise FlightFailed("Could not connect to SITL on port %u" % port)
+                time.sleep(0.2)
+        if self.mav.wait_heartbeat(timeout=60) is None:
+            raise FlightFailed("No heartbeat")
+
+    def stop(self):
+        if self.mav is not None:
+            self.mav.close()
+            self.mav = None
+        if self.sitl is not None:
+            if self.sitl.poll() is None:
+                self.sitl.send_signal(signal.SIGTERM)
+                try:
+                    self.sitl.wait()
+                except OSError:
+                    pass
+            self.sitl = None
+            self.logfile.close()
+        if self.workdir is not None and not self.opts.keep:
+            shutil.rmtree(self.workdir, ignore_errors=True)
+
+    def recv(self, types, timeout=1):
+        m = self.mav.recv_match(type=types, blocking=True, timeout=timeout)
+        if m is not None and hasattr(m, 'time_boot_ms'):
+            self.sim_time_ms = m.time_boot_ms
+        return m
+
+    def upload_mission(self):
+        items = self.plan.items()
+        self.mav.mav.mission_count_send(1, 1, len(items))
+        remaining = set(range(len(items)))
+        tstart = time.time()
+        while True:
+            if time.time() - tstart > 30:
+                raise FlightFailed("Timeout uploading mission")
+            m = self.recv(['MISSION_REQUEST', 'MISSION_REQUEST_INT', 'MISSION_ACK'])
+            if m is None:
+                continue
+            if m.get_type() == 'MISSION_ACK':
+                if m.target_system != self.mav.mav.srcSystem:
+                    continue
+                if m.type != mavutil.mavlink.MAV_MISSION_ACCEPTED or len(remaining):
+                    raise FlightFailed("Mission upload failed (%u)" % m.type)
+                return
+            if m.seq >= len(items):
+                raise FlightFailed("Request for unknown mission item %u" % m.seq)
+            item = items[m.seq]
+            item.target_system = 1
+            item.target_component = 1
+            self.mav.mav.send(item)
+            remaining.discard(m.seq)
+
+    def arm_and_start(self):
+        '''arm in GUIDED and start the mission, retrying until prearm
+        checks (EKF, GPS) pass'''
+        tstart = time.time()
+        while True:
+            if time.time() - tstart > 120:
+                raise FlightFailed("Failed to arm")
+            self.mav.set_mode('GUIDED')
+            self.mav.mav.command_long_send(1, 1,
+                                           mavutil.mavlink.MAV_CMD_COMPONENT_ARM_DISARM,
+                                           0, 1, 0, 0, 0, 0, 0, 0)
+            m = self.recv('COMMAND_ACK', timeout=2)
+            if (m is not None and
+                m.command == mavutil.mavlink.MAV_CMD_COMPONENT_ARM_DISARM and
+                m.result == mavutil.mavlink.MAV_RESULT_ACCEPTED):
+                break
+            time.sleep(1)
+        self.mav.mav.command_long_send(1, 1,
+                                       mavutil.mavlink.MAV_CMD_MISSION_START,
+                                       0, 0, 0, 0, 0, 0, 0, 0)
+
+    def fly(self):
+        '''fly the mission, collecting metrics until disarm or timeout'''
+        opts = self.opts
+        origin = self.plan.origin
+        last_seq = self.plan.count() - 1
+        spray_channel = opts.spray_channel
+        spray_threshold = opts.spray_pwm
+        actual = CoverageGrid(opts.cell_size)
+
+        result = {
+            'completed': 0,
+            'failsafes': 0,
+            'failsafe_mode': '',
+            'xtrack_rms': 0.0,
+            'xtrack_max': 0.0,
+            'battery_mah': 0.0,
+            'flight_time': 0.0,
+            'distance': 0.0,
+        }
+        xtrack_sq_sum = 0.0
+        xtrack_count = 0
+        current_seq = 0
+        last_pos = None
+        pump_on = False
+        start_ms = None
+        armed_seen = False
+        wall_start = time.time()
+
+        while True:
+            if self.sitl.poll() is not None:
+                raise FlightFailed("SITL exited with %d" % self.sitl.returncode)
+            if start_ms is not None and (self.sim_time_ms - start_ms) * 0.001 > opts.timeout:
+                result['failsafe_mode'] = 'TIMEOUT'
+                break
+            if time.time() - wall_start > opts.timeout:
+                # guard against a stalled simulation
+                result['failsafe_mode'] = 'TIMEOUT'
+                break
+            m = self.recv(['GLOBAL_POSITION_INT', 'MISSION_CURRENT',
+                           'MISSION_ITEM_REACHED', 'SERVO_OUTPUT_RAW',
+                           'BATTERY_STATUS', 'HEARTBEAT', 'STATUSTEXT'])
+            if m is None:
+                continue
+            mtype = m.get_type()
+            if mtype == 'HEARTBEAT':
+                if m.get_srcComponent() != 1:
+                    continue
+                armed = (m.base_mode & mavutil.mavlink.MAV_MODE_FLAG_SAFETY_ARMED) != 0
+                if armed and not armed_seen:
+                    armed_seen = True
+                    start_ms = self.sim_time_ms
+                if armed_seen and not armed:
+                    break
+                if armed and m.custom_mode in FAILSAFE_MODES and not result['failsafe_mode']:
+                    result['failsafe_mode'] = FAILSAFE_MODES[m.custom_mode]
+            elif mtype == 'STATUSTEXT':
+                self.progress(m.text)
+                if 'failsafe' in m.text.lower():
+                    result['failsafes'] += 1
+            elif mtype == 'MISSION_CURRENT':
+                current_seq = m.seq
+            elif mtype == 'MISSION_ITEM_REACHED':
+                if m.seq == last_seq:
+                    result['completed'] = 1
+            elif mtype == 'SERVO_OUTPUT_RAW':
+                if spray_channel > 0:
+                    pwm = getattr(m, 'servo%u_raw' % spray_channel, 0)
+                    pump_on = pwm > spray_threshold
+            elif mtype == 'BATTERY_STATUS':
+                if m.current_consumed >= 0:
+                    result['battery_mah'] = float(m.current_consumed)
+            elif mtype == 'GLOBAL_POSITION_INT':
+                if not armed_seen:
+                    continue
+                pos = local_ne(origin, m.lat*1.0e-7, m.lon*1.0e-7)
+                if last_pos is not None:
+                    result['distance'] += math.hypot(pos[0]-last_pos[0], pos[1]-last_pos[1])
+                    if pump_on:
+                        actual.paint_segment(last_pos, pos, opts.spray_width)
+                last_pos = pos
+                leg = self.plan.legs.get(current_seq)
+                if leg is not None and m.relative_alt > 1000:
+                    err = distance_to_segment(pos, leg[0], leg[1])
+                    xtrack_sq_sum += err*err
+                    xtrack_count += 1
+                    result['xtrack_max'] = max(result['xtrack_max'], err)
+
+        if start_ms is not None:
+            result['flight_time'] = (self.sim_time_ms - start_ms) * 0.001
+        if xtrack_count > 0:
+            result['xtrack_rms'] = math.sqrt(xtrack_sq_sum / xtrack_count)
+        return result, actual
+
+    def run(self):
+        ret = {
+            'run': self.run_index,
+            'error': '',
+        }
+        ret.update(self.sampled)
+        try:
+            self.start_sitl()
+            self.connect()
+            self.upload_mission()
+            self.arm_and_start()
+            (result, actual) = self.fly()
+            ret.update(result)
+            planned = self.plan.planned_coverage(self.opts.cell_size, self.opts.spray_width)
+            if planned.cells:
+                hit = planned.cells & actual.cells
+                ret['coverage'] = float(len(hit)) / len(planned.cells)
+                ret['overspray_m2'] = actual.area(actual.cells - planned.cells)
+            ret['sprayed_m2'] = actual.area()
+        except FlightFailed as ex:
+            ret['error'] = str(ex)
+        finally:
+            self.stop()
+        return ret
+
+
+# instance numbers not currently in use by a worker
+_free_instances = None
+
+
+def init_worker(free_instances):
+    global _free_instances
+    _free_instances = free_instances
+    # let the parent handle ctrl-c
+    signal.signal(signal.SIGINT, signal.SIG_IGN)
+
+
+def run_one(args):
+    (opts, run_index, params, sampled) = args
+    instance = _free_instances.get()
+    try:
+        return MissionRun(opts, run_index, instance, params, sampled).run()
+    finally:
+        _free_instances.put(instance)
+
+
+def percentile(values, pct):
+    if len(values) == 0:
+        return float('nan')
+    values = sorted(values)
+    k = (len(values) - 1) * pct / 100.0
+    f = int(math.floor(k))
+    c = min(f + 1, len(values) - 1)
+    return values[f] + (values[c] - values[f]) * (k - f)
+
+
+def summarise(results, keys):
+    summary = {}
+    for key in keys:
+        values = [float(r[key]) for r in results if key in r and r['error'] == '']
+        if len(values) == 0:
+            continue
+        mean = sum(values) / len(values)
+        var = sum([(v-mean)**2 for v in values]) / len(values)
+        summary[key] = {
+            'mean': mean,
+            'std': math.sqrt(var),
+            'min': min(values),
+            'p50': percentile(values, 50),
+            'p95': percentile(values, 95),
+            'max': max(values),
+        }
+    return summary
+
+
+METRIC_KEYS = ['completed', 'failsafes', 'xtrack_rms', 'xtrack_max',
+               'coverage', 'overspray_m2', 'sprayed_m2',
+               'battery_mah', 'flight_time', 'distance']
+
+
+def main():
+    parser = optparse.OptionParser("mission_batch.py [options]")
+    parser.add_option("--binary", default=util.reltopdir('build/sitl/bin/arducopter'),
+                      help="SITL binary to run")
+    parser.add_option("--model", default='quad', help="SITL frame model")
+    parser.add_option("--model-defaults", default=util.reltopdir('Tools/autotest/default_params/copter.parm'),
+                      help="model defaults file, applied before --params")
+    parser.add_option("--home", default='-35.362881,149.165222,582,0',
+                      help="home location lat,lng,alt,yaw")
+    parser.add_option("--mission", help="mission file (QGC WPL format)")
+    parser.add_option("--params", action='append', default=[],
+                      help="parameter file applied to every run (repeatable)")
+    parser.add_option("--runs", type='int', default=10, help="number of flights")
+    parser.add_option("-j", "--jobs", type='int', default=multiprocessing.cpu_count(),
+                      help="number of simultaneous SITL instances")
+    parser.add_option("--speedup", type='int', default=10, help="SITL speedup")
+    parser.add_option("--timeout", type='float', default=1800,
+                      help="maximum flight time in simulated seconds")
+    parser.add_option("--seed", type='int', default=0, help="random seed")
+    parser.add_option("--wind-speed", help="distribution of SIM_WIND_SPD (m/s)")
+    parser.add_option("--wind-dir", help="distribution of SIM_WIND_DIR (degrees)")
+    parser.add_option("--wind-turb", help="distribution of SIM_WIND_TURB")
+    parser.add_option("--vary", action='append', default=[],
+                      help="NAME=DISTRIBUTION, randomise any parameter per run (repeatable)")
+    parser.add_option("--spray-channel", type='int', default=-1,
+                      help="servo output of the sprayer pump (default: from SERVOn_FUNCTION)")
+    parser.add_option("--spray-pwm", type='int', default=-1,
+                      help="pump PWM above which spraying is assumed (default: SERVOn_MIN+20)")
+    parser.add_option("--spray-width", type='float', default=4.0, help="spray swath width (m)")
+    parser.add_option("--cell-size", type='float', default=0.5, help="coverage grid cell size (m)")
+    parser.add_option("--csv", help="write per-run results to this CSV file")
+    parser.add_option("--json", help="write the aggregated summary to this JSON file")
+    parser.add_option("--keep", action='store_true', default=False,
+                      help="keep per-run working directories (logs, eeprom)")
+    parser.add_option("-v", "--verbose", action='store_true', default=False)
+
+    (opts, args) = parser.parse_args()
+
+    if opts.mission is None:
+        parser.error("--mission is required")
+    if not os.path.exists(opts.binary):
+        parser.error("SITL binary %s not found; build it first" % opts.binary)
+    if opts.jobs < 1:
+        opts.jobs = 1
+
+    # fail early on a bad mission; each worker loads its own copy
+    MissionPlan(opts.mission)
+
+    base_params = {}
+    if opts.model_defaults:
+        base_params.update(load_param_file(opts.model_defaults))
+    user_params = {}
+    for p in opts.params:
+        user_params.update(load_param_file(p))
+    base_params.update(user_params)
+    user_params.update(STREAM_PARAMS)
+
+    if opts.spray_channel < 0:
+        opts.spray_channel = 0
+        for i in range(1, 17):
+            if base_params.get('SERVO%u_FUNCTION' % i) == SPRAYER_PUMP_FUNCTION:
+                opts.spray_channel = i
+                break
+    if opts.spray_pwm < 0 and opts.spray_channel > 0:
+        opts.spray_pwm = base_params.get('SERVO%u_MIN' % opts.spray_channel, 1100) + 20
+    if opts.spray_channel == 0:
+        print("No sprayer pump output found; coverage will not be measured")
+
+    distributions = []
+    for (name, spec) in [('SIM_WIND_SPD', opts.wind_speed),
+                         ('SIM_WIND_DIR', opts.wind_dir),
+                         ('SIM_WIND_TURB', opts.wind_turb)]:
+        if spec is not None:
+            distributions.append((name, Distribution(spec)))
+    for v in opts.vary:
+        if '=' not in v:
+            parser.error("--vary expects NAME=DISTRIBUTION")
+        (name, spec) = v.split('=', 1)
+        distributions.append((name.upper(), Distribution(spec)))
+
+    runs = []
+    for i in range(opts.runs):
+        rng = random.Random(opts.seed * 1000003 + i)
+        sampled = {}
+        for (name, dist) in distributions:
+            sampled[name] = dist.sample(rng)
+        params = dict(user_params)
+        params.update(sampled)
+        runs.append((opts, i, params, sampled))
+
+    manager = multiprocessing.Manager()
+    free_instances = manager.Queue()
+    for i in range(opts.jobs):
+        free_instances.put(i)
+
+    print("Flying %u runs of %s on %u SITL instances" % (opts.runs, opts.mission, opts.jobs))
+    tstart = time.time()
+    results = []
+    pool = multiprocessing.Pool(opts.jobs, init_worker, (free_instances,))
+    try:
+        for r in pool.imap_unordered(run_one, runs):
+            results.append(r)
+            status = r['error'] if r['error'] else "xtrack_rms=%.2f coverage=%.3f battery=%.0fmAh" % (
+                r.get('xtrack_rms', 0), r.get('coverage', 0), r.get('battery_mah', 0))
+            print("[%u/%u] run %u: %s" % (len(results), opts.runs, r['run'], status))
+        pool.close()
+    except KeyboardInterrupt:
+        pool.terminate()
+        print("Interrupted; summarising %u completed runs" % len(results))
+    pool.join()
+    results.sort(key=lambda r: r['run'])
+
+    if opts.csv is not None:
+        fields = ['run', 'error'] + [name for (name, dist) in distributions] + METRIC_KEYS
+        with open(opts.csv, 'w') as f:
+            writer = csv.DictWriter(f, fieldnames=fields, extrasaction='ignore')
+            writer.writeheader()
+            for r in results:
+                writer.writerow(r)
+
+    summary = summarise(results, METRIC_KEYS)
+    failed = len([r for r in results if r['error'] != ''])
+    print("%u runs (%u failed to fly) in %.0fs" % (len(results), failed, time.time() - tstart))
+    print("%-14s %10s %10s %10s %10s %10s %10s" % ('metric', 'mean', 'std', 'min', 'p50', 'p95', 'max'))
+    for key in METRIC_KEYS:
+        if key not in summary:
+            continue
+        s = summary[key]
+        print("%-14s %10.3f %10.3f %10.3f %10.3f %10.3f %10.3f" % (
+            key, s['mean'], s['std'], s['min'], s['p50'], s['p95'], s['max']))
+
+    if opts.json is not None:
+        with open(opts.json, 'w') as f:
+            json.dump({'runs': len(results), 'failed': failed, 'metrics': summary}, f, indent=2)
+
+    if failed == len(results):
+        sys.exit(1)
+
+
+if __name__ == '__main__':
+    main()
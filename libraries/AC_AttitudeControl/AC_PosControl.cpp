@@ -889,24 +889,25 @@ void AC_PosControl::write_log()
     float accel_x, accel_y;
     lean_angles_to_accel(accel_x, accel_y);
 
-    AP::logger().Write("PSC",
-                       "TimeUS,TPX,TPY,PX,PY,TVX,TVY,VX,VY,TAX,TAY,AX,AY",
-                       "smmmmnnnnoooo",
-                       "F000000000000",
-                       "Qffffffffffff",
+    static AP_Logger::MessageDef<'Q','f','f','f','f','f','f','f','f','f','f','f','f'> psc_msg{
+        "PSC",
+        "TimeUS,TPX,TPY,PX,PY,TVX,TVY,VX,VY,TAX,TAY,AX,AY",
+        "smmmmnnnnoooo",
+        "F000000000000"};
+    AP::logger().Write(psc_msg,
                        AP_HAL::micros64(),
-                       double(pos_target.x * 0.01f),
-                       double(pos_target.y * 0.01f),
-                       double(position.x * 0.01f),
-                       double(position.y * 0.01f),
-                       double(vel_target.x * 0.01f),
-                       double(vel_target.y * 0.01f),
-                       double(velocity.x * 0.01f),
-                       double(velocity.y * 0.01f),
-                       double(accel_target.x * 0.01f),
-                       double(accel_target.y * 0.01f),
-                       double(accel_x * 0.01f),
-                       double(accel_y * 0.01f));
+                       pos_target.x * 0.01f,
+                       pos_target.y * 0.01f,
+                       position.x * 0.01f,
+                       position.y * 0.01f,
+                       vel_target.x * 0.01f,
+                       vel_target.y * 0.01f,
+                       velocity.x * 0.01f,
+                       velocity.y * 0.01f,
+                       accel_target.x * 0.01f,
+                       accel_target.y * 0.01f,
+                       accel_x * 0.01f,
+                       accel_y * 0.01f);
 }
 
 /// init_vel_controller_xyz - initialise the velocity controller - should be called once before the caller attempts to use the controller
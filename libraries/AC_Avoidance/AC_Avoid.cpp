@@ -396,6 +396,19 @@ void AC_Avoid::adjust_velocity_inclusion_and_exclusion_polygons(float kP, float
         return;
     }
 
+    // exit if no polygon edge is near enough to limit velocity
+    // twice the distance needed to stop plus the margin is used to allow for the velocity controller's limits
+    const AP_SegmentGrid *polygon_index = fence->polyfence().get_polygon_index();
+    Vector2f position_xy;
+    if ((polygon_index != nullptr) && (accel_cmss > 0.0f) && AP::ahrs().get_relative_position_NE_origin(position_xy)) {
+        const float speed = desired_vel_cms.length();
+        const float stopping_dist_cm = MAX(get_stopping_distance(kP, accel_cmss, speed), speed * dt);
+        const float radius_cm = 2.0f * (2.0f + MAX(fence->get_margin() * 100.0f, 0.0f) + stopping_dist_cm);
+        if (!polygon_index->near_edge(position_xy * 100.0f, radius_cm)) {
+            return;
+        }
+    }
+
     // iterate through inclusion polygons
     const uint8_t num_inclusion_polygons = fence->polyfence().get_inclusion_polygon_count();
     for (uint8_t i = 0; i < num_inclusion_polygons; i++) {
@@ -115,7 +115,9 @@ void AP_OADatabase::init()
     if (!healthy()) {
         gcs().send_text(MAV_SEVERITY_INFO, "DB init failed . Sizes queue:%u, db:%u", (unsigned int)_queue.size, (unsigned int)_database.size);
         delete _queue.items;
-        delete[] _database.items;
+        _queue.items = nullptr;
+        hal.util->free_type(_database.items, _database.size * sizeof(OA_DbItem), AP_HAL::Util::MEM_NORMAL, AP_HAL::Util::MEM_TAG_OADB);
+        _database.items = nullptr;
         return;
     }
 }
@@ -143,10 +145,7 @@ void AP_OADatabase::queue_push(const Vector2f &pos, uint32_t timestamp_ms, float
     }
 
     const OA_DbItem item = {pos, timestamp_ms, MAX(_radius_min, distance * dist_to_radius_scalar), 0, AP_OADatabase::OA_DbItemImportance::Normal};
-    {
-        WITH_SEMAPHORE(_queue.sem);
-        _queue.items->push(item);
-    }
+    _queue.items->push(item);
 }
 
 void AP_OADatabase::init_queue()
@@ -156,7 +155,7 @@ void AP_OADatabase::init_queue()
         return;
     }
 
-    _queue.items = new ObjectBuffer<OA_DbItem>(_queue.size);
+    _queue.items = new ObjectBufferMPSC<OA_DbItem>(_queue.size);
 }
 
 void AP_OADatabase::init_database()
@@ -166,7 +165,7 @@ void AP_OADatabase::init_database()
         return;
     }
 
-    _database.items = new OA_DbItem[_database.size];
+    _database.items = (OA_DbItem *)hal.util->malloc_type(_database.size * sizeof(OA_DbItem), AP_HAL::Util::MEM_NORMAL, AP_HAL::Util::MEM_TAG_OADB);
 }
 
 // get bitmask of gcs channels item should be sent to based on its importance
@@ -214,13 +213,7 @@ bool AP_OADatabase::process_queue()
 
     for (uint16_t queue_index=0; queue_index<queue_available; queue_index++) {
         OA_DbItem item;
-
-        bool pop_success;
-        {
-            WITH_SEMAPHORE(_queue.sem);
-            pop_success = _queue.items->pop(item);
-        }
-        if (!pop_success) {
+        if (!_queue.items->pop(item)) {
             return false;
         }
 
@@ -91,9 +91,8 @@ private:
     AP_Float        _dist_max;                              // objects maximum distance (in meters)
 
     struct {
-        ObjectBuffer<OA_DbItem> *items;                     // thread safe incoming queue of points from proximity sensor to be put into database
+        ObjectBufferMPSC<OA_DbItem> *items;                 // lock-free incoming queue of points from proximity sensors, emptied by the avoidance thread
         uint16_t        size;                               // cached value of _queue_size_param.
-        HAL_Semaphore   sem;                                // semaphore for multi-thread use of queue
     } _queue;
     float dist_to_radius_scalar;                            // scalar to convert the distance and beam width to an object radius
 
@@ -22,21 +22,34 @@
 #define OA_DIJKSTRA_EXPANDING_ARRAY_ELEMENTS_PER_CHUNK  32      // expanding arrays for fence points and paths to destination will grow in increments of 20 elements
 #define OA_DIJKSTRA_POLYGON_SHORTPATH_NOTSET_IDX        255     // index use to indicate we do not have a tentative short path for a node
 #define OA_DIJKSTRA_ERROR_REPORTING_INTERVAL_MS         5000    // failure messages sent to GCS every 5 seconds
+#define OA_DIJKSTRA_HEAP_NOTSET_IDX                     UINT16_MAX  // heap index used to indicate a node is not in the heap
 
 /// Constructor
 AP_OADijkstra::AP_OADijkstra() :
         _inclusion_polygon_pts(OA_DIJKSTRA_EXPANDING_ARRAY_ELEMENTS_PER_CHUNK),
         _exclusion_polygon_pts(OA_DIJKSTRA_EXPANDING_ARRAY_ELEMENTS_PER_CHUNK),
         _exclusion_circle_pts(OA_DIJKSTRA_EXPANDING_ARRAY_ELEMENTS_PER_CHUNK),
+        _fence_visible(nullptr),
+        _fence_visible_row_ok(nullptr),
+        _fence_visible_numpoints(0),
         _short_path_data(OA_DIJKSTRA_EXPANDING_ARRAY_ELEMENTS_PER_CHUNK),
+        _short_path_heap(OA_DIJKSTRA_EXPANDING_ARRAY_ELEMENTS_PER_CHUNK),
         _path(OA_DIJKSTRA_EXPANDING_ARRAY_ELEMENTS_PER_CHUNK)
 {
 }
 
+AP_OADijkstra::~AP_OADijkstra()
+{
+    delete[] _fence_visible;
+    delete[] _fence_visible_row_ok;
+}
+
 // calculate a destination to avoid fences
 // returns DIJKSTRA_STATE_SUCCESS and populates origin_new and destination_new if avoidance is required
 AP_OADijkstra::AP_OADijkstra_State AP_OADijkstra::update(const Location &current_loc, const Location &destination, Location& origin_new, Location& destination_new)
 {
+    const uint32_t slice_start_us = AP_HAL::micros();
+
     // require ekf origin to have been set
     struct Location ekf_origin {};
     {
@@ -115,6 +128,8 @@ AP_OADijkstra::AP_OADijkstra_State AP_OADijkstra::update(const Location &current
 
     // create visgraph for all fence (with margin) points
     if (!_polyfence_visgraph_ok) {
+        // restart any search in progress
+        _search_in_progress = false;
         _polyfence_visgraph_ok = create_fence_visgraph(error_id);
         if (!_polyfence_visgraph_ok) {
             _shortest_path_ok = false;
@@ -128,18 +143,55 @@ AP_OADijkstra::AP_OADijkstra_State AP_OADijkstra::update(const Location &current
     if (!destination.same_latlon_as(_destination_prev)) {
         _destination_prev = destination;
         _shortest_path_ok = false;
+        _search_in_progress = false;
     }
 
     // calculate shortest path from current_loc to destination
     if (!_shortest_path_ok) {
-        _shortest_path_ok = calc_shortest_path(current_loc, destination, error_id);
-        if (!_shortest_path_ok) {
+        // start a new search unless a time sliced search is in progress
+        if (!_search_in_progress) {
+            // the old path is not followed while the new one is searched for
+            _path_numpoints = 0;
+            _search_in_progress = start_shortest_path(current_loc, destination, error_id);
+        }
+        bool complete = false;
+        if (!_search_in_progress || !continue_shortest_path(slice_start_us, complete, error_id)) {
+            _search_in_progress = false;
+            report_error(error_id);
+            AP::logger().Write_OADijkstra(DIJKSTRA_STATE_ERROR, (uint8_t)error_id, 0, 0, destination, destination);
+            return DIJKSTRA_STATE_ERROR;
+        }
+        node_index path_end_idx = OA_DIJKSTRA_POLYGON_SHORTPATH_NOTSET_IDX;
+        if (complete) {
+            // extract path starting from destination
+            _search_in_progress = false;
+            find_node_from_id({AP_OAVisGraph::OATYPE_DESTINATION, 0}, path_end_idx);
+        } else if (_search_best_idx == OA_DIJKSTRA_POLYGON_SHORTPATH_NOTSET_IDX) {
+            // search has not yet reached any fence point so there is no partial path to follow
+            AP::logger().Write_OADijkstra(DIJKSTRA_STATE_PROCESSING, 0, 0, 0, destination, destination);
+            return DIJKSTRA_STATE_PROCESSING;
+        } else {
+            // follow the partial path to the best point so far
+            path_end_idx = _search_best_idx;
+        }
+
+        // the vehicle keeps its progress if the new path starts with the points it has already travelled
+        const bool keep_progress = (path_end_idx != OA_DIJKSTRA_POLYGON_SHORTPATH_NOTSET_IDX) &&
+                                   path_prefix_matches(path_end_idx, _path_idx_returned);
+        if ((path_end_idx == OA_DIJKSTRA_POLYGON_SHORTPATH_NOTSET_IDX) || !extract_path(path_end_idx, error_id)) {
+            if (!complete) {
+                AP::logger().Write_OADijkstra(DIJKSTRA_STATE_PROCESSING, 0, 0, 0, destination, destination);
+                return DIJKSTRA_STATE_PROCESSING;
+            }
             report_error(error_id);
             AP::logger().Write_OADijkstra(DIJKSTRA_STATE_ERROR, (uint8_t)error_id, 0, 0, destination, destination);
             return DIJKSTRA_STATE_ERROR;
         }
-        // start from 2nd point on path (first is the original origin)
-        _path_idx_returned = 1;
+        _shortest_path_ok = complete;
+        if (!keep_progress) {
+            // start from 2nd point on path (first is the original origin)
+            _path_idx_returned = 1;
+        }
     }
 
     // path has been created, return latest point
@@ -164,9 +216,11 @@ AP_OADijkstra::AP_OADijkstra_State AP_OADijkstra::update(const Location &current
         destination_new.lng = temp_loc.lng;
 
         // check if we should advance to next point for next iteration
+        // the last point of a partial path is held until the search completes
         const bool near_oa_wp = current_loc.get_distance(destination_new) <= 2.0f;
         const bool past_oa_wp = current_loc.past_interval_finish_line(origin_new, destination_new);
-        if (near_oa_wp || past_oa_wp) {
+        const bool hold_oa_wp = _search_in_progress && (_path_idx_returned + 1 >= _path_numpoints);
+        if ((near_oa_wp || past_oa_wp) && !hold_oa_wp) {
             _path_idx_returned++;
         }
         // log success
@@ -539,27 +593,10 @@ bool AP_OADijkstra::intersects_fence(const Vector2f &seg_start, const Vector2f &
         return false;
     }
 
-    // determine if segment crosses any of the inclusion polygons
-    uint16_t num_points = 0;
-    for (uint8_t i = 0; i < fence->polyfence().get_inclusion_polygon_count(); i++) {
-        const Vector2f* boundary = fence->polyfence().get_inclusion_polygon(i, num_points);
-        if ((boundary != nullptr) && (num_points >= 3)) {
-            Vector2f intersection;
-            if (Polygon_intersects(boundary, num_points, seg_start, seg_end, intersection)) {
-                return true;
-            }
-        }
-    }
-
-    // determine if segment crosses any of the exclusion polygons
-    for (uint8_t i = 0; i < fence->polyfence().get_exclusion_polygon_count(); i++) {
-        const Vector2f* boundary = fence->polyfence().get_exclusion_polygon(i, num_points);
-        if ((boundary != nullptr) && (num_points >= 3)) {
-            Vector2f intersection;
-            if (Polygon_intersects(boundary, num_points, seg_start, seg_end, intersection)) {
-                return true;
-            }
-        }
+    // determine if segment crosses any of the inclusion or exclusion polygons
+    const AP_SegmentGrid *polygon_index = fence->polyfence().get_polygon_index();
+    if ((polygon_index != nullptr) && polygon_index->intersects(seg_start, seg_end)) {
+        return true;
     }
 
     // determine if segment crosses any of the inclusion circles
@@ -597,7 +634,8 @@ bool AP_OADijkstra::intersects_fence(const Vector2f &seg_start, const Vector2f &
     return false;
 }
 
-// create visibility graph for all fence (with margin) points
+// check polygon fence edges are indexed and clear the fence point visibility matrix
+// visibility between fence points is then calculated on demand by update_fence_visibility
 // returns true on success.  returns false on failure and err_id is updated
 // requires these functions to have been run create_inclusion_polygon_with_margin, create_exclusion_polygon_with_margin, create_exclusion_circle_with_margin
 bool AP_OADijkstra::create_fence_visgraph(AP_OADijkstra_Error &err_id)
@@ -615,34 +653,93 @@ bool AP_OADijkstra::create_fence_visgraph(AP_OADijkstra_Error &err_id)
         return false;
     }
 
-    // clear fence points visibility graph
-    _fence_visgraph.clear();
-
-    // calculate distance from each point to all other points
-    for (uint8_t i = 0; i < total_numpoints() - 1; i++) {
-        Vector2f start_seg;
-        if (get_point(i, start_seg)) {
-            for (uint8_t j = i + 1; j < total_numpoints(); j++) {
-                Vector2f end_seg;
-                if (get_point(j, end_seg)) {
-                    // if line segment does not intersect with any inclusion or exclusion zones add to visgraph
-                    if (!intersects_fence(start_seg, end_seg)) {
-                        if (!_fence_visgraph.add_item({AP_OAVisGraph::OATYPE_INTERMEDIATE_POINT, i},
-                                                      {AP_OAVisGraph::OATYPE_INTERMEDIATE_POINT, j},
-                                                      (start_seg - end_seg).length())) {
-                            // failure to add a point can only be caused by out-of-memory
-                            err_id = AP_OADijkstra_Error::DIJKSTRA_ERROR_OUT_OF_MEMORY;
-                            return false;
-                        }
-                    }
-                }
-            }
+    // destination visibility depends upon the fence so must be recalculated
+    _destination_visgraph_ok = false;
+
+    // polygon edges are indexed by the fence loader so intersects_fence only needs to check edges near each segment
+    const AC_PolyFence_loader &polyfence = fence->polyfence();
+    if ((polyfence.get_inclusion_polygon_count() + polyfence.get_exclusion_polygon_count() > 0) &&
+        (polyfence.get_polygon_index() == nullptr)) {
+        err_id = AP_OADijkstra_Error::DIJKSTRA_ERROR_OUT_OF_MEMORY;
+        return false;
+    }
+
+    // allocate visibility matrix if number of points has changed (one extra byte so an empty matrix is still allocated)
+    const uint16_t row_bytes = (total_numpoints() + 7) / 8;
+    if ((_fence_visible == nullptr) || (_fence_visible_numpoints != total_numpoints())) {
+        delete[] _fence_visible;
+        delete[] _fence_visible_row_ok;
+        _fence_visible_numpoints = 0;
+        _fence_visible = new uint8_t[total_numpoints() * row_bytes + 1];
+        _fence_visible_row_ok = new uint8_t[row_bytes + 1];
+        if ((_fence_visible == nullptr) || (_fence_visible_row_ok == nullptr)) {
+            delete[] _fence_visible;
+            delete[] _fence_visible_row_ok;
+            _fence_visible = nullptr;
+            _fence_visible_row_ok = nullptr;
+            err_id = AP_OADijkstra_Error::DIJKSTRA_ERROR_OUT_OF_MEMORY;
+            return false;
         }
+        _fence_visible_numpoints = total_numpoints();
     }
 
+    // fence points may have moved so all visibility must be recalculated
+    memset(_fence_visible, 0, total_numpoints() * row_bytes);
+    memset(_fence_visible_row_ok, 0, row_bytes);
+
     return true;
 }
 
+// calculate visibility from a fence (with margin) point to all other fence points if not already known
+void AP_OADijkstra::update_fence_visibility(uint8_t point_idx)
+{
+    // sanity check
+    if ((_fence_visible == nullptr) || (point_idx >= _fence_visible_numpoints)) {
+        return;
+    }
+
+    // nothing to do if already calculated
+    if ((_fence_visible_row_ok[point_idx / 8] & (1U << (point_idx % 8))) != 0) {
+        return;
+    }
+
+    Vector2f start_seg;
+    if (!get_point(point_idx, start_seg)) {
+        return;
+    }
+    const uint16_t row_bytes = (_fence_visible_numpoints + 7) / 8;
+    uint8_t *row = &_fence_visible[point_idx * row_bytes];
+    for (uint8_t j = 0; j < _fence_visible_numpoints; j++) {
+        if (j == point_idx) {
+            continue;
+        }
+        bool visible;
+        if ((_fence_visible_row_ok[j / 8] & (1U << (j % 8))) != 0) {
+            // reuse result from when point j's row was calculated
+            visible = fence_point_visible(j, point_idx);
+        } else {
+            // line segment is visible if it does not intersect with any inclusion or exclusion zones
+            Vector2f end_seg;
+            visible = get_point(j, end_seg) && !intersects_fence(start_seg, end_seg);
+        }
+        if (visible) {
+            row[j / 8] |= (1U << (j % 8));
+        }
+    }
+    _fence_visible_row_ok[point_idx / 8] |= (1U << (point_idx % 8));
+}
+
+// returns true if fence point j is visible from fence point i
+// requires update_fence_visibility(i) to have been run
+bool AP_OADijkstra::fence_point_visible(uint8_t i, uint8_t j) const
+{
+    if ((_fence_visible == nullptr) || (i >= _fence_visible_numpoints) || (j >= _fence_visible_numpoints)) {
+        return false;
+    }
+    const uint16_t row_bytes = (_fence_visible_numpoints + 7) / 8;
+    return (_fence_visible[i * row_bytes + j / 8] & (1U << (j % 8))) != 0;
+}
+
 // updates visibility graph for a given position which is an offset (in cm) from the ekf origin
 // to add an additional position (i.e. the destination) set add_extra_position = true and provide the position in the extra_position argument
 // requires create_inclusion_polygon_with_margin to have been run
@@ -691,39 +788,82 @@ void AP_OADijkstra::update_visible_node_distances(node_index curr_node_idx)
         return;
     }
 
-    // get current node for convenience
+    // only fence points are expanded here, the source's neighbours come from _source_visgraph
     const ShortPathNode &curr_node = _short_path_data[curr_node_idx];
+    if (curr_node.id.id_type != AP_OAVisGraph::OATYPE_INTERMEDIATE_POINT) {
+        return;
+    }
+    const uint8_t point_idx = curr_node.id.id_num;
+    Vector2f curr_pos;
+    if (!get_point(point_idx, curr_pos)) {
+        return;
+    }
 
-    // for each visibility graph
-    const AP_OAVisGraph* visgraphs[] = {&_fence_visgraph, &_destination_visgraph};
-    for (uint8_t v=0; v<ARRAY_SIZE(visgraphs); v++) {
-
-        // skip if empty
-        const AP_OAVisGraph &curr_visgraph = *visgraphs[v];
-        if (curr_visgraph.num_items() == 0) {
+    // update fence points visible from current node
+    update_fence_visibility(point_idx);
+    for (uint8_t j = 0; j < total_numpoints(); j++) {
+        if ((j == point_idx) || !fence_point_visible(point_idx, j)) {
             continue;
         }
+        node_index item_node_idx;
+        Vector2f item_pos;
+        if (find_node_from_id({AP_OAVisGraph::OATYPE_INTERMEDIATE_POINT, j}, item_node_idx) && get_point(j, item_pos)) {
+            update_node_distance(item_node_idx, curr_node_idx, (curr_pos - item_pos).length());
+        }
+    }
 
-        // search visibility graph for items visible from current_node
-        for (uint16_t i = 0; i < curr_visgraph.num_items(); i++) {
-            const AP_OAVisGraph::VisGraphItem &item = curr_visgraph[i];
-            // match if current node's id matches either of the id's in the graph (i.e. either end of the vector)
-            if ((curr_node.id == item.id1) || (curr_node.id == item.id2)) {
-                AP_OAVisGraph::OAItemID matching_id = (curr_node.id == item.id1) ? item.id2 : item.id1;
-                // find item's id in node array
-                node_index item_node_idx;
-                if (find_node_from_id(matching_id, item_node_idx)) {
-                    // if current node's distance + distance to item is less than item's current distance, update item's distance
-                    const float dist_to_item_via_current_node = _short_path_data[curr_node_idx].distance_cm + item.distance_cm;
-                    if (dist_to_item_via_current_node < _short_path_data[item_node_idx].distance_cm) {
-                        // update item's distance and set "distance_from_idx" to current node's index
-                        _short_path_data[item_node_idx].distance_cm = dist_to_item_via_current_node;
-                        _short_path_data[item_node_idx].distance_from_idx = curr_node_idx;
-                    }
-                }
-            }
+    // update destination if visible from current node
+    const float distance_to_destination_cm = _short_path_data[curr_node_idx].distance_to_destination_cm;
+    node_index dest_node_idx;
+    if ((distance_to_destination_cm < FLT_MAX) && find_node_from_id({AP_OAVisGraph::OATYPE_DESTINATION, 0}, dest_node_idx)) {
+        update_node_distance(dest_node_idx, curr_node_idx, distance_to_destination_cm);
+    }
+}
+
+// update a node's distance if reaching it via from_idx is shorter than its current distance
+void AP_OADijkstra::update_node_distance(node_index node_idx, node_index from_idx, float distance_cm)
+{
+    ShortPathNode &node = _short_path_data[node_idx];
+    if (node.visited) {
+        return;
+    }
+    const float dist_via_from_node = _short_path_data[from_idx].distance_cm + distance_cm;
+    if (dist_via_from_node < node.distance_cm) {
+        // update item's distance and set "distance_from_idx" to from node's index
+        node.distance_cm = dist_via_from_node;
+        node.distance_from_idx = from_idx;
+        heap_update(node_idx);
+    }
+}
+
+// move the heap element at heap_idx to a new position in the heap, keeping node's heap_idx in sync
+void AP_OADijkstra::heap_set(uint16_t heap_idx, node_index node_idx)
+{
+    _short_path_heap[heap_idx] = node_idx;
+    _short_path_data[node_idx].heap_idx = heap_idx;
+}
+
+// add a node to the heap or move it towards the top after its distance has been reduced
+void AP_OADijkstra::heap_update(node_index node_idx)
+{
+    uint16_t heap_idx = _short_path_data[node_idx].heap_idx;
+    if (heap_idx == OA_DIJKSTRA_HEAP_NOTSET_IDX) {
+        // add to bottom of heap, space for every node was reserved by calc_shortest_path
+        heap_idx = _short_path_heap_numpoints++;
+    }
+
+    // move up while parent is further from source
+    const float distance_cm = _short_path_data[node_idx].distance_cm;
+    while (heap_idx > 0) {
+        const uint16_t parent_idx = (heap_idx - 1) / 2;
+        const node_index parent_node_idx = _short_path_heap[parent_idx];
+        if (_short_path_data[parent_node_idx].distance_cm <= distance_cm) {
+            break;
         }
+        heap_set(heap_idx, parent_node_idx);
+        heap_idx = parent_idx;
     }
+    heap_set(heap_idx, node_idx);
 }
 
 // find a node's index into _short_path_data array from it's id (i.e. id type and id number)
@@ -758,34 +898,50 @@ bool AP_OADijkstra::find_node_from_id(const AP_OAVisGraph::OAItemID &id, node_in
     return false;
 }
 
-// find index of node with lowest tentative distance (ignore visited nodes)
+// remove node with lowest tentative distance from the heap
 // returns true if successful and node_idx argument is updated
-bool AP_OADijkstra::find_closest_node_idx(node_index &node_idx) const
+bool AP_OADijkstra::find_closest_node_idx(node_index &node_idx)
 {
-    node_index lowest_idx = 0;
-    float lowest_dist = FLT_MAX;
-
-    // scan through all nodes looking for closest
-    for (node_index i=0; i<_short_path_data_numpoints; i++) {
-        const ShortPathNode &node = _short_path_data[i];
-        if (!node.visited && (node.distance_cm < lowest_dist)) {
-            lowest_idx = i;
-            lowest_dist = node.distance_cm;
-        }
+    if (_short_path_heap_numpoints == 0) {
+        return false;
     }
 
-    if (lowest_dist < FLT_MAX) {
-        node_idx = lowest_idx;
+    // closest node is at the top of the heap
+    node_idx = _short_path_heap[0];
+    _short_path_data[node_idx].heap_idx = OA_DIJKSTRA_HEAP_NOTSET_IDX;
+    _short_path_heap_numpoints--;
+    if (_short_path_heap_numpoints == 0) {
         return true;
     }
-    return false;
+
+    // move last node down from the top until both children are further from source
+    const node_index last_node_idx = _short_path_heap[_short_path_heap_numpoints];
+    const float distance_cm = _short_path_data[last_node_idx].distance_cm;
+    uint16_t heap_idx = 0;
+    while (true) {
+        uint16_t child_idx = heap_idx * 2 + 1;
+        if (child_idx >= _short_path_heap_numpoints) {
+            break;
+        }
+        if ((child_idx + 1 < _short_path_heap_numpoints) &&
+            (_short_path_data[_short_path_heap[child_idx + 1]].distance_cm < _short_path_data[_short_path_heap[child_idx]].distance_cm)) {
+            child_idx++;
+        }
+        const node_index child_node_idx = _short_path_heap[child_idx];
+        if (distance_cm <= _short_path_data[child_node_idx].distance_cm) {
+            break;
+        }
+        heap_set(heap_idx, child_node_idx);
+        heap_idx = child_idx;
+    }
+    heap_set(heap_idx, last_node_idx);
+    return true;
 }
 
-// calculate shortest path from origin to destination
+// start calculating shortest path from origin to destination
 // returns true on success.  returns false on failure and err_id is updated
 // requires these functions to have been run: create_inclusion_polygon_with_margin, create_exclusion_polygon_with_margin, create_exclusion_circle_with_margin, create_polygon_fence_visgraph
-// resulting path is stored in _shortest_path array as vector offsets from EKF origin
-bool AP_OADijkstra::calc_shortest_path(const Location &origin, const Location &destination, AP_OADijkstra_Error &err_id)
+bool AP_OADijkstra::start_shortest_path(const Location &origin, const Location &destination, AP_OADijkstra_Error &err_id)
 {
     // convert origin and destination to offsets from EKF origin
     Vector2f origin_NE, destination_NE;
@@ -794,65 +950,122 @@ bool AP_OADijkstra::calc_shortest_path(const Location &origin, const Location &d
         return false;
     }
 
-    // create visgraphs of origin and destination to fence points
+    // create visgraph of origin to fence points
     if (!update_visgraph(_source_visgraph, {AP_OAVisGraph::OATYPE_SOURCE, 0}, origin_NE, true, destination_NE)) {
         err_id = AP_OADijkstra_Error::DIJKSTRA_ERROR_OUT_OF_MEMORY;
         return false;
     }
-    if (!update_visgraph(_destination_visgraph, {AP_OAVisGraph::OATYPE_DESTINATION, 0}, destination_NE)) {
-        err_id = AP_OADijkstra_Error::DIJKSTRA_ERROR_OUT_OF_MEMORY;
-        return false;
+
+    // create visgraph of destination to fence points unless unchanged since last calculation
+    if (!_destination_visgraph_ok || !(_destination_visgraph_pos == destination_NE)) {
+        _destination_visgraph_ok = update_visgraph(_destination_visgraph, {AP_OAVisGraph::OATYPE_DESTINATION, 0}, destination_NE);
+        if (!_destination_visgraph_ok) {
+            err_id = AP_OADijkstra_Error::DIJKSTRA_ERROR_OUT_OF_MEMORY;
+            return false;
+        }
+        _destination_visgraph_pos = destination_NE;
     }
 
-    // expand _short_path_data if necessary
-    if (!_short_path_data.expand_to_hold(2 + total_numpoints())) {
+    // expand _short_path_data and _short_path_heap if necessary
+    if (!_short_path_data.expand_to_hold(2 + total_numpoints()) || !_short_path_heap.expand_to_hold(2 + total_numpoints())) {
         err_id = AP_OADijkstra_Error::DIJKSTRA_ERROR_OUT_OF_MEMORY;
         return false;
     }
 
-    // add origin and destination (node_type, id, visited, distance_from_idx, distance_cm) to short_path_data array
-    _short_path_data[0] = {{AP_OAVisGraph::OATYPE_SOURCE, 0}, false, 0, 0};
-    _short_path_data[1] = {{AP_OAVisGraph::OATYPE_DESTINATION, 0}, false, OA_DIJKSTRA_POLYGON_SHORTPATH_NOTSET_IDX, FLT_MAX};
+    // add origin and destination (node_type, id, visited, distance_from_idx, distance_cm, distance_to_destination_cm, heap_idx) to short_path_data array
+    _short_path_data[0] = {{AP_OAVisGraph::OATYPE_SOURCE, 0}, false, 0, 0, FLT_MAX, OA_DIJKSTRA_HEAP_NOTSET_IDX};
+    _short_path_data[1] = {{AP_OAVisGraph::OATYPE_DESTINATION, 0}, false, OA_DIJKSTRA_POLYGON_SHORTPATH_NOTSET_IDX, FLT_MAX, 0, OA_DIJKSTRA_HEAP_NOTSET_IDX};
     _short_path_data_numpoints = 2;
+    _short_path_heap_numpoints = 0;
 
-    // add all inclusion and exclusion fence points to short_path_data array (node_type, id, visited, distance_from_idx, distance_cm)
+    // add all inclusion and exclusion fence points to short_path_data array
     for (uint8_t i=0; i<total_numpoints(); i++) {
-        _short_path_data[_short_path_data_numpoints++] = {{AP_OAVisGraph::OATYPE_INTERMEDIATE_POINT, i}, false, OA_DIJKSTRA_POLYGON_SHORTPATH_NOTSET_IDX, FLT_MAX};
+        _short_path_data[_short_path_data_numpoints++] = {{AP_OAVisGraph::OATYPE_INTERMEDIATE_POINT, i}, false, OA_DIJKSTRA_POLYGON_SHORTPATH_NOTSET_IDX, FLT_MAX, FLT_MAX, OA_DIJKSTRA_HEAP_NOTSET_IDX};
+    }
+
+    // record which fence points can see the destination
+    for (uint16_t i = 0; i < _destination_visgraph.num_items(); i++) {
+        node_index node_idx;
+        if (find_node_from_id(_destination_visgraph[i].id2, node_idx)) {
+            _short_path_data[node_idx].distance_to_destination_cm = _destination_visgraph[i].distance_cm;
+        }
     }
 
     // start algorithm from source point
-    node_index current_node_idx = 0;
+    const node_index source_node_idx = 0;
+
+    // mark source node as visited
+    _short_path_data[source_node_idx].visited = true;
 
     // update nodes visible from source point
     for (uint16_t i = 0; i < _source_visgraph.num_items(); i++) {
         node_index node_idx;
         if (find_node_from_id(_source_visgraph[i].id2, node_idx)) {
-            _short_path_data[node_idx].distance_cm = _source_visgraph[i].distance_cm;
-            _short_path_data[node_idx].distance_from_idx = current_node_idx;
+            update_node_distance(node_idx, source_node_idx, _source_visgraph[i].distance_cm);
         } else {
             err_id = AP_OADijkstra_Error::DIJKSTRA_ERROR_COULD_NOT_FIND_PATH;
             return false;
         }
     }
-    // mark source node as visited
-    _short_path_data[current_node_idx].visited = true;
+
+    _search_source = origin_NE;
+    _search_destination = destination_NE;
+    _search_best_idx = OA_DIJKSTRA_POLYGON_SHORTPATH_NOTSET_IDX;
+    _search_best_length_cm = FLT_MAX;
+
+    return true;
+}
+
+// continue shortest path search started by start_shortest_path until the destination is reached or the time slice starting at slice_start_us expires
+// returns true on success and complete is set true if the destination has been reached.  returns false on failure and err_id is updated
+bool AP_OADijkstra::continue_shortest_path(uint32_t slice_start_us, bool &complete, AP_OADijkstra_Error &err_id)
+{
+    complete = false;
 
     // move current_node_idx to node with lowest distance
+    node_index current_node_idx;
     while (find_closest_node_idx(current_node_idx)) {
+        // mark current node as visited
+        ShortPathNode &current_node = _short_path_data[current_node_idx];
+        current_node.visited = true;
+
+        // stop once destination is reached, its distance can no longer be reduced
+        if (current_node.id.id_type == AP_OAVisGraph::OATYPE_DESTINATION) {
+            complete = true;
+            return true;
+        }
+
+        // remember node which looks most promising in case the search is interrupted
+        Vector2f current_pos;
+        if (get_point(current_node.id.id_num, current_pos)) {
+            const float length_cm = current_node.distance_cm + (_search_destination - current_pos).length();
+            if (length_cm < _search_best_length_cm) {
+                _search_best_length_cm = length_cm;
+                _search_best_idx = current_node_idx;
+            }
+        }
+
         // update distances to all neighbours of current node
         update_visible_node_distances(current_node_idx);
 
-        // mark current node as visited
-        _short_path_data[current_node_idx].visited = true;
+        // yield if time slice has expired
+        if ((_slice_ms > 0) && (AP_HAL::micros() - slice_start_us >= _slice_ms * 1000UL)) {
+            return true;
+        }
     }
 
-    // extract path starting from destination
+    // all reachable nodes visited without reaching destination
+    err_id = AP_OADijkstra_Error::DIJKSTRA_ERROR_COULD_NOT_FIND_PATH;
+    return false;
+}
+
+// extract path from source to node_idx found by the shortest path search
+// returns true on success.  returns false on failure and err_id is updated
+// resulting path is stored in _path array
+bool AP_OADijkstra::extract_path(node_index node_idx, AP_OADijkstra_Error &err_id)
+{
     bool success = false;
-    node_index nidx;
-    if (!find_node_from_id({AP_OAVisGraph::OATYPE_DESTINATION,0}, nidx)) {
-        err_id = AP_OADijkstra_Error::DIJKSTRA_ERROR_COULD_NOT_FIND_PATH;
-        return false;
-    }
+    node_index nidx = node_idx;
     _path_numpoints = 0;
     while (true) {
         if (!_path.expand_to_hold(_path_numpoints + 1)) {
@@ -880,15 +1093,56 @@ bool AP_OADijkstra::calc_shortest_path(const Location &origin, const Location &d
     }
     // update source and destination for by get_shortest_path_point
     if (success) {
-        _path_source = origin_NE;
-        _path_destination = destination_NE;
+        _path_source = _search_source;
+        _path_destination = _search_destination;
     } else {
+        _path_numpoints = 0;
         err_id = AP_OADijkstra_Error::DIJKSTRA_ERROR_COULD_NOT_FIND_PATH;
     }
 
     return success;
 }
 
+// returns true if the path from the source to node_idx starts with the
+// first num_points points of the current path
+bool AP_OADijkstra::path_prefix_matches(node_index node_idx, uint8_t num_points) const
+{
+    if ((num_points == 0) || (num_points > _path_numpoints)) {
+        return false;
+    }
+
+    // count the points on the new path, following it as extract_path() does
+    uint16_t new_numpoints = 0;
+    node_index nidx = node_idx;
+    while (true) {
+        if ((_short_path_data[nidx].distance_from_idx == OA_DIJKSTRA_POLYGON_SHORTPATH_NOTSET_IDX) ||
+            (_short_path_data[nidx].distance_cm >= FLT_MAX) ||
+            (new_numpoints >= _short_path_data_numpoints)) {
+            return false;
+        }
+        new_numpoints++;
+        if (_short_path_data[nidx].id.id_type == AP_OAVisGraph::OATYPE_SOURCE) {
+            break;
+        }
+        nidx = _short_path_data[nidx].distance_from_idx;
+    }
+    if (new_numpoints < num_points) {
+        return false;
+    }
+
+    // compare the first num_points points, the walk visits them last
+    nidx = node_idx;
+    for (uint16_t i = new_numpoints; i > 0; i--) {
+        const uint16_t point_num = i - 1;
+        if ((point_num < num_points) &&
+            !(_short_path_data[nidx].id == _path[_path_numpoints - point_num - 1])) {
+            return false;
+        }
+        nidx = _short_path_data[nidx].distance_from_idx;
+    }
+    return true;
+}
+
 // return point from final path as an offset (in cm) from the ekf origin
 bool AP_OADijkstra::get_shortest_path_point(uint8_t point_num, Vector2f& pos)
 {
@@ -14,6 +14,7 @@ class AP_OADijkstra {
 public:
 
     AP_OADijkstra();
+    ~AP_OADijkstra();
 
     /* Do not allow copies */
     AP_OADijkstra(const AP_OADijkstra &other) = delete;
@@ -22,11 +23,20 @@ public:
     // set fence margin (in meters) used when creating "safe positions" within the polygon fence
     void set_fence_margin(float margin) { _polyfence_margin = MAX(margin, 0.0f); }
 
+    // set maximum time (in milliseconds) each call to update may spend searching for the shortest path
+    // if the search is not complete the best partial path found so far is returned and the search continues on the next call
+    // 0 disables time slicing so the search always runs to completion
+    void set_slice_ms(uint16_t slice_ms) { _slice_ms = slice_ms; }
+
+    // returns true if a time sliced shortest path search is incomplete and update should be called again soon
+    bool search_in_progress() const { return _search_in_progress; }
+
     // update return status enum
     enum AP_OADijkstra_State : uint8_t {
         DIJKSTRA_STATE_NOT_REQUIRED = 0,
         DIJKSTRA_STATE_ERROR,
-        DIJKSTRA_STATE_SUCCESS
+        DIJKSTRA_STATE_SUCCESS,
+        DIJKSTRA_STATE_PROCESSING       // time sliced search has not yet found any part of a path
     };
 
     // calculate a destination to avoid the polygon fence
@@ -104,17 +114,29 @@ private:
     bool get_point(uint16_t index, Vector2f& point) const;
 
     // returns true if line segment intersects polygon or circular fence
+    // polygon edges are checked using the fence loader's polygon index
     bool intersects_fence(const Vector2f &seg_start, const Vector2f &seg_end) const;
 
-    // create visibility graph for all fence (with margin) points
+    // check polygon fence edges are indexed and clear the fence point visibility matrix
+    // visibility between fence points is then calculated on demand by update_fence_visibility
     // returns true on success.  returns false on failure and err_id is updated
     bool create_fence_visgraph(AP_OADijkstra_Error &err_id);
 
-    // calculate shortest path from origin to destination
+    // calculate visibility from a fence (with margin) point to all other fence points if not already known
+    void update_fence_visibility(uint8_t point_idx);
+
+    // returns true if fence point j is visible from fence point i
+    // requires update_fence_visibility(i) to have been run
+    bool fence_point_visible(uint8_t i, uint8_t j) const;
+
+    // start calculating shortest path from origin to destination
     // returns true on success.  returns false on failure and err_id is updated
     // requires create_polygon_fence_with_margin and create_polygon_fence_visgraph to have been run
-    // resulting path is stored in _shortest_path array as vector offsets from EKF origin
-    bool calc_shortest_path(const Location &origin, const Location &destination, AP_OADijkstra_Error &err_id);
+    bool start_shortest_path(const Location &origin, const Location &destination, AP_OADijkstra_Error &err_id);
+
+    // continue shortest path search started by start_shortest_path until the destination is reached or the time slice starting at slice_start_us expires
+    // returns true on success and complete is set true if the destination has been reached.  returns false on failure and err_id is updated
+    bool continue_shortest_path(uint32_t slice_start_us, bool &complete, AP_OADijkstra_Error &err_id);
 
     // shortest path state variables
     bool _inclusion_polygon_with_margin_ok;
@@ -122,6 +144,8 @@ private:
     bool _exclusion_circle_with_margin_ok;
     bool _polyfence_visgraph_ok;
     bool _shortest_path_ok;
+    bool _search_in_progress;       // true if a time sliced shortest path search has been started but has not reached the destination
+    uint16_t _slice_ms;             // maximum time spent searching during each call to update (0 for no limit)
 
     Location _destination_prev;     // destination of previous iterations (used to determine if path should be re-calculated)
     uint8_t _path_idx_returned;     // index into _path array which gives location vehicle should be currently moving towards
@@ -142,10 +166,16 @@ private:
     uint8_t _exclusion_circle_numpoints;    // number of points held in above array
     uint32_t _exclusion_circle_update_ms;   // system time exclusion circles were updated (used to detect changes)
 
+    // visibility between fence (with margin) points, calculated a row at a time as the shortest path search reaches each point
+    uint8_t *_fence_visible;                // bit matrix, bit j of row i is set if point j is visible from point i
+    uint8_t *_fence_visible_row_ok;         // bit i is set once row i of _fence_visible has been calculated
+    uint16_t _fence_visible_numpoints;      // number of points (rows and columns) held in _fence_visible
+
     // visibility graphs
-    AP_OAVisGraph _fence_visgraph;          // holds distances between all inclusion/exclusion fence points (with margin)
     AP_OAVisGraph _source_visgraph;         // holds distances from source point to all other nodes
     AP_OAVisGraph _destination_visgraph;    // holds distances from the destination to all other nodes
+    bool _destination_visgraph_ok;          // true if _destination_visgraph is valid for _destination_visgraph_pos and the current fence
+    Vector2f _destination_visgraph_pos;     // destination used to build _destination_visgraph (offset in cm from EKF origin)
 
     // updates visibility graph for a given position which is an offset (in cm) from the ekf origin
     // to add an additional position (i.e. the destination) set add_extra_position = true and provide the position in the extra_position argument
@@ -159,21 +189,42 @@ private:
         bool visited;                   // true if all this node's neighbour's distances have been updated
         node_index distance_from_idx;   // index into _short_path_data from where distance was updated (or 255 if not set)
         float distance_cm;              // distance from source (number is tentative until this node is the current node and/or visited = true)
+        float distance_to_destination_cm; // distance to destination if visible from this node, FLT_MAX if not
+        uint16_t heap_idx;              // index into _short_path_heap (or UINT16_MAX if not in heap)
     };
     AP_ExpandingArray<ShortPathNode> _short_path_data;
     node_index _short_path_data_numpoints;  // number of elements in _short_path_data array
 
+    // binary min-heap of indexes into _short_path_data ordered by distance_cm, holds unvisited nodes with a tentative distance
+    AP_ExpandingArray<node_index> _short_path_heap;
+    uint16_t _short_path_heap_numpoints;    // number of elements in _short_path_heap array
+
+    // best partial path found so far by a time sliced search
+    Vector2f _search_source;                // source position of search in progress (offset in cm from EKF origin)
+    Vector2f _search_destination;           // destination position of search in progress (offset in cm from EKF origin)
+    node_index _search_best_idx;            // visited node with the lowest estimated total path length (or 255 if not set)
+    float _search_best_length_cm;           // distance from source to _search_best_idx plus straight line distance from it to destination
+
+    // add a node to the heap or move it towards the top after its distance has been reduced
+    void heap_update(node_index node_idx);
+
+    // move the heap element at heap_idx to a new position in the heap, keeping node's heap_idx in sync
+    void heap_set(uint16_t heap_idx, node_index node_idx);
+
     // update total distance for all nodes visible from current node
     // curr_node_idx is an index into the _short_path_data array
     void update_visible_node_distances(node_index curr_node_idx);
 
+    // update a node's distance if reaching it via from_idx is shorter than its current distance
+    void update_node_distance(node_index node_idx, node_index from_idx, float distance_cm);
+
     // find a node's index into _short_path_data array from it's id (i.e. id type and id number)
     // returns true if successful and node_idx is updated
     bool find_node_from_id(const AP_OAVisGraph::OAItemID &id, node_index &node_idx) const;
 
-    // find index of node with lowest tentative distance (ignore visited nodes)
+    // remove node with lowest tentative distance from the heap
     // returns true if successful and node_idx argument is updated
-    bool find_closest_node_idx(node_index &node_idx) const;
+    bool find_closest_node_idx(node_index &node_idx);
 
     // final path variables and functions
     AP_ExpandingArray<AP_OAVisGraph::OAItemID> _path;   // ids of points on return path in reverse order (i.e. destination is first element)
@@ -181,6 +232,15 @@ private:
     Vector2f _path_source;                              // source point used in shortest path calculations (offset in cm from EKF origin)
     Vector2f _path_destination;                         // destination position used in shortest path calculations (offset in cm from EKF origin)
 
+    // extract path from source to node_idx found by the shortest path search
+    // returns true on success.  returns false on failure and err_id is updated
+    // resulting path is stored in _path array
+    bool extract_path(node_index node_idx, AP_OADijkstra_Error &err_id);
+
+    // returns true if the path from the source to node_idx starts with the
+    // first num_points points of the current path
+    bool path_prefix_matches(node_index node_idx, uint8_t num_points) const;
+
     // return point from final path as an offset (in cm) from the ekf origin
     bool get_shortest_path_point(uint8_t point_num, Vector2f& pos);
 
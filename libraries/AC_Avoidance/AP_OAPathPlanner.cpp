@@ -66,6 +66,15 @@ const AP_Param::GroupInfo AP_OAPathPlanner::var_info[] = {
     // @Path: AP_OADatabase.cpp
     AP_SUBGROUPINFO(_oadatabase, "DB_", 4, AP_OAPathPlanner, AP_OADatabase),
 
+    // @Param: SLICE_MS
+    // @DisplayName: Object Avoidance path planning time slice
+    // @Description: Dijkstra's path planning will return the best path found so far if planning takes longer than this and continue refining it.  Set to zero to always wait for planning to complete
+    // @Units: ms
+    // @Range: 0 1000
+    // @Increment: 1
+    // @User: Advanced
+    AP_GROUPINFO("SLICE_MS", 5, AP_OAPathPlanner, _slice_ms, 0),
+
     AP_GROUPEND
 };
 
@@ -168,14 +177,23 @@ AP_OAPathPlanner::OA_RetState AP_OAPathPlanner::mission_avoidance(const Location
     }
 
     const uint32_t now = AP_HAL::millis();
-    WITH_SEMAPHORE(_rsem);
 
     // place new request for the thread to work on
-    avoidance_request.current_loc = current_loc;
-    avoidance_request.origin = origin;
-    avoidance_request.destination = destination;
-    avoidance_request.ground_speed_vec = AP::ahrs().groundspeed_vector();
-    avoidance_request.request_time_ms = now;
+    // if the thread is copying the previous request this one is skipped, the next call will place a newer one
+    if (_rsem.take_nonblocking()) {
+        avoidance_request.current_loc = current_loc;
+        avoidance_request.origin = origin;
+        avoidance_request.destination = destination;
+        avoidance_request.ground_speed_vec = AP::ahrs().groundspeed_vector();
+        avoidance_request.request_time_ms = now;
+        _rsem.give();
+    }
+
+    // get background thread's latest result
+    avoidance_result_info avoidance_result;
+    if (!get_avoidance_result(avoidance_result)) {
+        return OA_PROCESSING;
+    }
 
     // check result's destination matches our request
     const bool destination_matches = (destination.lat == avoidance_result.destination.lat) && (destination.lng == avoidance_result.destination.lng);
@@ -205,15 +223,18 @@ void AP_OAPathPlanner::avoidance_thread()
 {
     while (true) {
 
+        // continue a time sliced path planning search as soon as possible
+        const bool search_in_progress = (_type == OA_PATHPLAN_DIJKSTRA) && (_oadijkstra != nullptr) && _oadijkstra->search_in_progress();
+
         // if database queue needs attention, service it faster
-        if (_oadatabase.process_queue()) {
+        if (_oadatabase.process_queue() || search_in_progress) {
             hal.scheduler->delay(1);
         } else {
             hal.scheduler->delay(20);
         }
 
         const uint32_t now = AP_HAL::millis();
-        if (now - avoidance_latest_ms < OA_UPDATE_MS) {
+        if (!search_in_progress && (now - avoidance_latest_ms < OA_UPDATE_MS)) {
             continue;
         }
         avoidance_latest_ms = now;
@@ -257,6 +278,7 @@ void AP_OAPathPlanner::avoidance_thread()
                 continue;
             }
             _oadijkstra->set_fence_margin(_margin_max);
+            _oadijkstra->set_slice_ms(MAX(_slice_ms, 0));
             const AP_OADijkstra::AP_OADijkstra_State dijkstra_state = _oadijkstra->update(avoidance_request2.current_loc, avoidance_request2.destination, origin_new, destination_new);
             switch (dijkstra_state) {
             case AP_OADijkstra::DIJKSTRA_STATE_NOT_REQUIRED:
@@ -268,20 +290,50 @@ void AP_OAPathPlanner::avoidance_thread()
             case AP_OADijkstra::DIJKSTRA_STATE_SUCCESS:
                 res = OA_SUCCESS;
                 break;
+            case AP_OADijkstra::DIJKSTRA_STATE_PROCESSING:
+                res = OA_PROCESSING;
+                break;
             }
             break;
         }
 
-        {
-            // give the main thread the avoidance result
-            WITH_SEMAPHORE(_rsem);
-            avoidance_result.destination = avoidance_request2.destination;
-            avoidance_result.origin_new = (res == OA_SUCCESS) ? origin_new : avoidance_result.origin_new;
-            avoidance_result.destination_new = (res == OA_SUCCESS) ? destination_new : avoidance_result.destination;
-            avoidance_result.result_time_ms = AP_HAL::millis();
-            avoidance_result.ret_state = res;
+        // give the main thread the avoidance result
+        const avoidance_result_info &prev_result = _avoidance_result[_avoidance_result_publish_count & 1];
+        avoidance_result_info result;
+        result.destination = avoidance_request2.destination;
+        result.origin_new = (res == OA_SUCCESS) ? origin_new : prev_result.origin_new;
+        result.destination_new = (res == OA_SUCCESS) ? destination_new : prev_result.destination;
+        result.result_time_ms = AP_HAL::millis();
+        result.ret_state = res;
+        publish_avoidance_result(result);
+    }
+}
+
+// publish a new result from the avoidance thread
+void AP_OAPathPlanner::publish_avoidance_result(const avoidance_result_info &result)
+{
+    // announce which buffer is about to be written before writing it
+    const uint32_t count = _avoidance_result_publish_count.load(std::memory_order_relaxed) + 1;
+    _avoidance_result_write_count.store(count, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    _avoidance_result[count & 1] = result;
+    _avoidance_result_publish_count.store(count, std::memory_order_release);
+}
+
+// get latest published result, returns false if it could not be read because the avoidance thread was overwriting it
+bool AP_OAPathPlanner::get_avoidance_result(avoidance_result_info &result) const
+{
+    for (uint8_t i = 0; i < 3; i++) {
+        const uint32_t count = _avoidance_result_publish_count.load(std::memory_order_acquire);
+        result = _avoidance_result[count & 1];
+        std::atomic_thread_fence(std::memory_order_acquire);
+        // the copy is only corrupt if the thread has since started writing the same buffer
+        if (_avoidance_result_write_count.load(std::memory_order_relaxed) - count < 2) {
+            return true;
         }
     }
+    return false;
 }
 
 // singleton instance
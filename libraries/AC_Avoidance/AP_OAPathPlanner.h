@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <AP_Common/AP_Common.h>
 #include <AP_Common/Location.h>
 #include <AP_Param/AP_Param.h>
@@ -82,21 +83,34 @@ private:
     } avoidance_request, avoidance_request2;
 
     // an avoidance result from the avoidance thread
-    struct {
+    struct avoidance_result_info {
         Location destination;       // destination vehicle is trying to get to (also used to verify the result matches a recent request)
         Location origin_new;        // intermediate origin.  The start of line segment that vehicle should follow
         Location destination_new;   // intermediate destination vehicle should move towards
         uint32_t result_time_ms;    // system time the result was calculated (used to verify the result is recent)
         OA_RetState ret_state;      // OA_SUCCESS if the vehicle should move along the path from origin_new to destination_new
-    } avoidance_result;
+    };
+
+    // results are double buffered so the navigation code can read the latest result without waiting for the avoidance thread
+    // the avoidance thread only writes to the buffer which is not currently published
+    avoidance_result_info _avoidance_result[2];
+    std::atomic<uint32_t> _avoidance_result_write_count{0}; // number of results the avoidance thread has started writing
+    std::atomic<uint32_t> _avoidance_result_publish_count{0}; // number of results published, latest is in _avoidance_result[_avoidance_result_publish_count & 1]
+
+    // publish a new result from the avoidance thread
+    void publish_avoidance_result(const avoidance_result_info &result);
+
+    // get latest published result, returns false if it could not be read because the avoidance thread was overwriting it
+    bool get_avoidance_result(avoidance_result_info &result) const;
 
     // parameters
     AP_Int8 _type;                  // avoidance algorith to be used
     AP_Float _lookahead;            // object avoidance will look this many meters ahead of vehicle
     AP_Float _margin_max;           // object avoidance will ignore objects more than this many meters from vehicle
+    AP_Int16 _slice_ms;             // path planning time slice, the best path found so far is returned if planning takes longer than this
 
     // internal variables used by front end
-    HAL_Semaphore_Recursive _rsem;  // semaphore for multi-thread use of avoidance_request and avoidance_result
+    HAL_Semaphore_Recursive _rsem;  // semaphore for multi-thread use of avoidance_request
     bool _thread_created;           // true once background thread has been created
     AP_OABendyRuler *_oabendyruler; // Bendy Ruler algorithm
     AP_OADijkstra *_oadijkstra;     // Dijkstra's algorithm
@@ -210,19 +210,26 @@ bool AC_PolyFence_loader::breached(const Vector2f& pos_cm) const
         return false;
     }
 
-    // check we are inside each inclusion zone:
-    for (uint8_t i=0; i<_num_loaded_inclusion_boundaries; i++) {
-        const InclusionBoundary &boundary = _loaded_inclusion_boundary[i];
-        if (Polygon_outside(pos_cm, boundary.points, boundary.count)) {
+    if (_polygon_index.built()) {
+        // check inclusion and exclusion zones together using the index
+        if (_polygon_index.outside(pos_cm)) {
             return true;
         }
-    }
+    } else {
+        // check we are inside each inclusion zone:
+        for (uint8_t i=0; i<_num_loaded_inclusion_boundaries; i++) {
+            const InclusionBoundary &boundary = _loaded_inclusion_boundary[i];
+            if (Polygon_outside(pos_cm, boundary.points, boundary.count)) {
+                return true;
+            }
+        }
 
-    // check we are outside each exclusion zone:
-    for (uint8_t i=0; i<_num_loaded_exclusion_boundaries; i++) {
-        const ExclusionBoundary &boundary = _loaded_exclusion_boundary[i];
-        if (!Polygon_outside(pos_cm, boundary.points, boundary.count)) {
-            return true;
+        // check we are outside each exclusion zone:
+        for (uint8_t i=0; i<_num_loaded_exclusion_boundaries; i++) {
+            const ExclusionBoundary &boundary = _loaded_exclusion_boundary[i];
+            if (!Polygon_outside(pos_cm, boundary.points, boundary.count)) {
+                return true;
+            }
         }
     }
 
@@ -563,6 +570,54 @@ void AC_PolyFence_loader::unload()
 
     _loaded_return_point = nullptr;
     _load_time_ms = 0;
+
+    _polygon_index.clear();
+}
+
+// build_polygon_index - index the edges of the loaded inclusion and
+// exclusion polygons.  breached() checks each polygon in turn if
+// this fails
+bool AC_PolyFence_loader::build_polygon_index()
+{
+    uint16_t num_edges = 0;
+    for (uint8_t i=0; i<_num_loaded_inclusion_boundaries; i++) {
+        num_edges += _loaded_inclusion_boundary[i].count;
+    }
+    for (uint8_t i=0; i<_num_loaded_exclusion_boundaries; i++) {
+        num_edges += _loaded_exclusion_boundary[i].count;
+    }
+    if (!_polygon_index.init(num_edges)) {
+        return false;
+    }
+    for (uint8_t i=0; i<_num_loaded_inclusion_boundaries; i++) {
+        const InclusionBoundary &boundary = _loaded_inclusion_boundary[i];
+        if (!_polygon_index.add_polygon(boundary.points, boundary.count, true)) {
+            _polygon_index.clear();
+            return false;
+        }
+    }
+    for (uint8_t i=0; i<_num_loaded_exclusion_boundaries; i++) {
+        const ExclusionBoundary &boundary = _loaded_exclusion_boundary[i];
+        if (!_polygon_index.add_polygon(boundary.points, boundary.count, false)) {
+            _polygon_index.clear();
+            return false;
+        }
+    }
+    if (!_polygon_index.build()) {
+        _polygon_index.clear();
+        return false;
+    }
+    return true;
+}
+
+// get_polygon_index - returns index of the loaded polygon edges or
+// nullptr if there are no polygons or the index could not be built
+const AP_SegmentGrid *AC_PolyFence_loader::get_polygon_index() const
+{
+    if (!loaded() || !_polygon_index.built()) {
+        return nullptr;
+    }
+    return &_polygon_index;
 }
 
 // return the number of fences of type type in the index:
@@ -807,6 +862,10 @@ bool AC_PolyFence_loader::load_from_eeprom()
         return false;
     }
 
+    if (!build_polygon_index()) {
+        gcs().send_text(MAV_SEVERITY_WARNING, "AC_Fence: polygon index failed");
+    }
+
     _load_time_ms = AP_HAL::millis();
 
     get_loaded_fence_semaphore().give();
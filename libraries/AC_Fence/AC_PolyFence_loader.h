@@ -3,6 +3,7 @@
 #include <AP_Common/AP_Common.h>
 #include <AP_Common/Location.h>
 #include <AP_Math/AP_Math.h>
+#include <AP_Math/AP_SegmentGrid.h>
 #include <GCS_MAVLink/GCS_MAVLink.h>
 
 #define AC_POLYFENCE_FENCE_POINT_PROTOCOL_SUPPORT 1
@@ -81,6 +82,11 @@ public:
         return _load_time_ms;
     }
 
+    /// returns index of the edges of all inclusion and exclusion polygons, rebuilt when the fence is loaded
+    /// returns nullptr if there are no polygons or there was not enough memory to build the index
+    /// callers on other threads must hold the loaded fence semaphore while using it
+    const AP_SegmentGrid *get_polygon_index() const;
+
     ///
     /// exclusion circles
     ///
@@ -264,6 +270,12 @@ private:
     ExclusionBoundary *_loaded_exclusion_boundary;
     uint8_t _num_loaded_exclusion_boundaries;
 
+    // _polygon_index - grid of the edges of all loaded inclusion and
+    // exclusion polygons used to check for breaches without testing
+    // every polygon
+    AP_SegmentGrid _polygon_index;
+    bool build_polygon_index() WARN_IF_UNUSED;
+
     // _loaded_offsets_from_origin - stores x/y offset-from-origin
     // coordinate pairs.  Various items store their locations in this
     // allocation - the polygon boundaries and the return point, for
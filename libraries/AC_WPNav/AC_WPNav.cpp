@@ -135,6 +135,23 @@ const AP_Param::GroupInfo AC_WPNav::var_info[] = {
     // @User: Standard
     AP_GROUPINFO("WPOV_MAX", 20, AC_WPNav, _wp_fast_overshoot_max, WPNAV_WP_FAST_OVERSHOOT_MAX),
 
+    // @Param: LOOKAHEAD
+    // @DisplayName: Waypoint lookahead legs
+    // @Description: Number of mission legs after a fast waypoint used to plan the speed through its corner. The speed is reduced for sharp corners and short legs so the vehicle can always stop at the end of the last leg planned. Zero disables planning, so fast waypoints are passed at full speed
+    // @Range: 0 8
+    // @Increment: 1
+    // @User: Advanced
+    AP_GROUPINFO("LOOKAHEAD", 21, AC_WPNav, _lookahead_legs, WPNAV_LOOKAHEAD_LEGS_DEFAULT),
+
+    // @Param: JERK
+    // @DisplayName: Waypoint jerk
+    // @Description: Rate of change of acceleration used when planning the speed through waypoint corners. Lower values begin slowing down for corners earlier
+    // @Units: cm/s/s/s
+    // @Range: 100 10000
+    // @Increment: 10
+    // @User: Advanced
+    AP_GROUPINFO("JERK", 22, AC_WPNav, _wp_jerk_cmsss, WPNAV_JERK),
+
 
     AP_GROUPEND
 };
@@ -296,6 +313,15 @@ bool AC_WPNav::set_wp_destination_NED(const Vector3f& destination_NED)
 ///     returns false on failure (likely caused by missing terrain data)
 bool AC_WPNav::set_wp_origin_and_destination(const Vector3f& origin, const Vector3f& destination, bool terrain_alt)
 {
+    // when advancing through a mission the new destination is the
+    // first of the next legs, so the rest of them are kept
+    if (_next_leg_count > 0 && terrain_alt == _terrain_alt && (destination - _next_legs[0]).length() < 1.0f) {
+        _next_leg_count--;
+        memmove(&_next_legs[0], &_next_legs[1], _next_leg_count * sizeof(_next_legs[0]));
+    } else {
+        _next_leg_count = 0;
+    }
+
     // store origin and destination locations
     _origin = origin;
     _destination = destination;
@@ -318,6 +344,9 @@ bool AC_WPNav::set_wp_origin_and_destination(const Vector3f& origin, const Vecto
     // calculate leash lengths
     calculate_wp_leash_length();
 
+    // plan the speed at the destination
+    plan_next_legs();
+
     // get origin's alt-above-terrain
     float origin_terr_offset = 0.0f;
     if (terrain_alt) {
@@ -511,6 +540,10 @@ bool AC_WPNav::advance_wp_target_along_track(float dt)
                 if (_flags.slowing_down) {
                     _limited_speed_xy_cms = MIN(_limited_speed_xy_cms, get_slow_down_speed(dist_to_dest, _track_accel));
                 }
+            } else if (_next_leg_count > 0) {
+                // slow down to the speed planned for the corner at the destination
+                const float dist_to_dest = MAX(_track_length - _track_desired, 0.0f);
+                _limited_speed_xy_cms = MIN(_limited_speed_xy_cms, get_entry_speed(_leg_end_speed, dist_to_dest, _track_accel, _wp_jerk_cmsss));
             }
 
             // if our current velocity is within the linear velocity range limit the intermediate point's velocity to be no more than the linear_velocity above or below our current velocity
@@ -878,6 +911,9 @@ bool AC_WPNav::set_spline_origin_and_destination(const Vector3f& origin, const V
         update_spline_solution(origin, destination, _spline_origin_vel, _spline_destination_vel);
     }
 
+    // lookahead planning is only used for straight segments
+    _next_leg_count = 0;
+
     // store origin and destination locations
     _origin = origin;
     _destination = destination;
@@ -1177,6 +1213,120 @@ float AC_WPNav::get_slow_down_speed(float dist_from_dest_cm, float accel_cmss)
     }
 }
 
+/// add_next_leg - add the destination of the leg following the current destination and any legs already added
+///     returns false if lookahead is disabled or full, or the location cannot be converted to the frame of the current destination
+bool AC_WPNav::add_next_leg(const Location& destination)
+{
+    if (_next_leg_count >= constrain_int16(_lookahead_legs, 0, WPNAV_LOOKAHEAD_LEGS_MAX)) {
+        return false;
+    }
+
+    Vector3f dest_neu;
+    bool terr_alt;
+    if (!get_vector_NEU(destination, dest_neu, terr_alt) || terr_alt != _terrain_alt) {
+        return false;
+    }
+
+    _next_legs[_next_leg_count++] = dest_neu;
+    plan_next_legs();
+    return true;
+}
+
+/// clear_next_legs - forget the legs after the current destination
+void AC_WPNav::clear_next_legs()
+{
+    _next_leg_count = 0;
+    plan_next_legs();
+}
+
+/// plan_next_legs - calculate the speed at the end of the current leg from the corners and lengths of the legs which follow
+void AC_WPNav::plan_next_legs()
+{
+    _leg_end_speed = plan_leg_end_speed(_origin, _destination, _next_legs, _next_leg_count,
+                                        _pos_control.get_max_speed_xy(), _pv_fastwp_radius_cm,
+                                        _wp_accel_cmss, _wp_jerk_cmsss);
+}
+
+/// plan_leg_end_speed - returns the speed in cm/s at which to pass destination so that the target can follow the legs
+///     to each of next_legs, turning inside corner_radius_cm at each corner, and stop at the last
+float AC_WPNav::plan_leg_end_speed(const Vector3f& origin, const Vector3f& destination, const Vector3f next_legs[], uint8_t num_legs,
+                                   float speed_max, float corner_radius_cm, float accel_cmss, float jerk_cmsss)
+{
+    // the points of the path, leaving out legs with no direction so
+    // that a repeated waypoint doesn't hide the corner it is on
+    Vector3f points[WPNAV_LOOKAHEAD_LEGS_MAX + 2];
+    uint8_t num_points = 1;
+    uint8_t dest_point = 0;
+    points[0] = origin;
+    num_legs = MIN(num_legs, WPNAV_LOOKAHEAD_LEGS_MAX);
+    for (uint8_t i = 0; i <= num_legs; i++) {
+        const Vector3f &point = (i == 0) ? destination : next_legs[i-1];
+        if ((point - points[num_points-1]).length() >= WPNAV_LEG_LENGTH_MIN) {
+            points[num_points++] = point;
+        }
+        if (i == 0) {
+            dest_point = num_points - 1;
+        }
+    }
+
+    // work back from the last point, where the vehicle must be able to
+    // stop, to the corner at the destination
+    float speed = 0.0f;
+    for (uint8_t i = num_points - 1; i > dest_point; i--) {
+        const Vector3f leg = points[i] - points[i-1];
+        speed = MIN(get_entry_speed(speed, leg.length(), accel_cmss, jerk_cmsss), speed_max);
+        if (i >= 2) {
+            speed = MIN(speed, get_corner_speed(points[i-1] - points[i-2], leg, speed_max, corner_radius_cm, accel_cmss));
+        }
+    }
+
+    return speed;
+}
+
+/// get_corner_speed - returns the highest speed in cm/s up to speed_max at which the target can turn from leg_in onto leg_out
+///     on an arc tangent to both legs corner_radius_cm from the corner
+float AC_WPNav::get_corner_speed(const Vector3f& leg_in, const Vector3f& leg_out, float speed_max, float corner_radius_cm, float accel_cmss)
+{
+    const float length_in = leg_in.length();
+    const float length_out = leg_out.length();
+    if (is_zero(length_in) || is_zero(length_out)) {
+        return speed_max;
+    }
+
+    // the vehicle cuts the corner within the fast waypoint radius, so
+    // turns on an arc tangent to both legs that distance from the corner
+    const float cos_turn = constrain_float((leg_in * leg_out) / (length_in * length_out), -1.0f, 1.0f);
+    if (cos_turn <= -0.99f) {
+        // turning back along the same line needs a stop
+        return 0.0f;
+    }
+    const float tan_half_turn = safe_sqrt((1.0f - cos_turn) / (1.0f + cos_turn));
+    if (is_zero(tan_half_turn)) {
+        return speed_max;
+    }
+    const float turn_radius = corner_radius_cm / tan_half_turn;
+
+    return MIN(safe_sqrt(accel_cmss * turn_radius), speed_max);
+}
+
+/// get_entry_speed - returns the highest speed in cm/s from which the target can slow to exit_speed over dist_cm
+///     with the acceleration limited to accel_cmss and its rate of change limited to jerk_cmsss
+float AC_WPNav::get_entry_speed(float exit_speed, float dist_cm, float accel_cmss, float jerk_cmsss)
+{
+    if (!is_positive(accel_cmss) || !is_positive(dist_cm)) {
+        return exit_speed;
+    }
+
+    // slowing from v1 to v0 needs (v1^2-v0^2)/2a plus the distance
+    // covered while the acceleration ramps up and down, which is at
+    // most (v1+v0)*a/2j. Solve for v1
+    const float k = is_positive(jerk_cmsss) ? sq(accel_cmss) / jerk_cmsss : 0.0f;
+    const float c = k * exit_speed - sq(exit_speed) - 2.0f * accel_cmss * dist_cm;
+    const float entry_speed = 0.5f * (safe_sqrt(sq(k) - 4.0f * c) - k);
+
+    return MAX(entry_speed, exit_speed);
+}
+
 /// wp_speed_update - calculates how to handle speed change requests
 void AC_WPNav::wp_speed_update(float dt)
 {
@@ -47,8 +47,15 @@
 
 #define WPNAV_RANGEFINDER_FILT_Z         0.25f      // range finder distance filtered at 0.25hz
 
+#define WPNAV_LOOKAHEAD_LEGS_MAX            8       // maximum number of legs after the current destination used to plan the speed through corners
+#define WPNAV_LOOKAHEAD_LEGS_DEFAULT        0       // default number of legs after the current destination used to plan the speed through corners, zero disables planning
+#define WPNAV_JERK                       1000.0f    // default jerk in cm/s/s/s used when planning speed changes between corners
+#define WPNAV_LEG_LENGTH_MIN             1.0f      // legs shorter than this in cm have no direction and are left out of corner planning
+
 class AC_WPNav
 {
+    friend class AC_WPNav_Test;
+
 public:
 
     // spline segment end types enum
@@ -176,6 +183,25 @@ public:
 
     void resetReachedPreviousWaypoint(){_flags.reached_previous_wpt = false;}
 
+    ///
+    /// lookahead planning
+    ///     knowing the legs which follow the destination lets the target pass through each fast waypoint
+    ///     at the speed its corner and the legs after it allow, rather than always at full speed
+    ///
+
+    /// add_next_leg - add the destination of the leg following the current destination and any legs already added
+    ///     returns false if lookahead is disabled or full, or the location cannot be converted to the frame of the current destination
+    bool add_next_leg(const Location& destination);
+
+    /// clear_next_legs - forget the legs after the current destination
+    void clear_next_legs();
+
+    /// num_next_legs - number of legs after the current destination that are known
+    uint8_t num_next_legs() const { return _next_leg_count; }
+
+    /// get_leg_end_speed - planned speed in cm/s along track when passing the current destination
+    float get_leg_end_speed() const { return _leg_end_speed; }
+
     //precisionvision: 
     void set_execute_do_cmds_before_next_nav(bool executeDoCmdsBeforeNav){ _flags.do_cmds_before_next_nav = executeDoCmdsBeforeNav;}
     public:
@@ -285,6 +311,22 @@ protected:
 
     /// get_slow_down_speed - returns target speed of target point based on distance from the destination (in cm)
     float get_slow_down_speed(float dist_from_dest_cm, float accel_cmss);
+
+    /// plan_next_legs - calculate the speed at the end of the current leg from the corners and lengths of the legs which follow
+    void plan_next_legs();
+
+    /// plan_leg_end_speed - returns the speed in cm/s at which to pass destination so that the target can follow the legs
+    ///     to each of next_legs, turning inside corner_radius_cm at each corner, and stop at the last
+    static float plan_leg_end_speed(const Vector3f& origin, const Vector3f& destination, const Vector3f next_legs[], uint8_t num_legs,
+                                    float speed_max, float corner_radius_cm, float accel_cmss, float jerk_cmsss);
+
+    /// get_corner_speed - returns the highest speed in cm/s up to speed_max at which the target can turn from leg_in onto leg_out
+    ///     on an arc tangent to both legs corner_radius_cm from the corner
+    static float get_corner_speed(const Vector3f& leg_in, const Vector3f& leg_out, float speed_max, float corner_radius_cm, float accel_cmss);
+
+    /// get_entry_speed - returns the highest speed in cm/s from which the target can slow to exit_speed over dist_cm
+    ///     with the acceleration limited to accel_cmss and its rate of change limited to jerk_cmsss
+    static float get_entry_speed(float exit_speed, float dist_cm, float accel_cmss, float jerk_cmsss);
     
     /// wp_speed_update - calculates how to change speed when changes are requested
     void wp_speed_update(float dt);
@@ -343,6 +385,11 @@ protected:
     float       _track_leash_length;    // leash length along track
     float       _slow_down_dist;        // vehicle should begin to slow down once it is within this distance from the destination
 
+    // lookahead planning variables
+    Vector3f    _next_legs[WPNAV_LOOKAHEAD_LEGS_MAX];   // destinations of the legs after the current destination in cm from ekf origin
+    uint8_t     _next_leg_count;        // number of valid entries in _next_legs
+    float       _leg_end_speed;         // planned speed in cm/s when passing the current destination
+
     // spline variables
     float       _spline_time;           // current spline time between origin and destination
     float       _spline_time_scale;     // current spline time between origin and destination
@@ -367,5 +414,7 @@ protected:
     AP_Int32  _yaw_leash_len_min;
     AP_Float  _yaw_leash_pct_min;
     AP_Float _wp_fast_overshoot_max;
+    AP_Int8  _lookahead_legs;
+    AP_Float _wp_jerk_cmsss;
 
 };
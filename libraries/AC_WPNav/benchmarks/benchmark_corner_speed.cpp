@@ -0,0 +1,42 @@
+#include <AP_gbenchmark.h>
+
+#include <AC_WPNav/AC_WPNav.h>
+
+/*
+  cost of planning the speed at the end of the current leg through the
+  corners of the legs after it, as done each time a waypoint is reached
+ */
+
+const AP_HAL::HAL &hal = AP_HAL::get_HAL();
+
+class AC_WPNav_Test
+{
+public:
+    // plan the end of a leg followed by state.range_x() legs of a zigzag
+    static void plan(benchmark::State& state)
+    {
+        const uint8_t num_legs = state.range_x();
+        const Vector3f origin;
+        const Vector3f destination(5000, 0, 0);
+        Vector3f next_legs[WPNAV_LOOKAHEAD_LEGS_MAX];
+        for (uint8_t i = 0; i < num_legs; i++) {
+            next_legs[i] = Vector3f(5000 * (i + 2), (i % 2 == 0) ? 3000 : 0, 100 * i);
+        }
+
+        float speed = 0;
+        while (state.KeepRunning()) {
+            speed += AC_WPNav::plan_leg_end_speed(origin, destination, next_legs, num_legs,
+                                                  1000.0f, 200.0f, 250.0f, 1000.0f);
+            benchmark::DoNotOptimize(speed);
+        }
+        state.SetItemsProcessed(state.iterations() * (num_legs + 1));
+    }
+};
+
+static void BM_WPNavPlanLegEndSpeed(benchmark::State& state)
+{
+    AC_WPNav_Test::plan(state);
+}
+BENCHMARK(BM_WPNavPlanLegEndSpeed)->DenseRange(0, WPNAV_LOOKAHEAD_LEGS_MAX);
+
+BENCHMARK_MAIN()
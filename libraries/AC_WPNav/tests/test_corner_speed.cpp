@@ -0,0 +1,179 @@
+#include <AP_gtest.h>
+
+#include <AC_WPNav/AC_WPNav.h>
+
+const AP_HAL::HAL &hal = AP_HAL::get_HAL();
+
+static const float speed_max = 1000.0f;
+static const float corner_radius = 200.0f;
+static const float accel = 250.0f;
+static const float jerk = 1000.0f;
+
+class AC_WPNav_Test
+{
+public:
+    static float corner_speed(const Vector3f &leg_in, const Vector3f &leg_out)
+    {
+        return AC_WPNav::get_corner_speed(leg_in, leg_out, speed_max, corner_radius, accel);
+    }
+
+    static float entry_speed(float exit_speed, float dist_cm, float jerk_cmsss = jerk)
+    {
+        return AC_WPNav::get_entry_speed(exit_speed, dist_cm, accel, jerk_cmsss);
+    }
+
+    // the speed at destination, followed by the legs to each point in turn
+    static float leg_end_speed(const Vector3f &origin, const Vector3f &destination, std::initializer_list<Vector3f> legs)
+    {
+        Vector3f next_legs[WPNAV_LOOKAHEAD_LEGS_MAX];
+        uint8_t num_legs = 0;
+        for (const Vector3f &leg : legs) {
+            next_legs[num_legs++] = leg;
+        }
+        return AC_WPNav::plan_leg_end_speed(origin, destination, next_legs, num_legs,
+                                            speed_max, corner_radius, accel, jerk);
+    }
+};
+
+// the speed on an arc corner_radius inside a corner turning by angle
+static float arc_speed(float angle)
+{
+    return sqrtf(accel * corner_radius / tanf(angle * 0.5f));
+}
+
+TEST(AC_WPNav, corner_speed_straight)
+{
+    EXPECT_FLOAT_EQ(speed_max, AC_WPNav_Test::corner_speed(Vector3f(1000, 0, 0), Vector3f(300, 0, 0)));
+    EXPECT_FLOAT_EQ(speed_max, AC_WPNav_Test::corner_speed(Vector3f(0, -500, 100), Vector3f(0, -2500, 500)));
+
+    // a leg with no direction gives no corner
+    EXPECT_FLOAT_EQ(speed_max, AC_WPNav_Test::corner_speed(Vector3f(), Vector3f(0, 1000, 0)));
+    EXPECT_FLOAT_EQ(speed_max, AC_WPNav_Test::corner_speed(Vector3f(1000, 0, 0), Vector3f()));
+}
+
+TEST(AC_WPNav, corner_speed_turns)
+{
+    // a right angle turns on an arc of the corner radius
+    EXPECT_NEAR(sqrtf(accel * corner_radius), AC_WPNav_Test::corner_speed(Vector3f(1000, 0, 0), Vector3f(0, 1000, 0)), 0.1f);
+    EXPECT_NEAR(arc_speed(M_PI_2), AC_WPNav_Test::corner_speed(Vector3f(0, 1000, 0), Vector3f(-700, 0, 0)), 0.1f);
+    EXPECT_NEAR(arc_speed(M_PI_4), AC_WPNav_Test::corner_speed(Vector3f(1000, 0, 0), Vector3f(1000, 1000, 0)), 0.1f);
+
+    // gentle turns are only limited by the maximum speed
+    EXPECT_FLOAT_EQ(speed_max, AC_WPNav_Test::corner_speed(Vector3f(1000, 0, 0), Vector3f(1000, 10, 0)));
+
+    // sharper corners are slower
+    float last_speed = speed_max;
+    for (uint8_t deg = 10; deg < 180; deg += 10) {
+        const float angle = radians(deg);
+        const float speed = AC_WPNav_Test::corner_speed(Vector3f(1000, 0, 0), Vector3f(cosf(angle), sinf(angle), 0) * 1000);
+        EXPECT_LE(speed, last_speed) << unsigned(deg);
+        EXPECT_NEAR(MIN(arc_speed(angle), speed_max), speed, 0.5f) << unsigned(deg);
+        last_speed = speed;
+    }
+}
+
+TEST(AC_WPNav, corner_speed_reversing)
+{
+    EXPECT_FLOAT_EQ(0.0f, AC_WPNav_Test::corner_speed(Vector3f(1000, 0, 0), Vector3f(-1000, 0, 0)));
+    EXPECT_FLOAT_EQ(0.0f, AC_WPNav_Test::corner_speed(Vector3f(0, 500, -100), Vector3f(0, -1500, 300)));
+    EXPECT_FLOAT_EQ(0.0f, AC_WPNav_Test::corner_speed(Vector3f(1000, 0, 0), Vector3f(-1000, 5, 0)));
+}
+
+TEST(AC_WPNav, entry_speed)
+{
+    // without a jerk limit this is v^2 = v0^2 + 2ad
+    EXPECT_FLOAT_EQ(sqrtf(2 * accel * 800), AC_WPNav_Test::entry_speed(0, 800, 0));
+    EXPECT_FLOAT_EQ(sqrtf(sq(300.0f) + 2 * accel * 800), AC_WPNav_Test::entry_speed(300, 800, 0));
+
+    // the acceleration ramp covers (v1+v0)a/2j more
+    for (const float exit_speed : { 0.0f, 100.0f, 500.0f }) {
+        for (const float dist : { 50.0f, 400.0f, 5000.0f }) {
+            const float v1 = AC_WPNav_Test::entry_speed(exit_speed, dist);
+            EXPECT_LT(v1, AC_WPNav_Test::entry_speed(exit_speed, dist, 0));
+            const float slow_down_dist = (sq(v1) - sq(exit_speed)) / (2 * accel) + (v1 + exit_speed) * accel / (2 * jerk);
+            if (exit_speed * accel / jerk < dist) {
+                EXPECT_NEAR(dist, slow_down_dist, dist * 1e-4f) << exit_speed << " " << dist;
+            } else {
+                // too short to ramp the acceleration up and down again
+                EXPECT_FLOAT_EQ(exit_speed, v1) << dist;
+            }
+        }
+    }
+
+    // never below the exit speed, even with no room to change speed
+    EXPECT_FLOAT_EQ(400.0f, AC_WPNav_Test::entry_speed(400, 0));
+    EXPECT_FLOAT_EQ(400.0f, AC_WPNav_Test::entry_speed(400, 1));
+    EXPECT_FLOAT_EQ(400.0f, AC_WPNav_Test::entry_speed(400, -10));
+}
+
+TEST(AC_WPNav, plan_stop)
+{
+    const Vector3f origin;
+    const Vector3f destination(10000, 0, 0);
+
+    // with nothing after it the vehicle stops at the destination
+    EXPECT_FLOAT_EQ(0.0f, AC_WPNav_Test::leg_end_speed(origin, destination, {}));
+}
+
+TEST(AC_WPNav, plan_straight)
+{
+    const Vector3f origin;
+    const Vector3f destination(10000, 0, 0);
+
+    EXPECT_FLOAT_EQ(speed_max, AC_WPNav_Test::leg_end_speed(origin, destination, { Vector3f(20000, 0, 0) }));
+    EXPECT_FLOAT_EQ(speed_max, AC_WPNav_Test::leg_end_speed(origin, destination, { Vector3f(15000, 0, 0), Vector3f(30000, 0, -500) }));
+}
+
+TEST(AC_WPNav, plan_corners)
+{
+    const Vector3f origin;
+    const Vector3f destination(10000, 0, 0);
+
+    EXPECT_NEAR(arc_speed(M_PI_2), AC_WPNav_Test::leg_end_speed(origin, destination, { Vector3f(10000, 10000, 0) }), 0.1f);
+
+    // passing back over the destination needs a stop there
+    EXPECT_FLOAT_EQ(0.0f, AC_WPNav_Test::leg_end_speed(origin, destination, { Vector3f(0, 0, 0) }));
+
+    // the slower of two corners as far apart as these limits the first
+    EXPECT_NEAR(arc_speed(M_PI_2), AC_WPNav_Test::leg_end_speed(origin, destination,
+                                                                { Vector3f(10000, 300, 0), Vector3f(10300, 300, 0), Vector3f(20000, 300, 0) }),
+                0.1f);
+}
+
+TEST(AC_WPNav, plan_entry_speed_limit)
+{
+    const Vector3f origin;
+    const Vector3f destination(10000, 0, 0);
+
+    // a short leg to the end of the plan limits the speed at its start
+    EXPECT_FLOAT_EQ(AC_WPNav_Test::entry_speed(0, 100), AC_WPNav_Test::leg_end_speed(origin, destination, { Vector3f(10100, 0, 0) }));
+
+    // a right angle followed by a short leg and a reversal
+    EXPECT_FLOAT_EQ(AC_WPNav_Test::entry_speed(0, 100),
+                    AC_WPNav_Test::leg_end_speed(origin, destination, { Vector3f(10000, 100, 0), Vector3f(10000, -5000, 0) }));
+
+    // the speed after a corner carries back over a short leg
+    const float corner = AC_WPNav_Test::corner_speed(Vector3f(0, 50, 0), Vector3f(-10000, 0, 0));
+    EXPECT_FLOAT_EQ(MIN(AC_WPNav_Test::entry_speed(corner, 50), arc_speed(M_PI_2)),
+                    AC_WPNav_Test::leg_end_speed(origin, destination, { Vector3f(10000, 50, 0), Vector3f(0, 50, 0) }));
+}
+
+TEST(AC_WPNav, plan_zero_length_leg)
+{
+    const Vector3f origin;
+    const Vector3f destination(10000, 0, 0);
+
+    // a repeated waypoint doesn't hide the reversal after it
+    EXPECT_FLOAT_EQ(0.0f, AC_WPNav_Test::leg_end_speed(origin, destination, { destination, Vector3f(0, 0, 0) }));
+    EXPECT_NEAR(arc_speed(M_PI_2), AC_WPNav_Test::leg_end_speed(origin, destination,
+                                                                { destination, destination, Vector3f(10000, 10000, 0) }),
+                0.1f);
+
+    // nor the stop at the end of the plan
+    EXPECT_FLOAT_EQ(0.0f, AC_WPNav_Test::leg_end_speed(origin, destination, { destination }));
+
+    // a current leg with no length has no corner at its end
+    EXPECT_FLOAT_EQ(speed_max, AC_WPNav_Test::leg_end_speed(destination, destination, { Vector3f(10000, 10000, 0) }));
+}
+
+AP_GTEST_MAIN()
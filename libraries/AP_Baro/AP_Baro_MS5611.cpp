@@ -161,15 +161,6 @@ uint16_t AP_Baro_MS56XX::_read_prom_word(uint8_t word)
     return (val[0] << 8) | val[1];
 }
 
-uint32_t AP_Baro_MS56XX::_read_adc()
-{
-    uint8_t val[3];
-    if (!_dev->transfer(&CMD_MS56XX_READ_ADC, 1, val, sizeof(val))) {
-        return 0;
-    }
-    return (val[0] << 16) | (val[1] << 8) | val[2];
-}
-
 bool AP_Baro_MS56XX::_read_prom_5611(uint16_t prom[8])
 {
     /*
@@ -243,25 +234,25 @@ bool AP_Baro_MS56XX::_read_prom_5637(uint16_t prom[8])
 */
 void AP_Baro_MS56XX::_timer(void)
 {
-    uint8_t next_cmd;
-    uint8_t next_state;
-    uint32_t adc_val = _read_adc();
-
     /*
-     * If read fails, re-initiate a read command for current state or we are
-     * stuck
+     * Read the conversion in progress and start the next one in a single
+     * submission to the bus. The next conversion is started before the
+     * result is known, so a failed read moves on to it like a good one
+     * and the result of that conversion is discarded
      */
-    if (adc_val == 0) {
-        next_state = _state;
-    } else {
-        next_state = (_state + 1) % 5;
+    const uint8_t next_state = (_state + 1) % 5;
+    const uint8_t next_cmd = next_state == 0 ? ADDR_CMD_CONVERT_TEMPERATURE
+                                             : ADDR_CMD_CONVERT_PRESSURE;
+    uint8_t val[3];
+    _dev->queue_transfer(&CMD_MS56XX_READ_ADC, 1, val, sizeof(val));
+    _dev->queue_transfer(&next_cmd, 1, nullptr, 0);
+    uint32_t adc_val = 0;
+    if (_dev->submit_transfers()) {
+        adc_val = (val[0] << 16) | (val[1] << 8) | val[2];
     }
 
-    next_cmd = next_state == 0 ? ADDR_CMD_CONVERT_TEMPERATURE
-                               : ADDR_CMD_CONVERT_PRESSURE;
-    if (!_dev->transfer(&next_cmd, 1, nullptr, 0)) {
-        return;
-    }
+    const uint8_t state = _state;
+    _state = next_state;
 
     /* if we had a failed read we are all done */
     if (adc_val == 0 || adc_val == 0xFFFFFF) {
@@ -274,21 +265,18 @@ void AP_Baro_MS56XX::_timer(void)
 
     if (_discard_next) {
         _discard_next = false;
-        _state = next_state;
         return;
     }
 
     WITH_SEMAPHORE(_sem);
 
-    if (_state == 0) {
+    if (state == 0) {
         _update_and_wrap_accumulator(&_accum.s_D2, adc_val,
                                      &_accum.d2_count, 32);
     } else if (pressure_ok(adc_val)) {
         _update_and_wrap_accumulator(&_accum.s_D1, adc_val,
                                      &_accum.d1_count, 128);
     }
-    
-    _state = next_state;
 }
 
 void AP_Baro_MS56XX::_update_and_wrap_accumulator(uint32_t *accum, uint32_t val,
@@ -173,6 +173,26 @@ bool AP_FlashStorage::protected_switch_full_sector(void)
     return switch_sectors();
 }
 
+// erase ahead - if the other sector is full and the current sector is
+// nearly full then switch to the other sector now rather than when a
+// later write runs out of space
+bool AP_FlashStorage::erase_ahead(void)
+{
+    if (write_error || reserved_space == 0) {
+        // other sector is still available, switching to it needs no erase
+        return false;
+    }
+    const uint32_t space_available = flash_sector_size - write_offset;
+    if (space_available >= reserved_space + flash_sector_size / erase_ahead_divisor) {
+        return false;
+    }
+    if (!flash_erase_ok()) {
+        return false;
+    }
+    debug("erase ahead at write_offset=%u\n", (unsigned)write_offset);
+    return switch_full_sector();
+}
+
 // write some data to virtual EEPROM
 bool AP_FlashStorage::write(uint16_t offset, uint16_t length)
 {
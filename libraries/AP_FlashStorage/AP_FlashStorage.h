@@ -120,6 +120,13 @@ public:
     // write some data to storage from mem_buffer
     bool write(uint16_t offset, uint16_t length) WARN_IF_UNUSED;
 
+    // erase ahead - if the other sector is full and the current sector
+    // is nearly full then switch to the other sector now. Should be
+    // called when the caller is idle so the erase does not have to
+    // happen in the middle of a later write. Returns true if sectors
+    // were switched
+    bool erase_ahead(void) WARN_IF_UNUSED;
+
     // fixed storage size
     static const uint16_t storage_size = HAL_STORAGE_SIZE;
     
@@ -196,6 +203,9 @@ private:
 
     // amount of space needed to write full storage
     static const uint32_t reserve_size = (storage_size / max_write) * (sizeof(block_header) + max_write) + max_write;
+
+    // erase_ahead() switches sectors once less than this fraction of the sector is free
+    static const uint8_t erase_ahead_divisor = 8;
         
     // load data from a sector
     bool load_sector(uint8_t sector) WARN_IF_UNUSED;
@@ -36,6 +36,7 @@
 #include "AP_GPS_UBLOX.h"
 #include "AP_GPS_MAV.h"
 #include "GPS_Backend.h"
+#include "RTCM3_Parser.h"
 
 #if HAL_WITH_UAVCAN
 #include <AP_BoardConfig/AP_BoardConfig_CAN.h>
@@ -814,6 +815,10 @@ void AP_GPS::update(void)
         update_instance(i);
     }
 
+#ifndef HAL_BUILD_AP_PERIPH
+    Write_RTCM_stats();
+#endif
+
     // calculate number of instances
     for (uint8_t i=0; i<GPS_MAX_RECEIVERS; i++) {
         if (drivers[i] != nullptr) {
@@ -1070,6 +1075,8 @@ void AP_GPS::lock_port(uint8_t instance, bool lock)
 // Inject a packet of raw binary to a GPS
 void AP_GPS::inject_data(const uint8_t *data, uint16_t len)
 {
+    rtcm_update_stats(data, len);
+
     //Support broadcasting to all GPSes.
     if (_inject_to == GPS_RTK_INJECT_TO_ALL) {
         for (uint8_t i=0; i<GPS_MAX_RECEIVERS; i++) {
@@ -1235,6 +1242,17 @@ void AP_GPS::handle_gps_rtcm_fragment(uint8_t flags, const uint8_t *data, uint8_
         return;
     }
 
+    uint8_t fragment = (flags >> 1U) & 0x03;
+    uint8_t sequence = (flags >> 3U) & 0x1F;
+
+    if (fragment == 0 && len < MAVLINK_MSG_GPS_RTCM_DATA_FIELD_DATA_LEN &&
+        (rtcm_buffer == nullptr || rtcm_buffer->fragments_received == 0)) {
+        // a first fragment which is short is the whole block, pass
+        // direct rather than copying it through the buffer
+        inject_data(data, len);
+        return;
+    }
+
     // see if we need to allocate re-assembly buffer
     if (rtcm_buffer == nullptr) {
         rtcm_buffer = (struct rtcm_buffer *)calloc(1, sizeof(*rtcm_buffer));
@@ -1244,16 +1262,16 @@ void AP_GPS::handle_gps_rtcm_fragment(uint8_t flags, const uint8_t *data, uint8_
         }
     }
 
-    uint8_t fragment = (flags >> 1U) & 0x03;
-    uint8_t sequence = (flags >> 3U) & 0x1F;
-
     // see if this fragment is consistent with existing fragments
     if (rtcm_buffer->fragments_received &&
         (rtcm_buffer->sequence != sequence ||
         (rtcm_buffer->fragments_received & (1U<<fragment)))) {
         // we have one or more partial fragments already received
         // which conflict with the new fragment, discard previous fragments
-        memset(rtcm_buffer, 0, sizeof(*rtcm_buffer));
+        rtcm_buffer->fragments_received = 0;
+        rtcm_buffer->fragment_count = 0;
+        rtcm_buffer->total_length = 0;
+        rtcm_stats.blocks_lost++;
     }
 
     // add this fragment
@@ -1280,11 +1298,99 @@ void AP_GPS::handle_gps_rtcm_fragment(uint8_t flags, const uint8_t *data, uint8_
     // see if we have all fragments
     if (rtcm_buffer->fragment_count != 0 &&
         rtcm_buffer->fragments_received == (1U << rtcm_buffer->fragment_count) - 1) {
-        // we have them all, inject
+        // we have them all, inject. Only the header is cleared for
+        // reuse, the data is overwritten by the next fragments
         inject_data(rtcm_buffer->buffer, rtcm_buffer->total_length);
-        memset(rtcm_buffer, 0, sizeof(*rtcm_buffer));
+        rtcm_buffer->fragments_received = 0;
+        rtcm_buffer->fragment_count = 0;
+        rtcm_buffer->total_length = 0;
+    }
+}
+
+/*
+  count the RTCMv3 frames in a block of injected data, checking their
+  crc. The data is injected whether or not the frames are good, the
+  GPS does its own checks. Only a preamble followed by zero reserved
+  bits and a non-empty length is taken as a frame, and a frame is
+  skipped whole whether its crc is good or not, so 0xD3 bytes in the
+  payload are not counted
+ */
+void AP_GPS::rtcm_update_stats(const uint8_t *data, uint16_t len)
+{
+    // skip the end of a frame which started in the last block
+    uint16_t ofs = MIN(rtcm_stats.continued_bytes, len);
+    rtcm_stats.continued_bytes -= ofs;
+    while (ofs + 6U <= len) {
+        const uint8_t *p = (const uint8_t *)memchr(&data[ofs], RTCM3_Parser::RTCMv3_PREAMBLE, len - ofs);
+        if (p == nullptr) {
+            break;
+        }
+        ofs = p - data;
+        if (ofs + 6U > len) {
+            break;
+        }
+        const uint16_t payload_len = (p[1]<<8 | p[2]) & 0x3ff;
+        if ((p[1] & 0xFC) != 0 || payload_len == 0) {
+            // not a frame header
+            ofs++;
+            continue;
+        }
+        const uint16_t frame_len = payload_len + 6;
+        if (ofs + frame_len > len) {
+            // the frame continues in the next block, it can't be
+            // checked and the rest of this block is its payload
+            rtcm_stats.continued_bytes = ofs + frame_len - len;
+            break;
+        }
+        const uint32_t crc = (p[frame_len-3] << 16) | (p[frame_len-2] << 8) | p[frame_len-1];
+        if (RTCM3_Parser::crc24(p, frame_len-3) == crc) {
+            rtcm_stats.frames++;
+            rtcm_stats.last_frame_ms = AP_HAL::millis();
+        } else {
+            rtcm_stats.crc_errors++;
+        }
+        ofs += frame_len;
+    }
+}
+
+uint32_t AP_GPS::rtcm_age_ms(void) const
+{
+    if (rtcm_stats.frames == 0) {
+        return 0;
+    }
+    return AP_HAL::millis() - rtcm_stats.last_frame_ms;
+}
+
+#ifndef HAL_BUILD_AP_PERIPH
+/*
+  log the injected RTCM statistics once a second, once there are any
+ */
+void AP_GPS::Write_RTCM_stats(void)
+{
+    if (rtcm_stats.frames == 0 && rtcm_stats.crc_errors == 0) {
+        return;
     }
+    const uint32_t now_ms = AP_HAL::millis();
+    if (now_ms - rtcm_stats.last_log_ms < 1000 || !should_log()) {
+        return;
+    }
+    rtcm_stats.last_log_ms = now_ms;
+
+// @LoggerMessage: GRTC
+// @Description: Injected RTCM correction statistics
+// @Field: TimeUS: Time since system startup
+// @Field: Age: time since the last good RTCMv3 frame was injected
+// @Field: Frames: good RTCMv3 frames injected
+// @Field: CRCErr: RTCMv3 frames with a bad crc
+// @Field: Lost: partly received blocks of fragments discarded
+    AP::logger().Write("GRTC", "TimeUS,Age,Frames,CRCErr,Lost", "QIIII",
+                       AP_HAL::micros64(),
+                       rtcm_age_ms(),
+                       rtcm_stats.frames,
+                       rtcm_stats.crc_errors,
+                       rtcm_stats.blocks_lost);
 }
+#endif
 
 /*
    re-assemble GPS_RTCM_DATA message
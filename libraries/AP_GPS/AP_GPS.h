@@ -471,6 +471,9 @@ public:
     // handle possibly fragmented RTCM injection data
     void handle_gps_rtcm_fragment(uint8_t flags, const uint8_t *data, uint8_t len);
 
+    // time since the last good RTCMv3 frame was injected, zero if none have been
+    uint32_t rtcm_age_ms(void) const;
+
     // get configured type by instance
     GPS_Type get_type(uint8_t instance) const {
         return instance>=GPS_MAX_RECEIVERS? GPS_Type::GPS_TYPE_NONE : GPS_Type(_type[instance].get());
@@ -589,6 +592,23 @@ private:
         uint8_t buffer[MAVLINK_MSG_GPS_RTCM_DATA_FIELD_DATA_LEN*4];
     } *rtcm_buffer;
 
+    /*
+      statistics of RTCMv3 frames injected, for the age of the
+      corrections. Frames are counted when a block of injected data
+      contains them whole
+     */
+    struct {
+        uint32_t last_frame_ms;     // time the last good frame was injected
+        uint32_t frames;            // good frames injected
+        uint32_t crc_errors;        // frames with a bad crc
+        uint32_t blocks_lost;       // partly received blocks discarded
+        uint32_t last_log_ms;
+        uint16_t continued_bytes;   // bytes of the last frame which are in the next block
+    } rtcm_stats;
+
+    void rtcm_update_stats(const uint8_t *data, uint16_t len);
+    void Write_RTCM_stats(void);
+
     // re-assemble GPS_RTCM_DATA message
     void handle_gps_rtcm_data(const mavlink_message_t &msg);
     void handle_gps_inject(const mavlink_message_t &msg);
@@ -536,8 +536,10 @@ AP_GPS_UBLOX::_request_port(void)
 bool
 AP_GPS_UBLOX::read(void)
 {
+    uint8_t chunk[UBLOX_READ_CHUNK];
+    uint32_t chunk_len = 0;
     uint8_t data;
-    int16_t numc;
+    uint32_t numc;
     bool parsed = false;
     uint32_t millis_now = AP_HAL::millis();
 
@@ -567,10 +569,29 @@ AP_GPS_UBLOX::read(void)
     }
 
     numc = port->available();
-    for (int16_t i = 0; i < numc; i++) {        // Process bytes received
+    for (uint32_t i = 0; ; i++) {               // Process bytes received
+
+        if (i == chunk_len) {
+            // take the next chunk of the bytes received, rather
+            // than reading the port a byte at a time
+            chunk_len = MIN(numc, sizeof(chunk));
+#if GPS_UBLOX_MOVING_BASELINE
+            if (rtcm3_parser) {
+                // parsing may stop at any byte to hand over a RTCMv3
+                // packet, so don't take bytes we may not process
+                chunk_len = MIN(chunk_len, 1U);
+            }
+#endif
+            chunk_len = port->read_bytes(chunk, chunk_len);
+            if (chunk_len == 0) {
+                break;
+            }
+            numc -= chunk_len;
+            i = 0;
+        }
 
         // read the next byte
-        data = port->read();
+        data = chunk[i];
 
 #if GPS_UBLOX_MOVING_BASELINE
         if (rtcm3_parser) {
@@ -656,14 +677,18 @@ AP_GPS_UBLOX::read(void)
 
         // Receive message data
         //
-        case 6:
-            _ck_b += (_ck_a += data);                   // checksum byte
-            if (_payload_counter < sizeof(_buffer)) {
-                _buffer[_payload_counter] = data;
-            }
-            if (++_payload_counter == _payload_length)
+        case 6: {
+            // take the rest of the payload in this chunk at once,
+            // _payload_length has been checked against sizeof(_buffer)
+            const uint16_t len = MIN(uint32_t(_payload_length - _payload_counter), chunk_len - i);
+            memcpy(&_buffer[_payload_counter], &chunk[i], len);
+            _update_checksum(&chunk[i], len, _ck_a, _ck_b);
+            _payload_counter += len;
+            i += len - 1;
+            if (_payload_counter == _payload_length)
                 _step++;
             break;
+        }
 
         // Checksum and message processing
         //
@@ -1567,15 +1592,24 @@ AP_GPS_UBLOX::_parse_gps(void)
 
 /*
  *  update checksum for a set of bytes
+ *
+ *  Adding the bytes one at a time gives ck_a += d[i], ck_b += ck_a.
+ *  Over the whole set this is ck_b += len*ck_a + sum((len-i)*d[i]), so
+ *  the sums can be accumulated without a dependency between bytes and
+ *  the loop unrolled and vectorised. The checksum is modulo 256, so
+ *  the sums are allowed to wrap.
  */
 void
-AP_GPS_UBLOX::_update_checksum(uint8_t *data, uint16_t len, uint8_t &ck_a, uint8_t &ck_b)
+AP_GPS_UBLOX::_update_checksum(const uint8_t *data, uint16_t len, uint8_t &ck_a, uint8_t &ck_b)
 {
-    while (len--) {
-        ck_a += *data;
-        ck_b += ck_a;
-        data++;
+    uint32_t sum = 0;
+    uint32_t weighted_sum = 0;
+    for (uint16_t i = 0; i < len; i++) {
+        sum += data[i];
+        weighted_sum += uint32_t(len - i) * data[i];
     }
+    ck_b += uint32_t(len) * ck_a + weighted_sum;
+    ck_a += sum;
 }
 
 
@@ -57,6 +57,11 @@
 
 #define UBLOX_MAX_PORTS 6
 
+// bytes taken from the UART at once by read()
+#ifndef UBLOX_READ_CHUNK
+#define UBLOX_READ_CHUNK 64
+#endif
+
 #define RATE_POSLLH 1
 #define RATE_STATUS 1
 #define RATE_SOL 1
@@ -146,6 +151,8 @@ public:
     bool is_healthy(void) const override;
     
 private:
+    friend class AP_GPS_UBLOX_Test;
+
     // u-blox UBX protocol essentials
     struct PACKED ubx_header {
         uint8_t preamble1;
@@ -717,7 +724,7 @@ private:
     bool        _configure_valget(ConfigKey key);
     void        _configure_rate(void);
     void        _configure_sbas(bool enable);
-    void        _update_checksum(uint8_t *data, uint16_t len, uint8_t &ck_a, uint8_t &ck_b);
+    static void _update_checksum(const uint8_t *data, uint16_t len, uint8_t &ck_a, uint8_t &ck_b);
     bool        _send_message(uint8_t msg_class, uint8_t msg_id, void *msg, uint16_t size);
     void	send_next_rate_update(void);
     bool        _request_message_rate(uint8_t msg_class, uint8_t msg_id);
@@ -19,6 +19,14 @@
 
 #include <stdint.h>
 
+/*
+  use a 1k table for the CRC rather than computing it bit by bit. This
+  can be disabled on boards where flash matters more than CPU
+ */
+#ifndef RTCM3_CRC24_TABLE
+#define RTCM3_CRC24_TABLE 1
+#endif
+
 class RTCM3_Parser {
 public:
     // process one byte, return true if packet found
@@ -35,10 +43,14 @@ public:
 
     // return ID of found packet
     uint16_t get_id(void) const;
-    
+
+    // calculate 24 bit RTCMv3 crc
+    static uint32_t crc24(const uint8_t *bytes, uint16_t len);
+
+    static const uint8_t RTCMv3_PREAMBLE = 0xD3;
+
 private:
-    const uint8_t RTCMv3_PREAMBLE = 0xD3;
-    const uint32_t POLYCRC24 = 0x1864CFB;
+    static const uint32_t POLYCRC24 = 0x1864CFB;
 
     // raw packet, we shouldn't need over 300 bytes for the MB configs we use
     uint8_t pkt[300];
@@ -54,6 +66,5 @@ private:
     
     bool parse(void);
     void resync(void);
-    uint32_t crc24(const uint8_t *bytes, uint16_t len);
 };
 
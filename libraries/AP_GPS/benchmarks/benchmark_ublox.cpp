@@ -0,0 +1,127 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_GPS/AP_GPS_UBLOX.h>
+#include <GCS_MAVLink/GCS_Dummy.h>
+
+/*
+  bytes per second parsed by AP_GPS_UBLOX::read() from a 5Hz receiver
+  stream of NAV-PVT, NAV-DOP and RXM-RAWX messages, with the bytes
+  arriving in chunks of the size given between reads
+ */
+
+const AP_HAL::HAL &hal = AP_HAL::get_HAL();
+
+static GCS_Dummy _gcs;
+
+const AP_Param::GroupInfo GCS_MAVLINK_Parameters::var_info[] = {
+    AP_GROUPEND
+};
+
+static AP_GPS gps;
+
+#define UBLOX_BM_RAWX_MEASUREMENTS 24
+
+static uint8_t ubx_stream[5 * (8 + 92 + 8 + 18 + 8 + 16 + 32 * UBLOX_BM_RAWX_MEASUREMENTS)];
+static uint32_t ubx_stream_len;
+
+/*
+  add a message to the stream. The payload is left zero so NAV-PVT
+  decodes as no fix rather than an unexpected fix type to report
+ */
+static void ubx_add_message(uint8_t msg_class, uint8_t msg_id, uint16_t payload_length)
+{
+    uint8_t *msg = &ubx_stream[ubx_stream_len];
+    msg[0] = 0xB5;
+    msg[1] = 0x62;
+    msg[2] = msg_class;
+    msg[3] = msg_id;
+    msg[4] = payload_length & 0xFF;
+    msg[5] = payload_length >> 8;
+    uint8_t ck_a = 0;
+    uint8_t ck_b = 0;
+    for (uint16_t i = 2; i < 6 + payload_length; i++) {
+        ck_a += msg[i];
+        ck_b += ck_a;
+    }
+    msg[6 + payload_length] = ck_a;
+    msg[7 + payload_length] = ck_b;
+    ubx_stream_len += 8 + payload_length;
+}
+
+static void ubx_setup_stream()
+{
+    if (ubx_stream_len != 0) {
+        return;
+    }
+    for (uint8_t i = 0; i < 5; i++) {
+        ubx_add_message(0x01, 0x07, 92);
+        ubx_add_message(0x01, 0x04, 18);
+        ubx_add_message(0x02, 0x15, 16 + 32 * UBLOX_BM_RAWX_MEASUREMENTS);
+    }
+}
+
+// a UART letting each read() of the driver find the next chunk of the stream
+class UBXStreamUART : public AP_HAL::UARTDriver
+{
+public:
+    UBXStreamUART(uint16_t chunk_size) : _chunk_size(chunk_size) {}
+
+    void next_chunk()
+    {
+        if (_ofs == ubx_stream_len) {
+            _ofs = 0;
+        }
+        _end = MIN(_ofs + _chunk_size, ubx_stream_len);
+    }
+
+    void begin(uint32_t baud) override {}
+    void begin(uint32_t baud, uint16_t rxSpace, uint16_t txSpace) override {}
+    void end() override {}
+    void flush() override {}
+    bool is_initialized() override { return true; }
+    void set_blocking_writes(bool blocking) override {}
+    bool tx_pending() override { return false; }
+    size_t write(uint8_t c) override { return 1; }
+    size_t write(const uint8_t *buffer, size_t size) override { return size; }
+    uint32_t txspace() override { return 1024; }
+
+    uint32_t available() override { return _end - _ofs; }
+    int16_t read() override { return (_ofs < _end) ? ubx_stream[_ofs++] : -1; }
+    uint32_t read_bytes(uint8_t *buffer, uint32_t count) override
+    {
+        count = MIN(count, available());
+        memcpy(buffer, &ubx_stream[_ofs], count);
+        _ofs += count;
+        return count;
+    }
+
+private:
+    const uint16_t _chunk_size;
+    uint32_t _ofs = 0;
+    uint32_t _end = 0;
+};
+
+static void BM_UBloxRead(benchmark::State& state)
+{
+    ubx_setup_stream();
+    UBXStreamUART uart(state.range_x());
+    AP_GPS::GPS_State gps_state {};
+    // the driver relies on new zeroing it, as when AP_GPS creates it
+    AP_GPS_UBLOX *ublox = new AP_GPS_UBLOX(gps, gps_state, &uart, AP_GPS::GPS_ROLE_NORMAL);
+
+    uint64_t bytes = 0;
+    while (state.KeepRunning()) {
+        uart.next_chunk();
+        bytes += uart.available();
+        bool parsed = ublox->read();
+        gbenchmark_escape(&parsed);
+    }
+    state.SetBytesProcessed(bytes);
+
+    delete ublox;
+}
+
+// a byte at a time, a typical UART DMA transfer, a driver chunk and a 5Hz burst
+BENCHMARK(BM_UBloxRead)->Arg(1)->Arg(16)->Arg(UBLOX_READ_CHUNK)->Arg(sizeof(ubx_stream));
+
+BENCHMARK_MAIN()
@@ -0,0 +1,240 @@
+#include <AP_gtest.h>
+
+#include <AP_GPS/AP_GPS_UBLOX.h>
+#include <GCS_MAVLink/GCS_Dummy.h>
+
+const AP_HAL::HAL &hal = AP_HAL::get_HAL();
+
+static GCS_Dummy _gcs;
+
+const AP_Param::GroupInfo GCS_MAVLINK_Parameters::var_info[] = {
+    AP_GROUPEND
+};
+
+static AP_GPS gps;
+
+class AP_GPS_UBLOX_Test
+{
+public:
+    static void update_checksum(const uint8_t *data, uint16_t len, uint8_t &ck_a, uint8_t &ck_b)
+    {
+        AP_GPS_UBLOX::_update_checksum(data, len, ck_a, ck_b);
+    }
+};
+
+// the checksum as it was computed a byte at a time
+static void update_checksum_bytewise(const uint8_t *data, uint16_t len, uint8_t &ck_a, uint8_t &ck_b)
+{
+    while (len--) {
+        ck_a += *data;
+        ck_b += ck_a;
+        data++;
+    }
+}
+
+/*
+  a receiver stream of NAV-PVT, NAV-DOP and RXM-RAWX messages with
+  some NMEA between them
+ */
+static const uint8_t ubx_stream[] = {
+    0xb5, 0x62, 0x01, 0x07, 0x5c, 0x00, 0x00, 0x70, 0x99, 0x14, 0xe4, 0x07,
+    0x06, 0x01, 0x0c, 0x00, 0x00, 0x37, 0x32, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x03, 0x01, 0x00, 0x0e, 0x07, 0x6f, 0xe2, 0x58, 0x6b, 0xad,
+    0xee, 0xea, 0x40, 0xe9, 0x08, 0x00, 0x80, 0x8b, 0x08, 0x00, 0xbc, 0x02,
+    0x00, 0x00, 0x84, 0x03, 0x00, 0x00, 0x78, 0x00, 0x00, 0x00, 0xac, 0xfe,
+    0xff, 0xff, 0x0f, 0x00, 0x00, 0x00, 0x90, 0x01, 0x00, 0x00, 0x40, 0x54,
+    0x89, 0x00, 0x2c, 0x01, 0x00, 0x00, 0xc4, 0x09, 0x00, 0x00, 0x78, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x72, 0x10, 0xb5, 0x62, 0x01, 0x04, 0x12, 0x00, 0x00, 0x70,
+    0x99, 0x14, 0x96, 0x00, 0x82, 0x00, 0x5a, 0x00, 0x46, 0x00, 0x3c, 0x00,
+    0x32, 0x00, 0x28, 0x00, 0x82, 0x7e, 0xb5, 0x62, 0x02, 0x15, 0x10, 0x01,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x18, 0x15, 0x41, 0x34, 0x08, 0x12, 0x08,
+    0x01, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xf4, 0x06, 0x74, 0x41,
+    0x00, 0x00, 0x00, 0x00, 0xde, 0x39, 0x9a, 0x41, 0x00, 0x10, 0x96, 0xc4,
+    0x00, 0x03, 0x00, 0x00, 0x30, 0x75, 0x26, 0x01, 0x02, 0x03, 0x07, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x5e, 0x1f, 0x74, 0x41, 0x00, 0x00, 0x00, 0x00,
+    0xe7, 0x76, 0x9a, 0x41, 0x00, 0xf0, 0x95, 0xc4, 0x00, 0x04, 0x00, 0x00,
+    0x30, 0x75, 0x27, 0x01, 0x02, 0x03, 0x07, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0xc8, 0x37, 0x74, 0x41, 0x00, 0x00, 0x00, 0x00, 0xf0, 0xb3, 0x9a, 0x41,
+    0x00, 0xd0, 0x95, 0xc4, 0x00, 0x05, 0x00, 0x00, 0x30, 0x75, 0x28, 0x01,
+    0x02, 0x03, 0x07, 0x00, 0x00, 0x00, 0x00, 0x00, 0x32, 0x50, 0x74, 0x41,
+    0x00, 0x00, 0x00, 0x00, 0xf9, 0xf0, 0x9a, 0x41, 0x00, 0xb0, 0x95, 0xc4,
+    0x00, 0x06, 0x00, 0x00, 0x30, 0x75, 0x29, 0x01, 0x02, 0x03, 0x07, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x9c, 0x68, 0x74, 0x41, 0x00, 0x00, 0x00, 0x00,
+    0x02, 0x2e, 0x9b, 0x41, 0x00, 0x90, 0x95, 0xc4, 0x00, 0x07, 0x00, 0x00,
+    0x30, 0x75, 0x2a, 0x01, 0x02, 0x03, 0x07, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x06, 0x81, 0x74, 0x41, 0x00, 0x00, 0x00, 0x00, 0x0b, 0x6b, 0x9b, 0x41,
+    0x00, 0x70, 0x95, 0xc4, 0x00, 0x08, 0x00, 0x00, 0x30, 0x75, 0x2b, 0x01,
+    0x02, 0x03, 0x07, 0x00, 0x00, 0x00, 0x00, 0x00, 0x70, 0x99, 0x74, 0x41,
+    0x00, 0x00, 0x00, 0x00, 0x14, 0xa8, 0x9b, 0x41, 0x00, 0x50, 0x95, 0xc4,
+    0x00, 0x09, 0x00, 0x00, 0x30, 0x75, 0x2c, 0x01, 0x02, 0x03, 0x07, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0xda, 0xb1, 0x74, 0x41, 0x00, 0x00, 0x00, 0x00,
+    0x1d, 0xe5, 0x9b, 0x41, 0x00, 0x30, 0x95, 0xc4, 0x00, 0x0a, 0x00, 0x00,
+    0x30, 0x75, 0x2d, 0x01, 0x02, 0x03, 0x07, 0x00, 0xc6, 0xad, 0x24, 0x47,
+    0x50, 0x47, 0x47, 0x41, 0x2c, 0x6a, 0x75, 0x6e, 0x6b, 0x0d, 0x0a, 0xb5,
+    0x62, 0x01, 0x07, 0x5c, 0x00, 0x00, 0x70, 0x99, 0x14, 0xe4, 0x07, 0x06,
+    0x01, 0x0c, 0x00, 0x00, 0x37, 0x32, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x03, 0x01, 0x00, 0x0e, 0x07, 0x6f, 0xe2, 0x58, 0x6b, 0xad, 0xee,
+    0xea, 0x40, 0xe9, 0x08, 0x00, 0x80, 0x8b, 0x08, 0x00, 0xbc, 0x02, 0x00,
+    0x00, 0x84, 0x03, 0x00, 0x00, 0x78, 0x00, 0x00, 0x00, 0xac, 0xfe, 0xff,
+    0xff, 0x0f, 0x00, 0x00, 0x00, 0x90, 0x01, 0x00, 0x00, 0x40, 0x54, 0x89,
+    0x00, 0x2c, 0x01, 0x00, 0x00, 0xc4, 0x09, 0x00, 0x00, 0x78, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x72, 0x10,
+};
+
+TEST(AP_GPS_UBLOX, checksum_matches_bytewise)
+{
+    uint8_t data[600];
+    uint32_t seed = 1;
+    for (uint16_t i = 0; i < sizeof(data); i++) {
+        seed = seed * 1103515245 + 12345;
+        data[i] = seed >> 16;
+    }
+
+    for (uint16_t len = 0; len < sizeof(data); len++) {
+        uint8_t ck_a = len;
+        uint8_t ck_b = len * 3;
+        uint8_t ref_a = ck_a;
+        uint8_t ref_b = ck_b;
+        AP_GPS_UBLOX_Test::update_checksum(data, len, ck_a, ck_b);
+        update_checksum_bytewise(data, len, ref_a, ref_b);
+        ASSERT_EQ(ref_a, ck_a);
+        ASSERT_EQ(ref_b, ck_b);
+    }
+}
+
+/*
+  check each message of the stream, taking its payload in pieces the
+  way read() takes the part of a payload in each chunk from the UART
+ */
+TEST(AP_GPS_UBLOX, checksum_stream_chunks)
+{
+    const uint16_t chunk_sizes[] { 1, 3, 7, UBLOX_READ_CHUNK, sizeof(ubx_stream) };
+
+    for (const uint16_t chunk_size : chunk_sizes) {
+        uint8_t messages = 0;
+        for (uint16_t ofs = 0; ofs + 8U <= sizeof(ubx_stream); ofs++) {
+            const uint8_t *msg = &ubx_stream[ofs];
+            if (msg[0] != 0xB5 || msg[1] != 0x62) {
+                continue;
+            }
+            const uint16_t payload_length = msg[4] | (msg[5] << 8);
+            ASSERT_LE(ofs + 8U + payload_length, sizeof(ubx_stream));
+
+            // class, id and length are added a byte at a time
+            uint8_t ck_a = 0;
+            uint8_t ck_b = 0;
+            for (uint8_t i = 2; i < 6; i++) {
+                AP_GPS_UBLOX_Test::update_checksum(&msg[i], 1, ck_a, ck_b);
+            }
+            for (uint16_t done = 0; done < payload_length; ) {
+                const uint16_t len = MIN(chunk_size, payload_length - done);
+                AP_GPS_UBLOX_Test::update_checksum(&msg[6 + done], len, ck_a, ck_b);
+                done += len;
+            }
+            EXPECT_EQ(msg[6 + payload_length], ck_a);
+            EXPECT_EQ(msg[7 + payload_length], ck_b);
+
+            messages++;
+            ofs += 7 + payload_length;
+        }
+        EXPECT_EQ(4, messages);
+    }
+}
+
+/*
+  a UART holding the stream, where each read() of the driver finds at
+  most chunk_size more bytes, as if they had arrived since the last one
+ */
+class UBXStreamUART : public AP_HAL::UARTDriver
+{
+public:
+    UBXStreamUART(uint16_t chunk_size) : _chunk_size(chunk_size) {}
+
+    // let the next chunk of the stream be read
+    void next_chunk() { _end = MIN(_ofs + _chunk_size, sizeof(ubx_stream)); }
+    bool done() const { return _ofs == sizeof(ubx_stream); }
+
+    void begin(uint32_t baud) override {}
+    void begin(uint32_t baud, uint16_t rxSpace, uint16_t txSpace) override {}
+    void end() override {}
+    void flush() override {}
+    bool is_initialized() override { return true; }
+    void set_blocking_writes(bool blocking) override {}
+    bool tx_pending() override { return false; }
+
+    // configuration sent to the receiver is dropped
+    size_t write(uint8_t c) override { return 1; }
+    size_t write(const uint8_t *buffer, size_t size) override { return size; }
+    uint32_t txspace() override { return 1024; }
+
+    uint32_t available() override { return _end - _ofs; }
+    int16_t read() override { return (_ofs < _end) ? ubx_stream[_ofs++] : -1; }
+    uint32_t read_bytes(uint8_t *buffer, uint32_t count) override
+    {
+        count = MIN(count, available());
+        memcpy(buffer, &ubx_stream[_ofs], count);
+        _ofs += count;
+        return count;
+    }
+
+private:
+    const uint16_t _chunk_size;
+    uint32_t _ofs = 0;
+    uint32_t _end = 0;
+};
+
+/*
+  feed the stream to read() in chunks of several sizes, splitting the
+  messages across reads at every point for the smaller ones, and check
+  the state decoded from it
+ */
+TEST(AP_GPS_UBLOX, read_stream_chunks)
+{
+    const uint16_t chunk_sizes[] { 1, 2, 5, 7, 31, UBLOX_READ_CHUNK - 1, UBLOX_READ_CHUNK,
+                                   UBLOX_READ_CHUNK + 1, 100, 200, sizeof(ubx_stream) };
+
+    for (const uint16_t chunk_size : chunk_sizes) {
+        UBXStreamUART uart(chunk_size);
+        AP_GPS::GPS_State state {};
+        // the driver relies on new zeroing it, as when AP_GPS creates it
+        AP_GPS_UBLOX *ublox = new AP_GPS_UBLOX(gps, state, &uart, AP_GPS::GPS_ROLE_NORMAL);
+        ASSERT_NE(nullptr, ublox);
+
+        uint8_t fixes = 0;
+        while (!uart.done()) {
+            uart.next_chunk();
+            if (ublox->read()) {
+                fixes++;
+            }
+            EXPECT_EQ(0U, uart.available()) << chunk_size;
+        }
+
+        // a fix for each NAV-PVT, unless both are taken in one read
+        EXPECT_EQ((chunk_size == sizeof(ubx_stream)) ? 1 : 2, fixes) << chunk_size;
+
+        EXPECT_EQ(AP_GPS::GPS_OK_FIX_3D, state.status) << chunk_size;
+        EXPECT_EQ(345600000U, state.time_week_ms) << chunk_size;
+        EXPECT_EQ(-353456789, state.location.lat) << chunk_size;
+        EXPECT_EQ(1491234567, state.location.lng) << chunk_size;
+        EXPECT_EQ(56000, state.location.alt) << chunk_size;
+        EXPECT_EQ(14, state.num_sats) << chunk_size;
+        EXPECT_FLOAT_EQ(0.7f, state.horizontal_accuracy) << chunk_size;
+        EXPECT_FLOAT_EQ(0.9f, state.vertical_accuracy) << chunk_size;
+        EXPECT_FLOAT_EQ(0.3f, state.speed_accuracy) << chunk_size;
+        EXPECT_FLOAT_EQ(0.4f, state.ground_speed) << chunk_size;
+        EXPECT_FLOAT_EQ(90.0f, state.ground_course) << chunk_size;
+        EXPECT_FLOAT_EQ(0.12f, state.velocity.x) << chunk_size;
+        EXPECT_FLOAT_EQ(-0.34f, state.velocity.y) << chunk_size;
+        EXPECT_FLOAT_EQ(0.015f, state.velocity.z) << chunk_size;
+
+        // the DOPs of NAV-DOP replace the position DOP of NAV-PVT
+        EXPECT_EQ(60, state.hdop) << chunk_size;
+        EXPECT_EQ(70, state.vdop) << chunk_size;
+
+        delete ublox;
+    }
+}
+
+AP_GTEST_MAIN()
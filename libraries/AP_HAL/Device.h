@@ -159,6 +159,59 @@ public:
         return transfer(nullptr, 0, recv, recv_len);
     }
 
+    /*
+     * Queue a transfer to be done by #submit_transfers() together with the
+     * others queued on this device, in a single call into the bus driver
+     * where the backend supports it. Transfers are done in the order they
+     * were queued. On SPI each queued transfer is still a transaction of
+     * its own, with chip select released between them. I2C backends don't
+     * batch: each transfer is done immediately with its own stop. The send
+     * bytes are copied, recv must stay valid until the transfers are
+     * submitted. Backends that can't batch transfers do them immediately.
+     *
+     * Return: false if the transfer failed immediately.
+     */
+    virtual bool queue_transfer(const uint8_t *send, uint32_t send_len,
+                                uint8_t *recv, uint32_t recv_len)
+    {
+        if (!transfer(send, send_len, recv, recv_len)) {
+            _queue_failed = true;
+            return false;
+        }
+        return true;
+    }
+
+    /*
+     * Do the transfers queued by #queue_transfer().
+     *
+     * Return: true if all the transfers queued since the last call
+     * succeeded, false otherwise.
+     */
+    virtual bool submit_transfers()
+    {
+        const bool ret = !_queue_failed;
+        _queue_failed = false;
+        return ret;
+    }
+
+    /**
+     * Wrapper function over #queue_transfer() like #read_registers()
+     */
+    bool queue_read_registers(uint8_t first_reg, uint8_t *recv, uint32_t recv_len)
+    {
+        first_reg |= _read_flag;
+        return queue_transfer(&first_reg, 1, recv, recv_len);
+    }
+
+    /**
+     * Wrapper function over #queue_transfer() like #write_register()
+     */
+    bool queue_write_register(uint8_t reg, uint8_t val)
+    {
+        uint8_t buf[2] = { reg, val };
+        return queue_transfer(buf, sizeof(buf), nullptr, 0);
+    }
+
     /*
      * Get the semaphore for the bus this device is in.  This is intended for
      * drivers to use during initialization phase only.
@@ -291,6 +344,9 @@ public:
 protected:
     uint8_t _read_flag = 0;
 
+    /* a transfer queued since the last #submit_transfers() failed */
+    bool _queue_failed = false;
+
     /*
       broken out device elements. The bitfields are used to keep
       the overall value small enough to fit in a float accurately,
@@ -11,4 +11,18 @@ public:
     virtual void write_block(uint16_t dst, const void* src, size_t n) = 0;
     virtual void _timer_tick(void) {};
     virtual bool healthy(void) { return true; }
+
+    // counters for writes reaching the storage backend. Dividing
+    // bytes_written by bytes_changed gives the write amplification
+    struct Stats {
+        uint32_t bytes_changed;     // bytes modified by write_block()
+        uint32_t bytes_written;     // bytes written to the backend, including headers and rewrites
+        uint32_t backend_writes;    // number of writes to the backend
+        uint16_t erase_count;       // number of sector erases
+        uint32_t erase_time_us;     // total time spent erasing
+        uint32_t erase_max_us;      // longest single erase
+    };
+
+    // fill in stats, returns false if the backend does not keep them
+    virtual bool get_stats(Stats &stats) const { return false; }
 };
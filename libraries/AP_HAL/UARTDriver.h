@@ -107,6 +107,23 @@ public:
      */
     virtual uint64_t receive_time_constraint_us(uint16_t nbytes) { return 0; }
 
+    /*
+      read up to count bytes into buffer, returning the number of
+      bytes read. Drivers with a receive ring buffer override this to
+      copy its contiguous regions rather than calling read() per byte
+     */
+    virtual uint32_t read_bytes(uint8_t *buffer, uint32_t count) {
+        uint32_t n = 0;
+        while (n < count) {
+            const int16_t c = read();
+            if (c < 0) {
+                break;
+            }
+            buffer[n++] = c;
+        }
+        return n;
+    }
+
     virtual uint32_t bw_in_kilobytes_per_second() const {
         return 57;
     }
@@ -24,11 +24,12 @@ public:
         return 1;
     }
     size_t write(const uint8_t *buffer, size_t size) override {
-        size_t n = 0;
-        while (size--) {
-            n += write(*buffer++);
+        if (_offs < _size) {
+            const size_t n = _size - _offs < size ? _size - _offs : size;
+            memcpy(&_str[_offs], buffer, n);
         }
-        return n;
+        _offs += size;
+        return size;
     }
 
     size_t _offs;
@@ -105,3 +106,28 @@ void AP_HAL::Util::set_soft_armed(const bool b)
         }
     }
 }
+
+const char *AP_HAL::Util::memory_tag_name(Memory_Tag tag)
+{
+    switch (tag) {
+    case MEM_TAG_OTHER:
+        return "Other";
+    case MEM_TAG_EKF:
+        return "EKF";
+    case MEM_TAG_INS:
+        return "INS";
+    case MEM_TAG_LOGGER:
+        return "Logger";
+    case MEM_TAG_OADB:
+        return "OADB";
+    case MEM_TAG_SMARTRTL:
+        return "SmartRTL";
+    case MEM_TAG_SCRIPTING:
+        return "Scripting";
+    case MEM_TAG_TERRAIN:
+        return "Terrain";
+    case MEM_TAG_COUNT:
+        break;
+    }
+    return "?";
+}
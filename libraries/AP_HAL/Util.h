@@ -1,15 +1,16 @@
 #pragma once
 
 #include <stdarg.h>
+#include <AP_Common/AP_Common.h>
 #include "AP_HAL_Namespace.h"
 
 class AP_HAL::Util {
 public:
     int snprintf(char* str, size_t size,
-                 const char *format, ...);
+                 const char *format, ...) FMT_PRINTF(4, 5);
 
     int vsnprintf(char* str, size_t size,
-                  const char *format, va_list ap);
+                  const char *format, va_list ap) FMT_PRINTF(4, 0);
 
     void set_soft_armed(const bool b);
     bool get_soft_armed() const { return soft_armed; }
@@ -154,10 +155,40 @@ public:
     // allocate and free DMA-capable memory if possible. Otherwise return normal memory
     enum Memory_Type {
         MEM_DMA_SAFE,
-        MEM_FAST
+        MEM_FAST,
+        MEM_NORMAL
     };
-    virtual void *malloc_type(size_t size, Memory_Type mem_type) { return calloc(1, size); }
-    virtual void free_type(void *ptr, size_t size, Memory_Type mem_type) { return free(ptr); }
+
+    // the subsystem an allocation is accounted to
+    enum Memory_Tag : uint8_t {
+        MEM_TAG_OTHER,
+        MEM_TAG_EKF,
+        MEM_TAG_INS,
+        MEM_TAG_LOGGER,
+        MEM_TAG_OADB,
+        MEM_TAG_SMARTRTL,
+        MEM_TAG_SCRIPTING,
+        MEM_TAG_TERRAIN,
+        MEM_TAG_COUNT
+    };
+    static const char *memory_tag_name(Memory_Tag tag);
+
+    /*
+      memory is returned zeroed. The size passed to free_type() must
+      be the size it was allocated with
+     */
+    virtual void *malloc_type(size_t size, Memory_Type mem_type, Memory_Tag tag=MEM_TAG_OTHER) { return calloc(1, size); }
+    virtual void free_type(void *ptr, size_t size, Memory_Type mem_type, Memory_Tag tag=MEM_TAG_OTHER) { return free(ptr); }
+
+    // allocation statistics for one tag
+    struct Memory_Stats {
+        uint32_t current;       // bytes allocated now
+        uint32_t high_water;    // most bytes allocated at once
+        uint32_t count;         // number of allocations now
+        uint32_t failures;      // number of failed allocations
+    };
+    // return false if the HAL does not account allocations
+    virtual bool memory_stats(Memory_Tag tag, Memory_Stats &stats) { return false; }
 
 #ifdef ENABLE_HEAP
     // heap functions, note that a heap once alloc'd cannot be dealloc'd
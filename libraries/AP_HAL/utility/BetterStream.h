@@ -28,7 +28,7 @@ class AP_HAL::BetterStream {
 public:
 
     virtual void printf(const char *, ...) FMT_PRINTF(2, 3);
-    virtual void vprintf(const char *, va_list);
+    virtual void vprintf(const char *, va_list) FMT_PRINTF(2, 0);
 
     void print(const char *str) { write(str); }
     void println(const char *str) { printf("%s\r\n", str); }
@@ -0,0 +1,119 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "MemoryPool.h"
+
+MemoryPool::~MemoryPool(void)
+{
+    while (_slabs != nullptr) {
+        slab_header *next = _slabs->next;
+        free(_slabs);
+        _slabs = next;
+    }
+}
+
+uint8_t MemoryPool::size_class(size_t size)
+{
+    uint8_t c = 0;
+    while (class_size(c) < size) {
+        c++;
+    }
+    return c;
+}
+
+/*
+  carve a new slab into blocks of size class c and put them on its
+  free list. Called with the semaphore held
+ */
+bool MemoryPool::add_slab(uint8_t c)
+{
+    slab_header *header = (slab_header *)malloc(sizeof(slab_header) + MEMPOOL_SLAB_SIZE);
+    if (header == nullptr) {
+        return false;
+    }
+    header->next = _slabs;
+    _slabs = header;
+
+    uint8_t *slab = (uint8_t *)(header + 1);
+    const size_t block_size = class_size(c);
+    for (size_t ofs = 0; ofs + block_size <= MEMPOOL_SLAB_SIZE; ofs += block_size) {
+        free_block *block = (free_block *)&slab[ofs];
+        block->next = _free_list[c];
+        _free_list[c] = block;
+    }
+    _slab_bytes += MEMPOOL_SLAB_SIZE;
+    return true;
+}
+
+void *MemoryPool::allocate(size_t size, AP_HAL::Util::Memory_Tag tag)
+{
+    if (tag >= AP_HAL::Util::MEM_TAG_COUNT) {
+        tag = AP_HAL::Util::MEM_TAG_OTHER;
+    }
+
+    WITH_SEMAPHORE(_sem);
+
+    AP_HAL::Util::Memory_Stats &stats = _stats[tag];
+    void *ret;
+    if (size > MEMPOOL_MAX_BLOCK) {
+        ret = calloc(1, size);
+    } else {
+        const uint8_t c = size_class(size);
+        if (_free_list[c] == nullptr && !add_slab(c)) {
+            ret = nullptr;
+        } else {
+            free_block *block = _free_list[c];
+            _free_list[c] = block->next;
+            memset(block, 0, class_size(c));
+            ret = block;
+        }
+    }
+
+    if (ret == nullptr) {
+        stats.failures++;
+        return nullptr;
+    }
+    stats.current += size;
+    stats.count++;
+    if (stats.current > stats.high_water) {
+        stats.high_water = stats.current;
+    }
+    return ret;
+}
+
+void MemoryPool::release(void *ptr, size_t size, AP_HAL::Util::Memory_Tag tag)
+{
+    if (ptr == nullptr) {
+        return;
+    }
+    if (tag >= AP_HAL::Util::MEM_TAG_COUNT) {
+        tag = AP_HAL::Util::MEM_TAG_OTHER;
+    }
+
+    WITH_SEMAPHORE(_sem);
+
+    AP_HAL::Util::Memory_Stats &stats = _stats[tag];
+    stats.current = stats.current > size ? stats.current - size : 0;
+    if (stats.count > 0) {
+        stats.count--;
+    }
+
+    if (size > MEMPOOL_MAX_BLOCK) {
+        free(ptr);
+        return;
+    }
+    const uint8_t c = size_class(size);
+    free_block *block = (free_block *)ptr;
+    block->next = _free_list[c];
+    _free_list[c] = block;
+}
+
+bool MemoryPool::get_stats(AP_HAL::Util::Memory_Tag tag, AP_HAL::Util::Memory_Stats &stats)
+{
+    if (tag >= AP_HAL::Util::MEM_TAG_COUNT) {
+        return false;
+    }
+    WITH_SEMAPHORE(_sem);
+    stats = _stats[tag];
+    return true;
+}
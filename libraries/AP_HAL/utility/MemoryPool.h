@@ -0,0 +1,75 @@
+#pragma once
+
+#include <AP_HAL/AP_HAL.h>
+
+/*
+  a size-class pool allocator for malloc_type() with per-tag accounting
+
+  requests up to MEMPOOL_MAX_BLOCK bytes are rounded up to a power of
+  two size class and served from a free list for that class. Free
+  lists are refilled by carving a slab into blocks. Slabs are only
+  given back when the pool is destroyed, so a subsystem that frees and
+  allocates again reuses its blocks without going to the heap. Larger
+  requests go to calloc()
+ */
+
+#ifndef MEMPOOL_MIN_BLOCK
+#define MEMPOOL_MIN_BLOCK 16
+#endif
+
+#ifndef MEMPOOL_MAX_BLOCK
+#define MEMPOOL_MAX_BLOCK 2048
+#endif
+
+#ifndef MEMPOOL_SLAB_SIZE
+#define MEMPOOL_SLAB_SIZE 8192
+#endif
+
+class MemoryPool {
+public:
+    MemoryPool() {}
+    ~MemoryPool(void);
+
+    /* Do not allow copies */
+    MemoryPool(const MemoryPool &other) = delete;
+    MemoryPool &operator=(const MemoryPool&) = delete;
+
+    // allocate zeroed memory, accounted to tag
+    void *allocate(size_t size, AP_HAL::Util::Memory_Tag tag);
+
+    // free memory from allocate(). size must be the allocated size
+    void release(void *ptr, size_t size, AP_HAL::Util::Memory_Tag tag);
+
+    // get the statistics for a tag
+    bool get_stats(AP_HAL::Util::Memory_Tag tag, AP_HAL::Util::Memory_Stats &stats);
+
+    // bytes held in slabs, whether allocated or free
+    uint32_t slab_bytes(void) const { return _slab_bytes; }
+
+private:
+    static constexpr uint8_t num_classes = 8;
+    static_assert(MEMPOOL_MIN_BLOCK << (num_classes-1) == MEMPOOL_MAX_BLOCK, "size classes must cover MEMPOOL_MAX_BLOCK");
+    static_assert(MEMPOOL_SLAB_SIZE >= MEMPOOL_MAX_BLOCK, "slab must hold the largest block");
+
+    struct free_block {
+        free_block *next;
+    };
+
+    // header at the start of each slab, padded to keep blocks aligned
+    struct slab_header {
+        slab_header *next;
+        uint8_t pad[16 - sizeof(slab_header *)];
+    };
+
+    // return the size class for a request of size bytes
+    static uint8_t size_class(size_t size);
+    static size_t class_size(uint8_t c) { return size_t(MEMPOOL_MIN_BLOCK) << c; }
+
+    bool add_slab(uint8_t c);
+
+    HAL_Semaphore _sem;
+    free_block *_free_list[num_classes] {};
+    slab_header *_slabs = nullptr;
+    AP_HAL::Util::Memory_Stats _stats[AP_HAL::Util::MEM_TAG_COUNT] {};
+    uint32_t _slab_bytes = 0;
+};
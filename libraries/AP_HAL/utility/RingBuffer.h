@@ -350,3 +350,190 @@ private:
     uint16_t _count; // number in buffer now
     uint16_t _head;  // first element
 };
+
+
+/*
+  bounded ring buffer of objects which several threads can push to
+  without taking a lock. If MULTI_CONSUMER is false only one thread at
+  a time may pop, which saves an atomic operation per pop.
+
+  Each slot holds a sequence number telling the position it is ready
+  for: a push waits for a slot to come round to its position and a pop
+  for it to be one past its position (D. Vyukov's bounded MPMC
+  queue). Pushes and pops of several objects claim their slots with a
+  single atomic update of the index. The read and write indexes are
+  kept on separate cache lines so producers and consumers don't
+  contend on them.
+
+  The size is rounded up to a power of two. available() and space()
+  are only a snapshot when other threads are pushing or popping.
+ */
+#ifndef RINGBUFFER_CACHE_LINE_SIZE
+#define RINGBUFFER_CACHE_LINE_SIZE 64
+#endif
+
+template <class T, bool MULTI_CONSUMER>
+class ObjectBufferMP {
+public:
+    ObjectBufferMP(uint32_t size_) {
+        size = 1;
+        while (size < size_) {
+            size <<= 1;
+        }
+        slots = new Slot[size];
+        if (slots == nullptr) {
+            size = 0;
+            return;
+        }
+        for (uint32_t i = 0; i < size; i++) {
+            slots[i].seq.store(i, std::memory_order_relaxed);
+        }
+    }
+    ~ObjectBufferMP(void) {
+        delete[] slots;
+    }
+
+    /* Do not allow copies */
+    ObjectBufferMP(const ObjectBufferMP &other) = delete;
+    ObjectBufferMP &operator=(const ObjectBufferMP&) = delete;
+
+    // return size of ringbuffer in objects
+    uint32_t get_size(void) const {
+        return size;
+    }
+
+    // return number of objects available to be read
+    uint32_t available(void) const {
+        const uint32_t n = tail.load(std::memory_order_relaxed) - head.load(std::memory_order_relaxed);
+        // head can be read after a pop moved it past the tail we read
+        return int32_t(n) < 0 ? 0 : (n > size ? size : n);
+    }
+
+    // return number of objects that could be written
+    uint32_t space(void) const {
+        return size - available();
+    }
+
+    // true if available() == 0
+    bool empty(void) const {
+        return available() == 0;
+    }
+
+    // push one object
+    bool push(const T &object) {
+        return push(&object, 1);
+    }
+
+    // push N objects, all of them or none
+    bool push(const T *objects, uint32_t n) {
+        if (n == 0) {
+            return true;
+        }
+        if (n > size) {
+            return false;
+        }
+        uint32_t pos = tail.load(std::memory_order_relaxed);
+        while (true) {
+            uint32_t i = 0;
+            int32_t diff = 0;
+            for (; i < n; i++) {
+                diff = int32_t(slot(pos + i).seq.load(std::memory_order_acquire) - (pos + i));
+                if (diff != 0) {
+                    break;
+                }
+            }
+            if (i == n) {
+                // on failure pos is updated to the current tail
+                if (tail.compare_exchange_weak(pos, pos + n, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                // the slot still holds an object from the previous lap
+                return false;
+            } else {
+                // another producer claimed the slot
+                pos = tail.load(std::memory_order_relaxed);
+            }
+        }
+        for (uint32_t i = 0; i < n; i++) {
+            Slot &s = slot(pos + i);
+            s.object = objects[i];
+            s.seq.store(pos + i + 1, std::memory_order_release);
+        }
+        return true;
+    }
+
+    /*
+      pop earliest object off the queue
+     */
+    bool pop(T &object) {
+        return pop(&object, 1) == 1;
+    }
+
+    /*
+      pop up to N objects off the queue, returning the number popped
+     */
+    uint32_t pop(T *objects, uint32_t n) {
+        uint32_t pos = head.load(std::memory_order_relaxed);
+        uint32_t count;
+        while (true) {
+            count = 0;
+            int32_t diff = 0;
+            for (; count < n; count++) {
+                diff = int32_t(slot(pos + count).seq.load(std::memory_order_acquire) - (pos + count + 1));
+                if (diff != 0) {
+                    break;
+                }
+            }
+            if (count == 0) {
+                if (diff < 0) {
+                    // empty, or the next object is not written yet
+                    return 0;
+                }
+                // another consumer took the slot
+                pos = head.load(std::memory_order_relaxed);
+                continue;
+            }
+            if (!MULTI_CONSUMER) {
+                head.store(pos + count, std::memory_order_relaxed);
+                break;
+            }
+            if (head.compare_exchange_weak(pos, pos + count, std::memory_order_relaxed)) {
+                break;
+            }
+        }
+        for (uint32_t i = 0; i < count; i++) {
+            Slot &s = slot(pos + i);
+            objects[i] = s.object;
+            s.seq.store(pos + i + size, std::memory_order_release);
+        }
+        return count;
+    }
+
+private:
+    struct Slot {
+        std::atomic<uint32_t> seq;
+        T object;
+    };
+
+    Slot &slot(uint32_t pos) {
+        return slots[pos & (size - 1)];
+    }
+
+    Slot *slots;
+    uint32_t size;
+
+    uint8_t pad0[RINGBUFFER_CACHE_LINE_SIZE];
+    std::atomic<uint32_t> tail{0}; // where to write data
+    uint8_t pad1[RINGBUFFER_CACHE_LINE_SIZE - sizeof(std::atomic<uint32_t>)];
+    std::atomic<uint32_t> head{0}; // where to read data
+    uint8_t pad2[RINGBUFFER_CACHE_LINE_SIZE - sizeof(std::atomic<uint32_t>)];
+};
+
+// ring buffer for objects pushed by several threads and popped by one
+template <class T>
+using ObjectBufferMPSC = ObjectBufferMP<T, false>;
+
+// ring buffer for objects pushed and popped by several threads
+template <class T>
+using ObjectBufferMPMC = ObjectBufferMP<T, true>;
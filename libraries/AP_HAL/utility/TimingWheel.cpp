@@ -0,0 +1,168 @@
+#include "TimingWheel.h"
+
+// rotate a slot bitmask so bit 0 is the slot after start
+static uint64_t rotate_from(uint64_t occupied, uint64_t start)
+{
+    const uint8_t s = start & (TIMING_WHEEL_SLOTS - 1);
+    if (s == 0) {
+        return occupied;
+    }
+    return (occupied >> s) | (occupied << (TIMING_WHEEL_SLOTS - s));
+}
+
+void TimingWheel::add(Entry &e, uint64_t first_expiry, uint32_t period)
+{
+    e.expiry = first_expiry;
+    e.period = period > 0 ? period : 1;
+    insert(&e);
+}
+
+/*
+  put an entry on the level for its distance from the current tick
+ */
+void TimingWheel::insert(Entry *e)
+{
+    if (e->expiry <= _now) {
+        push(_expired, e);
+        return;
+    }
+    const uint64_t delta = e->expiry - _now;
+    if (delta < TIMING_WHEEL_SLOTS) {
+        const uint8_t slot = e->expiry & mask;
+        push(_level0[slot], e);
+        _occupied0 |= 1ULL << slot;
+    } else if (delta < TIMING_WHEEL_SLOTS * TIMING_WHEEL_SLOTS) {
+        const uint8_t slot = (e->expiry >> TIMING_WHEEL_SLOT_BITS) & mask;
+        push(_level1[slot], e);
+        _occupied1 |= 1ULL << slot;
+    } else {
+        push(_overflow, e);
+        // it can go on level 1 once it is this close
+        const uint64_t check = e->expiry - (TIMING_WHEEL_SLOTS * TIMING_WHEEL_SLOTS - 1);
+        if (check < _overflow_check) {
+            _overflow_check = check;
+        }
+    }
+}
+
+/*
+  the next tick after the current one at which a level 0 slot expires,
+  a level 1 slot moves down or the overflow list needs looking at
+ */
+uint64_t TimingWheel::next_event(void) const
+{
+    uint64_t ret = _overflow_check;
+    if (_occupied0 != 0) {
+        const uint64_t t = _now + 1 + __builtin_ctzll(rotate_from(_occupied0, _now + 1));
+        if (t < ret) {
+            ret = t;
+        }
+    }
+    if (_occupied1 != 0) {
+        const uint64_t block = (_now >> TIMING_WHEEL_SLOT_BITS) + 1;
+        const uint64_t t = (block + __builtin_ctzll(rotate_from(_occupied1, block))) << TIMING_WHEEL_SLOT_BITS;
+        if (t < ret) {
+            ret = t;
+        }
+    }
+    return ret;
+}
+
+uint64_t TimingWheel::next_expiry(void) const
+{
+    if (_expired != nullptr) {
+        return _now;
+    }
+    uint64_t ret = UINT64_MAX;
+    if (_overflow != nullptr) {
+        ret = _overflow_check + (TIMING_WHEEL_SLOTS * TIMING_WHEEL_SLOTS - 1);
+    }
+    if (_occupied0 != 0) {
+        // level 0 slots hold a single tick
+        const uint64_t t = _now + 1 + __builtin_ctzll(rotate_from(_occupied0, _now + 1));
+        if (t < ret) {
+            ret = t;
+        }
+    }
+    if (_occupied1 != 0) {
+        // the first occupied level 1 slot is earlier than any later one
+        const uint64_t block = (_now >> TIMING_WHEEL_SLOT_BITS) + 1;
+        const uint8_t slot = (block + __builtin_ctzll(rotate_from(_occupied1, block))) & mask;
+        for (const Entry *e = _level1[slot]; e != nullptr; e = e->next) {
+            if (e->expiry < ret) {
+                ret = e->expiry;
+            }
+        }
+    }
+    return ret;
+}
+
+/*
+  move the wheel forward to tick now, visiting only the ticks that
+  have work to do
+ */
+void TimingWheel::advance(uint64_t now)
+{
+    while (_now < now) {
+        const uint64_t next = next_event();
+        if (next > now) {
+            _now = now;
+            return;
+        }
+        _now = next;
+
+        if ((_now & mask) == 0) {
+            // start of a block, move its level 1 slot down
+            const uint8_t slot = (_now >> TIMING_WHEEL_SLOT_BITS) & mask;
+            Entry *list = _level1[slot];
+            _level1[slot] = nullptr;
+            _occupied1 &= ~(1ULL << slot);
+            while (list != nullptr) {
+                Entry *e = list;
+                list = list->next;
+                insert(e);
+            }
+        }
+
+        if (_now >= _overflow_check) {
+            Entry *list = _overflow;
+            _overflow = nullptr;
+            _overflow_check = UINT64_MAX;
+            while (list != nullptr) {
+                Entry *e = list;
+                list = list->next;
+                insert(e);
+            }
+        }
+
+        const uint8_t slot = _now & mask;
+        Entry *list = _level0[slot];
+        _level0[slot] = nullptr;
+        _occupied0 &= ~(1ULL << slot);
+        while (list != nullptr) {
+            Entry *e = list;
+            list = list->next;
+            push(_expired, e);
+        }
+    }
+}
+
+TimingWheel::Entry *TimingWheel::expire(uint64_t now)
+{
+    advance(now);
+
+    Entry *e = _expired;
+    if (e == nullptr) {
+        return nullptr;
+    }
+    _expired = e->next;
+
+    // re-arm on the same phase, but if whole periods were jumped
+    // over then only fire once for them
+    e->expiry += e->period;
+    if (e->expiry <= _now) {
+        e->expiry = _now + e->period;
+    }
+    insert(e);
+    return e;
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <stdint.h>
+
+/*
+  a two level hierarchical timing wheel for periodic callbacks
+
+  time is in ticks, which are whatever unit the caller passes to
+  expire(). An entry expiring within TIMING_WHEEL_SLOTS ticks sits in
+  the level 0 slot for its tick, one expiring within
+  TIMING_WHEEL_SLOTS^2 ticks sits in the level 1 slot for its block of
+  TIMING_WHEEL_SLOTS ticks and is moved down to level 0 when that
+  block starts. Anything further out waits on an overflow list.
+
+  Each level keeps a bitmask of occupied slots, so advancing the wheel
+  goes straight to the next tick with work to do instead of stepping
+  through idle ticks, and a jump over many periods fires an entry
+  once rather than once per missed period.
+
+  The wheel does no locking and never calls the entries itself: the
+  caller takes entries from expire() one at a time and runs them with
+  whatever locks and re-entrancy guards it needs.
+ */
+
+#define TIMING_WHEEL_SLOT_BITS 6
+#define TIMING_WHEEL_SLOTS (1U<<TIMING_WHEEL_SLOT_BITS)
+
+class TimingWheel {
+public:
+    TimingWheel() {}
+
+    /* Do not allow copies */
+    TimingWheel(const TimingWheel &other) = delete;
+    TimingWheel &operator=(const TimingWheel&) = delete;
+
+    struct Entry {
+        Entry *next;
+        uint64_t expiry;
+        uint32_t period;
+    };
+
+    /*
+      add an entry which will first expire at tick first_expiry and
+      then every period ticks after that. The entry must stay valid
+      for the life of the wheel
+     */
+    void add(Entry &e, uint64_t first_expiry, uint32_t period);
+
+    /*
+      advance the wheel to tick now and return one expired entry, or
+      nullptr if nothing has expired. The entry is re-armed for its
+      next period before it is returned, so calling expire() until it
+      returns nullptr runs each due entry once
+     */
+    Entry *expire(uint64_t now);
+
+    // the tick the wheel has been advanced to
+    uint64_t now(void) const { return _now; }
+
+    // the tick at which the next entry expires, UINT64_MAX if none
+    uint64_t next_expiry(void) const;
+
+private:
+    static constexpr uint32_t mask = TIMING_WHEEL_SLOTS - 1;
+
+    void insert(Entry *e);
+    void advance(uint64_t now);
+    uint64_t next_event(void) const;
+    static void push(Entry *&list, Entry *e) {
+        e->next = list;
+        list = e;
+    }
+
+    Entry *_level0[TIMING_WHEEL_SLOTS] {};
+    Entry *_level1[TIMING_WHEEL_SLOTS] {};
+    uint64_t _occupied0 = 0;
+    uint64_t _occupied1 = 0;
+    Entry *_overflow = nullptr;
+    uint64_t _overflow_check = UINT64_MAX;
+    Entry *_expired = nullptr;
+    uint64_t _now = 0;
+};
@@ -0,0 +1,111 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_HAL/utility/print_vprintf.h>
+
+/*
+  time per call of the common telemetry formats, both into a string
+  with snprintf() and into a stream that takes a lock on each write()
+  the way the UART drivers do
+ */
+
+const AP_HAL::HAL &hal = AP_HAL::get_HAL();
+
+class LockedStream : public AP_HAL::BetterStream {
+public:
+    size_t write(uint8_t c) override {
+        WITH_SEMAPHORE(sem);
+        buf[len++ % sizeof(buf)] = c;
+        return 1;
+    }
+    size_t write(const uint8_t *buffer, size_t size) override {
+        WITH_SEMAPHORE(sem);
+        for (size_t i = 0; i < size; i++) {
+            buf[len++ % sizeof(buf)] = buffer[i];
+        }
+        return size;
+    }
+    uint32_t available() override { return 0; }
+    int16_t read() override { return -1; }
+    uint32_t txspace() override { return sizeof(buf); }
+
+private:
+    HAL_Semaphore sem;
+    uint8_t buf[256];
+    uint32_t len = 0;
+};
+
+static LockedStream stream;
+
+static void BM_SnprintfIntegers(benchmark::State& state)
+{
+    char buf[64];
+    uint32_t n = 0;
+    while (state.KeepRunning()) {
+        hal.util->snprintf(buf, sizeof(buf), "PERF: %u/%u [%lu:%lu] F=%uHz sd=%lu Ex=%lu",
+                           (unsigned)(n & 7), 400U, (unsigned long)2612 + n, 2331UL, 400U, 12UL, 0UL);
+        gbenchmark_escape(buf);
+        n++;
+    }
+}
+
+static void BM_SnprintfFloats(benchmark::State& state)
+{
+    char buf[64];
+    float v = 0.1f;
+    while (state.KeepRunning()) {
+        hal.util->snprintf(buf, sizeof(buf), "%.2f %.2f %.2f", (double)v, (double)(v * -3.1f), (double)(v * 97.3f));
+        gbenchmark_escape(buf);
+        v += 0.01f;
+    }
+}
+
+static void BM_SnprintfFloatExp(benchmark::State& state)
+{
+    char buf[64];
+    float v = 1.0e-3f;
+    while (state.KeepRunning()) {
+        hal.util->snprintf(buf, sizeof(buf), "%e %g", (double)v, (double)v);
+        gbenchmark_escape(buf);
+        v *= 1.1f;
+        if (v > 1.0e30f) {
+            v = 1.0e-3f;
+        }
+    }
+}
+
+static void BM_SnprintfText(benchmark::State& state)
+{
+    char buf[64];
+    while (state.KeepRunning()) {
+        hal.util->snprintf(buf, sizeof(buf), "EKF3 IMU%u MAG%u in-flight yaw alignment %s", 1U, 0U, "complete");
+        gbenchmark_escape(buf);
+    }
+}
+
+static void BM_StreamText(benchmark::State& state)
+{
+    while (state.KeepRunning()) {
+        stream.printf("GPS %u: detected as %s at %d baud\n", 1U, "u-blox", 230400);
+    }
+    gbenchmark_escape(&stream);
+}
+
+static void BM_StreamFloats(benchmark::State& state)
+{
+    float v = 0.1f;
+    while (state.KeepRunning()) {
+        stream.printf("Lat:%.7f Lng:%.7f Alt:%.2fm\n", (double)(v - 35.36f), (double)(v + 149.16f), (double)(v * 584.1f));
+        v += 0.0001f;
+    }
+    gbenchmark_escape(&stream);
+}
+
+BENCHMARK(BM_SnprintfIntegers);
+BENCHMARK(BM_SnprintfFloats);
+BENCHMARK(BM_SnprintfFloatExp);
+BENCHMARK(BM_SnprintfText);
+BENCHMARK(BM_StreamText);
+BENCHMARK(BM_StreamFloats);
+
+BENCHMARK_MAIN()
@@ -0,0 +1,79 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_HAL/utility/RingBuffer.h>
+
+/*
+  compare an ObjectBuffer behind a semaphore, the way drivers share one
+  between threads, against the lock-free ring buffers with several
+  threads pushing and popping at once
+ */
+
+const AP_HAL::HAL &hal = AP_HAL::get_HAL();
+
+#define BATCH_SIZE 8
+
+static ObjectBuffer<uint32_t> locked_buffer{1024};
+static HAL_Semaphore locked_sem;
+static ObjectBufferMPMC<uint32_t> mpmc_buffer{1024};
+
+static void BM_ObjectBufferLocked(benchmark::State& state)
+{
+    uint32_t v = state.thread_index;
+    while (state.KeepRunning()) {
+        {
+            WITH_SEMAPHORE(locked_sem);
+            locked_buffer.push(v);
+        }
+        WITH_SEMAPHORE(locked_sem);
+        locked_buffer.pop(v);
+        gbenchmark_escape(&v);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+static void BM_ObjectBufferMPMC(benchmark::State& state)
+{
+    uint32_t v = state.thread_index;
+    while (state.KeepRunning()) {
+        mpmc_buffer.push(v);
+        mpmc_buffer.pop(v);
+        gbenchmark_escape(&v);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+static void BM_ObjectBufferLockedBatch(benchmark::State& state)
+{
+    uint32_t v[BATCH_SIZE] {};
+    while (state.KeepRunning()) {
+        {
+            WITH_SEMAPHORE(locked_sem);
+            locked_buffer.push(v, BATCH_SIZE);
+        }
+        WITH_SEMAPHORE(locked_sem);
+        for (uint8_t i = 0; i < BATCH_SIZE; i++) {
+            locked_buffer.pop(v[i]);
+        }
+        gbenchmark_escape(v);
+    }
+    state.SetItemsProcessed(state.iterations() * BATCH_SIZE);
+}
+
+static void BM_ObjectBufferMPMCBatch(benchmark::State& state)
+{
+    uint32_t v[BATCH_SIZE] {};
+    while (state.KeepRunning()) {
+        mpmc_buffer.push(v, BATCH_SIZE);
+        mpmc_buffer.pop(v, BATCH_SIZE);
+        gbenchmark_escape(v);
+    }
+    state.SetItemsProcessed(state.iterations() * BATCH_SIZE);
+}
+
+BENCHMARK(BM_ObjectBufferLocked)->ThreadRange(1, 8);
+BENCHMARK(BM_ObjectBufferMPMC)->ThreadRange(1, 8);
+BENCHMARK(BM_ObjectBufferLockedBatch)->ThreadRange(1, 8);
+BENCHMARK(BM_ObjectBufferMPMCBatch)->ThreadRange(1, 8);
+
+BENCHMARK_MAIN()
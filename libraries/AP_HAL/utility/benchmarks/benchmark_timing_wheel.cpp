@@ -0,0 +1,75 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_HAL/utility/TimingWheel.h>
+
+/*
+  cost per simulated FDM step of running the SITL timer and IO
+  processes, calling every process on every step as the SITL
+  scheduler used to, against only calling the ones due on a timing
+  wheel. The argument is the step in microseconds
+ */
+
+#define NUM_PROCS 8
+
+static volatile uint32_t calls;
+
+class Driver {
+public:
+    void update(void) { calls++; }
+};
+
+static Driver drivers[2*NUM_PROCS];
+
+struct proc_entry : TimingWheel::Entry {
+    AP_HAL::MemberProc proc;
+};
+
+static void set_calls_label(benchmark::State& state)
+{
+    char label[32];
+    snprintf(label, sizeof(label), "%.2f calls/step", double(calls) / state.iterations());
+    state.SetLabel(label);
+}
+
+static void BM_PollProcs(benchmark::State& state)
+{
+    AP_HAL::MemberProc procs[2*NUM_PROCS];
+    for (uint8_t i = 0; i < ARRAY_SIZE(procs); i++) {
+        procs[i] = FUNCTOR_BIND(&drivers[i], &Driver::update, void);
+    }
+    calls = 0;
+    while (state.KeepRunning()) {
+        for (uint8_t i = 0; i < ARRAY_SIZE(procs); i++) {
+            procs[i]();
+        }
+    }
+    set_calls_label(state);
+}
+
+static void BM_WheelProcs(benchmark::State& state)
+{
+    TimingWheel wheel;
+    proc_entry procs[2*NUM_PROCS];
+    for (uint8_t i = 0; i < ARRAY_SIZE(procs); i++) {
+        // half timer processes at 500us, half IO processes at 1ms
+        const uint32_t period = i < NUM_PROCS ? 500 : 1000;
+        procs[i].proc = FUNCTOR_BIND(&drivers[i], &Driver::update, void);
+        wheel.add(procs[i], period, period);
+    }
+    const uint32_t step = state.range_x();
+    uint64_t now = 0;
+    calls = 0;
+    while (state.KeepRunning()) {
+        now += step;
+        while (proc_entry *e = static_cast<proc_entry *>(wheel.expire(now))) {
+            e->proc();
+        }
+    }
+    set_calls_label(state);
+}
+
+BENCHMARK(BM_PollProcs);
+BENCHMARK(BM_WheelProcs)->Arg(833)->Arg(250)->Arg(100);
+
+BENCHMARK_MAIN()
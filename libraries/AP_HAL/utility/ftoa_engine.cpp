@@ -85,6 +85,24 @@ static const uint32_t factorTable[32] = {
     1038459372UL
 };
 
+static const int64_t pow10Table[15] = {
+    1LL,
+    10LL,
+    100LL,
+    1000LL,
+    10000LL,
+    100000LL,
+    1000000LL,
+    10000000LL,
+    100000000LL,
+    1000000000LL,
+    10000000000LL,
+    100000000000LL,
+    1000000000000LL,
+    10000000000000LL,
+    100000000000000LL
+};
+
 int16_t ftoa_engine(float val, char *buf, uint8_t precision, uint8_t maxDecimals) 
 {
     uint8_t flags;
@@ -138,56 +156,44 @@ int16_t ftoa_engine(float val, char *buf, uint8_t precision, uint8_t maxDecimals
     // If the lower 3 bits are 0 we right-shift 7x
     prod >>= (15-(exp & 7));
 
-    // Now convert to decimal.
-    uint8_t hadNonzeroDigit = 0; // a flag
+    // Now convert to decimal. Skip leading zeros by comparing against
+    // the powers of ten rather than producing zero digits.
     uint8_t outputIdx = 0;
-    int64_t decimal = 100000000000000ull;
+    int8_t decIdx = 14;
+    while (decIdx > 0 && prod < pow10Table[decIdx]) {
+        decIdx--;
+        exp10--;
+    }
+
+    // Compute how many digits N to output.
+    if(maxDecimals != 0) {                        // If limiting decimals...
+        int8_t beforeDP = exp10+1;                // Digits before point
+        if (beforeDP < 1) beforeDP = 1;            // Numbers < 1 should also output at least 1 digit.
+        /*
+         * Below a simpler version of this:
+        int8_t afterDP = outputNum - beforeDP;
+        if (afterDP > maxDecimals-1)
+            afterDP = maxDecimals-1;
+        outputNum = beforeDP + afterDP;
+        */
+        maxDecimals = maxDecimals+beforeDP-1;
+        if (precision > maxDecimals)
+            precision = maxDecimals;
+
+    } else {
+        precision++;                            // Output one more digit than the param value.
+    }
 
     do {
         char digit = '0';
-        while(1) {// find the first nonzero digit or any of the next digits.
-            while ((prod -= decimal) >= 0)
+        if (decIdx >= 0) {
+            const int64_t decimal = pow10Table[decIdx];
+            while (prod >= decimal) {
+                prod -= decimal;
                 digit++;
-            // Now we got too low. Fix it by adding again, once.
-            // it might appear more efficient to check before subtract, or
-            // to save and restore last nonnegative value - but in fact
-            // they take as long time and more space.
-            prod += decimal;
-            decimal /= 10;
-
-            // If already found a leading nonzero digit, accept zeros.
-            if (hadNonzeroDigit) break;
-
-            // Else, don't return results with a leading zero! Instead
-            // skip those and decrement exp10 accordingly.
-            if(digit == '0') {
-                exp10--;
-                continue;
             }
-
-            hadNonzeroDigit = 1;
-
-            // Compute how many digits N to output.
-            if(maxDecimals != 0) {                        // If limiting decimals...
-                int8_t beforeDP = exp10+1;                // Digits before point
-                if (beforeDP < 1) beforeDP = 1;            // Numbers < 1 should also output at least 1 digit.
-                /*
-                 * Below a simpler version of this:
-                int8_t afterDP = outputNum - beforeDP;
-                if (afterDP > maxDecimals-1)
-                    afterDP = maxDecimals-1;
-                outputNum = beforeDP + afterDP;
-                */
-                maxDecimals = maxDecimals+beforeDP-1;
-                if (precision > maxDecimals)
-                    precision = maxDecimals;
-
-            } else {
-                precision++;                            // Output one more digit than the param value.
-            }
-
-            break;
         }
+        decIdx--;
 
         // Now have a digit.
         outputIdx++;
@@ -195,17 +201,14 @@ int16_t ftoa_engine(float val, char *buf, uint8_t precision, uint8_t maxDecimals
             buf[outputIdx] = digit;
         else {
             // Abnormal case, write 9s and bail.
-            // We might as well abuse hadNonzeroDigit as counter, it will not be used again.
-            for(hadNonzeroDigit=outputIdx; hadNonzeroDigit>0; hadNonzeroDigit--)
-                buf[hadNonzeroDigit] = '9';
+            for(uint8_t i=outputIdx; i>0; i--)
+                buf[i] = '9';
             goto roundup; // this is ugly but it _is_ code derived from assembler :)
         }
     } while (outputIdx<precision);
 
-    // Rounding:
-    decimal *= 10;
-
-    if (prod - (decimal >> 1) >= 0) {
+    // Rounding, against half of the last digit's place value
+    if (decIdx >= 0 && prod >= (pow10Table[decIdx+1] >> 1)) {
 
     roundup:
         // Increment digit, cascade
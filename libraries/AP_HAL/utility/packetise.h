@@ -5,3 +5,9 @@
 */
 uint16_t mavlink_packetise(ByteBuffer &writebuf, uint16_t n);
 
+/*
+  the same for the first n bytes of buf, so a copy of the buffer can be
+  split into several packets
+*/
+uint16_t mavlink_packetise(const uint8_t *buf, uint16_t n);
+
@@ -66,8 +66,59 @@
 #define FL_FLTEXP   FL_PREC
 #define FL_FLTFIX   FL_LONG
 
-void print_vprintf(AP_HAL::BetterStream *s, const char *fmt, va_list ap)
+#ifndef PRINT_VPRINTF_BUFFER_SIZE
+#define PRINT_VPRINTF_BUFFER_SIZE 32
+#endif
+
+/*
+  output is collected here and given to the stream a block at a
+  time. A write() per character is a virtual call, and on most
+  streams also takes a lock
+ */
+class PrintBuffer {
+public:
+    PrintBuffer(AP_HAL::BetterStream *_s) : s(_s) {}
+    ~PrintBuffer() { flush(); }
+
+    /* Do not allow copies */
+    PrintBuffer(const PrintBuffer &other) = delete;
+    PrintBuffer &operator=(const PrintBuffer&) = delete;
+
+    void write(uint8_t c) {
+        if (len == sizeof(buf)) {
+            flush();
+        }
+        buf[len++] = c;
+    }
+
+    void write(const char *str, size_t n) {
+        if (n > sizeof(buf) - len) {
+            flush();
+            if (n >= sizeof(buf)) {
+                s->write((const uint8_t *)str, n);
+                return;
+            }
+        }
+        memcpy(&buf[len], str, n);
+        len += n;
+    }
+
+    void flush() {
+        if (len > 0) {
+            s->write(buf, len);
+            len = 0;
+        }
+    }
+
+private:
+    AP_HAL::BetterStream *s;
+    uint8_t buf[PRINT_VPRINTF_BUFFER_SIZE];
+    uint8_t len = 0;
+};
+
+void print_vprintf(AP_HAL::BetterStream *stream, const char *fmt, va_list ap)
 {
+        PrintBuffer s{stream};
         unsigned char c;        /* holds a char from the format string */
         uint16_t flags;
         unsigned char width;
@@ -76,20 +127,23 @@ void print_vprintf(AP_HAL::BetterStream *s, const char *fmt, va_list ap)
 
         for (;;) {
             /*
-             * Process non-format characters
+             * Process non-format characters, a run at a time
              */
             for (;;) {
-                c = *fmt++;
+                const char *start = fmt;
+                while ((c = *fmt) != 0 && c != '%') {
+                    fmt++;
+                }
+                s.write(start, fmt - start);
                 if (!c) {
                     return;
                 }
-                if (c == '%') {
-                    c = *fmt++;
-                    if (c != '%') {
-                        break;
-                    }
+                fmt++;
+                c = *fmt++;
+                if (c != '%') {
+                    break;
                 }
-                s->write(c);
+                s.write('%');
             }
 
             flags = 0;
@@ -217,14 +271,14 @@ flt_oper:
                         width -= ndigs;
                         if (!(flags & FL_LPAD)) {
                             do {
-                                s->write(' ');
+                                s.write(' ');
                             } while (--width);
                         }
                     } else {
                         width = 0;
                     }
                     if (sign) {
-                        s->write(sign);
+                        s.write(sign);
                     }
 
                     const char *p = "inf";
@@ -233,7 +287,7 @@ flt_oper:
                     while ((ndigs = *p) != 0) {
                         if (flags & FL_FLTUPP)
                             ndigs += 'I' - 'i';
-                        s->write(ndigs);
+                        s.write(ndigs);
                         p++;
                     }
                     goto tail;
@@ -280,16 +334,16 @@ flt_oper:
                 /* Output before first digit    */
                 if (!(flags & (FL_LPAD | FL_ZFILL))) {
                     while (width) {
-                        s->write(' ');
+                        s.write(' ');
                         width--;
                     }
                 }
                 if (sign) {
-                    s->write(sign);
+                    s.write(sign);
                 }
                 if (!(flags & FL_LPAD)) {
                     while (width) {
-                        s->write('0');
+                        s.write('0');
                         width--;
                     }
                 }
@@ -300,14 +354,14 @@ flt_oper:
                     unsigned char v = 0;
                     do {
                         if (n == -1) {
-                            s->write('.');
+                            s.write('.');
                         }
                         v = (n <= exp && n > exp - ndigs)
                             ? buf[exp - n + 1] : '0';
                         if (--n < -prec || v == 0) {
                             break;
                         }
-                        s->write(v);
+                        s.write(v);
                     } while (1);
                     if (n == exp
                         && (buf[1] > '5'
@@ -315,33 +369,33 @@ flt_oper:
                         v = '1';
                     }
                     if (v) {
-                        s->write(v);
+                        s.write(v);
                     }
                 } else {                                /* 'e(E)' format        */
                     /* mantissa     */
                     if (buf[1] != '1')
                         vtype &= ~FTOA_CARRY;
-                    s->write(buf[1]);
+                    s.write(buf[1]);
                     if (prec) {
-                        s->write('.');
+                        s.write('.');
                         sign = 2;
                         do {
-                            s->write(buf[sign++]);
+                            s.write(buf[sign++]);
                         } while (--prec);
                     }
 
                     /* exponent     */
-                    s->write(flags & FL_FLTUPP ? 'E' : 'e');
+                    s.write(flags & FL_FLTUPP ? 'E' : 'e');
                     ndigs = '+';
                     if (exp < 0 || (exp == 0 && (vtype & FTOA_CARRY) != 0)) {
                         exp = -exp;
                         ndigs = '-';
                     }
-                    s->write(ndigs);
+                    s.write(ndigs);
                     for (ndigs = '0'; exp >= 10; exp -= 10)
                         ndigs += 1;
-                    s->write(ndigs);
-                    s->write('0' + exp);
+                    s.write(ndigs);
+                    s.write('0' + exp);
                 }
 
                 goto tail;
@@ -372,16 +426,13 @@ flt_oper:
 
                 if (!(flags & FL_LPAD)) {
                     while (size < width) {
-                        s->write(' ');
+                        s.write(' ');
                         width--;
                     }
                 }
 
-                while (size) {
-                    s->write(*pnt++);
-                    if (width) width -= 1;
-                    size -= 1;
-                }
+                s.write(pnt, size);
+                width = width > size ? width - size : 0;
                 goto tail;
             }
 
@@ -492,7 +543,7 @@ ultoa:
                         }
                     }
                     while (len < width) {
-                        s->write(' ');
+                        s.write(' ');
                         len++;
                     }
                 }
@@ -500,9 +551,9 @@ ultoa:
                 width =  (len < width) ? width - len : 0;
 
                 if (flags & FL_ALT) {
-                    s->write('0');
+                    s.write('0');
                     if (flags & FL_ALTHEX) {
-                        s->write(flags & FL_ALTUPP ? 'X' : 'x');
+                        s.write(flags & FL_ALTUPP ? 'X' : 'x');
                     }
                 } else if (flags & (FL_NEGATIVE | FL_PLUS | FL_SPACE)) {
                     unsigned char z = ' ';
@@ -512,23 +563,23 @@ ultoa:
                     if (flags & FL_NEGATIVE) {
                         z = '-';
                     }
-                    s->write(z);
+                    s.write(z);
                 }
 
                 while (prec > c) {
-                    s->write('0');
+                    s.write('0');
                     prec--;
                 }
 
                 do {
-                    s->write(buf[--c]);
+                    s.write(buf[--c]);
                 } while (c);
             }
 
 tail:
             /* Tail is possible.    */
             while (width) {
-                s->write(' ');
+                s.write(' ');
                 width--;
             }
         } /* for (;;) */
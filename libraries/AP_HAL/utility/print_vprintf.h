@@ -4,4 +4,4 @@
 
 #include <AP_HAL/AP_HAL.h>
 
-void print_vprintf(AP_HAL::BetterStream *s, const char *fmt, va_list ap);
+void print_vprintf(AP_HAL::BetterStream *s, const char *fmt, va_list ap) FMT_PRINTF(2, 0);
@@ -0,0 +1,137 @@
+#include <AP_gtest.h>
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_HAL/utility/MemoryPool.h>
+
+#include <thread>
+#include <vector>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+TEST(MemoryPool, ZeroedAndReused)
+{
+    MemoryPool pool;
+
+    uint8_t *a = (uint8_t *)pool.allocate(100, AP_HAL::Util::MEM_TAG_EKF);
+    ASSERT_NE(nullptr, a);
+    for (uint8_t i = 0; i < 100; i++) {
+        EXPECT_EQ(0, a[i]);
+    }
+    memset(a, 0x55, 100);
+    pool.release(a, 100, AP_HAL::Util::MEM_TAG_EKF);
+
+    // a request in the same size class gets the block back, zeroed
+    uint8_t *b = (uint8_t *)pool.allocate(120, AP_HAL::Util::MEM_TAG_EKF);
+    EXPECT_EQ(a, b);
+    for (uint8_t i = 0; i < 120; i++) {
+        EXPECT_EQ(0, b[i]);
+    }
+    pool.release(b, 120, AP_HAL::Util::MEM_TAG_EKF);
+
+    EXPECT_EQ(uint32_t(MEMPOOL_SLAB_SIZE), pool.slab_bytes());
+}
+
+TEST(MemoryPool, SizeClasses)
+{
+    MemoryPool pool;
+    const size_t sizes[] { 0, 1, 16, 17, 64, 500, 1024, MEMPOOL_MAX_BLOCK, MEMPOOL_MAX_BLOCK+1, 100000 };
+    std::vector<uint8_t *> blocks;
+
+    // every block must be usable to its size without overlapping others
+    for (uint8_t round = 0; round < 20; round++) {
+        for (const size_t size : sizes) {
+            uint8_t *p = (uint8_t *)pool.allocate(size, AP_HAL::Util::MEM_TAG_OTHER);
+            ASSERT_NE(nullptr, p);
+            memset(p, uint8_t(blocks.size()), size);
+            blocks.push_back(p);
+        }
+    }
+    for (uint16_t i = 0; i < blocks.size(); i++) {
+        const size_t size = sizes[i % ARRAY_SIZE(sizes)];
+        for (size_t j = 0; j < size; j++) {
+            ASSERT_EQ(uint8_t(i), blocks[i][j]);
+        }
+        pool.release(blocks[i], size, AP_HAL::Util::MEM_TAG_OTHER);
+    }
+
+    AP_HAL::Util::Memory_Stats stats;
+    ASSERT_TRUE(pool.get_stats(AP_HAL::Util::MEM_TAG_OTHER, stats));
+    EXPECT_EQ(0U, stats.current);
+    EXPECT_EQ(0U, stats.count);
+}
+
+TEST(MemoryPool, Stats)
+{
+    MemoryPool pool;
+    AP_HAL::Util::Memory_Stats stats;
+
+    void *a = pool.allocate(1000, AP_HAL::Util::MEM_TAG_LOGGER);
+    void *b = pool.allocate(5000, AP_HAL::Util::MEM_TAG_LOGGER);
+    void *c = pool.allocate(40, AP_HAL::Util::MEM_TAG_TERRAIN);
+
+    ASSERT_TRUE(pool.get_stats(AP_HAL::Util::MEM_TAG_LOGGER, stats));
+    EXPECT_EQ(6000U, stats.current);
+    EXPECT_EQ(6000U, stats.high_water);
+    EXPECT_EQ(2U, stats.count);
+    EXPECT_EQ(0U, stats.failures);
+
+    pool.release(b, 5000, AP_HAL::Util::MEM_TAG_LOGGER);
+    ASSERT_TRUE(pool.get_stats(AP_HAL::Util::MEM_TAG_LOGGER, stats));
+    EXPECT_EQ(1000U, stats.current);
+    EXPECT_EQ(6000U, stats.high_water);
+    EXPECT_EQ(1U, stats.count);
+
+    ASSERT_TRUE(pool.get_stats(AP_HAL::Util::MEM_TAG_TERRAIN, stats));
+    EXPECT_EQ(40U, stats.current);
+    EXPECT_EQ(1U, stats.count);
+
+    ASSERT_TRUE(pool.get_stats(AP_HAL::Util::MEM_TAG_EKF, stats));
+    EXPECT_EQ(0U, stats.high_water);
+    EXPECT_FALSE(pool.get_stats(AP_HAL::Util::MEM_TAG_COUNT, stats));
+
+    pool.release(a, 1000, AP_HAL::Util::MEM_TAG_LOGGER);
+    pool.release(c, 40, AP_HAL::Util::MEM_TAG_TERRAIN);
+    pool.release(nullptr, 40, AP_HAL::Util::MEM_TAG_TERRAIN);
+    ASSERT_TRUE(pool.get_stats(AP_HAL::Util::MEM_TAG_TERRAIN, stats));
+    EXPECT_EQ(0U, stats.current);
+    EXPECT_EQ(0U, stats.count);
+}
+
+TEST(MemoryPool, Threads)
+{
+    MemoryPool pool;
+    std::vector<std::thread> threads;
+
+    for (uint8_t t = 0; t < 4; t++) {
+        threads.emplace_back([&pool, t]() {
+            uint8_t *blocks[32] {};
+            size_t sizes[32] {};
+            for (uint32_t i = 0; i < 20000; i++) {
+                const uint8_t n = i % ARRAY_SIZE(blocks);
+                if (blocks[n] != nullptr) {
+                    // nobody else may have written to our block
+                    for (size_t j = 0; j < sizes[n]; j++) {
+                        ASSERT_EQ(t, blocks[n][j]);
+                    }
+                    pool.release(blocks[n], sizes[n], AP_HAL::Util::MEM_TAG_SCRIPTING);
+                }
+                sizes[n] = 1 + (i * 7) % 600;
+                blocks[n] = (uint8_t *)pool.allocate(sizes[n], AP_HAL::Util::MEM_TAG_SCRIPTING);
+                ASSERT_NE(nullptr, blocks[n]);
+                memset(blocks[n], t, sizes[n]);
+            }
+            for (uint8_t n = 0; n < ARRAY_SIZE(blocks); n++) {
+                pool.release(blocks[n], sizes[n], AP_HAL::Util::MEM_TAG_SCRIPTING);
+            }
+        });
+    }
+    for (auto &t : threads) {
+        t.join();
+    }
+
+    AP_HAL::Util::Memory_Stats stats;
+    ASSERT_TRUE(pool.get_stats(AP_HAL::Util::MEM_TAG_SCRIPTING, stats));
+    EXPECT_EQ(0U, stats.count);
+}
+
+AP_GTEST_MAIN()
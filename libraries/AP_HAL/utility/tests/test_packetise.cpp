@@ -0,0 +1,87 @@
+#include <AP_gtest.h>
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_HAL/utility/RingBuffer.h>
+#include <AP_HAL/utility/packetise.h>
+#include <GCS_MAVLink/GCS_MAVLink.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+/*
+  a stream of a MAVLink1 packet, a MAVLink2 packet, a signed MAVLink2
+  packet and some text, then the start of a packet
+ */
+static uint16_t make_stream(uint8_t *buf)
+{
+    uint16_t n = 0;
+
+    buf[n++] = MAVLINK_STX_MAVLINK1;
+    buf[n++] = 9;
+    for (uint8_t i = 0; i < 9 + 6; i++) {
+        buf[n++] = i;
+    }
+
+    buf[n++] = MAVLINK_STX;
+    buf[n++] = 20;
+    buf[n++] = 0;
+    for (uint8_t i = 0; i < 20 + 9; i++) {
+        buf[n++] = i;
+    }
+
+    buf[n++] = MAVLINK_STX;
+    buf[n++] = 3;
+    buf[n++] = MAVLINK_IFLAG_SIGNED;
+    for (uint8_t i = 0; i < 3 + 9 + MAVLINK_SIGNATURE_BLOCK_LEN; i++) {
+        buf[n++] = i;
+    }
+
+    const char text[] = "hello";
+    memcpy(&buf[n], text, strlen(text));
+    n += strlen(text);
+
+    buf[n++] = MAVLINK_STX;
+    buf[n++] = 30;
+    buf[n++] = 0;
+
+    return n;
+}
+
+TEST(Packetise, SplitCopy)
+{
+    uint8_t buf[256];
+    const uint16_t n = make_stream(buf);
+    const uint16_t expected[] { 17, 32, 28, 5, 0 };
+
+    uint16_t ofs = 0;
+    for (const uint16_t len : expected) {
+        EXPECT_EQ(len, mavlink_packetise(&buf[ofs], n - ofs));
+        ofs += len;
+    }
+    EXPECT_EQ(n - 3, ofs);
+}
+
+TEST(Packetise, MatchesRingBuffer)
+{
+    uint8_t buf[256];
+    const uint16_t n = make_stream(buf);
+
+    ByteBuffer writebuf{64};
+    uint16_t ofs = 0;
+    for (uint8_t i = 0; i < 10; i++) {
+        // refill the ring so the data wraps around its end
+        ofs += writebuf.write(&buf[ofs], n - ofs);
+        const uint16_t available = writebuf.available();
+        uint8_t copy[64];
+        writebuf.peekbytes(copy, available);
+        for (uint16_t len = 0; len <= available; len++) {
+            EXPECT_EQ(mavlink_packetise(writebuf, len), mavlink_packetise(copy, len));
+        }
+        const uint16_t len = mavlink_packetise(writebuf, available);
+        if (len == 0) {
+            break;
+        }
+        writebuf.advance(len);
+    }
+}
+
+AP_GTEST_MAIN()
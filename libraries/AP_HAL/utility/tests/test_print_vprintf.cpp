@@ -0,0 +1,298 @@
+#include <AP_gtest.h>
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_HAL/utility/print_vprintf.h>
+
+#include <string>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+/*
+  collect the output of print_vprintf(), counting the calls it makes
+ */
+class StringStream : public AP_HAL::BetterStream {
+public:
+    size_t write(uint8_t c) override {
+        str += char(c);
+        writes++;
+        return 1;
+    }
+    size_t write(const uint8_t *buffer, size_t size) override {
+        str.append((const char *)buffer, size);
+        writes++;
+        return size;
+    }
+    uint32_t available() override { return 0; }
+    int16_t read() override { return -1; }
+    uint32_t txspace() override { return 0; }
+
+    std::string str;
+    uint32_t writes = 0;
+};
+
+static std::string format(StringStream &s, const char *fmt, ...) FMT_PRINTF(2, 3);
+static std::string format(StringStream &s, const char *fmt, ...)
+{
+    s.str.clear();
+    s.writes = 0;
+    va_list ap;
+    va_start(ap, fmt);
+    print_vprintf(&s, fmt, ap);
+    va_end(ap);
+    return s.str;
+}
+
+/*
+  the corpus was produced by the formatting engine as it was before
+  the fast paths were added, apart from %llu of values of 2^63 and
+  above which it did not convert correctly
+ */
+static const char *const int_formats[] = {
+    "%d", "%i", "%5d", "%-5d|", "%05d", "%+d", "% d", "%.3d", "%8.3d",
+    "%u", "%x", "%X", "%#x", "%08x", "%hd", "%ld", "%lu", "%lx",
+};
+
+static const int32_t int_values[] = {
+    0, 1, -1, 7, 42, -42, 999, 1000, 65535, 123456789, -123456789, INT32_MAX, INT32_MIN,
+};
+
+static const char *const int64_formats[] = {
+    "%lld", "%llu", "%llx", "%20lld", "%-20lld|", "%020llu",
+};
+
+static const int64_t int64_values[] = {
+    0, 1, -1, 1234567890123LL, -1234567890123LL, INT64_MAX, -INT64_MAX,
+};
+
+static const char *const float_formats[] = {
+    "%f", "%.0f", "%.1f", "%.2f", "%.3f", "%.7f", "%8.2f", "%-8.2f|", "%08.2f", "%+.2f", "% .1f",
+    "%e", "%.2e", "%E", "%g", "%.3g", "%G",
+};
+
+static const float float_values[] = {
+    0.0f, -0.0f, 1.0f, -1.0f, 0.5f, 0.05f, 3.71f, 3.75f, 10.4f, 10.6f, 0.001234f, 123.456f,
+    1020.123456f, 9999999.0f, 10304052.6f, -1030405023.6f, 1e-10f, 3.4e38f, 1.17549435e-38f,
+    INFINITY, -INFINITY, NAN,
+};
+
+static const char *const string_formats[] = {
+    "%s", "%10s", "%-10s|", "%.3s", "%.0s|",
+};
+
+static const char *const string_values[] = {
+    "", "a", "hello", "ArduPilot Copter",
+};
+
+static const char *const int_expected[][ARRAY_SIZE(int_values)] = {
+    { "0", "1", "-1", "7", "42", "-42", "999", "1000", "65535", "123456789", "-123456789",
+      "2147483647", "-2147483648" },
+    { "0", "1", "-1", "7", "42", "-42", "999", "1000", "65535", "123456789", "-123456789",
+      "2147483647", "-2147483648" },
+    { "    0", "    1", "   -1", "    7", "   42", "  -42", "  999", " 1000", "65535", "123456789",
+      "-123456789", "2147483647", "-2147483648" },
+    { "0    |", "1    |", "-1   |", "7    |", "42   |", "-42  |", "999  |", "1000 |", "65535|",
+      "123456789|", "-123456789|", "2147483647|", "-2147483648|" },
+    { "00000", "00001", "-0001", "00007", "00042", "-0042", "00999", "01000", "65535", "123456789",
+      "-123456789", "2147483647", "-2147483648" },
+    { "+0", "+1", "-1", "+7", "+42", "-42", "+999", "+1000", "+65535", "+123456789", "-123456789",
+      "+2147483647", "-2147483648" },
+    { " 0", " 1", "-1", " 7", " 42", "-42", " 999", " 1000", " 65535", " 123456789", "-123456789",
+      " 2147483647", "-2147483648" },
+    { "000", "001", "-001", "007", "042", "-042", "999", "1000", "65535", "123456789",
+      "-123456789", "2147483647", "-2147483648" },
+    { "     000", "     001", "    -001", "     007", "     042", "    -042", "     999",
+      "    1000", "   65535", "123456789", "-123456789", "2147483647", "-2147483648" },
+    { "0", "1", "4294967295", "7", "42", "4294967254", "999", "1000", "65535", "123456789",
+      "4171510507", "2147483647", "2147483648" },
+    { "0", "1", "FFFFFFFF", "7", "2A", "FFFFFFD6", "3E7", "3E8", "FFFF", "75BCD15", "F8A432EB",
+      "7FFFFFFF", "80000000" },
+    { "0", "1", "FFFFFFFF", "7", "2A", "FFFFFFD6", "3E7", "3E8", "FFFF", "75BCD15", "F8A432EB",
+      "7FFFFFFF", "80000000" },
+    { "0", "0x1", "0xFFFFFFFF", "0x7", "0x2A", "0xFFFFFFD6", "0x3E7", "0x3E8", "0xFFFF",
+      "0x75BCD15", "0xF8A432EB", "0x7FFFFFFF", "0x80000000" },
+    { "00000000", "00000001", "FFFFFFFF", "00000007", "0000002A", "FFFFFFD6", "000003E7",
+      "000003E8", "0000FFFF", "075BCD15", "F8A432EB", "7FFFFFFF", "80000000" },
+    { "0", "1", "-1", "7", "42", "-42", "999", "1000", "65535", "123456789", "-123456789",
+      "2147483647", "-2147483648" },
+    { "0", "1", "-1", "7", "42", "-42", "999", "1000", "65535", "123456789", "-123456789",
+      "2147483647", "-2147483648" },
+    { "0", "1", "4294967295", "7", "42", "4294967254", "999", "1000", "65535", "123456789",
+      "4171510507", "2147483647", "2147483648" },
+    { "0", "1", "FFFFFFFF", "7", "2A", "FFFFFFD6", "3E7", "3E8", "FFFF", "75BCD15", "F8A432EB",
+      "7FFFFFFF", "80000000" },
+};
+
+static const char *const int64_expected[][ARRAY_SIZE(int64_values)] = {
+    { "0", "1", "-1", "1234567890123", "-1234567890123", "9223372036854775807",
+      "-9223372036854775807" },
+    { "0", "1", "18446744073709551615", "1234567890123", "18446742839141661493",
+      "9223372036854775807", "9223372036854775809" },
+    { "0", "1", "FFFFFFFFFFFFFFFF", "11F71FB04CB", "FFFFFEE08E04FB35", "7FFFFFFFFFFFFFFF",
+      "8000000000000001" },
+    { "                   0", "                   1", "                  -1",
+      "       1234567890123", "      -1234567890123", " 9223372036854775807",
+      "-9223372036854775807" },
+    { "0                   |", "1                   |", "-1                  |",
+      "1234567890123       |", "-1234567890123      |", "9223372036854775807 |",
+      "-9223372036854775807|" },
+    { "00000000000000000000", "00000000000000000001", "18446744073709551615",
+      "00000001234567890123", "18446742839141661493", "09223372036854775807",
+      "09223372036854775809" },
+};
+
+static const char *const float_expected[][ARRAY_SIZE(float_values)] = {
+    { "0.000000", "-0.000000", "1.000000", "-1.000000", "0.500000", "0.050000", "3.710000",
+      "3.750000", "10.40000", "10.60000", "0.001234", "123.4560", "1020.123", "9999999.",
+      "1.030405e+07", "-1.030405e+09", "0.000000", "3.400000e+38", "0.000000", "inf", "-inf",
+      "nan" },
+    { "0", "-0", "1", "-1", "1", "0", "4", "4", "10", "11", "0", "123", "1020", "9999999", "1e+07",
+      "-1e+09", "0", "3e+38", "0", "inf", "-inf", "nan" },
+    { "0.0", "-0.0", "1.0", "-1.0", "0.5", "0.1", "3.7", "3.8", "10.4", "10.6", "0.0", "123.5",
+      "1020.1", "9999999.", "1.0e+07", "-1.0e+09", "0.0", "3.4e+38", "0.0", "inf", "-inf", "nan" },
+    { "0.00", "-0.00", "1.00", "-1.00", "0.50", "0.05", "3.71", "3.75", "10.40", "10.60", "0.00",
+      "123.46", "1020.12", "9999999.", "1.03e+07", "-1.03e+09", "0.00", "3.40e+38", "0.00", "inf",
+      "-inf", "nan" },
+    { "0.000", "-0.000", "1.000", "-1.000", "0.500", "0.050", "3.710", "3.750", "10.400", "10.600",
+      "0.001", "123.456", "1020.123", "9999999.", "1.030e+07", "-1.030e+09", "0.000", "3.400e+38",
+      "0.000", "inf", "-inf", "nan" },
+    { "0.0000000", "-0.0000000", "1.000000", "-1.000000", "0.5000000", "0.0500000", "3.710000",
+      "3.750000", "10.40000", "10.60000", "0.0012340", "123.4560", "1020.123", "9999999.",
+      "1.0304053e+07", "-1.0304050e+09", "0.0000000", "3.4000000e+38", "0.0000000", "inf", "-inf",
+      "nan" },
+    { "    0.00", "   -0.00", "    1.00", "   -1.00", "    0.50", "    0.05", "    3.71",
+      "    3.75", "   10.40", "   10.60", "    0.00", "  123.46", " 1020.12", "9999999.",
+      "1.03e+07", "-1.03e+09", "    0.00", "3.40e+38", "    0.00", "     inf", "    -inf",
+      "     nan" },
+    { "0.00    |", "-0.00   |", "1.00    |", "-1.00   |", "0.50    |", "0.05    |", "3.71    |",
+      "3.75    |", "10.40   |", "10.60   |", "0.00    |", "123.46  |", "1020.12 |", "9999999.|",
+      "1.03e+07|", "-1.03e+09|", "0.00    |", "3.40e+38|", "0.00    |", "inf     |", "-inf    |",
+      "nan     |" },
+    { "00000.00", "-0000.00", "00001.00", "-0001.00", "00000.50", "00000.05", "00003.71",
+      "00003.75", "00010.40", "00010.60", "00000.00", "00123.46", "01020.12", "9999999.",
+      "1.03e+07", "-1.03e+09", "00000.00", "3.40e+38", "00000.00", "     inf", "    -inf",
+      "     nan" },
+    { "+0.00", "-0.00", "+1.00", "-1.00", "+0.50", "+0.05", "+3.71", "+3.75", "+10.40", "+10.60",
+      "+0.00", "+123.46", "+1020.12", "+9999999.", "+1.03e+07", "-1.03e+09", "+0.00", "+3.40e+38",
+      "+0.00", "+inf", "-inf", "+nan" },
+    { " 0.0", "-0.0", " 1.0", "-1.0", " 0.5", " 0.1", " 3.7", " 3.8", " 10.4", " 10.6", " 0.0",
+      " 123.5", " 1020.1", " 9999999.", " 1.0e+07", "-1.0e+09", " 0.0", " 3.4e+38", " 0.0", " inf",
+      "-inf", " nan" },
+    { "0.000000e+00", "-0.000000e+00", "1.000000e+00", "-1.000000e+00", "5.000000e-01",
+      "5.000000e-02", "3.710000e+00", "3.750000e+00", "1.040000e+01", "1.060000e+01",
+      "1.234000e-03", "1.234560e+02", "1.020123e+03", "9.999999e+06", "1.030405e+07",
+      "-1.030405e+09", "1.000000e-10", "3.400000e+38", "1.175494e-38", "inf", "-inf", "nan" },
+    { "0.00e+00", "-0.00e+00", "1.00e+00", "-1.00e+00", "5.00e-01", "5.00e-02", "3.71e+00",
+      "3.75e+00", "1.04e+01", "1.06e+01", "1.23e-03", "1.23e+02", "1.02e+03", "1.00e+07",
+      "1.03e+07", "-1.03e+09", "1.00e-10", "3.40e+38", "1.18e-38", "inf", "-inf", "nan" },
+    { "0.000000E+00", "-0.000000E+00", "1.000000E+00", "-1.000000E+00", "5.000000E-01",
+      "5.000000E-02", "3.710000E+00", "3.750000E+00", "1.040000E+01", "1.060000E+01",
+      "1.234000E-03", "1.234560E+02", "1.020123E+03", "9.999999E+06", "1.030405E+07",
+      "-1.030405E+09", "1.000000E-10", "3.400000E+38", "1.175494E-38", "INF", "-INF", "NAN" },
+    { "0", "-0", "1", "-1", "0.5", "0.05", "3.71", "3.75", "10.4", "10.6", "0.001234", "123.456",
+      "1020.12", "1e+07", "1.03041e+07", "-1.0304e+09", "1e-10", "3.4e+38", "1.17549e-38", "inf",
+      "-inf", "nan" },
+    { "0", "-0", "1", "-1", "0.5", "0.05", "3.71", "3.75", "10.4", "10.6", "0.00123", "123",
+      "1.02e+03", "1e+07", "1.03e+07", "-1.03e+09", "1e-10", "3.4e+38", "1.18e-38", "inf", "-inf",
+      "nan" },
+    { "0", "-0", "1", "-1", "0.5", "0.05", "3.71", "3.75", "10.4", "10.6", "0.001234", "123.456",
+      "1020.12", "1E+07", "1.03041E+07", "-1.0304E+09", "1E-10", "3.4E+38", "1.17549E-38", "INF",
+      "-INF", "NAN" },
+};
+
+static const char *const string_expected[][ARRAY_SIZE(string_values)] = {
+    { "", "a", "hello", "ArduPilot Copter" },
+    { "          ", "         a", "     hello", "ArduPilot Copter" },
+    { "          |", "a         |", "hello     |", "ArduPilot Copter|" },
+    { "", "a", "hel", "Ard" },
+    { "|", "|", "|", "|" },
+};
+
+// the corpus formats are not literals, so use the va_list entry point
+static std::string format_v(const char *fmt, ...)
+{
+    StringStream s;
+    va_list ap;
+    va_start(ap, fmt);
+    print_vprintf(&s, fmt, ap);
+    va_end(ap);
+    return s.str;
+}
+
+TEST(PrintVprintf, Integers)
+{
+    for (uint8_t f = 0; f < ARRAY_SIZE(int_formats); f++) {
+        const bool is_long = strchr(int_formats[f], 'l') != nullptr;
+        for (uint8_t v = 0; v < ARRAY_SIZE(int_values); v++) {
+            const std::string out = is_long ? format_v(int_formats[f], (long)int_values[v]) :
+                                    format_v(int_formats[f], int_values[v]);
+            EXPECT_EQ(int_expected[f][v], out) << int_formats[f] << " " << int_values[v];
+        }
+    }
+    for (uint8_t f = 0; f < ARRAY_SIZE(int64_formats); f++) {
+        for (uint8_t v = 0; v < ARRAY_SIZE(int64_values); v++) {
+            const std::string out = format_v(int64_formats[f], (long long)int64_values[v]);
+            EXPECT_EQ(int64_expected[f][v], out) << int64_formats[f] << " " << int64_values[v];
+        }
+    }
+}
+
+TEST(PrintVprintf, Floats)
+{
+    for (uint8_t f = 0; f < ARRAY_SIZE(float_formats); f++) {
+        for (uint8_t v = 0; v < ARRAY_SIZE(float_values); v++) {
+            const std::string out = format_v(float_formats[f], (double)float_values[v]);
+            EXPECT_EQ(float_expected[f][v], out) << float_formats[f] << " " << float_values[v];
+        }
+    }
+}
+
+TEST(PrintVprintf, Strings)
+{
+    for (uint8_t f = 0; f < ARRAY_SIZE(string_formats); f++) {
+        for (uint8_t v = 0; v < ARRAY_SIZE(string_values); v++) {
+            const std::string out = format_v(string_formats[f], string_values[v]);
+            EXPECT_EQ(string_expected[f][v], out) << string_formats[f] << " " << string_values[v];
+        }
+    }
+}
+
+TEST(PrintVprintf, Lines)
+{
+    StringStream s;
+
+    EXPECT_EQ("PERF: 3/400 [2612:2331] F=400Hz sd=12 Ex=0",
+              format(s, "PERF: %u/%u [%lu:%lu] F=%uHz sd=%lu Ex=%lu", 3U, 400U, 2612UL, 2331UL, 400U, 12UL, 0UL));
+    EXPECT_EQ("EKF3 IMU1 MAG0 in-flight yaw alignment complete",
+              format(s, "EKF3 IMU%u MAG%u in-flight yaw alignment complete", 1U, 0U));
+    EXPECT_EQ("GPS 1: detected as u-blox at 230400 baud",
+              format(s, "GPS %u: detected as %s at %d baud", 1U, "u-blox", 230400));
+    EXPECT_EQ("Lat:-35.36326 Lng:149.1652 Alt:584.09m",
+              format(s, "Lat:%.7f Lng:%.7f Alt:%.2fm", (double)-35.3632621f, (double)149.1652374f, (double)584.09f));
+    EXPECT_EQ(" 0.01 -12.35 100.00",
+              format(s, "%5.2f %5.2f %5.2f", (double)0.01f, (double)-12.345f, (double)100.0f));
+    EXPECT_EQ("100% done! ok    |-003.142|0XBEEF",
+              format(s, "100%% done%c %-6s|%08.3f|%#X", '!', "ok", (double)-3.14159f, 0xbeefU));
+    EXPECT_EQ("%", format(s, "%%"));
+    EXPECT_EQ("", format(s, "%s", ""));
+}
+
+TEST(PrintVprintf, BatchedWrites)
+{
+    StringStream s;
+
+    // a short line is passed to the stream in one write
+    format(s, "Mission: %u %s", 12U, "WP");
+    EXPECT_EQ("Mission: 12 WP", s.str);
+    EXPECT_EQ(1U, s.writes);
+
+    // long lines are still output in full and in order
+    std::string expected;
+    for (uint8_t i = 0; i < 20; i++) {
+        expected += "0123456789";
+    }
+    const std::string out = format(s, "%s|%s|%d", expected.c_str(), expected.c_str(), 42);
+    EXPECT_EQ(expected + "|" + expected + "|42", out);
+    EXPECT_LT(s.writes, 10U);
+}
+
+AP_GTEST_MAIN()
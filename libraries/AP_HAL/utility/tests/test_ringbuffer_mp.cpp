@@ -0,0 +1,198 @@
+#include <AP_gtest.h>
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_HAL/utility/RingBuffer.h>
+#include <AP_Math/AP_Math.h>
+
+#include <thread>
+#include <vector>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+#define STRESS_PRODUCERS 4
+#define STRESS_CONSUMERS 4
+#define STRESS_ITEMS 200000U
+
+// items are tagged with the producer in the top byte
+static uint32_t make_item(uint8_t producer, uint32_t seq)
+{
+    return (uint32_t(producer) << 24) | seq;
+}
+
+TEST(ObjectBufferMP, SizeRounding)
+{
+    ObjectBufferMPSC<uint32_t> a{1};
+    ObjectBufferMPSC<uint32_t> b{5};
+    ObjectBufferMPMC<uint32_t> c{64};
+
+    EXPECT_EQ(1U, a.get_size());
+    EXPECT_EQ(8U, b.get_size());
+    EXPECT_EQ(64U, c.get_size());
+}
+
+TEST(ObjectBufferMP, FifoAndFull)
+{
+    ObjectBufferMPMC<uint32_t> buf{4};
+    uint32_t v;
+
+    EXPECT_TRUE(buf.empty());
+    EXPECT_FALSE(buf.pop(v));
+
+    for (uint32_t i = 0; i < 4; i++) {
+        EXPECT_TRUE(buf.push(i));
+    }
+    EXPECT_FALSE(buf.push(4U));
+    EXPECT_EQ(4U, buf.available());
+    EXPECT_EQ(0U, buf.space());
+
+    for (uint32_t i = 0; i < 4; i++) {
+        EXPECT_TRUE(buf.pop(v));
+        EXPECT_EQ(i, v);
+    }
+    EXPECT_FALSE(buf.pop(v));
+    EXPECT_TRUE(buf.empty());
+}
+
+TEST(ObjectBufferMP, Batches)
+{
+    ObjectBufferMPSC<uint32_t> buf{8};
+    uint32_t in[8];
+    uint32_t out[8];
+    uint32_t next_in = 0;
+    uint32_t next_out = 0;
+
+    // go round the ring many times with batches that don't divide it
+    for (uint32_t lap = 0; lap < 100; lap++) {
+        const uint32_t n = 1 + lap % 5;
+        for (uint32_t i = 0; i < n; i++) {
+            in[i] = next_in + i;
+        }
+        ASSERT_TRUE(buf.push(in, n));
+        next_in += n;
+
+        const uint32_t popped = buf.pop(out, 3);
+        for (uint32_t i = 0; i < popped; i++) {
+            ASSERT_EQ(next_out++, out[i]);
+        }
+
+        // a batch that doesn't fit is not pushed at all
+        const uint32_t available = buf.available();
+        EXPECT_FALSE(buf.push(in, buf.space() + 1));
+        EXPECT_EQ(available, buf.available());
+    }
+
+    while (const uint32_t popped = buf.pop(out, 8)) {
+        for (uint32_t i = 0; i < popped; i++) {
+            ASSERT_EQ(next_out++, out[i]);
+        }
+    }
+    EXPECT_EQ(next_in, next_out);
+    EXPECT_FALSE(buf.push(in, 9));
+}
+
+static void produce(ObjectBufferMP<uint32_t, true> *mpmc,
+                    ObjectBufferMP<uint32_t, false> *mpsc,
+                    uint8_t producer)
+{
+    uint32_t batch[3];
+    for (uint32_t seq = 0; seq < STRESS_ITEMS; ) {
+        // alternate single pushes with batches
+        const uint32_t n = MIN(1 + seq % 3, STRESS_ITEMS - seq);
+        for (uint32_t i = 0; i < n; i++) {
+            batch[i] = make_item(producer, seq + i);
+        }
+        const bool ret = mpmc ? mpmc->push(batch, n) : mpsc->push(batch, n);
+        if (ret) {
+            seq += n;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+}
+
+/*
+  each consumer must see the items of a producer in the order they
+  were pushed, and all the items must be popped exactly once
+ */
+static void consume(ObjectBufferMP<uint32_t, true> *mpmc,
+                    ObjectBufferMP<uint32_t, false> *mpsc,
+                    std::atomic<int32_t> *remaining,
+                    std::vector<uint32_t> *counts,
+                    bool *in_order)
+{
+    uint32_t next[STRESS_PRODUCERS] {};
+    uint32_t items[4];
+    *in_order = true;
+    while (remaining->load() > 0) {
+        const uint32_t n = mpmc ? mpmc->pop(items, ARRAY_SIZE(items)) : mpsc->pop(items, ARRAY_SIZE(items));
+        if (n == 0) {
+            std::this_thread::yield();
+            continue;
+        }
+        remaining->fetch_sub(n);
+        for (uint32_t i = 0; i < n; i++) {
+            const uint8_t producer = items[i] >> 24;
+            const uint32_t seq = items[i] & 0xFFFFFF;
+            if (producer >= STRESS_PRODUCERS || seq < next[producer]) {
+                *in_order = false;
+                continue;
+            }
+            next[producer] = seq + 1;
+            (*counts)[producer]++;
+        }
+    }
+}
+
+TEST(ObjectBufferMP, StressMPSC)
+{
+    ObjectBufferMPSC<uint32_t> buf{64};
+    std::atomic<int32_t> remaining{STRESS_PRODUCERS * STRESS_ITEMS};
+    std::vector<uint32_t> counts(STRESS_PRODUCERS);
+    bool in_order;
+
+    std::vector<std::thread> threads;
+    for (uint8_t p = 0; p < STRESS_PRODUCERS; p++) {
+        threads.emplace_back(produce, nullptr, &buf, p);
+    }
+    consume(nullptr, &buf, &remaining, &counts, &in_order);
+    for (auto &t : threads) {
+        t.join();
+    }
+
+    EXPECT_TRUE(in_order);
+    for (uint8_t p = 0; p < STRESS_PRODUCERS; p++) {
+        EXPECT_EQ(STRESS_ITEMS, counts[p]);
+    }
+    EXPECT_TRUE(buf.empty());
+}
+
+TEST(ObjectBufferMP, StressMPMC)
+{
+    ObjectBufferMPMC<uint32_t> buf{64};
+    std::atomic<int32_t> remaining{STRESS_PRODUCERS * STRESS_ITEMS};
+    std::vector<std::vector<uint32_t>> counts(STRESS_CONSUMERS, std::vector<uint32_t>(STRESS_PRODUCERS));
+    bool in_order[STRESS_CONSUMERS];
+
+    std::vector<std::thread> threads;
+    for (uint8_t c = 0; c < STRESS_CONSUMERS; c++) {
+        threads.emplace_back(consume, &buf, nullptr, &remaining, &counts[c], &in_order[c]);
+    }
+    for (uint8_t p = 0; p < STRESS_PRODUCERS; p++) {
+        threads.emplace_back(produce, &buf, nullptr, p);
+    }
+    for (auto &t : threads) {
+        t.join();
+    }
+
+    for (uint8_t p = 0; p < STRESS_PRODUCERS; p++) {
+        uint32_t total = 0;
+        for (uint8_t c = 0; c < STRESS_CONSUMERS; c++) {
+            EXPECT_TRUE(in_order[c]);
+            total += counts[c][p];
+        }
+        EXPECT_EQ(STRESS_ITEMS, total);
+    }
+    EXPECT_TRUE(buf.empty());
+}
+
+AP_GTEST_MAIN()
@@ -0,0 +1,123 @@
+#include <AP_gtest.h>
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_HAL/utility/TimingWheel.h>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+// run everything due at now, returning the entries that fired
+static std::vector<TimingWheel::Entry *> run(TimingWheel &wheel, uint64_t now)
+{
+    std::vector<TimingWheel::Entry *> fired;
+    while (TimingWheel::Entry *e = wheel.expire(now)) {
+        fired.push_back(e);
+    }
+    std::sort(fired.begin(), fired.end());
+    return fired;
+}
+
+TEST(TimingWheel, Periodic)
+{
+    TimingWheel wheel;
+    TimingWheel::Entry a, b;
+
+    wheel.add(a, 1000, 1000);
+    wheel.add(b, 1500, 500);
+    EXPECT_EQ(1000U, wheel.next_expiry());
+
+    EXPECT_TRUE(run(wheel, 999).empty());
+    EXPECT_EQ(std::vector<TimingWheel::Entry *>{&a}, run(wheel, 1000));
+    EXPECT_TRUE(run(wheel, 1000).empty());
+    EXPECT_EQ(std::vector<TimingWheel::Entry *>{&b}, run(wheel, 1700));
+    EXPECT_EQ(2000U, wheel.next_expiry());
+
+    std::vector<TimingWheel::Entry *> both {&a, &b};
+    std::sort(both.begin(), both.end());
+    EXPECT_EQ(both, run(wheel, 2000));
+    EXPECT_EQ(2500U, b.expiry);
+    EXPECT_EQ(3000U, a.expiry);
+}
+
+TEST(TimingWheel, JumpFiresOnce)
+{
+    TimingWheel wheel;
+    TimingWheel::Entry a;
+
+    wheel.add(a, 100, 100);
+
+    // a jump over many periods fires once and keeps the period
+    // from the new time
+    EXPECT_EQ(1U, run(wheel, 1000000).size());
+    EXPECT_EQ(1000100U, a.expiry);
+    EXPECT_EQ(1000000U, wheel.now());
+    EXPECT_TRUE(run(wheel, 1000099).empty());
+    EXPECT_EQ(1U, run(wheel, 1000100).size());
+}
+
+TEST(TimingWheel, LongPeriods)
+{
+    TimingWheel wheel;
+    TimingWheel::Entry a, b;
+
+    // one entry on the overflow list and one on level 1
+    wheel.add(a, 5000000, 5000000);
+    wheel.add(b, 3000, 3000);
+    for (uint64_t t = 0; t < 20000000; t += 1000) {
+        const auto fired = run(wheel, t);
+        const bool fire_a = t > 0 && t % 5000000 == 0;
+        const bool fire_b = t > 0 && t % 3000 == 0;
+        ASSERT_EQ(size_t(fire_a + fire_b), fired.size()) << t;
+        if (fire_a) {
+            ASSERT_TRUE(std::find(fired.begin(), fired.end(), &a) != fired.end());
+        }
+    }
+}
+
+/*
+  compare against a brute force scan of every entry with random
+  periods, phases and time steps
+ */
+TEST(TimingWheel, MatchesLinearScan)
+{
+    std::mt19937 rng(1);
+    TimingWheel wheel;
+    TimingWheel::Entry entries[40];
+    uint64_t expected[ARRAY_SIZE(entries)];
+
+    for (uint8_t i = 0; i < ARRAY_SIZE(entries); i++) {
+        // periods from a few ticks to well past both levels
+        const uint32_t period = 1 + rng() % (i < 30 ? 3000 : 20000);
+        expected[i] = rng() % 10000;
+        wheel.add(entries[i], expected[i], period);
+    }
+
+    uint64_t now = 0;
+    for (uint32_t step = 0; step < 200000; step++) {
+        now += rng() % (step % 100 == 0 ? 30000 : 200);
+
+        std::vector<TimingWheel::Entry *> due;
+        for (uint8_t i = 0; i < ARRAY_SIZE(entries); i++) {
+            if (expected[i] <= now) {
+                due.push_back(&entries[i]);
+                const uint32_t period = entries[i].period;
+                expected[i] += period;
+                if (expected[i] <= now) {
+                    expected[i] = now + period;
+                }
+            }
+        }
+        std::sort(due.begin(), due.end());
+
+        ASSERT_EQ(due, run(wheel, now)) << step;
+        for (uint8_t i = 0; i < ARRAY_SIZE(entries); i++) {
+            ASSERT_EQ(expected[i], entries[i].expiry);
+        }
+        ASSERT_EQ(*std::min_element(expected, expected + ARRAY_SIZE(entries)), wheel.next_expiry());
+    }
+}
+
+AP_GTEST_MAIN()
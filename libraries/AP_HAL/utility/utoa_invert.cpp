@@ -28,13 +28,33 @@
   ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
   POSSIBILITY OF SUCH DAMAGE. */
 
+
 #include <stdint.h>
 #include "xtoa_fast.h"
 
+/*
+  pairs of decimal digits, so values are converted two digits per
+  division. The digits of a pair are stored reversed to match the
+  inverted output
+ */
+static const char digit_pairs[201] =
+	"00102030405060708090"
+	"01112131415161718191"
+	"02122232425262728292"
+	"03132333435363738393"
+	"04142434445464748494"
+	"05152535455565758595"
+	"06162636465666768696"
+	"07172737475767778797"
+	"08182838485868788898"
+	"09192939495969798999";
+
+static const char hex_digits[] = "0123456789ABCDEF";
+
 char * ultoa_invert (uint32_t val, char *s, uint8_t base) {
 	if (base == 8) {
 		do {
-			*s = '0' + (val & 0x7);
+			*s++ = '0' + (val & 0x7);
 			val >>= 3;
 		} while(val);
 		return s;
@@ -42,36 +62,24 @@ char * ultoa_invert (uint32_t val, char *s, uint8_t base) {
 
 	if (base == 16) {
 		do {
-			uint8_t digit = '0' + (val & 0xf);
-#if XTOA_UPPER == 0
-			if (digit > '0' + 9)
-				digit += ('a' - '0' - 10);
-#else
-			if (digit > '0' + 9)
-				digit += ('A' - '0' - 10);
-#endif
-			*s++ = digit;
+			*s++ = hex_digits[val & 0xf];
 			val >>= 4;
 		} while(val);
 		return s;
 	}
 
 	// Every base which in not hex and not oct is considered decimal.
-
-	// 33 bits would have been enough.
-	uint64_t xval = val;
-	do {
-		uint8_t saved = xval;
-		xval &= ~1;
-		xval += 2;
-		xval += xval >> 1;		// *1.5
-		xval += xval >> 4;		// *1.0625
-		xval += xval >> 8;		// *1.00390625
-		xval += xval >> 16;		// *1.000015259
-		xval += xval >> 32;		// it all amounts to *1.6
-		xval >>= 4;				// /16 ... so *1.6/16 is /10, fraction truncated.
-		*s++ = '0' + saved - 10 * (uint8_t)xval;
-	} while (xval);
+	while (val >= 100) {
+		const uint32_t q = val / 100;
+		const uint8_t r = val - q * 100;
+		*s++ = digit_pairs[2*r];
+		*s++ = digit_pairs[2*r+1];
+		val = q;
+	}
+	*s++ = digit_pairs[2*val];
+	if (val >= 10) {
+		*s++ = digit_pairs[2*val+1];
+	}
 	return s;
 }
 
@@ -79,7 +87,7 @@ char * ultoa_invert (uint32_t val, char *s, uint8_t base) {
 char * ulltoa_invert (uint64_t val, char *s, uint8_t base) {
 	if (base == 8) {
 		do {
-			*s = '0' + (val & 0x7);
+			*s++ = '0' + (val & 0x7);
 			val >>= 3;
 		} while(val);
 		return s;
@@ -87,15 +95,7 @@ char * ulltoa_invert (uint64_t val, char *s, uint8_t base) {
 
 	if (base == 16) {
 		do {
-			uint8_t digit = '0' + (val & 0xf);
-#if XTOA_UPPER == 0
-			if (digit > '0' + 9)
-				digit += ('a' - '0' - 10);
-#else
-			if (digit > '0' + 9)
-				digit += ('A' - '0' - 10);
-#endif
-			*s++ = digit;
+			*s++ = hex_digits[val & 0xf];
 			val >>= 4;
 		} while(val);
 		return s;
@@ -103,21 +103,20 @@ char * ulltoa_invert (uint64_t val, char *s, uint8_t base) {
 
 	// Every base which in not hex and not oct is considered decimal.
 
-	// 64 bits is not actually enough, we need 65, but it should
-	// be good enough for the log dumping we're using this for
-	uint64_t xval = val;
-	do {
-		uint8_t saved = xval;
-		xval &= ~1;
-		xval += 2;
-		xval += xval >> 1;		// *1.5
-		xval += xval >> 4;		// *1.0625
-		xval += xval >> 8;		// *1.00390625
-		xval += xval >> 16;		// *1.000015259
-		xval += xval >> 32;		// it all amounts to *1.6
-		xval >>= 4;				// /16 ... so *1.6/16 is /10, fraction truncated.
-		*s++ = '0' + saved - 10 * (uint8_t)xval;
-	} while (xval);
-	return s;
+	// take 9 digits at a time with one 64 bit division, so the rest
+	// is done in 32 bits
+	while (val > UINT32_MAX) {
+		const uint64_t q = val / 1000000000U;
+		uint32_t low = val - q * 1000000000U;
+		for (uint8_t i = 0; i < 9; i += 2) {
+			const uint8_t r = low % 100;
+			low /= 100;
+			*s++ = digit_pairs[2*r];
+			if (i < 8) {
+				*s++ = digit_pairs[2*r+1];
+			}
+		}
+		val = q;
+	}
+	return ultoa_invert(val, s, base);
 }
-
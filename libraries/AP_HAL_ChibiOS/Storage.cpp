@@ -175,6 +175,8 @@ void Storage::write_block(uint16_t loc, const void *src, size_t n)
         WITH_SEMAPHORE(sem);
         memcpy(&_buffer[loc], src, n);
         _mark_dirty(loc, n);
+        _last_change_ms = AP_HAL::millis();
+        _stats.bytes_changed += n;
     }
 }
 
@@ -185,11 +187,30 @@ void Storage::_timer_tick(void)
     }
     if (_dirty_mask.empty()) {
         _last_empty_ms = AP_HAL::millis();
+#ifdef STORAGE_FLASH_PAGE
+        if ((_initialisedType == StorageBackend::Flash) &&
+            (AP_HAL::millis() - _last_change_ms > HAL_STORAGE_FLASH_COALESCE_MAX_MS)) {
+            // use idle time to prepare the next flash sector
+            UNUSED_RESULT(_flash.erase_ahead());
+        }
+#endif
         return;
     }
 
-    // write out the first dirty line. We don't write more
-    // than one to keep the latency of this call to a minimum
+#ifdef STORAGE_FLASH_PAGE
+    if (_initialisedType == StorageBackend::Flash) {
+        // hold back flash writes while storage is still being changed
+        const uint32_t now = AP_HAL::millis();
+        if ((now - _last_change_ms < HAL_STORAGE_FLASH_COALESCE_MS) &&
+            (now - _last_empty_ms < HAL_STORAGE_FLASH_COALESCE_MAX_MS)) {
+            return;
+        }
+    }
+#endif
+
+    // write out the first run of dirty lines. We don't write more
+    // than CH_STORAGE_MAX_WRITE_LINES to keep the latency of this
+    // call to a minimum
     uint16_t i;
     for (i=0; i<CH_STORAGE_NUM_LINES; i++) {
         if (_dirty_mask.get(i)) {
@@ -200,18 +221,28 @@ void Storage::_timer_tick(void)
         // this shouldn't be possible
         return;
     }
+    uint16_t num_lines = 1;
+    while (num_lines < CH_STORAGE_MAX_WRITE_LINES &&
+           i + num_lines < CH_STORAGE_NUM_LINES &&
+           _dirty_mask.get(i + num_lines)) {
+        num_lines++;
+    }
+    const uint32_t offset = CH_STORAGE_LINE_SIZE*i;
+    const uint16_t length = CH_STORAGE_LINE_SIZE*num_lines;
 
     {
-        // take a copy of the line we are writing with a semaphore held
+        // take a copy of the lines we are writing with a semaphore held
         WITH_SEMAPHORE(sem);
-        memcpy(tmpline, &_buffer[CH_STORAGE_LINE_SIZE*i], CH_STORAGE_LINE_SIZE);
+        memcpy(tmpline, &_buffer[offset], length);
     }
 
     bool write_ok = false;
 
 #if HAL_WITH_RAMTRON
     if (_initialisedType == StorageBackend::FRAM) {
-        if (fram.write(CH_STORAGE_LINE_SIZE*i, tmpline, CH_STORAGE_LINE_SIZE)) {
+        if (fram.write(offset, tmpline, length)) {
+            _stats.bytes_written += length;
+            _stats.backend_writes++;
             write_ok = true;
         }
     }
@@ -219,16 +250,17 @@ void Storage::_timer_tick(void)
 
 #ifdef USE_POSIX
     if ((_initialisedType == StorageBackend::SDCard) && log_fd != -1) {
-        uint32_t offset = CH_STORAGE_LINE_SIZE*i;
         if (AP::FS().lseek(log_fd, offset, SEEK_SET) != offset) {
             return;
         }
-        if (AP::FS().write(log_fd, &_buffer[offset], CH_STORAGE_LINE_SIZE) != CH_STORAGE_LINE_SIZE) {
+        if (AP::FS().write(log_fd, &_buffer[offset], length) != length) {
             return;
         }
         if (AP::FS().fsync(log_fd) != 0) {
             return;
         }
+        _stats.bytes_written += length;
+        _stats.backend_writes++;
         write_ok = true;
     }
 #endif
@@ -236,7 +268,7 @@ void Storage::_timer_tick(void)
 #ifdef STORAGE_FLASH_PAGE
     if (_initialisedType == StorageBackend::Flash) {
         // save to storage backend
-        if (_flash_write(i)) {
+        if (_flash_write(i, num_lines)) {
             write_ok = true;
         }
     }
@@ -244,14 +276,16 @@ void Storage::_timer_tick(void)
 
     if (write_ok) {
         WITH_SEMAPHORE(sem);
-        // while holding the semaphore we check if the copy of the
+        // while holding the semaphore we check if the copy of each
         // line is different from the original line. If it is
         // different then someone has re-dirtied the line while we
         // were writing it, in which case we should not mark it
         // clean. If it matches then we know we can mark the line as
         // clean
-        if (memcmp(tmpline, &_buffer[CH_STORAGE_LINE_SIZE*i], CH_STORAGE_LINE_SIZE) == 0) {
-            _dirty_mask.clear(i);
+        for (uint16_t n=0; n<num_lines; n++) {
+            if (memcmp(&tmpline[CH_STORAGE_LINE_SIZE*n], &_buffer[offset+CH_STORAGE_LINE_SIZE*n], CH_STORAGE_LINE_SIZE) == 0) {
+                _dirty_mask.clear(i+n);
+            }
         }
     }
 }
@@ -275,12 +309,12 @@ void Storage::_flash_load(void)
 }
 
 /*
-  write one storage line. This also updates _dirty_mask.
+  write num_lines storage lines starting at line
 */
-bool Storage::_flash_write(uint16_t line)
+bool Storage::_flash_write(uint16_t line, uint16_t num_lines)
 {
 #ifdef STORAGE_FLASH_PAGE
-    return _flash.write(line*CH_STORAGE_LINE_SIZE, CH_STORAGE_LINE_SIZE);
+    return _flash.write(line*CH_STORAGE_LINE_SIZE, num_lines*CH_STORAGE_LINE_SIZE);
 #else
     return false;
 #endif
@@ -294,6 +328,8 @@ bool Storage::_flash_write_data(uint8_t sector, uint32_t offset, const uint8_t *
 #ifdef STORAGE_FLASH_PAGE
     size_t base_address = hal.flash->getpageaddr(_flash_page+sector);
     for (uint8_t i=0; i<STORAGE_FLASH_RETRIES; i++) {
+        _stats.bytes_written += length;
+        _stats.backend_writes++;
         if (hal.flash->write(base_address+offset, data, length)) {
             return true;
         }
@@ -348,11 +384,16 @@ bool Storage::_flash_erase_sector(uint8_t sector)
          */
         ChibiOS::Scheduler *sched = (ChibiOS::Scheduler *)hal.scheduler;
         sched->_expect_delay_ms(1000);
-        if (hal.flash->erasepage(_flash_page+sector)) {
-            sched->_expect_delay_ms(0);
+        const uint32_t start_us = AP_HAL::micros();
+        const bool erase_ok = hal.flash->erasepage(_flash_page+sector);
+        const uint32_t erase_us = AP_HAL::micros() - start_us;
+        sched->_expect_delay_ms(0);
+        _stats.erase_count++;
+        _stats.erase_time_us += erase_us;
+        _stats.erase_max_us = MAX(_stats.erase_max_us, erase_us);
+        if (erase_ok) {
             return true;
         }
-        sched->_expect_delay_ms(0);
         hal.scheduler->delay(1);
     }
     return false;
@@ -380,6 +421,15 @@ bool Storage::healthy(void)
             (AP_HAL::millis() - _last_empty_ms < 2000u));
 }
 
+/*
+  get counters of writes and erases
+ */
+bool Storage::get_stats(Stats &stats) const
+{
+    stats = _stats;
+    return true;
+}
+
 /*
   erase all storage
  */
@@ -37,6 +37,21 @@
 static_assert(CH_STORAGE_SIZE % CH_STORAGE_LINE_SIZE == 0,
               "Storage is not multiple of line size");
 
+// up to this many consecutive dirty lines are written together
+#define CH_STORAGE_MAX_WRITE_LINES 8
+
+// flash writes are held back until storage has not been changed for
+// this long so that bursts of small writes (such as a mission upload
+// or a parameter save) are merged into fewer, larger flash blocks
+#ifndef HAL_STORAGE_FLASH_COALESCE_MS
+#define HAL_STORAGE_FLASH_COALESCE_MS 100
+#endif
+
+// flash writes are never held back for longer than this
+#ifndef HAL_STORAGE_FLASH_COALESCE_MAX_MS
+#define HAL_STORAGE_FLASH_COALESCE_MAX_MS 1000
+#endif
+
 class ChibiOS::Storage : public AP_HAL::Storage {
 public:
     void init() override {}
@@ -46,6 +61,7 @@ public:
 
     void _timer_tick(void) override;
     bool healthy(void) override;
+    bool get_stats(Stats &stats) const override;
 
 private:
     enum class StorageBackend: uint8_t {
@@ -62,7 +78,9 @@ private:
     uint8_t _buffer[CH_STORAGE_SIZE] __attribute__((aligned(4)));
     Bitmask<CH_STORAGE_NUM_LINES> _dirty_mask;
     HAL_Semaphore sem;
-    uint8_t tmpline[CH_STORAGE_LINE_SIZE];
+    uint8_t tmpline[CH_STORAGE_LINE_SIZE*CH_STORAGE_MAX_WRITE_LINES];
+    uint32_t _last_change_ms;
+    Stats _stats;
 
     bool _flash_write_data(uint8_t sector, uint32_t offset, const uint8_t *data, uint16_t length);
     bool _flash_read_data(uint8_t sector, uint32_t offset, uint8_t *data, uint16_t length);
@@ -83,7 +101,7 @@ private:
 #endif
 
     void _flash_load(void);
-    bool _flash_write(uint16_t line);
+    bool _flash_write(uint16_t line, uint16_t num_lines);
 
 #if HAL_WITH_RAMTRON
     AP_RAMTRON fram;
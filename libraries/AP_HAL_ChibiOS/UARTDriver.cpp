@@ -584,6 +584,23 @@ int16_t UARTDriver::read()
     return byte;
 }
 
+uint32_t UARTDriver::read_bytes(uint8_t *buffer, uint32_t count)
+{
+    if (lock_read_key != 0 || _uart_owner_thd != chThdGetSelfX()){
+        return 0;
+    }
+    if (!_initialised) {
+        return 0;
+    }
+
+    const uint32_t n = _readbuf.read(buffer, count);
+    if (n > 0 && !_rts_is_active) {
+        update_rts_line();
+    }
+
+    return n;
+}
+
 int16_t UARTDriver::read_locked(uint32_t key)
 {
     if (lock_read_key != 0 && key != lock_read_key) {
@@ -45,6 +45,7 @@ public:
     uint32_t txspace() override;
     int16_t read() override;
     int16_t read_locked(uint32_t key) override;
+    uint32_t read_bytes(uint8_t *buffer, uint32_t count) override;
     void _timer_tick(void) override;
 
     size_t write(uint8_t c) override;
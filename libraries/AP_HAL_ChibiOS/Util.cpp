@@ -50,7 +50,7 @@ uint32_t Util::available_memory(void)
     Special Allocation Routines
 */
 
-void* Util::malloc_type(size_t size, AP_HAL::Util::Memory_Type mem_type)
+void* Util::malloc_type(size_t size, AP_HAL::Util::Memory_Type mem_type, AP_HAL::Util::Memory_Tag tag)
 {
     if (mem_type == AP_HAL::Util::MEM_DMA_SAFE) {
         return malloc_dma(size);
@@ -61,7 +61,7 @@ void* Util::malloc_type(size_t size, AP_HAL::Util::Memory_Type mem_type)
     }
 }
 
-void Util::free_type(void *ptr, size_t size, AP_HAL::Util::Memory_Type mem_type)
+void Util::free_type(void *ptr, size_t size, AP_HAL::Util::Memory_Type mem_type, AP_HAL::Util::Memory_Tag tag)
 {
     if (ptr != NULL) {
         chHeapFree(ptr);
@@ -31,8 +31,8 @@ public:
     uint32_t available_memory() override;
 
     // Special Allocation Routines
-    void *malloc_type(size_t size, AP_HAL::Util::Memory_Type mem_type) override;
-    void free_type(void *ptr, size_t size, AP_HAL::Util::Memory_Type mem_type) override;
+    void *malloc_type(size_t size, AP_HAL::Util::Memory_Type mem_type, AP_HAL::Util::Memory_Tag tag) override;
+    void free_type(void *ptr, size_t size, AP_HAL::Util::Memory_Type mem_type, AP_HAL::Util::Memory_Tag tag) override;
 
 #ifdef ENABLE_HEAP
     // heap functions, note that a heap once alloc'd cannot be dealloc'd
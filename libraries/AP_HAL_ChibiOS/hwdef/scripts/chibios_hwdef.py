@@ -80,6 +80,9 @@ spidev = []
 # dictionary of ROMFS files
 romfs = {}
 
+# ROMFS files to store uncompressed
+romfs_raw = []
+
 # SPI bus list
 spi_list = []
 
@@ -1579,6 +1582,7 @@ def write_ROMFS(outdir):
     for k in romfs.keys():
         romfs_list.append((k, romfs[k]))
     env_vars['ROMFS_FILES'] = romfs_list
+    env_vars['ROMFS_RAW_FILES'] = romfs_raw
 
 
 def setup_apj_IDs():
@@ -1961,6 +1965,9 @@ def process_line(line):
         baro_list.append(a[1:])
     elif a[0] == 'ROMFS':
         romfs_add(a[1], a[2])
+    elif a[0] == 'ROMFS_RAW':
+        romfs_add(a[1], a[2])
+        romfs_raw.append(a[1])
     elif a[0] == 'ROMFS_WILDCARD':
         romfs_wildcard(a[1])
     elif a[0] == 'undef':
@@ -59,6 +59,15 @@ ssize_t ConsoleDevice::read(uint8_t *buf, uint16_t n)
     return ::read(_rd_fd, buf, n);
 }
 
+ssize_t ConsoleDevice::readv(const struct iovec *iov, int iovcnt)
+{
+    if (_closed) {
+        return -EAGAIN;
+    }
+
+    return ::readv(_rd_fd, iov, iovcnt);
+}
+
 ssize_t ConsoleDevice::write(const uint8_t *buf, uint16_t n)
 {
     if (_closed) {
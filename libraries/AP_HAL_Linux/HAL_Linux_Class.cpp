@@ -257,6 +257,13 @@ void _usage(void)
     printf("\tcustom terrain path:\n");
     printf("\t                   --terrain-directory /var/APM/terrain\n");
     printf("\t                   -t /var/APM/terrain\n");
+    printf("\tthread CPU affinity:\n");
+    printf("\t                   --cpu-affinity main=2,timer=3,uart=1,rcin=1,io=0,other=0+1\n");
+    printf("\t                   --cpu-affinity auto (main and timer on isolcpus= CPUs)\n");
+    printf("\t                   -c auto\n");
+    printf("\tthread wake-up latency report on exit:\n");
+    printf("\t                   --latency-report\n");
+    printf("\t                   -L\n");
 #if AP_MODULE_SUPPORTED
     printf("\tmodule support:\n");
     printf("\t                   --module-directory %s\n", AP_MODULE_DEFAULT_DIRECTORY);
@@ -286,11 +293,13 @@ void HAL_Linux::run(int argc, char* const argv[], Callbacks* callbacks) const
         {"terrain-directory",   true,  0, 't'},
         {"storage-directory",   true,  0, 's'},
         {"module-directory",    true,  0, 'M'},
+        {"cpu-affinity",        true,  0, 'c'},
+        {"latency-report",      false,  0, 'L'},
         {"help",                false,  0, 'h'},
         {0, false, 0, 0}
     };
 
-    GetOptLong gopt(argc, argv, "A:B:C:D:E:F:l:t:s:he:SM:",
+    GetOptLong gopt(argc, argv, "A:B:C:D:E:F:l:t:s:he:SM:c:L",
                     options);
 
     /*
@@ -336,6 +345,15 @@ void HAL_Linux::run(int argc, char* const argv[], Callbacks* callbacks) const
             module_path = gopt.optarg;
             break;
 #endif
+        case 'c':
+            if (!schedulerInstance.set_cpu_affinity_map(gopt.optarg)) {
+                printf("Invalid CPU affinity map '%s'\n", gopt.optarg);
+                exit(1);
+            }
+            break;
+        case 'L':
+            schedulerInstance.set_latency_report(true);
+            break;
         case 'h':
             _usage();
             exit(0);
@@ -89,11 +89,23 @@ public:
 
     int open(uint8_t n);
 
+    /*
+     * Do an I2C_RDWR ioctl, retrying up to @retries times and accounting
+     * it in the bus perf counters
+     */
+    int rdwr(struct i2c_rdwr_ioctl_data *data, unsigned retries);
+
     PollerThread thread;
     Semaphore sem;
     int fd = -1;
     uint8_t bus;
     uint8_t ref;
+
+    /* ioctls done on the bus and time spent transferring */
+    AP_HAL::Util::perf_counter_t perf_ioctl;
+    AP_HAL::Util::perf_counter_t perf_busy;
+    char perf_ioctl_name[sizeof("i2c-XXX-ioctl")];
+    char perf_busy_name[sizeof("i2c-XXX-busy")];
 };
 
 I2CBus::~I2CBus()
@@ -134,9 +146,28 @@ int I2CBus::open(uint8_t n)
 
     bus = n;
 
+    snprintf(perf_ioctl_name, sizeof(perf_ioctl_name), "i2c-%u-ioctl", bus);
+    snprintf(perf_busy_name, sizeof(perf_busy_name), "i2c-%u-busy", bus);
+    perf_ioctl = hal.util->perf_alloc(AP_HAL::Util::PC_COUNT, perf_ioctl_name);
+    perf_busy = hal.util->perf_alloc(AP_HAL::Util::PC_ELAPSED, perf_busy_name);
+
     return fd;
 }
 
+int I2CBus::rdwr(struct i2c_rdwr_ioctl_data *data, unsigned retries)
+{
+    int r;
+
+    hal.util->perf_begin(perf_busy);
+    do {
+        hal.util->perf_count(perf_ioctl);
+        r = ::ioctl(fd, I2C_RDWR, data);
+    } while (r == -1 && retries-- > 0);
+    hal.util->perf_end(perf_busy);
+
+    return r;
+}
+
 I2CDevice::I2CDevice(I2CBus &bus, uint8_t address)
     : _bus(bus)
     , _address(address)
@@ -190,13 +221,7 @@ bool I2CDevice::transfer(const uint8_t *send, uint32_t send_len,
     i2c_data.msgs = msgs;
     i2c_data.nmsgs = nmsgs;
 
-    int r;
-    unsigned retries = _retries;
-    do {
-        r = ::ioctl(_bus.fd, I2C_RDWR, &i2c_data);
-    } while (r == -1 && retries-- > 0);
-
-    return r != -1;
+    return _bus.rdwr(&i2c_data, _retries) != -1;
 }
 
 bool I2CDevice::read_registers_multiple(uint8_t first_reg, uint8_t *recv,
@@ -229,13 +254,7 @@ bool I2CDevice::read_registers_multiple(uint8_t first_reg, uint8_t *recv,
             recv += recv_len;
         };
 
-        int r;
-        unsigned retries = _retries;
-        do {
-            r = ::ioctl(_bus.fd, I2C_RDWR, &i2c_data);
-        } while (r == -1 && retries-- > 0);
-
-        if (r == -1) {
+        if (_bus.rdwr(&i2c_data, _retries) == -1) {
             return false;
         }
 
@@ -253,7 +272,7 @@ AP_HAL::Semaphore *I2CDevice::get_semaphore()
 AP_HAL::Device::PeriodicHandle I2CDevice::register_periodic_callback(
     uint32_t period_usec, AP_HAL::Device::PeriodicCb cb)
 {
-    TimerPollable *p = _bus.thread.add_timer(cb, &_bus, period_usec);
+    TimerPollable::Callback *p = _bus.thread.add_timer(cb, &_bus, period_usec);
     if (!p) {
         AP_HAL::panic("Could not create periodic callback");
     }
@@ -273,7 +292,7 @@ AP_HAL::Device::PeriodicHandle I2CDevice::register_periodic_callback(
 bool I2CDevice::adjust_periodic_callback(
     AP_HAL::Device::PeriodicHandle h, uint32_t period_usec)
 {
-    return _bus.thread.adjust_timer(static_cast<TimerPollable*>(h), period_usec);
+    return _bus.thread.adjust_timer(static_cast<TimerPollable::Callback*>(h), period_usec);
 }
 
 I2CDeviceManager::I2CDeviceManager()
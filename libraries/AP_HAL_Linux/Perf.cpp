@@ -16,6 +16,7 @@
  */
 #include <inttypes.h>
 #include <stdio.h>
+#include <string.h>
 #include <time.h>
 #include <vector>
 
@@ -61,35 +62,59 @@ void Perf::_debug_counters()
         return;
     }
 
+    print_counters(stderr);
+
+    _last_debug_msec = now;
+}
+
+void Perf::print_counters(FILE *out, const char *prefix)
+{
     pthread_rwlock_rdlock(&_perf_counters_lock);
     unsigned int uc = _update_count;
     auto v = _perf_counters;
     pthread_rwlock_unlock(&_perf_counters_lock);
 
     if (uc != _update_count) {
-        fprintf(stderr, "WARNING!! potentially wrong counters!!!");
+        fprintf(out, "WARNING!! potentially wrong counters!!!");
     }
 
+    const uint64_t now = now_nsec();
+
     for (auto &c : v) {
+        if (prefix != nullptr && strncmp(c.name, prefix, strlen(prefix)) != 0) {
+            continue;
+        }
         if (!c.count) {
-            fprintf(stderr, "%-30s\t"
+            fprintf(out, "%-30s\t"
                     "(no events)\n", c.name);
         } else if (c.type == Util::PC_ELAPSED) {
-            fprintf(stderr, "%-30s\t"
+            fprintf(out, "%-30s\t"
                     "count: %" PRIu64 "\t"
                     "min: %" PRIu64 "\t"
                     "max: %" PRIu64 "\t"
                     "avg: %.4f\t"
-                    "stddev: %.4f\n",
-                    c.name, c.count, c.min, c.max, c.avg, sqrt(c.m2));
+                    "stddev: %.4f\t"
+                    "busy: %.2f%%\n",
+                    c.name, c.count, c.min, c.max, c.avg, sqrt(c.m2),
+                    now > c.first ? c.total * 100.0 / (now - c.first) : 0.0);
+            fprintf(out, "%-30s\t", "");
+            for (uint8_t i = 0; i < PERF_HISTOGRAM_BUCKETS; i++) {
+                if (c.histogram[i] == 0) {
+                    continue;
+                }
+                if (i < PERF_HISTOGRAM_BUCKETS - 1) {
+                    fprintf(out, "<%uus: %u  ", 1U << i, (unsigned)c.histogram[i]);
+                } else {
+                    fprintf(out, ">=%uus: %u", 1U << (i - 1), (unsigned)c.histogram[i]);
+                }
+            }
+            fprintf(out, "\n");
         } else {
-            fprintf(stderr, "%-30s\t"
+            fprintf(out, "%-30s\t"
                     "count: %" PRIu64 "\n",
                     c.name, c.count);
         }
     }
-
-    _last_debug_msec = now;
 }
 
 Perf::Perf()
@@ -161,7 +186,40 @@ void Perf::end(Util::perf_counter_t pc)
 
     _update_count++;
 
-    const uint64_t elapsed = now_nsec() - perf.start;
+    _update_elapsed(perf, now_nsec() - perf.start);
+    perf.start = 0;
+
+    perf.lttng.end(perf.name);
+}
+
+void Perf::sample(Util::perf_counter_t pc, uint64_t elapsed_nsec)
+{
+    uintptr_t idx = (uintptr_t)pc;
+
+    if (idx >= _perf_counters.size()) {
+        return;
+    }
+
+    Perf_Counter &perf = _perf_counters[idx];
+    if (perf.type != Util::PC_ELAPSED) {
+        hal.console->printf("perf_sample() called on perf_counter_t(%s) that"
+                            " is not of PC_ELAPSED type.\n",
+                            perf.name);
+        return;
+    }
+
+    _update_count++;
+
+    _update_elapsed(perf, elapsed_nsec);
+
+    perf.lttng.count(perf.name, elapsed_nsec);
+}
+
+void Perf::_update_elapsed(Perf_Counter &perf, uint64_t elapsed)
+{
+    if (perf.count == 0) {
+        perf.first = now_nsec() - elapsed;
+    }
     perf.count++;
     perf.total += elapsed;
 
@@ -181,9 +239,12 @@ void Perf::end(Util::perf_counter_t pc)
     const double delta_intvl = elapsed - perf.avg;
     perf.avg += (delta_intvl / perf.count);
     perf.m2 += (delta_intvl * (elapsed - perf.avg));
-    perf.start = 0;
 
-    perf.lttng.end(perf.name);
+    uint8_t bucket = 0;
+    for (uint64_t usec = elapsed / 1000; usec != 0 && bucket < PERF_HISTOGRAM_BUCKETS - 1; usec >>= 1) {
+        bucket++;
+    }
+    perf.histogram[bucket]++;
 }
 
 void Perf::count(Util::perf_counter_t pc)
@@ -19,6 +19,7 @@
 #include <atomic>
 #include <limits.h>
 #include <pthread.h>
+#include <stdio.h>
 #include <vector>
 
 #include "AP_HAL_Linux.h"
@@ -26,6 +27,9 @@
 #include "Thread.h"
 #include "Util.h"
 
+/* buckets in the histogram of a PC_ELAPSED counter */
+#define PERF_HISTOGRAM_BUCKETS 12
+
 namespace Linux {
 
 class Perf_Counter {
@@ -49,12 +53,18 @@ public:
 
     /* Everything below is in nanoseconds */
     uint64_t start;
+    /* start of the first event, to tell the share of time spent in them */
+    uint64_t first;
     uint64_t total;
     uint64_t min;
     uint64_t max;
 
     double avg;
     double m2;
+
+    /* elapsed times by power of two microseconds: bucket 0 counts times
+     * under 1us, bucket n times under 2^n us and the last one the rest */
+    uint32_t histogram[PERF_HISTOGRAM_BUCKETS];
 };
 
 class Perf {
@@ -72,6 +82,12 @@ public:
     void end(perf_counter_t pc);
     void count(perf_counter_t pc);
 
+    /* add an elapsed time measured by the caller to a PC_ELAPSED counter */
+    void sample(perf_counter_t pc, uint64_t elapsed_nsec);
+
+    /* print the counters whose name starts with @prefix, or all of them */
+    void print_counters(FILE *out, const char *prefix = nullptr);
+
     unsigned int get_update_count() { return _update_count; }
 
 private:
@@ -81,6 +97,8 @@ private:
 
     void _debug_counters();
 
+    void _update_elapsed(Perf_Counter &perf, uint64_t elapsed);
+
     uint64_t _last_debug_msec;
 
     std::vector<Perf_Counter> _perf_counters;
@@ -41,7 +41,13 @@ void TimerPollable::on_can_read()
         _wrapper->start_cb();
     }
 
-    _cb();
+    {
+        WITH_SEMAPHORE(_sem);
+        /* by index: a callback may register another one on this timer */
+        for (size_t i = 0; i < _callbacks.size(); i++) {
+            _callbacks[i]->_cb();
+        }
+    }
 
     if (_wrapper) {
         _wrapper->end_cb();
@@ -86,34 +92,110 @@ bool TimerPollable::adjust_timer(uint32_t timeout_usec)
     return true;
 }
 
-TimerPollable *PollerThread::add_timer(TimerPollable::PeriodicCb cb,
-                                       TimerPollable::WrapperCb *wrapper,
-                                       uint32_t timeout_usec)
+TimerPollable::Callback *PollerThread::add_timer(TimerPollable::PeriodicCb cb,
+                                                 TimerPollable::WrapperCb *wrapper,
+                                                 uint32_t timeout_usec)
 {
     if (!_poller) {
         return nullptr;
     }
-    TimerPollable *p = new TimerPollable(cb, wrapper);
-    if (!p || !p->setup_timer(timeout_usec) ||
-        !_poller.register_pollable(p, POLLIN)) {
-        delete p;
+    TimerPollable::Callback *c = new TimerPollable::Callback(cb);
+    if (!c) {
         return nullptr;
     }
 
-    _timers.push_back(p);
+    WITH_SEMAPHORE(_timers_sem);
 
-    return p;
+    if (!_move_callback(c, wrapper, timeout_usec)) {
+        delete c;
+        return nullptr;
+    }
+
+    return c;
 }
 
-bool PollerThread::adjust_timer(TimerPollable *p, uint32_t timeout_usec)
+bool PollerThread::adjust_timer(TimerPollable::Callback *c, uint32_t timeout_usec)
 {
-    /* Make sure the handle points to a valid timer */
-    auto it = std::find(_timers.begin(), _timers.end(), p);
+    WITH_SEMAPHORE(_timers_sem);
+
+    /* Make sure the handle points to a valid callback */
+    auto it = std::find_if(_timers.begin(), _timers.end(),
+                           [c](const TimerPollable *p) {
+                               return std::find(p->_callbacks.begin(),
+                                                p->_callbacks.end(),
+                                                c) != p->_callbacks.end();
+                           });
     if (it == _timers.end()) {
         return false;
     }
 
-    return (*it)->adjust_timer(timeout_usec);
+    if (is_current_thread()) {
+        /*
+         * Called from a callback while the list of its timer is being
+         * walked: move it once the wakeup is done
+         */
+        c->_new_period_usec = timeout_usec;
+        _adjust_pending = true;
+        return true;
+    }
+
+    return _move_callback(c, (*it)->_wrapper, timeout_usec);
+}
+
+/*
+ * Put @c on the timer for @timeout_usec and @wrapper, creating it if there is
+ * none. Must be called with _timers_sem taken.
+ */
+bool PollerThread::_move_callback(TimerPollable::Callback *c,
+                                  TimerPollable::WrapperCb *wrapper,
+                                  uint32_t timeout_usec)
+{
+    TimerPollable *old = c->_timer;
+    TimerPollable *t = nullptr;
+
+    for (TimerPollable *p : _timers) {
+        if (!p->_removeme && p->_wrapper == wrapper &&
+            p->_period_usec == timeout_usec) {
+            t = p;
+            break;
+        }
+    }
+
+    if (old && old->_callbacks.size() == 1 && (!t || t == old)) {
+        /* Alone on its timer: just restart it with the new period */
+        if (!old->adjust_timer(timeout_usec)) {
+            return false;
+        }
+        old->_period_usec = timeout_usec;
+        return true;
+    }
+
+    if (t && t == old) {
+        return true;
+    }
+
+    if (!t) {
+        t = new TimerPollable(wrapper, timeout_usec, _timers_sem);
+        if (!t || !t->setup_timer(timeout_usec) ||
+            !_poller.register_pollable(t, POLLIN)) {
+            delete t;
+            return false;
+        }
+        _timers.push_back(t);
+    }
+
+    if (old) {
+        auto &cbs = old->_callbacks;
+        cbs.erase(std::find(cbs.begin(), cbs.end(), c));
+        if (cbs.empty()) {
+            old->_removeme = true;
+        }
+    }
+
+    t->_callbacks.push_back(c);
+    c->_timer = t;
+
+    return true;
 }
 
 void PollerThread::_cleanup_timers()
@@ -122,13 +204,36 @@ void PollerThread::_cleanup_timers()
         return;
     }
 
-    for (auto it = _timers.begin(); it != _timers.end(); it++) {
+    WITH_SEMAPHORE(_timers_sem);
+
+    if (_adjust_pending) {
+        _adjust_pending = false;
+        for (size_t i = 0; i < _timers.size(); i++) {
+            auto &cbs = _timers[i]->_callbacks;
+            for (size_t j = 0; j < cbs.size(); ) {
+                TimerPollable::Callback *c = cbs[j];
+                if (c->_new_period_usec != 0) {
+                    const uint32_t period_usec = c->_new_period_usec;
+                    c->_new_period_usec = 0;
+                    _move_callback(c, _timers[i]->_wrapper, period_usec);
+                }
+                /* a moved callback has been erased from this list */
+                if (j < cbs.size() && cbs[j] == c) {
+                    j++;
+                }
+            }
+        }
+    }
+
+    for (auto it = _timers.begin(); it != _timers.end(); ) {
         TimerPollable *p = *it;
-        if (p->_removeme) {
-            _timers.erase(it);
-            _poller.unregister_pollable(p);
-            delete p;
+        if (!p->_removeme) {
+            it++;
+            continue;
         }
+        it = _timers.erase(it);
+        _poller.unregister_pollable(p);
+        delete p;
     }
 }
 
@@ -22,12 +22,14 @@
 #include <AP_HAL/Device.h>
 
 #include "Poller.h"
+#include "Semaphores.h"
 #include "Thread.h"
 
 namespace Linux {
 
 class TimerPollable : public Pollable {
     friend class PollerThread;
+    friend class PollerThread_Test;
 
 public:
     class WrapperCb {
@@ -40,6 +42,26 @@ public:
 
     using PeriodicCb = AP_HAL::Device::PeriodicCb;
 
+    /*
+     * A periodic callback. Callbacks with the same period and wrapper
+     * share one timer, so they run one after the other on a single
+     * wakeup with the wrapper called only once around them.
+     */
+    class Callback {
+        friend class PollerThread;
+        friend class PollerThread_Test;
+        friend class TimerPollable;
+
+    public:
+        Callback(PeriodicCb cb) : _cb(cb) { }
+
+    protected:
+        PeriodicCb _cb;
+        TimerPollable *_timer = nullptr;
+        /* period to move to once the current wakeup is done, 0 if none */
+        uint32_t _new_period_usec = 0;
+    };
+
     virtual ~TimerPollable() { }
 
     void on_can_read() override;
@@ -48,27 +70,51 @@ public:
     bool adjust_timer(uint32_t timeout_usec);
 
 protected:
-    TimerPollable(PeriodicCb cb, WrapperCb *wrapper)
-        : _cb(cb)
-        , _wrapper(wrapper)
+    TimerPollable(WrapperCb *wrapper, uint32_t period_usec, Semaphore &sem)
+        : _wrapper(wrapper)
+        , _period_usec(period_usec)
+        , _sem(sem)
     {
     }
 
-    PeriodicCb _cb;
+    std::vector<Callback*> _callbacks{};
     WrapperCb *_wrapper;
+    uint32_t _period_usec;
+    /* protects _callbacks, owned by the PollerThread */
+    Semaphore &_sem;
     bool _removeme = false;
 };
 
 
 class PollerThread : public Thread {
+    friend class PollerThread_Test;
 public:
     PollerThread() : Thread{FUNCTOR_BIND_MEMBER(&PollerThread::mainloop, void)} { }
     virtual ~PollerThread() { }
 
-    TimerPollable *add_timer(TimerPollable::PeriodicCb cb,
-                             TimerPollable::WrapperCb *wrapper,
-                             uint32_t timeout_usec);
-    bool adjust_timer(TimerPollable *p, uint32_t timeout_usec);
+    /*
+     * Run @cb every @timeout_usec inside @wrapper. A callback joins the
+     * timer of other callbacks with the same period and wrapper, so
+     * devices on the same bus are serviced on one wakeup.
+     */
+    TimerPollable::Callback *add_timer(TimerPollable::PeriodicCb cb,
+                                       TimerPollable::WrapperCb *wrapper,
+                                       uint32_t timeout_usec);
+    bool adjust_timer(TimerPollable::Callback *c, uint32_t timeout_usec);
+
+    /*
+     * Wait for events on @p in this thread as well as for its timers. The
+     * callbacks of @p run in this thread.
+     */
+    bool register_pollable(Pollable *p, uint32_t events) {
+        return _poller.register_pollable(p, events);
+    }
+    bool modify_pollable(Pollable *p, uint32_t events) {
+        return _poller.modify_pollable(p, events);
+    }
+    void unregister_pollable(const Pollable *p) {
+        _poller.unregister_pollable(p);
+    }
 
     void mainloop();
 
@@ -76,9 +122,15 @@ public:
 
 protected:
     void _cleanup_timers();
+    bool _move_callback(TimerPollable::Callback *c,
+                        TimerPollable::WrapperCb *wrapper,
+                        uint32_t timeout_usec);
 
     Poller _poller{};
     std::vector<TimerPollable*> _timers{};
+    Semaphore _timers_sem;
+    /* a callback asked to change its own period from this thread */
+    bool _adjust_pending = false;
 };
 
 }
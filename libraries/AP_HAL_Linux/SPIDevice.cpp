@@ -153,6 +153,15 @@ SPIDesc SPIDeviceManager::_device[] = {
 
 #define MAX_SUBDEVS 6
 
+/*
+ * Limits of the transfers queued on a device: messages in one
+ * SPI_IOC_MESSAGE(), bytes of queued send data and total length, which
+ * spidev caps to its bufsiz parameter (4096 by default)
+ */
+#define SPI_QUEUE_MAX_MSGS 16
+#define SPI_QUEUE_TX_SIZE 128
+#define SPI_QUEUE_MAX_BYTES 4096
+
 const uint8_t SPIDeviceManager::_n_device_desc = LINUX_SPI_DEVICE_NUM_DEVICES;
 
 
@@ -171,18 +180,34 @@ public:
 
     void open(uint16_t subdev);
 
+    /*
+     * Do a SPI_IOC_MESSAGE() ioctl, accounting it in the bus perf counters
+     */
+    int message(int fd, unsigned nmsgs, struct spi_ioc_transfer *msgs);
+
     PollerThread thread;
     Semaphore sem;
     int fd[MAX_SUBDEVS];
     uint16_t bus;
     int16_t last_mode = -1;
     uint8_t ref;
+
+    /* ioctls done on the bus and time spent transferring */
+    AP_HAL::Util::perf_counter_t perf_ioctl;
+    AP_HAL::Util::perf_counter_t perf_busy;
+    char perf_ioctl_name[sizeof("spi-XXXXX-ioctl")];
+    char perf_busy_name[sizeof("spi-XXXXX-busy")];
 };
 
 SPIBus::SPIBus(uint16_t bus_)
     : bus(bus_)
 {
     memset(fd, -1, sizeof(fd));
+
+    snprintf(perf_ioctl_name, sizeof(perf_ioctl_name), "spi-%u-ioctl", bus);
+    snprintf(perf_busy_name, sizeof(perf_busy_name), "spi-%u-busy", bus);
+    perf_ioctl = hal.util->perf_alloc(AP_HAL::Util::PC_COUNT, perf_ioctl_name);
+    perf_busy = hal.util->perf_alloc(AP_HAL::Util::PC_ELAPSED, perf_busy_name);
 }
 
 SPIBus::~SPIBus()
@@ -220,6 +245,16 @@ void SPIBus::open(uint16_t subdev)
     }
 }
 
+int SPIBus::message(int fd_, unsigned nmsgs, struct spi_ioc_transfer *msgs)
+{
+    hal.util->perf_count(perf_ioctl);
+    hal.util->perf_begin(perf_busy);
+    int r = ioctl(fd_, SPI_IOC_MESSAGE(nmsgs), msgs);
+    hal.util->perf_end(perf_busy);
+
+    return r;
+}
+
 
 SPIDevice::SPIDevice(SPIBus &bus, SPIDesc &device_desc)
     : _bus(bus)
@@ -244,6 +279,9 @@ SPIDevice::SPIDevice(SPIBus &bus, SPIDesc &device_desc)
 
 SPIDevice::~SPIDevice()
 {
+    delete[] _queue;
+    delete[] _queue_tx;
+
     // Unregister itself from the SPIDeviceManager
     SPIDeviceManager::from(hal.spi)->_unregister(_bus);
 }
@@ -320,19 +358,12 @@ bool SPIDevice::transfer(const uint8_t *send, uint32_t send_len,
     }
 #endif
 
-    int r;
-    if (_desc.mode != _bus.last_mode) {
-        r = ioctl(fd, SPI_IOC_WR_MODE, &_desc.mode);
-        if (r < 0) {
-            hal.console->printf("SPIDevice: error on setting mode fd=%d (%s)\n",
-                                fd, strerror(errno));
-            return false;
-        }
-        _bus.last_mode = _desc.mode;
+    if (!_set_mode(fd)) {
+        return false;
     }
 
     _cs_assert();
-    r = ioctl(fd, SPI_IOC_MESSAGE(nmsgs), &msgs);
+    int r = _bus.message(fd, nmsgs, msgs);
     _cs_release();
 
     if (r == -1) {
@@ -364,15 +395,17 @@ bool SPIDevice::transfer_fullduplex(const uint8_t *send, uint8_t *recv,
     msgs[0].bits_per_word = _desc.bits_per_word;
     msgs[0].cs_change = 0;
 
+    hal.util->perf_count(_bus.perf_ioctl);
     int r = ioctl(fd, SPI_IOC_WR_MODE, &_desc.mode);
     if (r < 0) {
         hal.console->printf("SPIDevice: error on setting mode fd=%d (%s)\n",
                             fd, strerror(errno));
         return false;
     }
+    _bus.last_mode = _desc.mode;
 
     _cs_assert();
-    r = ioctl(fd, SPI_IOC_MESSAGE(1), &msgs);
+    r = _bus.message(fd, 1, msgs);
     _cs_release();
 
     if (r == -1) {
@@ -384,6 +417,130 @@ bool SPIDevice::transfer_fullduplex(const uint8_t *send, uint8_t *recv,
     return true;
 }
 
+bool SPIDevice::_set_mode(int fd)
+{
+    if (_desc.mode == _bus.last_mode) {
+        return true;
+    }
+
+    hal.util->perf_count(_bus.perf_ioctl);
+    if (ioctl(fd, SPI_IOC_WR_MODE, &_desc.mode) < 0) {
+        hal.console->printf("SPIDevice: error on setting mode fd=%d (%s)\n",
+                            fd, strerror(errno));
+        return false;
+    }
+    _bus.last_mode = _desc.mode;
+
+    return true;
+}
+
+bool SPIDevice::queue_transfer(const uint8_t *send, uint32_t send_len,
+                               uint8_t *recv, uint32_t recv_len)
+{
+    if (!send || send_len == 0) {
+        send_len = 0;
+    }
+    if (!recv || recv_len == 0) {
+        recv_len = 0;
+    }
+
+    /*
+     * A userspace CS can't be toggled between the messages of an ioctl and
+     * a transfer that doesn't fit the queue on its own won't get any
+     * better: do them now, after what is already queued so the bus sees
+     * the transfers in order
+     */
+    if (_desc.cs_pin != SPI_CS_KERNEL || send_len > SPI_QUEUE_TX_SIZE ||
+        send_len + recv_len > SPI_QUEUE_MAX_BYTES) {
+        if (!submit_transfers()) {
+            _queue_failed = true;
+        }
+        return AP_HAL::SPIDevice::queue_transfer(send, send_len, recv, recv_len);
+    }
+
+    if (send_len + recv_len == 0) {
+        _queue_failed = true;
+        return false;
+    }
+
+    if (!_queue) {
+        _queue = new struct spi_ioc_transfer[SPI_QUEUE_MAX_MSGS];
+        _queue_tx = new uint8_t[SPI_QUEUE_TX_SIZE];
+        if (!_queue || !_queue_tx) {
+            AP_HAL::panic("SPIDevice: could not allocate transfer queue");
+        }
+    }
+
+    /* Make room by submitting what is already queued */
+    if (_queue_msgs + 2 > SPI_QUEUE_MAX_MSGS ||
+        _queue_tx_len + send_len > SPI_QUEUE_TX_SIZE ||
+        _queue_bytes + send_len + recv_len > SPI_QUEUE_MAX_BYTES) {
+        if (!submit_transfers()) {
+            _queue_failed = true;
+        }
+    }
+
+    if (send_len) {
+        memcpy(&_queue_tx[_queue_tx_len], send, send_len);
+        _queue_message(&_queue_tx[_queue_tx_len], nullptr, send_len);
+        _queue_tx_len += send_len;
+    }
+
+    if (recv_len) {
+        _queue_message(nullptr, recv, recv_len);
+    }
+
+    /* Release CS after the last message of the transfer */
+    _queue[_queue_msgs - 1].cs_change = 1;
+
+    return true;
+}
+
+void SPIDevice::_queue_message(const uint8_t *tx, uint8_t *rx, uint32_t len)
+{
+    struct spi_ioc_transfer &msg = _queue[_queue_msgs++];
+
+    memset(&msg, 0, sizeof(msg));
+    msg.tx_buf = (uint64_t) tx;
+    msg.rx_buf = (uint64_t) rx;
+    msg.len = len;
+    msg.speed_hz = _speed;
+    msg.delay_usecs = 0;
+    msg.bits_per_word = _desc.bits_per_word;
+    msg.cs_change = 0;
+
+    _queue_bytes += len;
+}
+
+bool SPIDevice::submit_transfers()
+{
+    if (_queue_msgs == 0) {
+        return AP_HAL::SPIDevice::submit_transfers();
+    }
+
+    int fd = _bus.fd[_desc.subdev];
+
+    assert(fd >= 0);
+
+    /*
+     * cs_change on the last message would keep the device selected after
+     * the ioctl
+     */
+    _queue[_queue_msgs - 1].cs_change = 0;
+
+    bool ret = _set_mode(fd);
+    if (ret && _bus.message(fd, _queue_msgs, _queue) == -1) {
+        hal.console->printf("SPIDevice: error transferring data fd=%d (%s)\n",
+                            fd, strerror(errno));
+        ret = false;
+    }
+
+    _queue_msgs = 0;
+    _queue_tx_len = 0;
+    _queue_bytes = 0;
+
+    return AP_HAL::SPIDevice::submit_transfers() && ret;
+}
 
 void SPIDevice::_cs_assert()
 {
@@ -411,7 +568,7 @@ AP_HAL::Semaphore *SPIDevice::get_semaphore()
 AP_HAL::Device::PeriodicHandle SPIDevice::register_periodic_callback(
     uint32_t period_usec, AP_HAL::Device::PeriodicCb cb)
 {
-    TimerPollable *p = _bus.thread.add_timer(cb, &_bus, period_usec);
+    TimerPollable::Callback *p = _bus.thread.add_timer(cb, &_bus, period_usec);
     if (!p) {
         AP_HAL::panic("Could not create periodic callback");
     }
@@ -431,7 +588,7 @@ AP_HAL::Device::PeriodicHandle SPIDevice::register_periodic_callback(
 bool SPIDevice::adjust_periodic_callback(
     AP_HAL::Device::PeriodicHandle h, uint32_t period_usec)
 {
-    return _bus.thread.adjust_timer(static_cast<TimerPollable*>(h), period_usec);
+    return _bus.thread.adjust_timer(static_cast<TimerPollable::Callback*>(h), period_usec);
 }
 
 
@@ -22,6 +22,8 @@
 #include <AP_HAL/HAL.h>
 #include <AP_HAL/SPIDevice.h>
 
+struct spi_ioc_transfer;
+
 namespace Linux {
 
 class SPIBus;
@@ -46,6 +48,13 @@ public:
     bool transfer_fullduplex(const uint8_t *send, uint8_t *recv,
                              uint32_t len) override;
 
+    /* See AP_HAL::Device::queue_transfer() */
+    bool queue_transfer(const uint8_t *send, uint32_t send_len,
+                        uint8_t *recv, uint32_t recv_len) override;
+
+    /* See AP_HAL::Device::submit_transfers() */
+    bool submit_transfers() override;
+
     /* See AP_HAL::Device::get_semaphore() */
     AP_HAL::Semaphore *get_semaphore() override;
 
@@ -63,6 +72,27 @@ protected:
     AP_HAL::DigitalSource *_cs;
     uint32_t _speed;
 
+    /*
+     * Transfers queued for submit_transfers(), as one or two messages each,
+     * and the copy of their send bytes
+     */
+    struct spi_ioc_transfer *_queue = nullptr;
+    uint8_t _queue_msgs = 0;
+    uint8_t *_queue_tx = nullptr;
+    uint16_t _queue_tx_len = 0;
+    uint32_t _queue_bytes = 0;
+
+    /*
+     * Set the mode of this device on the bus if it was last used with
+     * another one
+     */
+    bool _set_mode(int fd);
+
+    /*
+     * Add a message to the queue
+     */
+    void _queue_message(const uint8_t *tx, uint8_t *rx, uint32_t len);
+
     /*
      * Select device if using userspace CS
      */
@@ -136,6 +136,16 @@ int SPIUARTDriver::_read_fd(uint8_t *buf, uint16_t n)
     return n;
 }
 
+int SPIUARTDriver::_poll_fd()
+{
+    if (_external) {
+        return UARTDriver::_poll_fd();
+    }
+
+    // SPI transfers can only be polled
+    return -1;
+}
+
 void SPIUARTDriver::_timer_tick(void)
 {
     if (_external) {
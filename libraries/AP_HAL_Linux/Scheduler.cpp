@@ -1,10 +1,13 @@
 #include "Scheduler.h"
 
 #include <algorithm>
+#include <ctype.h>
 #include <errno.h>
+#include <fcntl.h>
 #include <poll.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <sys/mman.h>
 #include <sys/time.h>
 #include <unistd.h>
@@ -45,6 +48,8 @@ extern const AP_HAL::HAL& hal;
 #define APM_LINUX_IO_RATE               50
 #endif
 
+#define APM_LINUX_ISOLATED_CPUS_FILE    "/sys/devices/system/cpu/isolated"
+
 #define SCHED_THREAD(name_, UPPER_NAME_)                        \
     {                                                           \
         .name = "ap-" #name_,                                   \
@@ -52,10 +57,170 @@ extern const AP_HAL::HAL& hal;
         .policy = SCHED_FIFO,                                   \
         .prio = APM_LINUX_##UPPER_NAME_##_PRIORITY,             \
         .rate = APM_LINUX_##UPPER_NAME_##_RATE,                 \
+        .cpus = &_cpus[CPUS_##UPPER_NAME_],                     \
+        .wakeup_perf = "wakeup-" #name_,                        \
     }
 
 Scheduler::Scheduler()
-{ }
+{
+    for (uint8_t i = 0; i < CPUS_COUNT; i++) {
+        CPU_ZERO(&_cpus[i]);
+    }
+}
+
+/*
+  parse a list of CPUs like "0-2+4", or "0-2,4" as the kernel prints it
+ */
+bool Scheduler::parse_cpu_list(const char *s, size_t len, cpu_set_t &cpus)
+{
+    const char *end = s + len;
+
+    CPU_ZERO(&cpus);
+    while (s < end) {
+        // strtoul() would take a sign or leading spaces
+        if (!isdigit(*s)) {
+            return false;
+        }
+        char *p;
+        const unsigned long first = strtoul(s, &p, 10);
+        unsigned long last = first;
+        if (p < end && *p == '-') {
+            s = p + 1;
+            if (s == end || !isdigit(*s)) {
+                return false;
+            }
+            last = strtoul(s, &p, 10);
+            if (last < first) {
+                return false;
+            }
+        }
+        if (last >= CPU_SETSIZE) {
+            return false;
+        }
+        for (unsigned long cpu = first; cpu <= last; cpu++) {
+            CPU_SET(cpu, &cpus);
+        }
+        if (p < end && *p != '+' && *p != ',' && *p != '\n') {
+            return false;
+        }
+        s = p + 1;
+    }
+
+    return true;
+}
+
+bool Scheduler::set_cpu_affinity_map(const char *map)
+{
+    static const struct {
+        const char *name;
+        enum thread_cpus index;
+    } names[] = {
+        { "main", CPUS_MAIN },
+        { "timer", CPUS_TIMER },
+        { "uart", CPUS_UART },
+        { "rcin", CPUS_RCIN },
+        { "io", CPUS_IO },
+        { "other", CPUS_OTHER },
+    };
+
+    if (strcmp(map, "auto") == 0) {
+        _auto_cpus = true;
+        return true;
+    }
+
+    while (*map) {
+        const size_t len = strcspn(map, ",");
+        const char *eq = (const char *)memchr(map, '=', len);
+        if (eq == nullptr) {
+            return false;
+        }
+        const size_t name_len = eq - map;
+        uint8_t i;
+        for (i = 0; i < ARRAY_SIZE(names); i++) {
+            if (strlen(names[i].name) == name_len &&
+                strncmp(names[i].name, map, name_len) == 0) {
+                break;
+            }
+        }
+        if (i == ARRAY_SIZE(names) ||
+            !parse_cpu_list(eq + 1, len - name_len - 1, _cpus[names[i].index]) ||
+            CPU_COUNT(&_cpus[names[i].index]) == 0) {
+            return false;
+        }
+        map += len;
+        if (*map == ',') {
+            map++;
+        }
+    }
+
+    return true;
+}
+
+bool Scheduler::get_other_cpus(cpu_set_t &cpus) const
+{
+    if (CPU_COUNT(&_cpus[CPUS_OTHER]) == 0) {
+        return false;
+    }
+    cpus = _cpus[CPUS_OTHER];
+    return true;
+}
+
+/*
+  complete the CPU map before any thread is started: resolve "auto"
+  from the isolated CPUs and keep the threads without a CPU of their
+  own off the main thread's CPUs
+ */
+void Scheduler::init_cpus()
+{
+    cpu_set_t allowed;
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) {
+        return;
+    }
+
+    if (_auto_cpus) {
+        char buf[64];
+        cpu_set_t isolated;
+        int fd = open(APM_LINUX_ISOLATED_CPUS_FILE, O_RDONLY | O_CLOEXEC);
+        const ssize_t n = fd == -1 ? -1 : read(fd, buf, sizeof(buf) - 1);
+        if (fd != -1) {
+            close(fd);
+        }
+        if (n <= 0 || !parse_cpu_list(buf, n, isolated) || CPU_COUNT(&isolated) == 0) {
+            fprintf(stderr, "WARNING: no isolated CPUs, not placing threads\n");
+            return;
+        }
+
+        /*
+          the main loop takes the first isolated CPU and the timer thread
+          the next one, sharing the main thread's CPU if it is the only one
+         */
+        uint8_t placed = 0;
+        for (int cpu = 0; cpu < CPU_SETSIZE && placed < 2; cpu++) {
+            if (!CPU_ISSET(cpu, &isolated)) {
+                continue;
+            }
+            CPU_SET(cpu, &_cpus[placed == 0 ? CPUS_MAIN : CPUS_TIMER]);
+            placed++;
+        }
+        if (placed == 1) {
+            _cpus[CPUS_TIMER] = _cpus[CPUS_MAIN];
+        }
+        _cpus[CPUS_OTHER] = allowed;
+        CPU_AND(&_cpus[CPUS_OTHER], &_cpus[CPUS_OTHER], &isolated);
+        CPU_XOR(&_cpus[CPUS_OTHER], &_cpus[CPUS_OTHER], &allowed);
+    } else if (CPU_COUNT(&_cpus[CPUS_OTHER]) == 0 && CPU_COUNT(&_cpus[CPUS_MAIN]) != 0) {
+        // allowed CPUs except the main thread's ones
+        _cpus[CPUS_OTHER] = allowed;
+        CPU_AND(&_cpus[CPUS_OTHER], &_cpus[CPUS_OTHER], &_cpus[CPUS_MAIN]);
+        CPU_XOR(&_cpus[CPUS_OTHER], &_cpus[CPUS_OTHER], &allowed);
+    }
+
+    if (CPU_COUNT(&_cpus[CPUS_MAIN]) != 0 &&
+        sched_setaffinity(0, sizeof(_cpus[CPUS_MAIN]), &_cpus[CPUS_MAIN]) != 0) {
+        fprintf(stderr, "WARNING: failed to set CPU affinity of main thread: %s\n",
+                strerror(errno));
+    }
+}
 
 
 void Scheduler::init_realtime()
@@ -72,7 +237,9 @@ void Scheduler::init_realtime()
     }
 #endif
 
-    mlockall(MCL_CURRENT|MCL_FUTURE);
+    if (mlockall(MCL_CURRENT|MCL_FUTURE) == -1) {
+        fprintf(stderr, "WARNING: failed to lock memory: %s\n", strerror(errno));
+    }
 
     struct sched_param param = { .sched_priority = APM_LINUX_MAIN_PRIORITY };
     if (sched_setscheduler(0, SCHED_FIFO, &param) == -1) {
@@ -90,19 +257,22 @@ void Scheduler::init()
         int policy;
         int prio;
         uint32_t rate;
+        const cpu_set_t *cpus;
+        const char *wakeup_perf;
     } sched_table[] = {
         SCHED_THREAD(timer, TIMER),
-        SCHED_THREAD(uart, UART),
         SCHED_THREAD(rcin, RCIN),
         SCHED_THREAD(io, IO),
     };
 
     _main_ctx = pthread_self();
+    _main_wakeup_perf = Perf::get_singleton()->add(AP_HAL::Util::PC_ELAPSED, "wakeup-main");
 
+    init_cpus();
     init_realtime();
 
-    /* set barrier to N + 1 threads: worker threads + main */
-    unsigned n_threads = ARRAY_SIZE(sched_table) + 1;
+    /* set barrier to N + 2 threads: worker threads + uart + main */
+    unsigned n_threads = ARRAY_SIZE(sched_table) + 2;
     ret = pthread_barrier_init(&_initialized_barrier, nullptr, n_threads);
     if (ret) {
         AP_HAL::panic("Scheduler: Failed to initialise barrier object: %s",
@@ -114,9 +284,19 @@ void Scheduler::init()
 
         t->thread->set_rate(t->rate);
         t->thread->set_stack_size(1024 * 1024);
+        t->thread->set_cpu_affinity(*t->cpus);
+        t->thread->set_wakeup_perf(t->wakeup_perf);
         t->thread->start(t->name, t->policy, t->prio);
     }
 
+    if (!_uart_thread.add_timer(FUNCTOR_BIND_MEMBER(&Scheduler::_uart_task, void),
+                                nullptr, hz_to_usec(APM_LINUX_UART_RATE))) {
+        AP_HAL::panic("Scheduler: failed to create UART timer");
+    }
+    _uart_thread.set_stack_size(1024 * 1024);
+    _uart_thread.set_cpu_affinity(_cpus[CPUS_UART]);
+    _uart_thread.start("ap-uart", SCHED_FIFO, APM_LINUX_UART_PRIORITY);
+
 #if defined(DEBUG_STACK) && DEBUG_STACK
     register_timer_process(FUNCTOR_BIND_MEMBER(&Scheduler::_debug_stack, void));
 #endif
@@ -170,7 +350,17 @@ void Scheduler::delay_microseconds(uint16_t us)
     if (_stopped_clock_usec) {
         return;
     }
+    if (!in_main_thread()) {
+        microsleep(us);
+        return;
+    }
+
+    // the main loop waits here for its next sample, so time how late it wakes
+    const uint64_t wake_usec = AP_HAL::micros64() + us;
     microsleep(us);
+    const uint64_t now = AP_HAL::micros64();
+    const uint64_t late_usec = now > wake_usec ? now - wake_usec : 0;
+    Perf::get_singleton()->sample(_main_wakeup_perf, late_usec * 1000ULL);
 }
 
 void Scheduler::register_timer_process(AP_HAL::MemberProc proc)
@@ -328,6 +518,13 @@ bool Scheduler::SchedulerThread::_run()
     return PeriodicThread::_run();
 }
 
+bool Scheduler::SchedulerPollerThread::_run()
+{
+    _sched._wait_all_threads();
+
+    return PollerThread::_run();
+}
+
 void Scheduler::teardown()
 {
     _timer_thread.stop();
@@ -339,6 +536,15 @@ void Scheduler::teardown()
     _io_thread.join();
     _rcin_thread.join();
     _uart_thread.join();
+
+    if (_latency_report) {
+        fprintf(stderr, "Main loop and scheduler thread wake-up and UART latency (ns):\n");
+        Perf::get_singleton()->print_counters(stderr, "wakeup-");
+        Perf::get_singleton()->print_counters(stderr, "uart-");
+        fprintf(stderr, "SPI and I2C bus ioctls and busy time (ns):\n");
+        Perf::get_singleton()->print_counters(stderr, "spi-");
+        Perf::get_singleton()->print_counters(stderr, "i2c-");
+    }
 }
 
 /*
@@ -1,8 +1,10 @@
 #pragma once
 
 #include <pthread.h>
+#include <sched.h>
 
 #include "AP_HAL_Linux.h"
+#include "PollerThread.h"
 #include "Semaphores.h"
 #include "Thread.h"
 
@@ -51,7 +53,31 @@ public:
       create a new thread
      */
     bool thread_create(AP_HAL::MemberProc, const char *name, uint32_t stack_size, priority_base base, int8_t priority) override;
-    
+
+    /*
+      set the CPUs of the scheduler threads from a map like
+      "main=2,timer=3,uart=1,rcin=1,io=0,other=0+1", where CPU lists are
+      separated by '+' and may hold ranges like "0-1". "auto" places the
+      main and timer threads on the CPUs isolated with isolcpus= and the
+      rest on the other CPUs
+     */
+    bool set_cpu_affinity_map(const char *map);
+
+    // CPUs for threads without an affinity of their own, false if unset
+    bool get_other_cpus(cpu_set_t &cpus) const;
+
+    /*
+      parse a list of CPUs like "0-2+4", or "0-2,4" as the kernel prints
+      it in /sys, false if it is malformed or names a CPU past CPU_SETSIZE
+     */
+    static bool parse_cpu_list(const char *s, size_t len, cpu_set_t &cpus);
+
+    // print the wake-up latency of the main loop and scheduler threads on teardown
+    void set_latency_report(bool enable) { _latency_report = enable; }
+
+    // the thread servicing the UARTs, which they register their devices with
+    PollerThread &get_uart_thread() { return _uart_thread; }
+
 private:
     class SchedulerThread : public PeriodicThread {
     public:
@@ -66,7 +92,24 @@ private:
         Scheduler &_sched;
     };
 
+    /*
+      the UARTs are serviced when their devices are ready, plus at
+      APM_LINUX_UART_RATE for the ones that can't be waited on
+     */
+    class SchedulerPollerThread : public PollerThread {
+    public:
+        SchedulerPollerThread(Scheduler &sched)
+            : _sched(sched)
+        { }
+
+    protected:
+        bool _run() override;
+
+        Scheduler &_sched;
+    };
+
     void     init_realtime();
+    void     init_cpus();
 
     void _wait_all_threads();
 
@@ -87,7 +130,7 @@ private:
     SchedulerThread _timer_thread{FUNCTOR_BIND_MEMBER(&Scheduler::_timer_task, void), *this};
     SchedulerThread _io_thread{FUNCTOR_BIND_MEMBER(&Scheduler::_io_task, void), *this};
     SchedulerThread _rcin_thread{FUNCTOR_BIND_MEMBER(&Scheduler::_rcin_task, void), *this};
-    SchedulerThread _uart_thread{FUNCTOR_BIND_MEMBER(&Scheduler::_uart_task, void), *this};
+    SchedulerPollerThread _uart_thread{*this};
 
     void _timer_task();
     void _io_task();
@@ -102,6 +145,22 @@ private:
     pthread_t _main_ctx;
 
     Semaphore _io_semaphore;
+
+    enum thread_cpus {
+        CPUS_MAIN,
+        CPUS_TIMER,
+        CPUS_UART,
+        CPUS_RCIN,
+        CPUS_IO,
+        CPUS_OTHER,
+        CPUS_COUNT
+    };
+    cpu_set_t _cpus[CPUS_COUNT];
+
+    // how late the main thread wakes from delay_microseconds()
+    AP_HAL::Util::perf_counter_t _main_wakeup_perf;
+    bool _auto_cpus;
+    bool _latency_report;
 };
 
 }
@@ -2,6 +2,7 @@
 
 #include <stdint.h>
 #include <stdlib.h>
+#include <sys/uio.h>
 
 #include "AP_HAL_Linux.h"
 
@@ -23,4 +24,47 @@ public:
 
     /* Depends on lower level to implement, most devices are fine with defaults */
     virtual void set_parity(int v) { }
+
+    /*
+     * File descriptor that becomes readable when there is input, so the
+     * device can be waited on rather than polled. -1 if there is none.
+     */
+    virtual int get_fd() const { return -1; }
+
+    /*
+     * Read into several buffers, with a single system call where the
+     * device allows it. Stops at the first buffer that isn't filled.
+     */
+    virtual ssize_t readv(const struct iovec *iov, int iovcnt)
+    {
+        ssize_t total = 0;
+        for (int i = 0; i < iovcnt; i++) {
+            const ssize_t ret = read((uint8_t *)iov[i].iov_base, iov[i].iov_len);
+            if (ret < 0) {
+                return total > 0 ? total : ret;
+            }
+            total += ret;
+            if ((size_t)ret < iov[i].iov_len) {
+                break;
+            }
+        }
+        return total;
+    }
+
+    /*
+     * Write several packets, each one a datagram on packet based
+     * devices. Returns the number of packets completely written or -1
+     * if none could be.
+     */
+    virtual int write_packets(const struct iovec *packets, unsigned count)
+    {
+        unsigned i;
+        for (i = 0; i < count; i++) {
+            const ssize_t ret = write((const uint8_t *)packets[i].iov_base, packets[i].iov_len);
+            if (ret < (ssize_t)packets[i].iov_len) {
+                break;
+            }
+        }
+        return i > 0 ? (int)i : -1;
+    }
 };
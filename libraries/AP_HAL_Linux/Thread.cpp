@@ -27,6 +27,7 @@
 #include <AP_Math/AP_Math.h>
 
 #include "Scheduler.h"
+#include "Util.h"
 
 #define STACK_POISON 0xBEBACAFE
 
@@ -200,6 +201,23 @@ bool Thread::start(const char *name, int policy, int prio)
         pthread_setname_np(_ctx, name);
     }
 
+    /*
+      a thread inherits the affinity of the thread creating it, which is
+      the main thread's CPU once it is pinned: ask the scheduler where
+      threads without an affinity of their own should go
+     */
+    cpu_set_t cpus;
+    if (_has_cpus) {
+        cpus = _cpus;
+    } else if (!Scheduler::from(hal.scheduler)->get_other_cpus(cpus)) {
+        CPU_ZERO(&cpus);
+    }
+    if (CPU_COUNT(&cpus) > 0 &&
+        (r = pthread_setaffinity_np(_ctx, sizeof(cpus), &cpus)) != 0) {
+        fprintf(stderr, "WARNING: failed to set CPU affinity of thread '%s': %s\n",
+                name ? name : "", strerror(r));
+    }
+
     _started = true;
 
     return true;
@@ -227,6 +245,18 @@ bool Thread::join()
 }
 
 
+bool Thread::set_cpu_affinity(const cpu_set_t &cpus)
+{
+    if (_started) {
+        return false;
+    }
+
+    _cpus = cpus;
+    _has_cpus = CPU_COUNT(&cpus) > 0;
+
+    return true;
+}
+
 bool PeriodicThread::set_rate(uint32_t rate_hz)
 {
     if (_started || rate_hz == 0) {
@@ -238,6 +268,18 @@ bool PeriodicThread::set_rate(uint32_t rate_hz)
     return true;
 }
 
+bool PeriodicThread::set_wakeup_perf(const char *name)
+{
+    if (_started) {
+        return false;
+    }
+
+    _wakeup_perf = Perf::get_singleton()->add(AP_HAL::Util::PC_ELAPSED, name);
+    _has_wakeup_perf = true;
+
+    return true;
+}
+
 bool Thread::set_stack_size(size_t stack_size)
 {
     if (_started) {
@@ -259,11 +301,18 @@ bool PeriodicThread::_run()
 
     while (!_should_exit) {
         uint64_t dt = next_run_usec - AP_HAL::micros64();
+        if (dt <= _period_usec) {
+            Scheduler::from(hal.scheduler)->microsleep(dt);
+        }
+        const uint64_t now = AP_HAL::micros64();
+        if (_has_wakeup_perf) {
+            // a thread running so late that it lost sync is sampled too
+            const uint64_t late_usec = now > next_run_usec ? now - next_run_usec : 0;
+            Perf::get_singleton()->sample(_wakeup_perf, late_usec * 1000ULL);
+        }
         if (dt > _period_usec) {
             // we've lost sync - restart
-            next_run_usec = AP_HAL::micros64();
-        } else {
-            Scheduler::from(hal.scheduler)->microsleep(dt);
+            next_run_usec = now;
         }
         next_run_usec += _period_usec;
 
@@ -18,6 +18,7 @@
 
 #include <pthread.h>
 #include <inttypes.h>
+#include <sched.h>
 #include <stdlib.h>
 
 #include <AP_HAL/utility/functor.h>
@@ -47,6 +48,12 @@ public:
 
     void set_auto_free(bool auto_free) { _auto_free = auto_free; }
 
+    /*
+     * Restrict the thread to the CPUs in @cpus. Threads without an affinity
+     * of their own run on the CPUs the scheduler leaves for other threads.
+     */
+    bool set_cpu_affinity(const cpu_set_t &cpus);
+
     virtual bool stop() { return false; }
 
     bool join();
@@ -75,6 +82,9 @@ protected:
     } _stack_debug;
 
     size_t _stack_size = 0;
+
+    cpu_set_t _cpus;
+    bool _has_cpus = false;
 };
 
 class PeriodicThread : public Thread {
@@ -85,12 +95,22 @@ public:
 
     bool set_rate(uint32_t rate_hz);
 
+    /*
+     * Record how late the thread wakes up for each period in the PC_ELAPSED
+     * perf counter @name. Must be called before start().
+     */
+    bool set_wakeup_perf(const char *name);
+
     bool stop() override;
 
 protected:
     bool _run() override;
 
     uint64_t _period_usec = 0;
+
+    // AP_HAL::Util::perf_counter_t, which Util.h can't be included for here
+    void *_wakeup_perf;
+    bool _has_wakeup_perf = false;
 };
 
 }
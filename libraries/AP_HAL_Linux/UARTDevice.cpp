@@ -51,6 +51,11 @@ ssize_t UARTDevice::read(uint8_t *buf, uint16_t n)
     return ::read(_fd, buf, n);
 }
 
+ssize_t UARTDevice::readv(const struct iovec *iov, int iovcnt)
+{
+    return ::readv(_fd, iov, iovcnt);
+}
+
 ssize_t UARTDevice::write(const uint8_t *buf, uint16_t n)
 {
     struct pollfd fds;
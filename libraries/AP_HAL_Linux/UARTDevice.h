@@ -20,6 +20,8 @@ public:
         return _flow_control;
     }
     virtual void set_parity(int v) override;
+    virtual int get_fd() const override { return _fd; }
+    virtual ssize_t readv(const struct iovec *iov, int iovcnt) override;
 
 private:
     void _disable_crlf();
@@ -10,6 +10,8 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
 #include <sys/ioctl.h>
 #include <sys/socket.h>
 #include <sys/stat.h>
@@ -20,9 +22,11 @@
 #include <AP_HAL/AP_HAL.h>
 
 #include "ConsoleDevice.h"
+#include "Scheduler.h"
 #include "TCPServerDevice.h"
 #include "UARTDevice.h"
 #include "UDPDevice.h"
+#include "Util.h"
 
 #include <GCS_MAVLink/GCS.h>
 #include <AP_HAL/utility/packetise.h>
@@ -31,6 +35,23 @@ extern const AP_HAL::HAL& hal;
 
 using namespace Linux;
 
+// MAVLink packets sent together on packetised connections
+#define UART_MAX_PACKETS        8
+#define UART_MAX_PACKET_BYTES   2048U
+
+/*
+  time from input arriving to the vehicle reading it and from output
+  being written to the device taking all of it, for all the UARTs
+ */
+static AP_HAL::Util::perf_counter_t rx_latency_perf;
+static AP_HAL::Util::perf_counter_t tx_latency_perf;
+static bool latency_perf_allocated;
+
+static void sample_latency(AP_HAL::Util::perf_counter_t perf, uint32_t start_us)
+{
+    Perf::get_singleton()->sample(perf, (AP_HAL::micros() - start_us) * 1000ULL);
+}
+
 UARTDriver::UARTDriver(bool default_console) :
     device_path(nullptr),
     _packetise(false),
@@ -59,6 +80,12 @@ void UARTDriver::begin(uint32_t b)
 
 void UARTDriver::begin(uint32_t b, uint16_t rxS, uint16_t txS)
 {
+    if (!latency_perf_allocated) {
+        rx_latency_perf = Perf::get_singleton()->add(AP_HAL::Util::PC_ELAPSED, "uart-rx-latency");
+        tx_latency_perf = Perf::get_singleton()->add(AP_HAL::Util::PC_ELAPSED, "uart-tx-latency");
+        latency_perf_allocated = true;
+    }
+
     if (!_initialised) {
         if (device_path == nullptr && _console) {
             _device = new ConsoleDevice();
@@ -218,6 +245,7 @@ void UARTDriver::end()
         hal.scheduler->delay(1);
     }
 
+    _poll_unregister(0);
     _device->close();
     _deallocate_buffers();
 }
@@ -287,10 +315,25 @@ int16_t UARTDriver::read()
     if (!_readbuf.read_byte(&byte)) {
         return -1;
     }
+    _rx_consumed();
 
     return byte;
 }
 
+uint32_t UARTDriver::read_bytes(uint8_t *buffer, uint32_t count)
+{
+    if (!_initialised) {
+        return 0;
+    }
+
+    const uint32_t ret = _readbuf.read(buffer, count);
+    if (ret > 0) {
+        _rx_consumed();
+    }
+
+    return ret;
+}
+
 /* Linux implementations of Print virtual methods */
 size_t UARTDriver::write(uint8_t c)
 {
@@ -308,8 +351,12 @@ size_t UARTDriver::write(uint8_t c)
         }
         hal.scheduler->delay(1);
     }
+    if (_tx_start_us == 0) {
+        _tx_start_us = AP_HAL::micros() | 1;
+    }
     size_t ret = _writebuf.write(&c, 1);
     _write_mutex.give();
+    _kick();
     return ret;
 }
 
@@ -337,8 +384,12 @@ size_t UARTDriver::write(const uint8_t *buffer, size_t size)
         return ret;
     }
 
+    if (_tx_start_us == 0) {
+        _tx_start_us = AP_HAL::micros() | 1;
+    }
     size_t ret = _writebuf.write(buffer, size);
     _write_mutex.give();
+    _kick();
     return ret;
 }
 
@@ -376,39 +427,29 @@ int UARTDriver::_read_fd(uint8_t *buf, uint16_t n)
  */
 bool UARTDriver::_write_pending_bytes(void)
 {
+    if (_packetise) {
+        return _write_pending_packets();
+    }
+
     // write any pending bytes
     uint32_t available_bytes = _writebuf.available();
     uint16_t n = available_bytes;
 
-    if (_packetise && n > 0) {
-        // send on MAVLink packet boundaries if possible
-        n = mavlink_packetise(_writebuf, n);
-    }
-
     if (n > 0) {
         int ret;
 
-        if (_packetise) {
-            // keep as a single UDP packet
-            uint8_t tmpbuf[n];
-            _writebuf.peekbytes(tmpbuf, n);
-            ret = _write_fd(tmpbuf, n);
-            if (ret > 0)
-                _writebuf.advance(ret);
-        } else {
-            ByteBuffer::IoVec vec[2];
-            const auto n_vec = _writebuf.peekiovec(vec, n);
-            for (int i = 0; i < n_vec; i++) {
-                ret = _write_fd(vec[i].data, (uint16_t)vec[i].len);
-                if (ret < 0) {
-                    break;
-                }
-                _writebuf.advance(ret);
-
-                /* We wrote less than we asked for, stop */
-                if ((unsigned)ret != vec[i].len) {
-                    break;
-                }
+        ByteBuffer::IoVec vec[2];
+        const auto n_vec = _writebuf.peekiovec(vec, n);
+        for (int i = 0; i < n_vec; i++) {
+            ret = _write_fd(vec[i].data, (uint16_t)vec[i].len);
+            if (ret < 0) {
+                break;
+            }
+            _writebuf.advance(ret);
+
+            /* We wrote less than we asked for, stop */
+            if ((unsigned)ret != vec[i].len) {
+                break;
             }
         }
     }
@@ -417,22 +458,258 @@ bool UARTDriver::_write_pending_bytes(void)
 }
 
 /*
-  push any pending bytes to/from the serial port. This is called at
-  1kHz in the timer thread. Doing it this way reduces the system call
-  overhead in the main task enormously.
+  send the whole MAVLink packets at the start of the write buffer, each
+  one as a datagram, with a single call to the device
+  return true if progress is made
  */
-void UARTDriver::_timer_tick(void)
+bool UARTDriver::_write_pending_packets(void)
 {
-    if (!_initialised) return;
+    const uint16_t n = MIN(_writebuf.available(), UART_MAX_PACKET_BYTES);
+    if (n == 0) {
+        return false;
+    }
+
+    // allow for delayed connection, as in _write_fd()
+    if (!_connected) {
+        _connected = _device->open();
+    }
+    if (!_connected) {
+        return false;
+    }
+
+    uint8_t tmpbuf[n];
+    _writebuf.peekbytes(tmpbuf, n);
+
+    struct iovec packets[UART_MAX_PACKETS];
+    unsigned count = 0;
+    uint16_t ofs = 0;
+    while (count < UART_MAX_PACKETS && ofs < n) {
+        // send on MAVLink packet boundaries if possible
+        const uint16_t len = mavlink_packetise(&tmpbuf[ofs], n - ofs);
+        if (len == 0) {
+            break;
+        }
+        packets[count].iov_base = &tmpbuf[ofs];
+        packets[count].iov_len = len;
+        count++;
+        ofs += len;
+    }
+    if (count == 0) {
+        return false;
+    }
+
+    const int sent = _device->write_packets(packets, count);
+    for (int i = 0; i < sent; i++) {
+        _writebuf.advance(packets[i].iov_len);
+    }
+
+    return sent > 0;
+}
+
+int UARTDriver::_poll_fd()
+{
+    return _device->get_fd();
+}
+
+bool UARTDriver::KickPollable::open()
+{
+    _fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    return _fd >= 0;
+}
+
+void UARTDriver::KickPollable::close()
+{
+    ::close(_fd);
+    _fd = -1;
+}
+
+void UARTDriver::KickPollable::on_can_read()
+{
+    uint64_t val;
+    while (::read(_fd, &val, sizeof(val)) == -1 && errno == EINTR) {
+    }
+
+    _uart._poll_write();
+}
+
+/*
+  wait on the device from the UART thread if it has a file descriptor,
+  following it as it changes, e.g. when a TCP client connects
+ */
+void UARTDriver::_poll_register()
+{
+    const int fd = _poll_fd();
+    if (_polled) {
+        if (fd == _device_pollable.get_fd()) {
+            return;
+        }
+        _poll_unregister(0);
+    }
+
+    // wait for room for input before waiting for input
+    if (fd < 0 || _readbuf.space() == 0 ||
+        (int32_t)(AP_HAL::millis() - _poll_retry_ms) < 0) {
+        return;
+    }
+
+    PollerThread &thread = Scheduler::from(hal.scheduler)->get_uart_thread();
+
+    if (_kick_pollable.get_fd() < 0 && _kick_pollable.open() &&
+        !thread.register_pollable(&_kick_pollable, EPOLLIN)) {
+        _kick_pollable.close();
+    }
+
+    _device_pollable.set_fd(fd);
+    if (!thread.register_pollable(&_device_pollable, EPOLLIN)) {
+        // e.g. a regular file can't be waited on
+        _device_pollable.set_fd(-1);
+        _poll_retry_ms = AP_HAL::millis() + 1000;
+        return;
+    }
+    _polled = true;
+}
+
+/*
+  go back to polling the device at the UART thread's rate, for at least
+  retry_ms
+ */
+void UARTDriver::_poll_unregister(uint32_t retry_ms)
+{
+    if (!_polled) {
+        return;
+    }
+
+    Scheduler::from(hal.scheduler)->get_uart_thread().unregister_pollable(&_device_pollable);
+    _device_pollable.set_fd(-1);
+    _polled = false;
+    _poll_retry_ms = AP_HAL::millis() + retry_ms;
+}
+
+/*
+  read all the input there is into the read buffer with a single call
+ */
+void UARTDriver::_poll_read()
+{
+    if (!_initialised) {
+        return;
+    }
+
+    _in_timer = true;
+
+    ByteBuffer::IoVec vec[2];
+    struct iovec iov[2];
+    const bool was_empty = _readbuf.available() == 0;
+    const auto n_vec = _readbuf.reserve(vec, _readbuf.space());
+    if (n_vec == 0) {
+        // nobody reads this UART, poll it until there is room again
+        _poll_unregister(0);
+        _in_timer = false;
+        return;
+    }
+    for (int i = 0; i < n_vec; i++) {
+        iov[i].iov_base = vec[i].data;
+        iov[i].iov_len = vec[i].len;
+    }
+
+    const ssize_t ret = _device->readv(iov, n_vec);
+    if (ret > 0) {
+        _readbuf.commit((unsigned)ret);
+
+        // update receive timestamp
+        _receive_timestamp[_receive_timestamp_idx^1] = AP_HAL::micros64();
+        _receive_timestamp_idx ^= 1;
+
+        if (was_empty && _rx_start_us == 0) {
+            _rx_start_us = AP_HAL::micros() | 1;
+        }
+    } else if (_poll_fd() != _device_pollable.get_fd()) {
+        // e.g. a TCP client connected or went away
+        _poll_unregister(0);
+        _poll_register();
+    } else if (ret == 0 || (errno != EAGAIN && errno != EINTR)) {
+        // end of file or an error: don't spin on a descriptor that
+        // stays readable
+        _poll_unregister(1000);
+    }
+
+    _in_timer = false;
+}
+
+/*
+  send new output when a writer kicks the UART thread
+ */
+void UARTDriver::_poll_write()
+{
+    if (!_initialised) {
+        return;
+    }
 
     _in_timer = true;
+    _kick_pending = false;
+    _send_pending();
+    _in_timer = false;
+}
 
+/*
+  wake the UART thread to send output, once until it has sent it
+ */
+void UARTDriver::_kick()
+{
+    const int fd = _kick_pollable.get_fd();
+    if (fd < 0 || _kick_pending.exchange(true)) {
+        return;
+    }
+
+    const uint64_t val = 1;
+    if (::write(fd, &val, sizeof(val)) != sizeof(val)) {
+        _kick_pending = false;
+    }
+}
+
+void UARTDriver::_send_pending()
+{
     uint8_t num_send = 10;
     while (num_send != 0 && _write_pending_bytes()) {
         num_send--;
     }
 
+    if (_tx_start_us != 0 && _writebuf.available() == 0) {
+        sample_latency(tx_latency_perf, _tx_start_us);
+        _tx_start_us = 0;
+    }
+}
+
+void UARTDriver::_rx_consumed()
+{
+    if (_rx_start_us != 0) {
+        sample_latency(rx_latency_perf, _rx_start_us);
+        _rx_start_us = 0;
+    }
+}
+
+/*
+  push any pending bytes to/from the serial port. This is called at
+  APM_LINUX_UART_RATE in the UART thread. Doing it this way reduces the
+  system call overhead in the main task enormously. Devices that can be
+  waited on are read when they have input instead.
+ */
+void UARTDriver::_timer_tick(void)
+{
+    if (!_initialised) return;
+
+    _in_timer = true;
+
+    _poll_register();
+
+    _send_pending();
+
+    if (_polled) {
+        _in_timer = false;
+        return;
+    }
+
     // try to fill the read buffer
+    const bool was_empty = _readbuf.available() == 0;
     int ret;
     ByteBuffer::IoVec vec[2];
 
@@ -447,7 +724,11 @@ void UARTDriver::_timer_tick(void)
         // update receive timestamp
         _receive_timestamp[_receive_timestamp_idx^1] = AP_HAL::micros64();
         _receive_timestamp_idx ^= 1;
-        
+
+        if (was_empty && ret > 0 && _rx_start_us == 0) {
+            _rx_start_us = AP_HAL::micros() | 1;
+        }
+
         /* stop reading as we read less than we asked for */
         if ((unsigned)ret < vec[i].len) {
             break;
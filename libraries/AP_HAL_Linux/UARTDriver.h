@@ -1,9 +1,12 @@
 #pragma once
 
+#include <atomic>
+
 #include <AP_HAL/utility/OwnPtr.h>
 #include <AP_HAL/utility/RingBuffer.h>
 
 #include "AP_HAL_Linux.h"
+#include "Poller.h"
 #include "SerialDevice.h"
 #include "Semaphores.h"
 
@@ -30,6 +33,7 @@ public:
     uint32_t available() override;
     uint32_t txspace() override;
     int16_t read() override;
+    uint32_t read_bytes(uint8_t *buffer, uint32_t count) override;
 
     /* Linux implementations of Print virtual methods */
     size_t write(uint8_t c) override;
@@ -68,6 +72,64 @@ public:
     uint64_t receive_time_constraint_us(uint16_t nbytes) override;
 
 private:
+    /*
+      the device's file descriptor, waited on by the UART thread so input
+      is read as soon as it arrives rather than at the thread's next period
+     */
+    class DevicePollable : public Pollable {
+    public:
+        DevicePollable(UARTDriver &uart) : _uart(uart) { }
+        // the device owns the file descriptor
+        ~DevicePollable() { _fd = -1; }
+
+        void set_fd(int fd) { _fd = fd; }
+
+        void on_can_read() override { _uart._poll_read(); }
+        void on_error() override { _uart._poll_unregister(1000); }
+        void on_hang_up() override { _uart._poll_unregister(1000); }
+
+    private:
+        UARTDriver &_uart;
+    };
+
+    /*
+      an eventfd signalled by writers so the UART thread sends new output
+      without waiting for its next period
+     */
+    class KickPollable : public Pollable {
+    public:
+        KickPollable(UARTDriver &uart) : _uart(uart) { }
+
+        bool open();
+        void close();
+        void on_can_read() override;
+
+    private:
+        UARTDriver &_uart;
+    };
+
+    DevicePollable _device_pollable{*this};
+    KickPollable _kick_pollable{*this};
+    // true while the device is waited on
+    bool _polled;
+    // when to wait on the device again after a hang up or failure
+    uint32_t _poll_retry_ms;
+    std::atomic<bool> _kick_pending;
+
+    // when input was first left unread and output first left unsent, zero if none
+    uint32_t _rx_start_us;
+    uint32_t _tx_start_us;
+
+    void _poll_register();
+    void _poll_unregister(uint32_t retry_ms);
+    void _poll_read();
+    void _poll_write();
+    void _kick();
+    void _send_pending();
+    void _rx_consumed();
+
+    bool _write_pending_packets(void);
+
     AP_HAL::OwnPtr<SerialDevice> _device;
     bool _nonblocking_writes;
     bool _console;
@@ -100,6 +162,12 @@ protected:
     virtual int _write_fd(const uint8_t *buf, uint16_t n);
     virtual int _read_fd(uint8_t *buf, uint16_t n);
 
+    /*
+      file descriptor the UART thread can wait on for input, -1 if the
+      driver has to be polled
+     */
+    virtual int _poll_fd();
+
     Linux::Semaphore _write_mutex;
 };
 
@@ -2,7 +2,9 @@
 
 #include <fcntl.h>
 #include <stdio.h>
+#include <string.h>
 #include <sys/ioctl.h>
+#include <sys/socket.h>
 
 #include <AP_HAL/AP_HAL.h>
 
@@ -33,6 +35,26 @@ ssize_t UDPDevice::write(const uint8_t *buf, uint16_t n)
     return socket.sendto(buf, n, _ip, _port);
 }
 
+/*
+  send a datagram for each packet with a single sendmmsg() once the
+  peer is known
+ */
+int UDPDevice::write_packets(const struct iovec *packets, unsigned count)
+{
+    if (!_connected) {
+        return SerialDevice::write_packets(packets, count);
+    }
+
+    struct mmsghdr msgs[count];
+    memset(msgs, 0, sizeof(msgs));
+    for (unsigned i = 0; i < count; i++) {
+        msgs[i].msg_hdr.msg_iov = const_cast<struct iovec *>(&packets[i]);
+        msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    return sendmmsg(socket.get_read_fd(), msgs, count, MSG_DONTWAIT);
+}
+
 ssize_t UDPDevice::read(uint8_t *buf, uint16_t n)
 {
     ssize_t ret = socket.recv(buf, n, 0);
@@ -264,11 +264,11 @@ void *Util::heap_realloc(void *h, void *ptr, size_t new_size)
 
     heapp->current_heap_usage -= old_size;
     if (new_size == 0) {
-       free(old_header);
+       _mem_pool.release(old_header, old_size + sizeof(heap_allocation_header), MEM_TAG_SCRIPTING);
        return nullptr;
     }
 
-    heap_allocation_header *new_header = (heap_allocation_header *)malloc(new_size + sizeof(heap_allocation_header));
+    heap_allocation_header *new_header = (heap_allocation_header *)_mem_pool.allocate(new_size + sizeof(heap_allocation_header), MEM_TAG_SCRIPTING);
     if (new_header == nullptr) {
         // total failure to allocate, this is very surprising in SITL
         return nullptr;
@@ -281,7 +281,7 @@ void *Util::heap_realloc(void *h, void *ptr, size_t new_size)
         return new_mem;
     }
     memcpy(new_mem, ptr, old_size > new_size ? new_size : old_size);
-    free(old_header);
+    _mem_pool.release(old_header, old_size + sizeof(heap_allocation_header), MEM_TAG_SCRIPTING);
     return new_mem;
 }
 
@@ -2,6 +2,7 @@
 
 #include <AP_Common/AP_Common.h>
 #include <AP_HAL/AP_HAL.h>
+#include <AP_HAL/utility/MemoryPool.h>
 
 #include "Heat.h"
 #include "Perf.h"
@@ -59,6 +60,17 @@ public:
     bool get_system_id(char buf[40]) override;
     bool get_system_id_unformatted(uint8_t buf[], uint8_t &len) override;
 
+    // allocations are served from a size-class pool and accounted per tag
+    void *malloc_type(size_t size, Memory_Type mem_type, Memory_Tag tag) override {
+        return _mem_pool.allocate(size, tag);
+    }
+    void free_type(void *ptr, size_t size, Memory_Type mem_type, Memory_Tag tag) override {
+        _mem_pool.release(ptr, size, tag);
+    }
+    bool memory_stats(Memory_Tag tag, Memory_Stats &stats) override {
+        return _mem_pool.get_stats(tag, stats);
+    }
+
 #ifdef ENABLE_HEAP
     // heap functions, note that a heap once alloc'd cannot be dealloc'd
     virtual void *allocate_heap_memory(size_t size) override;
@@ -119,6 +131,7 @@ private:
     const char *custom_terrain_directory = nullptr;
     const char *custom_storage_directory = nullptr;
     static const char *_hw_names[UTIL_NUM_HARDWARES];
+    MemoryPool _mem_pool;
 
 #ifdef ENABLE_HEAP
     struct heap_allocation_header {
@@ -0,0 +1,107 @@
+#include <AP_gbenchmark.h>
+
+#include <poll.h>
+#include <sys/epoll.h>
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_HAL/utility/Socket.h>
+#include <AP_HAL_Linux/PollerThread.h>
+#include <AP_HAL_Linux/UDPDevice.h>
+#include <AP_Math/AP_Math.h>
+
+/*
+  round trip of a MAVLink sized datagram over loopback through a
+  UDPDevice that echoes what it reads, as the UART thread services it:
+  on a tick at the rate UARTs used to be polled at, or as soon as its
+  descriptor is readable. This is the share of the round trip taken by
+  the HAL, without the vehicle's main loop
+ */
+
+using namespace Linux;
+
+const AP_HAL::HAL &hal = AP_HAL::get_HAL();
+
+// the rate UARTs were serviced at before they were waited on
+#define UART_POLL_RATE_HZ 100
+
+#define ECHO_PORT 14570
+
+class UDPEcho : public Pollable {
+public:
+    UDPEcho(uint16_t port) : _device("127.0.0.1", port, false, true)
+    {
+        _device.open();
+        _device.set_blocking(false);
+        _fd = _device.get_fd();
+    }
+
+    ~UDPEcho() { _fd = -1; }
+
+    void on_can_read() override { echo(); }
+
+    // send back each datagram read
+    void echo()
+    {
+        uint8_t buf[300];
+        ssize_t n;
+        while ((n = _device.read(buf, sizeof(buf))) > 0) {
+            struct iovec packet { buf, size_t(n) };
+            _device.write_packets(&packet, 1);
+        }
+    }
+
+private:
+    UDPDevice _device;
+};
+
+static void round_trips(benchmark::State& state, PollerThread &thread, uint16_t port)
+{
+    SocketAPM client(true);
+    if (!client.connect("127.0.0.1", port)) {
+        state.SetLabel("connect failed");
+        while (state.KeepRunning()) {
+        }
+        return;
+    }
+
+    uint8_t packet[40] {};
+    uint8_t reply[sizeof(packet)];
+    uint32_t lost = 0;
+    while (state.KeepRunning()) {
+        client.send(packet, sizeof(packet));
+        if (client.recv(reply, sizeof(reply), 100) != sizeof(packet)) {
+            lost++;
+        }
+    }
+
+    thread.stop();
+    thread.join();
+
+    if (lost != 0) {
+        state.SetLabel("lost " + std::to_string(lost));
+    }
+}
+
+static void BM_UDPRoundTripPolled(benchmark::State& state)
+{
+    PollerThread thread;
+    UDPEcho echo(ECHO_PORT);
+    thread.add_timer(FUNCTOR_BIND(&echo, &UDPEcho::echo, void), nullptr, hz_to_usec(UART_POLL_RATE_HZ));
+    thread.start("bench-uart", SCHED_OTHER, 0);
+    round_trips(state, thread, ECHO_PORT);
+}
+
+static void BM_UDPRoundTripEpoll(benchmark::State& state)
+{
+    PollerThread thread;
+    UDPEcho echo(ECHO_PORT + 1);
+    thread.register_pollable(&echo, EPOLLIN);
+    thread.start("bench-uart", SCHED_OTHER, 0);
+    round_trips(state, thread, ECHO_PORT + 1);
+    thread.unregister_pollable(&echo);
+}
+
+BENCHMARK(BM_UDPRoundTripPolled);
+BENCHMARK(BM_UDPRoundTripEpoll);
+
+BENCHMARK_MAIN()
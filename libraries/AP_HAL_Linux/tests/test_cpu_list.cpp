@@ -0,0 +1,94 @@
+#include <AP_gtest.h>
+
+#include <string.h>
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_HAL_Linux/Scheduler.h>
+
+using namespace Linux;
+
+const AP_HAL::HAL &hal = AP_HAL::get_HAL();
+
+static bool parse(const char *s, cpu_set_t &cpus)
+{
+    return Scheduler::parse_cpu_list(s, strlen(s), cpus);
+}
+
+TEST(CpuListTest, SingleCpu)
+{
+    cpu_set_t cpus;
+
+    EXPECT_TRUE(parse("3", cpus));
+    EXPECT_EQ(1, CPU_COUNT(&cpus));
+    EXPECT_TRUE(CPU_ISSET(3, &cpus));
+}
+
+TEST(CpuListTest, RangesAndLists)
+{
+    cpu_set_t cpus;
+
+    // as given in a CPU affinity map
+    EXPECT_TRUE(parse("0-2+4", cpus));
+    EXPECT_EQ(4, CPU_COUNT(&cpus));
+    for (int cpu : { 0, 1, 2, 4 }) {
+        EXPECT_TRUE(CPU_ISSET(cpu, &cpus)) << cpu;
+    }
+
+    // as the kernel prints it in /sys/devices/system/cpu/isolated
+    EXPECT_TRUE(parse("1,3-4\n", cpus));
+    EXPECT_EQ(3, CPU_COUNT(&cpus));
+    for (int cpu : { 1, 3, 4 }) {
+        EXPECT_TRUE(CPU_ISSET(cpu, &cpus)) << cpu;
+    }
+
+    EXPECT_TRUE(parse("5-5", cpus));
+    EXPECT_EQ(1, CPU_COUNT(&cpus));
+    EXPECT_TRUE(CPU_ISSET(5, &cpus));
+}
+
+TEST(CpuListTest, OnlyLenBytes)
+{
+    cpu_set_t cpus;
+
+    // the list of one entry of a map ends where the next entry starts
+    const char *map = "0+2,timer=3";
+    EXPECT_TRUE(Scheduler::parse_cpu_list(map, 3, cpus));
+    EXPECT_EQ(2, CPU_COUNT(&cpus));
+    EXPECT_TRUE(CPU_ISSET(0, &cpus));
+    EXPECT_TRUE(CPU_ISSET(2, &cpus));
+}
+
+TEST(CpuListTest, Empty)
+{
+    cpu_set_t cpus;
+
+    // an isolated file with no CPUs in it
+    EXPECT_TRUE(parse("", cpus));
+    EXPECT_EQ(0, CPU_COUNT(&cpus));
+}
+
+TEST(CpuListTest, Malformed)
+{
+    cpu_set_t cpus;
+
+    for (const char *s : { "a", "-1", "+1", " 1", "1-", "3-1", "1-+2", "1++2", "1;2", "1 2", "2x" }) {
+        EXPECT_FALSE(parse(s, cpus)) << s;
+    }
+}
+
+TEST(CpuListTest, PastSetSize)
+{
+    cpu_set_t cpus;
+    char s[32];
+
+    snprintf(s, sizeof(s), "%d", CPU_SETSIZE - 1);
+    EXPECT_TRUE(parse(s, cpus));
+    EXPECT_TRUE(CPU_ISSET(CPU_SETSIZE - 1, &cpus));
+
+    snprintf(s, sizeof(s), "%d", CPU_SETSIZE);
+    EXPECT_FALSE(parse(s, cpus));
+    snprintf(s, sizeof(s), "0-%d", CPU_SETSIZE);
+    EXPECT_FALSE(parse(s, cpus));
+}
+
+AP_GTEST_MAIN()
@@ -0,0 +1,226 @@
+#include <AP_gtest.h>
+
+#include <unistd.h>
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_HAL_Linux/PollerThread.h>
+
+using namespace Linux;
+
+const AP_HAL::HAL &hal = AP_HAL::get_HAL();
+
+namespace Linux {
+
+/*
+  looks at which timer each periodic callback of a PollerThread is on
+ */
+class PollerThread_Test {
+public:
+    PollerThread_Test(PollerThread &thread) : _thread(thread) { }
+
+    TimerPollable *timer(TimerPollable::Callback *c)
+    {
+        WITH_SEMAPHORE(_thread._timers_sem);
+        return c->_timer;
+    }
+
+    size_t num_callbacks(TimerPollable *t)
+    {
+        WITH_SEMAPHORE(_thread._timers_sem);
+        return t->_callbacks.size();
+    }
+
+    uint32_t period(TimerPollable *t) const { return t->_period_usec; }
+    bool removed(TimerPollable *t) const { return t->_removeme; }
+
+    // timers, including those about to be removed
+    size_t num_timers()
+    {
+        WITH_SEMAPHORE(_thread._timers_sem);
+        return _thread._timers.size();
+    }
+
+    void cleanup() { _thread._cleanup_timers(); }
+
+private:
+    PollerThread &_thread;
+};
+
+}
+
+class TestWrapper : public TimerPollable::WrapperCb {
+public:
+    void start_cb() override { n_start++; }
+    void end_cb() override { n_end++; }
+
+    bool inside() const { return n_start == n_end + 1; }
+
+    volatile int n_start = 0;
+    volatile int n_end = 0;
+};
+
+class TestCallback {
+public:
+    TestCallback(TestWrapper *wrapper) : _wrapper(wrapper) { }
+
+    TimerPollable::PeriodicCb cb() { return FUNCTOR_BIND_MEMBER(&TestCallback::_run, void); }
+
+    volatile int n_calls = 0;
+    volatile int n_outside = 0;
+
+    // change to this period on the given call
+    PollerThread *thread = nullptr;
+    TimerPollable::Callback *handle = nullptr;
+    int adjust_on_call = 0;
+    uint32_t adjust_period = 0;
+
+private:
+    void _run()
+    {
+        if (_wrapper && !_wrapper->inside()) {
+            n_outside++;
+        }
+        if (++n_calls == adjust_on_call) {
+            thread->adjust_timer(handle, adjust_period);
+        }
+    }
+
+    TestWrapper *_wrapper;
+};
+
+// wait for the timer to expire and run its callbacks in this thread
+static void fire(TimerPollable *t)
+{
+    usleep(3000);
+    t->on_can_read();
+}
+
+TEST(LinuxPollerThread, shared_timers)
+{
+    PollerThread thread;
+    PollerThread_Test test(thread);
+    TestWrapper w1, w2;
+    TestCallback a(&w1), b(&w1), c(&w1), d(&w2);
+
+    TimerPollable::Callback *ha = thread.add_timer(a.cb(), &w1, 1000);
+    TimerPollable::Callback *hb = thread.add_timer(b.cb(), &w1, 1000);
+    TimerPollable::Callback *hc = thread.add_timer(c.cb(), &w1, 2000);
+    TimerPollable::Callback *hd = thread.add_timer(d.cb(), &w2, 1000);
+    ASSERT_NE(nullptr, ha);
+    ASSERT_NE(nullptr, hb);
+    ASSERT_NE(nullptr, hc);
+    ASSERT_NE(nullptr, hd);
+
+    // one timer for each period and wrapper
+    EXPECT_EQ(3U, test.num_timers());
+    EXPECT_EQ(test.timer(ha), test.timer(hb));
+    EXPECT_NE(test.timer(ha), test.timer(hc));
+    EXPECT_NE(test.timer(ha), test.timer(hd));
+    EXPECT_EQ(2U, test.num_callbacks(test.timer(ha)));
+
+    // both callbacks run on one wakeup, inside a single call of the wrapper
+    fire(test.timer(ha));
+    EXPECT_EQ(1, a.n_calls);
+    EXPECT_EQ(1, b.n_calls);
+    EXPECT_EQ(0, c.n_calls);
+    EXPECT_EQ(0, d.n_calls);
+    EXPECT_EQ(1, w1.n_start);
+    EXPECT_EQ(1, w1.n_end);
+    EXPECT_EQ(0, a.n_outside + b.n_outside);
+
+    fire(test.timer(hd));
+    EXPECT_EQ(1, d.n_calls);
+    EXPECT_EQ(1, w2.n_start);
+    EXPECT_EQ(0, d.n_outside);
+}
+
+TEST(LinuxPollerThread, adjust_moves_callbacks)
+{
+    PollerThread thread;
+    PollerThread_Test test(thread);
+    TestWrapper w;
+    TestCallback a(&w), b(&w), c(&w);
+
+    TimerPollable::Callback *ha = thread.add_timer(a.cb(), &w, 1000);
+    TimerPollable::Callback *hb = thread.add_timer(b.cb(), &w, 1000);
+    TimerPollable::Callback *hc = thread.add_timer(c.cb(), &w, 2000);
+    TimerPollable *t1000 = test.timer(ha);
+    TimerPollable *t2000 = test.timer(hc);
+
+    // moved to the timer already running at the new period
+    EXPECT_TRUE(thread.adjust_timer(hb, 2000));
+    EXPECT_EQ(t2000, test.timer(hb));
+    EXPECT_EQ(1U, test.num_callbacks(t1000));
+    EXPECT_EQ(2U, test.num_callbacks(t2000));
+
+    fire(t2000);
+    EXPECT_EQ(0, a.n_calls);
+    EXPECT_EQ(1, b.n_calls);
+    EXPECT_EQ(1, c.n_calls);
+    EXPECT_EQ(1, w.n_start);
+
+    // the last callback leaving a timer removes it
+    EXPECT_TRUE(thread.adjust_timer(ha, 2000));
+    EXPECT_EQ(t2000, test.timer(ha));
+    EXPECT_TRUE(test.removed(t1000));
+    test.cleanup();
+    EXPECT_EQ(1U, test.num_timers());
+
+    // a callback leaving for a new period gets a timer of its own
+    EXPECT_TRUE(thread.adjust_timer(hc, 5000));
+    TimerPollable *t5000 = test.timer(hc);
+    EXPECT_NE(t2000, t5000);
+    EXPECT_EQ(5000U, test.period(t5000));
+    EXPECT_EQ(2U, test.num_callbacks(t2000));
+    EXPECT_EQ(2U, test.num_timers());
+
+    // and keeps that timer, restarted, when it is alone on it
+    EXPECT_TRUE(thread.adjust_timer(hc, 1000));
+    EXPECT_EQ(t5000, test.timer(hc));
+    EXPECT_EQ(1000U, test.period(t5000));
+    EXPECT_FALSE(test.removed(t5000));
+
+    // handles that aren't on any timer
+    TimerPollable::Callback unknown(a.cb());
+    EXPECT_FALSE(thread.adjust_timer(&unknown, 1000));
+}
+
+TEST(LinuxPollerThread, adjust_from_callback)
+{
+    PollerThread thread;
+    PollerThread_Test test(thread);
+    TestWrapper w;
+    TestCallback a(&w), c(&w);
+
+    TimerPollable::Callback *ha = thread.add_timer(a.cb(), &w, 1000);
+    TimerPollable::Callback *hc = thread.add_timer(c.cb(), &w, 2000);
+    TimerPollable *t2000 = test.timer(hc);
+
+    // on its 10th call the callback moves itself to the other timer,
+    // which can only happen once the wakeup is done
+    c.thread = &thread;
+    c.handle = hc;
+    c.adjust_on_call = 10;
+    c.adjust_period = 1000;
+
+    ASSERT_TRUE(thread.start(nullptr, 0, 0));
+    for (uint16_t i = 0; i < 1000 && test.timer(hc) != test.timer(ha); i++) {
+        usleep(1000);
+    }
+    EXPECT_EQ(test.timer(ha), test.timer(hc));
+    const int n_calls = c.n_calls;
+    for (uint16_t i = 0; i < 1000 && c.n_calls < n_calls + 10; i++) {
+        usleep(1000);
+    }
+
+    EXPECT_TRUE(thread.stop());
+    EXPECT_TRUE(thread.join());
+
+    EXPECT_GE(c.n_calls, 20);
+    EXPECT_EQ(0, a.n_outside + c.n_outside);
+    EXPECT_EQ(1U, test.num_timers());
+    EXPECT_NE(t2000, test.timer(hc));
+    EXPECT_EQ(2U, test.num_callbacks(test.timer(ha)));
+}
+
+AP_GTEST_MAIN()
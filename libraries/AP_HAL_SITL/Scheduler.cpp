@@ -27,13 +27,17 @@ extern const AP_HAL::HAL& hal;
 
 AP_HAL::Proc Scheduler::_failsafe = nullptr;
 
-AP_HAL::MemberProc Scheduler::_timer_proc[SITL_SCHEDULER_MAX_TIMER_PROCS] = {nullptr};
+Scheduler::proc_entry Scheduler::_timer_proc[SITL_SCHEDULER_MAX_TIMER_PROCS];
 uint8_t Scheduler::_num_timer_procs = 0;
+TimingWheel Scheduler::_timer_wheel;
 bool Scheduler::_in_timer_proc = false;
 
-AP_HAL::MemberProc Scheduler::_io_proc[SITL_SCHEDULER_MAX_TIMER_PROCS] = {nullptr};
+Scheduler::proc_entry Scheduler::_io_proc[SITL_SCHEDULER_MAX_TIMER_PROCS];
 uint8_t Scheduler::_num_io_procs = 0;
+TimingWheel Scheduler::_io_wheel;
 bool Scheduler::_in_io_proc = false;
+uint64_t Scheduler::_next_hal_io_usec = 0;
+HAL_Semaphore Scheduler::_proc_sem;
 bool Scheduler::_should_reboot = false;
 bool Scheduler::_should_exit = false;
 
@@ -109,32 +113,47 @@ void Scheduler::delay(uint16_t ms)
     } while (now - start < ms);
 }
 
-void Scheduler::register_timer_process(AP_HAL::MemberProc proc)
+/*
+  add a process to a wheel, first running at the next multiple of the
+  period so that processes with the same period run together
+ */
+void Scheduler::register_proc(TimingWheel &wheel, proc_entry *procs, uint8_t &num_procs,
+                              AP_HAL::MemberProc proc, uint32_t period_us)
 {
-    for (uint8_t i = 0; i < _num_timer_procs; i++) {
-        if (_timer_proc[i] == proc) {
+    WITH_SEMAPHORE(_proc_sem);
+
+    for (uint8_t i = 0; i < num_procs; i++) {
+        if (procs[i].proc == proc) {
             return;
         }
     }
 
-    if (_num_timer_procs < SITL_SCHEDULER_MAX_TIMER_PROCS) {
-        _timer_proc[_num_timer_procs] = proc;
-        _num_timer_procs++;
+    if (num_procs >= SITL_SCHEDULER_MAX_TIMER_PROCS) {
+        return;
     }
+    proc_entry &e = procs[num_procs++];
+    e.proc = proc;
+    const uint64_t now = MAX(AP_HAL::micros64(), wheel.now());
+    wheel.add(e, (now / period_us + 1) * period_us, period_us);
 }
 
-void Scheduler::register_io_process(AP_HAL::MemberProc proc)
+/*
+  get the next process on a wheel which is due to run at time now
+ */
+Scheduler::proc_entry *Scheduler::next_due_proc(TimingWheel &wheel, uint64_t now)
 {
-    for (uint8_t i = 0; i < _num_io_procs; i++) {
-        if (_io_proc[i] == proc) {
-            return;
-        }
-    }
+    WITH_SEMAPHORE(_proc_sem);
+    return static_cast<proc_entry *>(wheel.expire(now));
+}
 
-    if (_num_io_procs < SITL_SCHEDULER_MAX_TIMER_PROCS) {
-        _io_proc[_num_io_procs] = proc;
-        _num_io_procs++;
-    }
+void Scheduler::register_timer_process(AP_HAL::MemberProc proc)
+{
+    register_proc(_timer_wheel, _timer_proc, _num_timer_procs, proc, SITL_SCHEDULER_TIMER_PERIOD_US);
+}
+
+void Scheduler::register_io_process(AP_HAL::MemberProc proc)
+{
+    register_proc(_io_wheel, _io_proc, _num_io_procs, proc, SITL_SCHEDULER_IO_PERIOD_US);
 }
 
 void Scheduler::register_timer_failsafe(AP_HAL::Proc failsafe, uint32_t period_us)
@@ -199,11 +218,10 @@ void Scheduler::_run_timer_procs()
     }
     _in_timer_proc = true;
 
-    // now call the timer based drivers
-    for (int i = 0; i < _num_timer_procs; i++) {
-        if (_timer_proc[i]) {
-            _timer_proc[i]();
-        }
+    // now call the timer based drivers which are due
+    const uint64_t now = AP_HAL::micros64();
+    while (proc_entry *e = next_due_proc(_timer_wheel, now)) {
+        e->proc();
     }
 
     // and the failsafe, if one is setup
@@ -221,15 +239,23 @@ void Scheduler::_run_io_procs()
     }
     _in_io_proc = true;
 
-    // now call the IO based drivers
-    for (int i = 0; i < _num_io_procs; i++) {
-        if (_io_proc[i]) {
-            _io_proc[i]();
-        }
+    // now call the IO based drivers which are due
+    const uint64_t now = AP_HAL::micros64();
+    while (proc_entry *e = next_due_proc(_io_wheel, now)) {
+        e->proc();
     }
 
     _in_io_proc = false;
 
+    // the HAL's own polling runs at the IO process rate too
+    if (now < _next_hal_io_usec) {
+        return;
+    }
+    _next_hal_io_usec += SITL_SCHEDULER_IO_PERIOD_US;
+    if (_next_hal_io_usec <= now) {
+        _next_hal_io_usec = now + SITL_SCHEDULER_IO_PERIOD_US;
+    }
+
     hal.uartA->_timer_tick();
     hal.uartB->_timer_tick();
     hal.uartC->_timer_tick();
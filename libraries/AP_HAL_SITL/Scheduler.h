@@ -3,11 +3,26 @@
 #include <AP_HAL/AP_HAL.h>
 #if CONFIG_HAL_BOARD == HAL_BOARD_SITL
 #include "AP_HAL_SITL_Namespace.h"
+#include <AP_HAL/utility/TimingWheel.h>
 #include <sys/time.h>
 #include <pthread.h>
 
 #define SITL_SCHEDULER_MAX_TIMER_PROCS 8
 
+/*
+  simulated time between runs of the timer and IO processes. The
+  timer rate is twice the fastest simulated sensor rate so a sensor
+  driven from a timer process never skips a sample, whatever the FDM
+  rate
+ */
+#ifndef SITL_SCHEDULER_TIMER_PERIOD_US
+#define SITL_SCHEDULER_TIMER_PERIOD_US 500
+#endif
+
+#ifndef SITL_SCHEDULER_IO_PERIOD_US
+#define SITL_SCHEDULER_IO_PERIOD_US 1000
+#endif
+
 /* Scheduler implementation: */
 class HALSITL::Scheduler : public AP_HAL::Scheduler {
 public:
@@ -74,11 +89,25 @@ private:
 
     static void _run_timer_procs();
 
+    struct proc_entry : TimingWheel::Entry {
+        AP_HAL::MemberProc proc;
+    };
+
+    // timer and IO processes are kept on timing wheels on simulated
+    // time, so each call only runs the processes that are due
+    static void register_proc(TimingWheel &wheel, proc_entry *procs, uint8_t &num_procs,
+                              AP_HAL::MemberProc proc, uint32_t period_us);
+    static proc_entry *next_due_proc(TimingWheel &wheel, uint64_t now);
+
     static volatile bool _timer_event_missed;
-    static AP_HAL::MemberProc _timer_proc[SITL_SCHEDULER_MAX_TIMER_PROCS];
-    static AP_HAL::MemberProc _io_proc[SITL_SCHEDULER_MAX_TIMER_PROCS];
+    static proc_entry _timer_proc[SITL_SCHEDULER_MAX_TIMER_PROCS];
+    static proc_entry _io_proc[SITL_SCHEDULER_MAX_TIMER_PROCS];
     static uint8_t _num_timer_procs;
     static uint8_t _num_io_procs;
+    static TimingWheel _timer_wheel;
+    static TimingWheel _io_wheel;
+    static HAL_Semaphore _proc_sem;
+    static uint64_t _next_hal_io_usec;
     static bool _in_timer_proc;
     static bool _in_io_proc;
 
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <AP_HAL/AP_HAL.h>
+#include <AP_HAL/utility/MemoryPool.h>
 #include "AP_HAL_SITL_Namespace.h"
 #include "AP_HAL_SITL.h"
 #include "Semaphores.h"
@@ -34,6 +35,17 @@ public:
     bool get_system_id_unformatted(uint8_t buf[], uint8_t &len) override;
     void dump_stack_trace();
 
+    // allocations are served from a size-class pool and accounted per tag
+    void *malloc_type(size_t size, Memory_Type mem_type, Memory_Tag tag) override {
+        return _mem_pool.allocate(size, tag);
+    }
+    void free_type(void *ptr, size_t size, Memory_Type mem_type, Memory_Tag tag) override {
+        _mem_pool.release(ptr, size, tag);
+    }
+    bool memory_stats(Memory_Tag tag, Memory_Stats &stats) override {
+        return _mem_pool.get_stats(tag, stats);
+    }
+
 #ifdef ENABLE_HEAP
     // heap functions, note that a heap once alloc'd cannot be dealloc'd
     void *allocate_heap_memory(size_t size) override;
@@ -52,6 +64,7 @@ public:
     
 private:
     SITL_State *sitlState;
+    MemoryPool _mem_pool;
 
 #ifdef WITH_SITL_TONEALARM
     static ToneAlarm_SF _toneAlarm;
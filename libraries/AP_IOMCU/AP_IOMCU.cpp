@@ -780,18 +780,31 @@ bool AP_IOMCU::check_crc(void)
     // flash size minus 4k bootloader
 	const uint32_t flash_size = 0x10000 - 0x1000;
 
-    fw = AP_ROMFS::find_decompress(fw_name, fw_size);
-    if (!fw) {
+    // CRC the firmware as it is decompressed, so it is only held in
+    // memory when it needs to be uploaded
+    AP_ROMFS::Stream fw_stream;
+    if (!fw_stream.open(fw_name)) {
         hal.console->printf("failed to find %s\n", fw_name);
         return false;
     }
-    uint32_t crc = crc_crc32(0, fw, fw_size);
+    fw_size = fw_stream.size();
+    uint32_t crc = 0;
+    uint8_t buf[256];
+    int32_t n;
+    while ((n = fw_stream.read(buf, sizeof(buf))) > 0) {
+        crc = crc_crc32(crc, buf, n);
+    }
+    fw_stream.close();
+    if (n < 0) {
+        hal.console->printf("failed to decompress %s\n", fw_name);
+        return false;
+    }
 
     // pad CRC to max size
-	for (uint32_t i=0; i<flash_size-fw_size; i++) {
-		uint8_t b = 0xff;
-		crc = crc_crc32(crc, &b, 1);
-	}
+    memset(buf, 0xff, sizeof(buf));
+    for (uint32_t i=fw_size; i<flash_size; i += sizeof(buf)) {
+        crc = crc_crc32(crc, buf, MIN(sizeof(buf), flash_size - i));
+    }
 
     uint32_t io_crc = 0;
     uint8_t tries = 32;
@@ -803,13 +816,17 @@ bool AP_IOMCU::check_crc(void)
     if (io_crc == crc) {
         hal.console->printf("IOMCU: CRC ok\n");
         crc_is_ok = true;
-        AP_ROMFS::free(fw);
-        fw = nullptr;
         return true;
     } else {
         hal.console->printf("IOMCU: CRC mismatch expected: 0x%X got: 0x%X\n", (unsigned)crc, (unsigned)io_crc);
     }
 
+    fw = AP_ROMFS::find_decompress(fw_name, fw_size);
+    if (!fw) {
+        hal.console->printf("failed to find %s\n", fw_name);
+        return false;
+    }
+
     const uint16_t magic = REBOOT_BL_MAGIC;
     write_registers(PAGE_SETUP, PAGE_REG_SETUP_REBOOT_BL, 1, &magic);
 
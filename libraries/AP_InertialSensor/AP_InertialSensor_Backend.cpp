@@ -54,14 +54,14 @@ void AP_InertialSensor_Backend::_set_gyro_oversampling(uint8_t instance, uint8_t
   sensor may vary slightly from the system clock. This slowly adjusts
   the rate to the observed rate
 */
-void AP_InertialSensor_Backend::_update_sensor_rate(uint16_t &count, uint32_t &start_us, float &rate_hz) const
+void AP_InertialSensor_Backend::_update_sensor_rate(uint16_t &count, uint32_t &start_us, float &rate_hz, uint8_t n) const
 {
     uint32_t now = AP_HAL::micros();
     if (start_us == 0) {
-        count = 0;
+        count = n - 1;
         start_us = now;
     } else {
-        count++;
+        count += n;
         if (now - start_us > 1000000UL) {
             float observed_rate_hz = count * 1.0e6f / (now - start_us);
 #if SENSOR_RATE_DEBUG
@@ -127,6 +127,75 @@ void AP_InertialSensor_Backend::_rotate_and_correct_gyro(uint8_t instance, Vecto
     }
 }
 
+/*
+  rotate and correct a burst of samples. The sensor rotation,
+  calibration and board rotation are combined into one matrix and
+  offset, so each sample takes a single matrix multiply. Building the
+  matrix costs about as much as correcting a few samples, so short
+  bursts are corrected one sample at a time
+ */
+#define INS_MIN_CORRECTION_BURST 4
+
+// board rotation with the columns multiplied by scale
+static Matrix3f board_rotation_scaled(enum Rotation board_orientation, const Matrix3f *custom_rotation,
+                                      const Vector3f &scale)
+{
+    Matrix3f m;
+    if (board_orientation == ROTATION_CUSTOM && custom_rotation) {
+        m = *custom_rotation;
+    } else {
+        m.from_rotation(board_orientation);
+    }
+    m.a.x *= scale.x; m.a.y *= scale.y; m.a.z *= scale.z;
+    m.b.x *= scale.x; m.b.y *= scale.y; m.b.z *= scale.z;
+    m.c.x *= scale.x; m.c.y *= scale.y; m.c.z *= scale.z;
+    return m;
+}
+
+void AP_InertialSensor_Backend::_rotate_and_correct_accel_samples(uint8_t instance, Vector3f *accel, uint8_t n)
+{
+    if (n < INS_MIN_CORRECTION_BURST) {
+        for (uint8_t i = 0; i < n; i++) {
+            _rotate_and_correct_accel(instance, accel[i]);
+        }
+        return;
+    }
+
+    // board * scale * (sensor * accel - offset)
+    const Matrix3f board = board_rotation_scaled(_imu._board_orientation, _imu._custom_rotation,
+                                                 _imu._accel_scale[instance].get());
+    Matrix3f sensor;
+    sensor.from_rotation(_imu._accel_orientation[instance]);
+    const Matrix3f m = board * sensor;
+    const Vector3f offset = board * _imu._accel_offset[instance].get();
+
+    for (uint8_t i = 0; i < n; i++) {
+        accel[i] = m * accel[i] - offset;
+    }
+}
+
+void AP_InertialSensor_Backend::_rotate_and_correct_gyro_samples(uint8_t instance, Vector3f *gyro, uint8_t n)
+{
+    if (n < INS_MIN_CORRECTION_BURST) {
+        for (uint8_t i = 0; i < n; i++) {
+            _rotate_and_correct_gyro(instance, gyro[i]);
+        }
+        return;
+    }
+
+    // board * (sensor * gyro - offset)
+    const Matrix3f board = board_rotation_scaled(_imu._board_orientation, _imu._custom_rotation,
+                                                 Vector3f(1, 1, 1));
+    Matrix3f sensor;
+    sensor.from_rotation(_imu._gyro_orientation[instance]);
+    const Matrix3f m = board * sensor;
+    const Vector3f offset = board * _imu._gyro_offset[instance].get();
+
+    for (uint8_t i = 0; i < n; i++) {
+        gyro[i] = m * gyro[i] - offset;
+    }
+}
+
 /*
   rotate gyro vector and add the gyro offset
  */
@@ -258,6 +327,107 @@ void AP_InertialSensor_Backend::_notify_new_gyro_raw_sample(uint8_t instance,
     }
 }
 
+// samples processed under one take of the semaphore when notifying a burst
+#define INS_NOTIFY_BURST_MAX 16
+
+void AP_InertialSensor_Backend::_notify_new_gyro_raw_samples(uint8_t instance, const Vector3f *gyro, uint8_t n)
+{
+    if (((1U<<instance) & _imu.imu_kill_mask) || n == 0) {
+        return;
+    }
+
+    _update_sensor_rate(_imu._sample_gyro_count[instance], _imu._sample_gyro_start_us[instance],
+                        _imu._gyro_raw_sample_rates[instance], n);
+
+    // don't accept below 100Hz
+    if (_imu._gyro_raw_sample_rates[instance] < 100) {
+        return;
+    }
+
+    // FIFO samples are evenly spaced at the sample rate
+    const float dt = 1.0f / _imu._gyro_raw_sample_rates[instance];
+    const uint64_t last_sample_us = _imu._gyro_last_sample_us[instance];
+    _imu._gyro_last_sample_us[instance] = AP_HAL::micros64();
+
+    for (uint8_t i = 0; i < n; i++) {
+#if AP_MODULE_SUPPORTED
+        // call gyro_sample hook if any
+        AP_Module::call_hook_gyro_sample(instance, dt, gyro[i]);
+#endif
+
+        // push gyros if optical flow present
+        if (hal.opticalflow) {
+            hal.opticalflow->push_gyro(gyro[i].x, gyro[i].y, dt);
+        }
+    }
+
+    const bool notch_enabled = _gyro_notch_enabled();
+    const bool harmonic_notch_enabled = gyro_harmonic_notch_enabled();
+    const bool post_filter_logging = _imu.batchsampler.doing_post_filter_logging();
+
+    for (uint8_t ofs = 0; ofs < n; ofs += INS_NOTIFY_BURST_MAX) {
+        const uint8_t count = MIN(n - ofs, INS_NOTIFY_BURST_MAX);
+        Vector3f filtered[INS_NOTIFY_BURST_MAX];
+        {
+            WITH_SEMAPHORE(_sem);
+
+            const bool reset = ofs == 0 && AP_HAL::micros64() - last_sample_us > 100000U;
+            if (reset) {
+                // zero accumulator if sensor was unhealthy for 0.1s
+                _imu._delta_angle_acc[instance].zero();
+                _imu._delta_angle_acc_dt[instance] = 0;
+            }
+
+            Vector3f &delta_angle_acc = _imu._delta_angle_acc[instance];
+            Vector3f &last_delta_angle = _imu._last_delta_angle[instance];
+            Vector3f &last_raw_gyro = _imu._last_raw_gyro[instance];
+            for (uint8_t i = 0; i < count; i++) {
+                const Vector3f &g = gyro[ofs + i];
+
+                if (reset && i == 0) {
+                    // the first sample after a reset is not integrated
+                    last_delta_angle.zero();
+                } else {
+                    // compute delta angle and coning correction, see _notify_new_gyro_raw_sample()
+                    const Vector3f delta_angle = (g + last_raw_gyro) * 0.5f * dt;
+                    Vector3f delta_coning = (delta_angle_acc + last_delta_angle * (1.0f / 6.0f));
+                    delta_coning = delta_coning % delta_angle;
+                    delta_coning *= 0.5f;
+
+                    delta_angle_acc += delta_angle + delta_coning;
+                    _imu._delta_angle_acc_dt[instance] += dt;
+                    last_delta_angle = delta_angle;
+                }
+                last_raw_gyro = g;
+
+                Vector3f gyro_filtered = _imu._gyro_filter[instance].apply(g);
+                if (notch_enabled) {
+                    gyro_filtered = _imu._gyro_notch_filter[instance].apply(gyro_filtered);
+                }
+                if (harmonic_notch_enabled) {
+                    gyro_filtered = _imu._gyro_harmonic_notch_filter[instance].apply(gyro_filtered);
+                }
+
+                // if the filtering failed in any way then reset the filters and keep the old value
+                if (gyro_filtered.is_nan() || gyro_filtered.is_inf()) {
+                    _imu._gyro_filter[instance].reset();
+                    _imu._gyro_notch_filter[instance].reset();
+                    _imu._gyro_harmonic_notch_filter[instance].reset();
+                } else {
+                    _imu._gyro_filtered[instance] = gyro_filtered;
+                }
+                filtered[i] = _imu._gyro_filtered[instance];
+            }
+
+            _imu._new_gyro_data[instance] = true;
+        }
+
+        for (uint8_t i = 0; i < count; i++) {
+            log_gyro_raw(instance, 0, post_filter_logging ? filtered[i] : gyro[ofs + i]);
+        }
+    }
+}
+
 void AP_InertialSensor_Backend::log_gyro_raw(uint8_t instance, const uint64_t sample_us, const Vector3f &gyro)
 {
     AP_Logger *logger = AP_Logger::get_singleton();
@@ -395,6 +565,75 @@ void AP_InertialSensor_Backend::_notify_new_accel_raw_sample(uint8_t instance,
     }
 }
 
+void AP_InertialSensor_Backend::_notify_new_accel_raw_samples(uint8_t instance, const Vector3f *accel, uint8_t n, const bool *fsync_set)
+{
+    if (((1U<<instance) & _imu.imu_kill_mask) || n == 0) {
+        return;
+    }
+
+    _update_sensor_rate(_imu._sample_accel_count[instance], _imu._sample_accel_start_us[instance],
+                        _imu._accel_raw_sample_rates[instance], n);
+
+    // don't accept below 100Hz
+    if (_imu._accel_raw_sample_rates[instance] < 100) {
+        return;
+    }
+
+    // FIFO samples are evenly spaced at the sample rate
+    const float dt = 1.0f / _imu._accel_raw_sample_rates[instance];
+    const uint64_t last_sample_us = _imu._accel_last_sample_us[instance];
+    _imu._accel_last_sample_us[instance] = AP_HAL::micros64();
+
+    for (uint8_t i = 0; i < n; i++) {
+#if AP_MODULE_SUPPORTED
+        // call accel_sample hook if any
+        AP_Module::call_hook_accel_sample(instance, dt, accel[i], fsync_set != nullptr && fsync_set[i]);
+#endif
+        _imu.calc_vibration_and_clipping(instance, accel[i], dt);
+    }
+
+    const bool post_filter_logging = _imu.batchsampler.doing_post_filter_logging();
+
+    for (uint8_t ofs = 0; ofs < n; ofs += INS_NOTIFY_BURST_MAX) {
+        const uint8_t count = MIN(n - ofs, INS_NOTIFY_BURST_MAX);
+        Vector3f filtered[INS_NOTIFY_BURST_MAX];
+        {
+            WITH_SEMAPHORE(_sem);
+
+            // the first sample of a burst after the sensor was unhealthy
+            // for 0.1s restarts the accumulator
+            uint8_t first = 0;
+            if (ofs == 0 && AP_HAL::micros64() - last_sample_us > 100000U) {
+                _imu._delta_velocity_acc[instance].zero();
+                _imu._delta_velocity_acc_dt[instance] = 0;
+                first = 1;
+            }
+
+            Vector3f sum;
+            for (uint8_t i = first; i < count; i++) {
+                sum += accel[ofs + i];
+            }
+            _imu._delta_velocity_acc[instance] += sum * dt;
+            _imu._delta_velocity_acc_dt[instance] += (count - first) * dt;
+
+            for (uint8_t i = 0; i < count; i++) {
+                _imu._accel_filtered[instance] = _imu._accel_filter[instance].apply(accel[ofs + i]);
+                if (_imu._accel_filtered[instance].is_nan() || _imu._accel_filtered[instance].is_inf()) {
+                    _imu._accel_filter[instance].reset();
+                }
+                _imu.set_accel_peak_hold(instance, _imu._accel_filtered[instance]);
+                filtered[i] = _imu._accel_filtered[instance];
+            }
+
+            _imu._new_accel_data[instance] = true;
+        }
+
+        for (uint8_t i = 0; i < count; i++) {
+            log_accel_raw(instance, 0, post_filter_logging ? filtered[i] : accel[ofs + i]);
+        }
+    }
+}
+
 void AP_InertialSensor_Backend::_notify_new_accel_sensor_rate_sample(uint8_t instance, const Vector3f &accel)
 {
     if (!_imu.batchsampler.doing_sensor_rate_logging()) {
@@ -124,6 +124,11 @@ protected:
     void _rotate_and_correct_accel(uint8_t instance, Vector3f &accel);
     void _rotate_and_correct_gyro(uint8_t instance, Vector3f &gyro);
 
+    // rotate and correct a burst of n samples, the same as calling
+    // _rotate_and_correct_accel() or _rotate_and_correct_gyro() on each
+    void _rotate_and_correct_accel_samples(uint8_t instance, Vector3f *accel, uint8_t n);
+    void _rotate_and_correct_gyro_samples(uint8_t instance, Vector3f *gyro, uint8_t n);
+
     // rotate gyro vector, offset and publish
     void _publish_gyro(uint8_t instance, const Vector3f &gyro);
 
@@ -146,6 +151,14 @@ protected:
     // sensors, and should be set to zero for FIFO based sensors
     void _notify_new_accel_raw_sample(uint8_t instance, const Vector3f &accel, uint64_t sample_us=0, bool fsync_set=false);
 
+    // notify a burst of n raw samples read together from a FIFO based
+    // sensor. This is the same as calling _notify_new_gyro_raw_sample()
+    // or _notify_new_accel_raw_sample() on each sample with a zero
+    // sample_us, but the sample rate, timing and semaphore are handled
+    // once per burst
+    void _notify_new_gyro_raw_samples(uint8_t instance, const Vector3f *gyro, uint8_t n);
+    void _notify_new_accel_raw_samples(uint8_t instance, const Vector3f *accel, uint8_t n, const bool *fsync_set=nullptr);
+
     // set the amount of oversamping a accel is doing
     void _set_accel_oversampling(uint8_t instance, uint8_t n);
 
@@ -178,8 +191,8 @@ protected:
         _imu._gyro_raw_sampling_multiplier[instance] = mul;
     }
 
-    // update the sensor rate for FIFO sensors
-    void _update_sensor_rate(uint16_t &count, uint32_t &start_us, float &rate_hz) const;
+    // update the sensor rate for FIFO sensors after n new samples
+    void _update_sensor_rate(uint16_t &count, uint32_t &start_us, float &rate_hz, uint8_t n=1) const;
 
     // return true if the sensors are still converging and sampling rates could change significantly
     bool sensors_converging() const { return AP_HAL::millis() < 30000; }
@@ -300,6 +313,12 @@ protected:
     void _notify_new_accel_sensor_rate_sample(uint8_t instance, const Vector3f &accel);
     void _notify_new_gyro_sensor_rate_sample(uint8_t instance, const Vector3f &gyro);
 
+    // true if sensor rate samples are being logged, so backends only
+    // need to scale sensor rate samples when they will be used
+    bool sensor_rate_logging() const {
+        return _imu.batchsampler.doing_sensor_rate_logging();
+    }
+
     /*
       notify of a FIFO reset so we don't use bad data to update observed sensor rate
     */
@@ -51,6 +51,15 @@ extern const AP_HAL::HAL& hal;
 #define INVENSENSE_EXT_SYNC_ENABLE 0
 #endif
 
+/*
+  BLOCK_PROCESSING decodes each FIFO read as a whole and passes the
+  samples to the backend as a block. Setting it to 0 processes one
+  sample at a time, for comparing the INV_fifo perf counter
+ */
+#ifndef INVENSENSE_BLOCK_PROCESSING
+#define INVENSENSE_BLOCK_PROCESSING 1
+#endif
+
 #include "AP_InertialSensor_Invensense_registers.h"
 
 #define MPU_SAMPLE_SIZE 14
@@ -80,7 +89,7 @@ AP_InertialSensor_Invensense::AP_InertialSensor_Invensense(AP_InertialSensor &im
 AP_InertialSensor_Invensense::~AP_InertialSensor_Invensense()
 {
     if (_fifo_buffer != nullptr) {
-        hal.util->free_type(_fifo_buffer, MPU_FIFO_BUFFER_LEN * MPU_SAMPLE_SIZE, AP_HAL::Util::MEM_DMA_SAFE);
+        hal.util->free_type(_fifo_buffer, MPU_FIFO_BUFFER_LEN * MPU_SAMPLE_SIZE, AP_HAL::Util::MEM_DMA_SAFE, AP_HAL::Util::MEM_TAG_INS);
     }
     delete _auxiliary_bus;
 }
@@ -152,13 +161,18 @@ void AP_InertialSensor_Invensense::_fifo_reset()
     uint8_t user_ctrl = _last_stat_user_ctrl;
     user_ctrl &= ~(BIT_USER_CTRL_FIFO_RESET | BIT_USER_CTRL_FIFO_EN);
 
+    const uint8_t fifo_en = BIT_XG_FIFO_EN | BIT_YG_FIFO_EN |
+        BIT_ZG_FIFO_EN | BIT_ACCEL_FIFO_EN | BIT_TEMP_FIFO_EN;
+
+    // the register writes go to the bus together where it allows it
     _dev->set_speed(AP_HAL::Device::SPEED_LOW);
-    _register_write(MPUREG_FIFO_EN, 0);
-    _register_write(MPUREG_USER_CTRL, user_ctrl);
-    _register_write(MPUREG_USER_CTRL, user_ctrl | BIT_USER_CTRL_FIFO_RESET);
-    _register_write(MPUREG_USER_CTRL, user_ctrl | BIT_USER_CTRL_FIFO_EN);
-    _register_write(MPUREG_FIFO_EN, BIT_XG_FIFO_EN | BIT_YG_FIFO_EN |
-                    BIT_ZG_FIFO_EN | BIT_ACCEL_FIFO_EN | BIT_TEMP_FIFO_EN, true);
+    _dev->queue_write_register(MPUREG_FIFO_EN, 0);
+    _dev->queue_write_register(MPUREG_USER_CTRL, user_ctrl);
+    _dev->queue_write_register(MPUREG_USER_CTRL, user_ctrl | BIT_USER_CTRL_FIFO_RESET);
+    _dev->queue_write_register(MPUREG_USER_CTRL, user_ctrl | BIT_USER_CTRL_FIFO_EN);
+    _dev->set_checked_register(MPUREG_FIFO_EN, fifo_en);
+    _dev->queue_write_register(MPUREG_FIFO_EN, fifo_en);
+    _dev->submit_transfers();
     hal.scheduler->delay_microseconds(1);
     _dev->set_speed(AP_HAL::Device::SPEED_HIGH);
     _last_stat_user_ctrl = user_ctrl | BIT_USER_CTRL_FIFO_EN;
@@ -343,11 +357,13 @@ void AP_InertialSensor_Invensense::start()
     _fifo_gyro_scale = _gyro_scale / _fifo_downsample_rate;
     
     // allocate fifo buffer
-    _fifo_buffer = (uint8_t *)hal.util->malloc_type(MPU_FIFO_BUFFER_LEN * MPU_SAMPLE_SIZE, AP_HAL::Util::MEM_DMA_SAFE);
+    _fifo_buffer = (uint8_t *)hal.util->malloc_type(MPU_FIFO_BUFFER_LEN * MPU_SAMPLE_SIZE, AP_HAL::Util::MEM_DMA_SAFE, AP_HAL::Util::MEM_TAG_INS);
     if (_fifo_buffer == nullptr) {
         AP_HAL::panic("Invensense: Unable to allocate FIFO buffer");
     }
 
+    _perf_fifo = hal.util->perf_alloc(AP_HAL::Util::PC_ELAPSED, "INV_fifo");
+
     // start the timer process to read samples
     _dev->register_periodic_callback(1000000UL / _backend_rate_hz, FUNCTOR_BIND_MEMBER(&AP_InertialSensor_Invensense::_poll_data, void));
 }
@@ -452,6 +468,58 @@ bool AP_InertialSensor_Invensense::_accumulate(uint8_t *samples, uint8_t n_sampl
     return true;
 }
 
+/*
+  decode a whole FIFO read, then rotate, correct and notify the
+  samples as a block
+ */
+bool AP_InertialSensor_Invensense::_accumulate_block(uint8_t *samples, uint8_t n_samples)
+{
+    Vector3f accel[MPU_FIFO_BUFFER_LEN];
+    Vector3f gyro[MPU_FIFO_BUFFER_LEN];
+#if INVENSENSE_EXT_SYNC_ENABLE
+    bool fsync_set[MPU_FIFO_BUFFER_LEN];
+#else
+    const bool *fsync_set = nullptr;
+#endif
+    bool ret = true;
+
+    uint8_t n;
+    for (n = 0; n < n_samples; n++) {
+        const uint8_t *data = samples + MPU_SAMPLE_SIZE * n;
+
+        int16_t t2 = int16_val(data, 3);
+        if (!_check_raw_temp(t2)) {
+            if (!hal.scheduler->in_expected_delay()) {
+                debug("temp reset IMU[%u] %d %d", _accel_instance, _raw_temp, t2);
+            }
+            ret = false;
+            break;
+        }
+        _temp_filtered = _temp_filter.apply(t2 * temp_sensitivity + temp_zero);
+
+#if INVENSENSE_EXT_SYNC_ENABLE
+        fsync_set[n] = (int16_val(data, 2) & 1U) != 0;
+#endif
+        accel[n] = Vector3f(int16_val(data, 1),
+                            int16_val(data, 0),
+                            -int16_val(data, 2)) * _accel_scale;
+        gyro[n] = Vector3f(int16_val(data, 5),
+                           int16_val(data, 4),
+                           -int16_val(data, 6)) * _gyro_scale;
+    }
+
+    // samples before a corrupt one are still used
+    _rotate_and_correct_accel_samples(_accel_instance, accel, n);
+    _rotate_and_correct_gyro_samples(_gyro_instance, gyro, n);
+    _notify_new_accel_raw_samples(_accel_instance, accel, n, fsync_set);
+    _notify_new_gyro_raw_samples(_gyro_instance, gyro, n);
+
+    if (!ret) {
+        _fifo_reset();
+    }
+    return ret;
+}
+
 /*
   when doing fast sampling the sensor gives us 8k samples/second. Every 2nd accel sample is a duplicate.
 
@@ -536,6 +604,93 @@ bool AP_InertialSensor_Invensense::_accumulate_sensor_rate_sampling(uint8_t *sam
     return ret;
 }
 
+/*
+  the same as _accumulate_sensor_rate_sampling(), but the downsampled
+  samples are rotated, corrected and notified as a block, and sensor
+  rate samples are only scaled when they are being logged
+ */
+bool AP_InertialSensor_Invensense::_accumulate_sensor_rate_sampling_block(uint8_t *samples, uint8_t n_samples)
+{
+    int32_t tsum = 0;
+    const int32_t unscaled_clip_limit = _clip_limit / _accel_scale;
+    const bool sensor_rate_logging = this->sensor_rate_logging();
+    bool clipped = false;
+    bool ret = true;
+
+    Vector3f accel[MPU_FIFO_BUFFER_LEN];
+    Vector3f gyro[MPU_FIFO_BUFFER_LEN];
+    uint8_t n_out = 0;
+
+    for (uint8_t i = 0; i < n_samples; i++) {
+        const uint8_t *data = samples + MPU_SAMPLE_SIZE * i;
+
+        // use temperatue to detect FIFO corruption
+        int16_t t2 = int16_val(data, 3);
+        if (!_check_raw_temp(t2)) {
+            if (!hal.scheduler->in_expected_delay()) {
+                debug("temp reset IMU[%u] %d %d", _accel_instance, _raw_temp, t2);
+            }
+            ret = false;
+            break;
+        }
+        tsum += t2;
+
+        if ((_accum.count & 1) == 0) {
+            // accel data is at 4kHz
+            Vector3f a(int16_val(data, 1),
+                       int16_val(data, 0),
+                       -int16_val(data, 2));
+            if (fabsf(a.x) > unscaled_clip_limit ||
+                fabsf(a.y) > unscaled_clip_limit ||
+                fabsf(a.z) > unscaled_clip_limit) {
+                clipped = true;
+            }
+            _accum.accel += _accum.accel_filter.apply(a);
+            if (sensor_rate_logging) {
+                _notify_new_accel_sensor_rate_sample(_accel_instance, a * _accel_scale);
+            }
+        }
+
+        Vector3f g(int16_val(data, 5),
+                   int16_val(data, 4),
+                   -int16_val(data, 6));
+        if (sensor_rate_logging) {
+            _notify_new_gyro_sensor_rate_sample(_gyro_instance, g * _gyro_scale);
+        }
+
+        _accum.gyro += _accum.gyro_filter.apply(g);
+        _accum.count++;
+
+        if (_accum.count == _fifo_downsample_rate) {
+            accel[n_out] = _accum.accel * _fifo_accel_scale;
+            gyro[n_out] = _accum.gyro * _fifo_gyro_scale;
+            n_out++;
+
+            _accum.accel.zero();
+            _accum.gyro.zero();
+            _accum.count = 0;
+        }
+    }
+
+    _rotate_and_correct_accel_samples(_accel_instance, accel, n_out);
+    _rotate_and_correct_gyro_samples(_gyro_instance, gyro, n_out);
+    _notify_new_accel_raw_samples(_accel_instance, accel, n_out);
+    _notify_new_gyro_raw_samples(_gyro_instance, gyro, n_out);
+
+    if (clipped) {
+        increment_clip_count(_accel_instance);
+    }
+
+    if (ret) {
+        float temp = (static_cast<float>(tsum)/n_samples)*temp_sensitivity + temp_zero;
+        _temp_filtered = _temp_filter.apply(temp);
+    } else {
+        _fifo_reset();
+    }
+
+    return ret;
+}
+
 void AP_InertialSensor_Invensense::_read_fifo()
 {
     uint8_t n_samples;
@@ -601,17 +756,27 @@ void AP_InertialSensor_Invensense::_read_fifo()
             _dev->set_chip_select(false);
         }
 
+        hal.util->perf_begin(_perf_fifo);
+        bool ok;
         if (_fast_sampling) {
-            if (!_accumulate_sensor_rate_sampling(rx, n)) {
-                if (!hal.scheduler->in_expected_delay()) {
-                    debug("IMU[%u] stop at %u of %u", _accel_instance, n_samples, bytes_read/MPU_SAMPLE_SIZE);
-                }
-                break;
+#if INVENSENSE_BLOCK_PROCESSING
+            ok = _accumulate_sensor_rate_sampling_block(rx, n);
+#else
+            ok = _accumulate_sensor_rate_sampling(rx, n);
+#endif
+            if (!ok && !hal.scheduler->in_expected_delay()) {
+                debug("IMU[%u] stop at %u of %u", _accel_instance, n_samples, bytes_read/MPU_SAMPLE_SIZE);
             }
         } else {
-            if (!_accumulate(rx, n)) {
-                break;
-            }
+#if INVENSENSE_BLOCK_PROCESSING
+            ok = _accumulate_block(rx, n);
+#else
+            ok = _accumulate(rx, n);
+#endif
+        }
+        hal.util->perf_end(_perf_fifo);
+        if (!ok) {
+            break;
         }
         n_samples -= n;
     }
@@ -103,6 +103,8 @@ private:
 
     bool _accumulate(uint8_t *samples, uint8_t n_samples);
     bool _accumulate_sensor_rate_sampling(uint8_t *samples, uint8_t n_samples);
+    bool _accumulate_block(uint8_t *samples, uint8_t n_samples);
+    bool _accumulate_sensor_rate_sampling_block(uint8_t *samples, uint8_t n_samples);
 
     bool _check_raw_temp(int16_t t2);
 
@@ -147,6 +149,9 @@ private:
     // buffer for fifo read
     uint8_t *_fifo_buffer;
 
+    // time spent processing each FIFO read
+    AP_HAL::Util::perf_counter_t _perf_fifo;
+
     /*
       accumulators for sensor_rate sampling
       See description in _accumulate_sensor_rate_sampling()
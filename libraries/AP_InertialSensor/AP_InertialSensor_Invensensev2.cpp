@@ -70,7 +70,7 @@ AP_InertialSensor_Invensensev2::AP_InertialSensor_Invensensev2(AP_InertialSensor
 AP_InertialSensor_Invensensev2::~AP_InertialSensor_Invensensev2()
 {
     if (_fifo_buffer != nullptr) {
-        hal.util->free_type(_fifo_buffer, INV2_FIFO_BUFFER_LEN * INV2_SAMPLE_SIZE, AP_HAL::Util::MEM_DMA_SAFE);
+        hal.util->free_type(_fifo_buffer, INV2_FIFO_BUFFER_LEN * INV2_SAMPLE_SIZE, AP_HAL::Util::MEM_DMA_SAFE, AP_HAL::Util::MEM_TAG_INS);
     }
     //delete _auxiliary_bus;
 }
@@ -236,7 +236,7 @@ void AP_InertialSensor_Invensensev2::start()
     _fifo_gyro_scale = GYRO_SCALE / _fifo_downsample_rate;
     
     // allocate fifo buffer
-    _fifo_buffer = (uint8_t *)hal.util->malloc_type(INV2_FIFO_BUFFER_LEN * INV2_SAMPLE_SIZE, AP_HAL::Util::MEM_DMA_SAFE);
+    _fifo_buffer = (uint8_t *)hal.util->malloc_type(INV2_FIFO_BUFFER_LEN * INV2_SAMPLE_SIZE, AP_HAL::Util::MEM_DMA_SAFE, AP_HAL::Util::MEM_TAG_INS);
     if (_fifo_buffer == nullptr) {
         AP_HAL::panic("Invensense: Unable to allocate FIFO buffer");
     }
@@ -96,6 +96,13 @@ const AP_Param::GroupInfo AP_Logger::var_info[] = {
     // @User: Standard
     // @Units: s
     AP_GROUPINFO("_FILE_TIMEOUT",  6, AP_Logger, _params.file_timeout,     HAL_LOGGING_FILE_TIMEOUT),
+
+    // @Param: _FILE_DELTA
+    // @DisplayName: Delta encode file logs
+    // @Description: When enabled, messages in logs written to file are delta encoded against the previous message of the same type, reducing the log size. These logs can only be read by log readers which support delta encoded messages. Takes effect when the next log is started.
+    // @Values: 0:Disabled,1:Enabled
+    // @User: Advanced
+    AP_GROUPINFO("_FILE_DELTA",  7, AP_Logger, _params.file_delta,       0),
     
     AP_GROUPEND
 };
@@ -822,6 +829,19 @@ void AP_Logger::WriteV(const char *name, const char *labels, const char *units,
     }
 }
 
+// send a packed message to all backends, emitting its FMT message first if required
+void AP_Logger::WriteBlock_for_write_fmt(log_write_fmt &f, const void *pBuffer, uint16_t size, bool is_critical)
+{
+    for (uint8_t i=0; i<_next_backend; i++) {
+        if (!(f.sent_mask & (1U<<i))) {
+            if (!backends[i]->Write_Emit_FMT(f.msg_type)) {
+                continue;
+            }
+            f.sent_mask |= (1U<<i);
+        }
+        backends[i]->WritePrioritisedBlock(pBuffer, size, is_critical);
+    }
+}
 
 #if CONFIG_HAL_BOARD == HAL_BOARD_SITL
 void AP_Logger::assert_same_fmt_for_name(const AP_Logger::log_write_fmt *f,
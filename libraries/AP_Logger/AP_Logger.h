@@ -13,6 +13,8 @@
 #include <AP_Mission/AP_Mission.h>
 #include <AP_RPM/AP_RPM.h>
 #include <AP_Logger/LogStructure.h>
+#include <AP_Logger/LogFormat.h>
+#include <AP_InternalError/AP_InternalError.h>
 #include <AP_Motors/AP_Motors.h>
 #include <AP_Rally/AP_Rally.h>
 #include <AP_Beacon/AP_Beacon.h>
@@ -178,6 +180,8 @@ class AP_Logger
 {
     friend class AP_Logger_Backend; // for _num_types
 
+    struct log_write_fmt;
+
 public:
     FUNCTOR_TYPEDEF(vehicle_startup_message_Writer, void);
 
@@ -250,7 +254,7 @@ public:
     void Write_POS();
     void Write_Radio(const mavlink_radio_t &packet);
     void Write_Message(const char *message);
-    void Write_MessageF(const char *fmt, ...);
+    void Write_MessageF(const char *fmt, ...) FMT_PRINTF(2, 3);
     void Write_CameraInfo(enum LogMessages msg, const Location &current_loc, uint64_t timestamp_us=0);
     void Write_Camera(const Location &current_loc, uint64_t timestamp_us=0);
     void Write_Trigger(const Location &current_loc);
@@ -290,6 +294,49 @@ public:
     void WriteCritical(const char *name, const char *labels, const char *units, const char *mults, const char *fmt, ...);
     void WriteV(const char *name, const char *labels, const char *units, const char *mults, const char *fmt, va_list arg_list, bool is_critical=false);
 
+    /*
+      a message whose format is given as template arguments so its
+      length is known and arguments are checked at compile time.
+      Declare it static so the message type is only looked up on the
+      first write, e.g.:
+
+        static AP_Logger::MessageDef<'Q','f','B'> msg{"NAME", "TimeUS,Val,Id"};
+        AP::logger().Write(msg, AP_HAL::micros64(), val, id);
+    */
+    template <char... FMT>
+    class MessageDef {
+    public:
+        MessageDef(const char *name, const char *labels, const char *units = nullptr, const char *mults = nullptr) :
+            _name(name),
+            _labels(labels),
+            _units(units),
+            _mults(mults),
+            _write_fmt(nullptr)
+        {}
+
+        static constexpr char fmt[] = {FMT..., '\0'};
+        static constexpr uint16_t msg_len = LOG_PACKET_HEADER_LEN + log_fmt_length<FMT...>::value;
+        static_assert(sizeof...(FMT) < LS_FORMAT_SIZE, "too many log message fields");
+        static_assert(msg_len <= UINT8_MAX, "log message too long");
+
+    private:
+        friend class AP_Logger;
+        const char *_name;
+        const char *_labels;
+        const char *_units;
+        const char *_mults;
+        log_write_fmt *_write_fmt;  // set on first write
+    };
+
+    template <char... FMT, typename... Args>
+    void Write(MessageDef<FMT...> &msg, Args... args) {
+        WriteMessageDef(msg, false, args...);
+    }
+    template <char... FMT, typename... Args>
+    void WriteCritical(MessageDef<FMT...> &msg, Args... args) {
+        WriteMessageDef(msg, true, args...);
+    }
+
     // This structure provides information on the internal member data of a PID for logging purposes
     struct PID_Info {
         float target;
@@ -337,6 +384,7 @@ public:
         AP_Int8 log_replay;
         AP_Int8 mav_bufsize; // in kilobytes
         AP_Int16 file_timeout; // in seconds
+        AP_Int8 file_delta;
     } _params;
 
     const struct LogStructure *structure(uint16_t num) const;
@@ -417,6 +465,28 @@ private:
 
     // return (possibly allocating) a log_write_fmt for a name
     struct log_write_fmt *msg_fmt_for_name(const char *name, const char *labels, const char *units, const char *mults, const char *fmt);
+
+    // pack a MessageDef message and send it to all backends
+    template <char... FMT, typename... Args>
+    void WriteMessageDef(MessageDef<FMT...> &msg, bool is_critical, Args... args) {
+        static_assert(sizeof...(FMT) == sizeof...(Args), "number of arguments must match log message format");
+        if (msg._write_fmt == nullptr) {
+            msg._write_fmt = msg_fmt_for_name(msg._name, msg._labels, msg._units, msg._mults, MessageDef<FMT...>::fmt);
+            if (msg._write_fmt == nullptr) {
+                AP::internalerror().error(AP_InternalError::error_t::logger_mapfailure);
+                return;
+            }
+        }
+        uint8_t buffer[MessageDef<FMT...>::msg_len];
+        buffer[0] = HEAD_BYTE1;
+        buffer[1] = HEAD_BYTE2;
+        buffer[2] = msg._write_fmt->msg_type;
+        log_fmt_packer<FMT...>::pack(&buffer[LOG_PACKET_HEADER_LEN], args...);
+        WriteBlock_for_write_fmt(*msg._write_fmt, buffer, sizeof(buffer), is_critical);
+    }
+
+    // send a packed message to all backends, emitting its FMT message first if required
+    void WriteBlock_for_write_fmt(log_write_fmt &f, const void *pBuffer, uint16_t size, bool is_critical);
     const struct log_write_fmt *log_write_fmt_for_msg_type(uint8_t msg_type) const;
 
     const struct LogStructure *structure_for_msg_type(uint8_t msg_type);
@@ -531,6 +601,9 @@ private:
 
 };
 
+template <char... FMT>
+constexpr char AP_Logger::MessageDef<FMT...>::fmt[];
+
 namespace AP {
     AP_Logger &logger();
 };
@@ -90,7 +90,7 @@ public:
     void Write_Rally();
     bool Write_Format(const struct LogStructure *structure);
     bool Write_Message(const char *message);
-    bool Write_MessageF(const char *fmt, ...);
+    bool Write_MessageF(const char *fmt, ...) FMT_PRINTF(2, 3);
     bool Write_Mission_Cmd(const AP_Mission &mission,
                                const AP_Mission::Mission_Command &cmd);
     bool Write_Mode(uint8_t mode, const ModeReason reason = ModeReason::UNKNOWN);
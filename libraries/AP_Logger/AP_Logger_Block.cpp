@@ -11,12 +11,24 @@
 #include <AP_HAL/AP_HAL.h>
 #include <stdio.h>
 #include <GCS_MAVLink/GCS.h>
+#include <AP_Math/crc.h>
+#include <AP_RTC/AP_RTC.h>
 
 extern AP_HAL::HAL& hal;
 
 // the last page holds the log format in first 4 bytes. Please change
 // this if (and only if!) the low level format changes
-#define DF_LOGGING_FORMAT    0x1901201A
+#define DF_LOGGING_FORMAT    0x1901201B
+
+// number of recent logs whose boundaries are held in memory
+#ifndef LOG_BLOCK_INDEX_LOGS
+#define LOG_BLOCK_INDEX_LOGS 64
+#endif
+
+// number of pages read at once when downloading logs
+#ifndef LOG_BLOCK_READ_PAGES
+#define LOG_BLOCK_READ_PAGES 16
+#endif
 
 AP_Logger_Block::AP_Logger_Block(AP_Logger &front, LoggerMessageWriter_DFLogStart *writer) :
     writebuf(0),
@@ -26,7 +38,7 @@ AP_Logger_Block::AP_Logger_Block(AP_Logger &front, LoggerMessageWriter_DFLogStar
     gcs().send_text(MAV_SEVERITY_INFO, "logging type block");
     hal.console->printf("AP_Logger_Block: initializing");
 
-    buffer = (uint8_t *)hal.util->malloc_type(page_size_max, AP_HAL::Util::MEM_DMA_SAFE);
+    buffer = (uint8_t *)hal.util->malloc_type(page_size_max, AP_HAL::Util::MEM_DMA_SAFE, AP_HAL::Util::MEM_TAG_LOGGER);
     if (buffer == nullptr) {
         AP_HAL::panic("Out of DMA memory for logging");
     }
@@ -58,6 +70,10 @@ void AP_Logger_Block::Init(void)
         }
 
         hal.console->printf("AP_Logger_Block: buffer size=%u\n", (unsigned)bufsize);
+
+        // without memory for the index the chip is searched for log boundaries
+        index_entries = new IndexEntry[LOG_BLOCK_INDEX_LOGS];
+
         _initialised = true;
     }
 
@@ -86,6 +102,14 @@ void AP_Logger_Block::FinishWrite(void)
 {
     // Write Buffer to flash
     BufferToPage(df_PageAdr);
+    if (df_PageAdr <= df_NumPages) {
+        index_last_page = df_PageAdr;
+        index_page_written = true;
+        if (read_cache_pages != 0 &&
+            df_PageAdr >= read_cache_page && df_PageAdr < read_cache_page + read_cache_pages) {
+            read_cache_pages = 0;
+        }
+    }
     df_PageAdr++;
 
     // If we reach the end of the memory, start from the beginning
@@ -96,6 +120,9 @@ void AP_Logger_Block::FinishWrite(void)
     // when starting a new sector, erase it
     if ((df_PageAdr-1) % df_PagePerBlock == 0) {
         SectorErase(df_PageAdr / df_PagePerBlock);
+        // the erase may have removed the oldest log
+        index_first_log = 0;
+        read_cache_pages = 0;
     }
 }
 
@@ -217,6 +244,8 @@ void AP_Logger_Block::EraseAll()
     Sector4kErase(get_sector(df_NumPages));
 
     log_write_started = false;
+    index_clear();
+    free_read_cache();
 
     StartErase();
     erase_started = true;
@@ -238,6 +267,12 @@ void AP_Logger_Block::Prep()
         EraseAll();
     }
     validate_log_structure();
+    if (!index_valid && !erase_started && df_EraseFrom == 0) {
+        load_index();
+    } else if (index_valid && index_next_record > index_num_records() * 3 / 4) {
+        // compact while disarmed rather than when a log starts
+        rebuild_index();
+    }
 }
 
 /*
@@ -322,6 +357,10 @@ int16_t AP_Logger_Block::get_log_data_raw(uint16_t log_num, uint32_t page, uint3
             page = 1 + page - df_NumPages;
         }
     }
+    if (read_cached(page, offset, len, data)) {
+        return (int16_t)len;
+    }
+
     if (log_write_started || df_Read_PageAdr != page) {
         StartRead(page);
     }
@@ -391,6 +430,17 @@ uint16_t AP_Logger_Block::get_num_logs(void)
     uint32_t lastpage;
     uint32_t last;
 
+    if (index_valid) {
+        if (!CardInserted() || index_last_log == 0) {
+            return 0;
+        }
+        const uint16_t first = index_first_log_number();
+        if (first == 0xFFFF || first > index_last_log) {
+            return 1;
+        }
+        return index_last_log - first + 1;
+    }
+
     if (!CardInserted() || find_last_page() == 1) {
         return 0;
     }
@@ -425,13 +475,16 @@ uint16_t AP_Logger_Block::get_num_logs(void)
 uint16_t AP_Logger_Block::start_new_log(void)
 {
     WITH_SEMAPHORE(sem);
-    uint32_t last_page = find_last_page();
+    free_read_cache();
+
+    uint32_t last_page = (index_valid && index_last_page != 0) ? index_last_page : find_last_page();
 
     StartRead(last_page);
 
     if (find_last_log() == 0 || GetFileNumber() == 0xFFFF) {
         SetFileNumber(1);
         StartWrite(1);
+        index_log_started(1, 1);
         return 1;
     }
 
@@ -444,6 +497,7 @@ uint16_t AP_Logger_Block::start_new_log(void)
         // and overwrite it
         SetFileNumber(new_log_num);
         StartWrite(last_page);
+        index_log_started(new_log_num, last_page);
     } else {
         new_log_num = GetFileNumber()+1;
         if (last_page == 0xFFFF) {
@@ -451,6 +505,7 @@ uint16_t AP_Logger_Block::start_new_log(void)
         }
         SetFileNumber(new_log_num);
         StartWrite(last_page + 1);
+        index_log_started(new_log_num, last_page + 1);
     }
     return new_log_num;
 }
@@ -460,6 +515,11 @@ uint16_t AP_Logger_Block::start_new_log(void)
 void AP_Logger_Block::get_log_boundaries(uint16_t log_num, uint32_t & start_page, uint32_t & end_page)
 {
     WITH_SEMAPHORE(sem);
+    uint32_t time_utc;
+    if (index_lookup(log_num, start_page, end_page, time_utc)) {
+        return;
+    }
+
     uint16_t num = get_num_logs();
     uint32_t look;
 
@@ -513,6 +573,9 @@ bool AP_Logger_Block::check_wrapped(void)
 uint16_t AP_Logger_Block::find_last_log(void)
 {
     WITH_SEMAPHORE(sem);
+    if (index_valid) {
+        return index_last_log;
+    }
     uint32_t last_page = find_last_page();
     StartRead(last_page);
     return GetFileNumber();
@@ -630,24 +693,36 @@ void AP_Logger_Block::get_log_info(uint16_t log_num, uint32_t &size, uint32_t &t
 
     WITH_SEMAPHORE(sem);
 
-    get_log_boundaries(log_num, start, end);
+    if (!index_lookup(log_num, start, end, time_utc)) {
+        get_log_boundaries(log_num, start, end);
+        time_utc = 0;
+    }
     if (end >= start) {
         size = (end + 1 - start) * (uint32_t)df_PageSize;
     } else {
         size = (df_NumPages + end - start) * (uint32_t)df_PageSize;
     }
-    time_utc = 0;
 }
 
 
 void AP_Logger_Block::PrepForArming()
 {
+    free_read_cache();
     if (logging_started()) {
         return;
     }
     start_new_log();
 }
 
+void AP_Logger_Block::stop_logging(void)
+{
+    WITH_SEMAPHORE(sem);
+    if (log_write_started) {
+        index_log_stopped();
+    }
+    log_write_started = false;
+}
+
 // read size bytes of data from the buffer
 bool AP_Logger_Block::BlockRead(uint16_t IntPageAdr, void *pBuffer, uint16_t size)
 {
@@ -677,6 +752,9 @@ void AP_Logger_Block::io_timer(void)
         memcpy(buffer, &version, sizeof(version));
         FinishWrite();
         erase_started = false;
+        // the index was erased with the rest of the chip
+        index_clear();
+        index_valid = index_num_records() != 0;
         gcs().send_text(MAV_SEVERITY_INFO, "Chip erase complete");
         return;
     }
@@ -698,6 +776,7 @@ void AP_Logger_Block::io_timer(void)
         }
         gcs().send_text(MAV_SEVERITY_WARNING, "Log recovery complete, erased %d blocks", unsigned(blocks_erased));
         df_EraseFrom = 0;
+        rebuild_index();
     }
 
     if (!CardInserted() || !log_write_started) {
@@ -714,3 +793,398 @@ void AP_Logger_Block::io_timer(void)
         df_FilePage++;
     }
 }
+
+/*
+  the log index
+ */
+
+// number of record slots in the index, zero if there is no room for an index
+uint32_t AP_Logger_Block::index_num_records() const
+{
+    if (index_entries == nullptr || df_PagePerBlock < 2 * df_PagePerSector) {
+        return 0;
+    }
+    return (df_PagePerBlock - df_PagePerSector) * (df_PageSize / sizeof(IndexRecord));
+}
+
+// forget the index held in memory
+void AP_Logger_Block::index_clear()
+{
+    if (index_entries != nullptr) {
+        memset(index_entries, 0, LOG_BLOCK_INDEX_LOGS * sizeof(IndexEntry));
+    }
+    index_valid = false;
+    index_next_record = 0;
+    index_last_log = 0;
+    index_last_page = 0;
+    index_page_written = false;
+    index_first_log = 0;
+    index_first_log_page = 0;
+}
+
+// current UTC time in seconds, zero if unknown
+uint32_t AP_Logger_Block::utc_seconds() const
+{
+    uint64_t utc_usec;
+    if (!AP::rtc().get_utc_usec(utc_usec)) {
+        return 0;
+    }
+    return utc_usec / 1000000U;
+}
+
+// read the header of a page without changing the read state
+void AP_Logger_Block::read_page_header(uint32_t PageAdr, PageHeader &ph)
+{
+    if (erase_started) {
+        memset(&ph, 0xFF, sizeof(ph));
+        return;
+    }
+    PageToBuffer(PageAdr);
+    memcpy(&ph, buffer, sizeof(ph));
+    df_Read_PageAdr = 0;
+}
+
+/*
+  read the index from the chip, rebuilding it if it does not match
+  the logs found on the chip
+ */
+void AP_Logger_Block::load_index()
+{
+    index_clear();
+    const uint32_t num_records = index_num_records();
+    if (num_records == 0) {
+        return;
+    }
+
+    const uint16_t records_per_page = df_PageSize / sizeof(IndexRecord);
+    uint32_t slot;
+    for (slot = 0; slot < num_records; slot++) {
+        if (slot % records_per_page == 0) {
+            PageToBuffer(index_first_page() + slot / records_per_page);
+        }
+        IndexRecord rec;
+        memcpy(&rec, &buffer[(slot % records_per_page) * sizeof(rec)], sizeof(rec));
+
+        // the first erased slot ends the index
+        const uint8_t *b = (const uint8_t *)&rec;
+        bool erased = true;
+        for (uint8_t i=0; i<sizeof(rec); i++) {
+            if (b[i] != 0xFF) {
+                erased = false;
+                break;
+            }
+        }
+        if (erased) {
+            break;
+        }
+
+        // skip records damaged by a power loss while being written
+        const uint8_t crc = rec.crc;
+        rec.crc = 0;
+        if (crc != crc_crc8((const uint8_t *)&rec, sizeof(rec)) || rec.log_num == 0) {
+            continue;
+        }
+
+        IndexEntry &e = index_entries[rec.log_num % LOG_BLOCK_INDEX_LOGS];
+        switch (rec.type) {
+        case IndexRecordType::START:
+            e.log_num = rec.log_num;
+            e.start_page = rec.page;
+            e.end_page = 0;
+            e.time_utc = rec.time_utc;
+            index_last_log = rec.log_num;
+            break;
+        case IndexRecordType::END:
+            if (e.log_num == rec.log_num) {
+                e.end_page = rec.page;
+                if (rec.time_utc != 0) {
+                    e.time_utc = rec.time_utc;
+                }
+            }
+            break;
+        }
+    }
+    index_next_record = slot;
+    df_Read_PageAdr = 0;
+
+    // the newest log in the index must be the one holding the last page written
+    index_last_page = find_last_page();
+    PageHeader ph;
+    read_page_header(index_last_page, ph);
+    const uint16_t last_log = (ph.FileNumber == 0xFFFF) ? 0 : ph.FileNumber;
+    if (last_log != index_last_log) {
+        hal.console->printf("AP_Logger_Block: rebuilding log index\n");
+        rebuild_index();
+        return;
+    }
+    index_page_written = last_log != 0;
+    index_valid = true;
+}
+
+// erase the sectors holding the index
+void AP_Logger_Block::index_erase()
+{
+    for (uint32_t page = index_first_page(); page <= df_NumPages + df_PagePerBlock; page += df_PagePerSector) {
+        Sector4kErase(get_sector(page));
+    }
+    index_next_record = 0;
+}
+
+/*
+  rewrite the index from memory, searching the chip for the recent
+  logs first if the index is not valid
+ */
+void AP_Logger_Block::rebuild_index()
+{
+    if (index_num_records() == 0) {
+        return;
+    }
+
+    if (!index_valid) {
+        index_clear();
+        const uint16_t num_logs = get_num_logs();
+        const uint16_t last_log = find_last_log();
+        if (num_logs > 0 && last_log != 0xFFFF) {
+            const uint16_t count = MIN(num_logs, LOG_BLOCK_INDEX_LOGS);
+            for (uint16_t log_num = last_log + 1 - count; log_num <= last_log; log_num++) {
+                IndexEntry &e = index_entries[log_num % LOG_BLOCK_INDEX_LOGS];
+                e.log_num = log_num;
+                get_log_boundaries(log_num, e.start_page, e.end_page);
+            }
+            // the newest log ends at the last page written
+            index_entries[last_log % LOG_BLOCK_INDEX_LOGS].end_page = 0;
+            index_last_log = last_log;
+        }
+        index_last_page = find_last_page();
+        index_page_written = index_last_log != 0;
+    }
+
+    index_erase();
+    index_valid = true;
+    if (index_last_log == 0) {
+        return;
+    }
+    const uint16_t count = MIN(index_last_log, LOG_BLOCK_INDEX_LOGS);
+    for (uint16_t log_num = index_last_log + 1 - count; log_num <= index_last_log; log_num++) {
+        const IndexEntry &e = index_entries[log_num % LOG_BLOCK_INDEX_LOGS];
+        if (e.log_num != log_num) {
+            continue;
+        }
+        if (!index_write_record(IndexRecordType::START, log_num, e.start_page, e.time_utc)) {
+            return;
+        }
+        if (e.end_page != 0 &&
+            !index_write_record(IndexRecordType::END, log_num, e.end_page, e.time_utc)) {
+            return;
+        }
+    }
+}
+
+// add a record to the index
+bool AP_Logger_Block::index_write_record(IndexRecordType type, uint16_t log_num, uint32_t page, uint32_t time_utc)
+{
+    if (index_next_record >= index_num_records()) {
+        // full, search the chip until Prep() rebuilds the index
+        index_valid = false;
+        return false;
+    }
+
+    IndexRecord rec;
+    rec.log_num = log_num;
+    rec.type = type;
+    rec.crc = 0;
+    rec.page = page;
+    rec.time_utc = time_utc;
+    rec.crc = crc_crc8((const uint8_t *)&rec, sizeof(rec));
+
+    // records are added to a page one at a time, rewriting the
+    // existing records unchanged and programming an erased slot
+    const uint16_t records_per_page = df_PageSize / sizeof(IndexRecord);
+    const uint32_t page_adr = index_first_page() + index_next_record / records_per_page;
+    PageToBuffer(page_adr);
+    memcpy(&buffer[(index_next_record % records_per_page) * sizeof(rec)], &rec, sizeof(rec));
+    BufferToPage(page_adr);
+    df_Read_PageAdr = 0;
+    index_next_record++;
+    return true;
+}
+
+// record the start of a log, ending the previous log if it was not stopped
+void AP_Logger_Block::index_log_started(uint16_t log_num, uint32_t start_page)
+{
+    if (!index_valid) {
+        return;
+    }
+
+    if (index_last_log != 0 && index_last_log + 1 == log_num) {
+        IndexEntry &prev = index_entries[index_last_log % LOG_BLOCK_INDEX_LOGS];
+        if (prev.log_num == index_last_log && prev.end_page == 0) {
+            prev.end_page = (start_page == 1) ? df_NumPages : start_page - 1;
+            if (!index_write_record(IndexRecordType::END, prev.log_num, prev.end_page, 0)) {
+                return;
+            }
+        }
+    }
+
+    IndexEntry &e = index_entries[log_num % LOG_BLOCK_INDEX_LOGS];
+    e.log_num = log_num;
+    e.start_page = start_page;
+    e.end_page = 0;
+    e.time_utc = utc_seconds();
+    index_last_log = log_num;
+    index_page_written = false;
+    if (index_first_log == 0xFFFF) {
+        // the chip was empty
+        index_first_log = 0;
+    }
+    index_write_record(IndexRecordType::START, log_num, start_page, e.time_utc);
+}
+
+// record the end of the newest log
+void AP_Logger_Block::index_log_stopped()
+{
+    if (!index_valid || index_last_log == 0 || !index_page_written) {
+        return;
+    }
+    IndexEntry &e = index_entries[index_last_log % LOG_BLOCK_INDEX_LOGS];
+    if (e.log_num != index_last_log || e.end_page != 0) {
+        return;
+    }
+    e.end_page = index_last_page;
+    const uint32_t time_utc = utc_seconds();
+    if (time_utc != 0) {
+        e.time_utc = time_utc;
+    }
+    index_write_record(IndexRecordType::END, e.log_num, e.end_page, e.time_utc);
+}
+
+// number of the oldest log still on the chip, 0xFFFF if the chip is empty
+uint16_t AP_Logger_Block::index_first_log_number()
+{
+    if (index_first_log != 0) {
+        return index_first_log;
+    }
+
+    PageHeader ph;
+    read_page_header(df_NumPages, ph);
+    uint32_t page = 1;
+    if (ph.FileNumber != 0xFFFF) {
+        // wrapped, the oldest data is in the first written block after
+        // the block being written
+        page = (get_block(index_last_page) + 1) * df_PagePerBlock + 1;
+        for (uint8_t i=0; i<2; i++) {
+            if (page > df_NumPages) {
+                page = 1;
+            }
+            read_page_header(page, ph);
+            if (ph.FileNumber != 0xFFFF) {
+                break;
+            }
+            page += df_PagePerBlock;
+        }
+    } else {
+        read_page_header(page, ph);
+    }
+    index_first_log = ph.FileNumber;
+    index_first_log_page = page;
+    return index_first_log;
+}
+
+// look up the boundaries and time of a log in the index
+bool AP_Logger_Block::index_lookup(uint16_t log_num, uint32_t &start_page, uint32_t &end_page, uint32_t &time_utc)
+{
+    if (!index_valid || log_num == 0 || log_num > index_last_log) {
+        return false;
+    }
+    const IndexEntry &e = index_entries[log_num % LOG_BLOCK_INDEX_LOGS];
+    if (e.log_num != log_num) {
+        return false;
+    }
+
+    start_page = e.start_page;
+    end_page = e.end_page;
+    if (end_page == 0) {
+        if (log_num != index_last_log) {
+            return false;
+        }
+        end_page = index_page_written ? index_last_page : start_page;
+    }
+
+    // the start of the oldest log is lost once the chip wraps
+    if (log_num == index_first_log_number() && index_first_log_page != 1) {
+        PageHeader ph;
+        read_page_header(start_page, ph);
+        if (ph.FileNumber != log_num || ph.FilePage != 1) {
+            start_page = index_first_log_page;
+        }
+    }
+    time_utc = e.time_utc;
+    return true;
+}
+
+/*
+  read pages into dest. Backends which can read several pages in one
+  transfer override this
+ */
+void AP_Logger_Block::ReadPages(uint32_t PageAdr, uint16_t NumPages, uint8_t *dest)
+{
+    for (uint16_t i=0; i<NumPages; i++) {
+        PageToBuffer(PageAdr + i);
+        memcpy(&dest[i * df_PageSize], buffer, df_PageSize);
+    }
+    df_Read_PageAdr = 0;
+}
+
+/*
+  copy len bytes of log data starting offset bytes into the data of
+  page, reading LOG_BLOCK_READ_PAGES pages at a time. Returns false if
+  the cache can't be used
+ */
+bool AP_Logger_Block::read_cached(uint32_t page, uint32_t offset, uint16_t len, uint8_t *data)
+{
+    if (erase_started) {
+        return false;
+    }
+    if (read_cache == nullptr) {
+        if (hal.util->get_soft_armed()) {
+            return false;
+        }
+        read_cache = (uint8_t *)hal.util->malloc_type(LOG_BLOCK_READ_PAGES * df_PageSize, AP_HAL::Util::MEM_DMA_SAFE, AP_HAL::Util::MEM_TAG_LOGGER);
+        if (read_cache == nullptr) {
+            return false;
+        }
+        read_cache_pages = 0;
+    }
+
+    const uint16_t data_page_size = df_PageSize - sizeof(struct PageHeader);
+    while (len > 0) {
+        if (read_cache_pages == 0 || page < read_cache_page || page >= read_cache_page + read_cache_pages) {
+            read_cache_pages = MIN(uint32_t(LOG_BLOCK_READ_PAGES), df_NumPages + 1 - page);
+            read_cache_page = page;
+            ReadPages(read_cache_page, read_cache_pages, read_cache);
+        }
+        const uint16_t n = MIN(uint32_t(len), data_page_size - offset);
+        memcpy(data, &read_cache[(page - read_cache_page) * df_PageSize + sizeof(struct PageHeader) + offset], n);
+        data += n;
+        len -= n;
+        offset += n;
+        if (offset == data_page_size) {
+            offset = 0;
+            page++;
+            if (page > df_NumPages) {
+                page = 1;
+            }
+        }
+    }
+    return true;
+}
+
+// release the download read cache
+void AP_Logger_Block::free_read_cache()
+{
+    if (read_cache != nullptr) {
+        hal.util->free_type(read_cache, LOG_BLOCK_READ_PAGES * df_PageSize, AP_HAL::Util::MEM_DMA_SAFE, AP_HAL::Util::MEM_TAG_LOGGER);
+        read_cache = nullptr;
+    }
+    read_cache_pages = 0;
+}
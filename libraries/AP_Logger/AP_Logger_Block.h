@@ -27,7 +27,7 @@ public:
     uint16_t get_num_logs() override;
     uint16_t start_new_log(void) override;
     uint32_t bufferspace_available() override;
-    void stop_logging(void) override { log_write_started = false; }
+    void stop_logging(void) override;
     bool logging_enabled() const override { return true; }
     bool logging_failed() const override { return false; }
     bool logging_started(void) const override { return log_write_started; }
@@ -37,6 +37,8 @@ protected:
     bool _WritePrioritisedBlock(const void *pBuffer, uint16_t size, bool is_critical) override;
 
 private:
+    friend class AP_Logger_Block_Test;
+
     /*
       functions implemented by the board specific backends
      */
@@ -46,12 +48,60 @@ private:
     virtual void Sector4kErase(uint32_t SectorAdr) = 0;
     virtual void StartErase() = 0;
     virtual bool InErase() = 0;
+    virtual void ReadPages(uint32_t PageAdr, uint16_t NumPages, uint8_t *dest);
 
     struct PACKED PageHeader {
         uint32_t FilePage;
         uint16_t FileNumber;
     };
 
+    /*
+      the index of log boundaries is a list of records in the reserved
+      block after the format version sector. A start record is added
+      when a log starts and an end record when it stops, so the
+      boundaries of recent logs are known without searching the chip
+     */
+    enum class IndexRecordType : uint8_t {
+        START = 1,
+        END = 2,
+    };
+
+    struct PACKED IndexRecord {
+        uint16_t log_num;           // 0xFFFF in an unused slot
+        IndexRecordType type;
+        uint8_t crc;                // crc8 of the record with this field zero
+        uint32_t page;              // first page of the log for a start record, last page for an end record
+        uint32_t time_utc;          // UTC seconds, zero if unknown
+    };
+
+    struct IndexEntry {
+        uint16_t log_num;
+        uint32_t start_page;
+        uint32_t end_page;          // zero while unknown
+        uint32_t time_utc;
+    };
+
+    // recent logs, indexed by log number modulo LOG_BLOCK_INDEX_LOGS
+    IndexEntry *index_entries;
+    // true once the index has been loaded and matches the chip
+    bool index_valid;
+    // next unused record slot
+    uint32_t index_next_record;
+    // number of the newest log, zero if there are no logs
+    uint16_t index_last_log;
+    // last page written, zero if unknown
+    uint32_t index_last_page;
+    // true once a page of the newest log has been written
+    bool index_page_written;
+    // number and first page of the oldest log still on the chip, zero if unknown
+    uint16_t index_first_log;
+    uint32_t index_first_log_page;
+
+    // pages read ahead for log downloads
+    uint8_t *read_cache;
+    uint32_t read_cache_page;
+    uint16_t read_cache_pages;
+
     HAL_Semaphore_Recursive sem;
     ByteBuffer writebuf;
 
@@ -80,6 +130,25 @@ private:
     bool NeedErase(void);
     void validate_log_structure();
 
+    // log index
+    uint32_t index_first_page() const { return df_NumPages + 1 + df_PagePerSector; }
+    uint32_t index_num_records() const;
+    void index_clear();
+    void load_index();
+    void rebuild_index();
+    void index_erase();
+    void read_page_header(uint32_t PageAdr, PageHeader &ph);
+    bool index_write_record(IndexRecordType type, uint16_t log_num, uint32_t page, uint32_t time_utc);
+    void index_log_started(uint16_t log_num, uint32_t start_page);
+    void index_log_stopped();
+    bool index_lookup(uint16_t log_num, uint32_t &start_page, uint32_t &end_page, uint32_t &time_utc);
+    uint16_t index_first_log_number();
+    uint32_t utc_seconds() const;
+
+    // read log data through read_cache
+    bool read_cached(uint32_t page, uint32_t offset, uint16_t len, uint8_t *data);
+    void free_read_cache();
+
     // internal high level functions
     int16_t get_log_data_raw(uint16_t log_num, uint32_t page, uint32_t offset, uint16_t len, uint8_t *data) WARN_IF_UNUSED;
     void StartRead(uint32_t PageAdr);
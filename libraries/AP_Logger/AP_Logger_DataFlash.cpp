@@ -211,7 +211,7 @@ void AP_Logger_DataFlash::send_command_addr(uint8_t command, uint32_t PageAdr)
 
 void AP_Logger_DataFlash::PageToBuffer(uint32_t pageNum)
 {
-    if (pageNum == 0 || pageNum > df_NumPages+1) {
+    if (pageNum == 0 || pageNum > df_NumPages+df_PagePerBlock) {
         printf("Invalid page read %u\n", pageNum);
         memset(buffer, 0xFF, df_PageSize);
         return;
@@ -227,9 +227,30 @@ void AP_Logger_DataFlash::PageToBuffer(uint32_t pageNum)
     dev->set_chip_select(false);
 }
 
+/*
+  read consecutive pages in one transfer
+*/
+void AP_Logger_DataFlash::ReadPages(uint32_t pageNum, uint16_t numPages, uint8_t *dest)
+{
+    if (pageNum == 0 || pageNum + numPages - 1 > df_NumPages+df_PagePerBlock) {
+        printf("Invalid page read %u\n", pageNum);
+        memset(dest, 0xFF, numPages * df_PageSize);
+        return;
+    }
+    WaitReady();
+
+    uint32_t PageAdr = (pageNum-1) * df_PageSize;
+
+    WITH_SEMAPHORE(dev_sem);
+    dev->set_chip_select(true);
+    send_command_addr(JEDEC_READ_DATA, PageAdr);
+    dev->transfer(NULL, 0, dest, numPages * df_PageSize);
+    dev->set_chip_select(false);
+}
+
 void AP_Logger_DataFlash::BufferToPage(uint32_t pageNum)
 {
-    if (pageNum == 0 || pageNum > df_NumPages+1) {
+    if (pageNum == 0 || pageNum > df_NumPages+df_PagePerBlock) {
         printf("Invalid page write %u\n", pageNum);
         return;
     }
@@ -20,6 +20,7 @@ public:
 private:
     void              BufferToPage(uint32_t PageAdr) override;
     void              PageToBuffer(uint32_t PageAdr) override;
+    void              ReadPages(uint32_t PageAdr, uint16_t NumPages, uint8_t *dest) override;
     void              SectorErase(uint32_t SectorAdr) override;
     void              Sector4kErase(uint32_t SectorAdr) override;
     void              StartErase() override;
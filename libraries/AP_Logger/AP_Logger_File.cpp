@@ -495,7 +495,19 @@ bool AP_Logger_File::_WritePrioritisedBlock(const void *pBuffer, uint16_t size,
     if (!semaphore.take(1)) {
         return false;
     }
-        
+
+    // delta encode against the previous message of the same type
+    const uint8_t *data = (const uint8_t *)pBuffer;
+    uint16_t data_size = size;
+    uint8_t encoded[UINT8_MAX];
+    if (_delta_enabled && size <= sizeof(encoded)) {
+        const uint16_t encoded_size = _delta.encode(data, size, encoded);
+        if (encoded_size != 0) {
+            data = encoded;
+            data_size = encoded_size;
+        }
+    }
+
     uint32_t space = _writebuf.space();
 
     if (_writing_startup_messages &&
@@ -523,15 +535,19 @@ bool AP_Logger_File::_WritePrioritisedBlock(const void *pBuffer, uint16_t size,
     }
 
     // if no room for entire message - drop it:
-    if (space < size) {
+    if (space < data_size) {
         hal.util->perf_count(_perf_overruns);
         _dropped++;
         semaphore.give();
         return false;
     }
 
-    _writebuf.write((uint8_t*)pBuffer, size);
-    df_stats_gather(size);
+    _writebuf.write(data, data_size);
+    df_stats_gather(data_size);
+    if (_delta_enabled) {
+        // the message is now the reference for the next of its type
+        _delta.update((const uint8_t *)pBuffer, size);
+    }
     semaphore.give();
     return true;
 }
@@ -813,6 +829,13 @@ uint16_t AP_Logger_File::start_new_log(void)
 {
     stop_logging();
 
+    {
+        // formats are written again at the start of each log
+        WITH_SEMAPHORE(semaphore);
+        _delta.reset();
+        _delta_enabled = _front._params.file_delta;
+    }
+
     start_new_log_reset_variables();
 
     if (_open_error) {
@@ -16,6 +16,7 @@
 
 #include <AP_HAL/utility/RingBuffer.h>
 #include "AP_Logger_Backend.h"
+#include "LogDelta.h"
 
 class AP_Logger_File : public AP_Logger_Backend
 {
@@ -119,6 +120,10 @@ private:
     const uint16_t _writebuf_chunk;
     uint32_t _last_write_time;
 
+    // delta encoding of messages, protected by semaphore
+    LogDeltaCodec _delta;
+    bool _delta_enabled;
+
     /* construct a file name given a log number. Caller must free. */
     char *_log_file_name(const uint16_t log_num) const;
     char *_log_file_name_long(const uint16_t log_num) const;
@@ -18,6 +18,7 @@
 
 #define DF_PAGE_SIZE 256UL
 #define DF_PAGE_PER_SECTOR 16 // 4k sectors
+#define DF_PAGE_PER_BLOCK 256 // 64k blocks
 #define DF_NUM_PAGES 65536UL
 
 #define ERASE_TIME_MS 10000
@@ -40,7 +41,7 @@ void AP_Logger_SITL::Init()
 
     df_PageSize = DF_PAGE_SIZE;
     df_PagePerSector = DF_PAGE_PER_SECTOR;
-    df_PagePerBlock = DF_PAGE_PER_SECTOR;
+    df_PagePerBlock = DF_PAGE_PER_BLOCK;
     df_NumPages = DF_NUM_PAGES;
 
     AP_Logger_Block::Init();
@@ -53,7 +54,7 @@ bool AP_Logger_SITL::CardInserted(void) const
 
 void AP_Logger_SITL::PageToBuffer(uint32_t PageAdr)
 {
-    assert(PageAdr>0 && PageAdr <= df_NumPages+1);
+    assert(PageAdr>0 && PageAdr <= df_NumPages+df_PagePerBlock);
     if (pread(flash_fd, buffer, DF_PAGE_SIZE, (PageAdr-1)*DF_PAGE_SIZE) != DF_PAGE_SIZE) {
         printf("Failed flash read");
     }
@@ -61,30 +62,41 @@ void AP_Logger_SITL::PageToBuffer(uint32_t PageAdr)
 
 void AP_Logger_SITL::BufferToPage(uint32_t PageAdr)
 {
-    assert(PageAdr>0 && PageAdr <= df_NumPages+1);
+    assert(PageAdr>0 && PageAdr <= df_NumPages+df_PagePerBlock);
     if (pwrite(flash_fd, buffer, DF_PAGE_SIZE, (PageAdr-1)*DF_PAGE_SIZE) != DF_PAGE_SIZE) {
         printf("Failed flash write");
     }
 }
 
-void AP_Logger_SITL::SectorErase(uint32_t SectorAdr)
+void AP_Logger_SITL::ReadPages(uint32_t PageAdr, uint16_t NumPages, uint8_t *dest)
 {
-    uint8_t fill[DF_PAGE_SIZE*DF_PAGE_PER_SECTOR];
-    memset(fill, 0xFF, sizeof(fill));
-    if (pwrite(flash_fd, fill, sizeof(fill), SectorAdr*DF_PAGE_PER_SECTOR*DF_PAGE_SIZE) != sizeof(fill)) {
-        printf("Failed sector erase");
+    assert(PageAdr>0 && PageAdr+NumPages-1 <= df_NumPages+df_PagePerBlock);
+    const ssize_t len = DF_PAGE_SIZE*NumPages;
+    if (pread(flash_fd, dest, len, (PageAdr-1)*DF_PAGE_SIZE) != len) {
+        printf("Failed flash read");
+    }
+}
+
+void AP_Logger_SITL::SectorErase(uint32_t BlockAdr)
+{
+    for (uint32_t i=0; i<DF_PAGE_PER_BLOCK/DF_PAGE_PER_SECTOR; i++) {
+        Sector4kErase(BlockAdr*(DF_PAGE_PER_BLOCK/DF_PAGE_PER_SECTOR) + i);
     }
 }
 
 void AP_Logger_SITL::Sector4kErase(uint32_t SectorAdr)
 {
-    SectorErase(SectorAdr);
+    uint8_t fill[DF_PAGE_SIZE*DF_PAGE_PER_SECTOR];
+    memset(fill, 0xFF, sizeof(fill));
+    if (pwrite(flash_fd, fill, sizeof(fill), SectorAdr*DF_PAGE_PER_SECTOR*DF_PAGE_SIZE) != sizeof(fill)) {
+        printf("Failed sector erase");
+    }
 }
 
 void AP_Logger_SITL::StartErase()
 {
     for (uint32_t i=0; i<DF_NUM_PAGES/DF_PAGE_PER_SECTOR; i++) {
-        SectorErase(i);
+        Sector4kErase(i);
     }
     erase_started_ms = AP_HAL::millis();
 }
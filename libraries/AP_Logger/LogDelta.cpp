@@ -0,0 +1,314 @@
+#include "LogDelta.h"
+
+#include <string.h>
+
+// how each field is encoded
+enum class DeltaFieldKind : uint8_t {
+    INTEGER,    // zigzag varint of the difference
+    FLOAT,      // varint of the bits xor'd with the previous bits
+    BYTES,      // unchanged flag followed by the field if changed
+};
+
+// size and kind of a format character as listed in LogStructure.h
+// returns false for unknown format characters
+static bool delta_field_info(char c, uint8_t &size, DeltaFieldKind &kind)
+{
+    kind = DeltaFieldKind::INTEGER;
+    switch (c) {
+    case 'b': case 'B': case 'M':
+        size = 1;
+        return true;
+    case 'h': case 'H': case 'c': case 'C':
+        size = 2;
+        return true;
+    case 'i': case 'I': case 'e': case 'E': case 'L':
+        size = 4;
+        return true;
+    case 'q': case 'Q':
+        size = 8;
+        return true;
+    case 'f':
+        size = 4;
+        kind = DeltaFieldKind::FLOAT;
+        return true;
+    case 'd':
+        size = 8;
+        kind = DeltaFieldKind::FLOAT;
+        return true;
+    case 'n':
+        size = 4;
+        kind = DeltaFieldKind::BYTES;
+        return true;
+    case 'N':
+        size = 16;
+        kind = DeltaFieldKind::BYTES;
+        return true;
+    case 'Z':
+    case 'a':
+        size = 64;
+        kind = DeltaFieldKind::BYTES;
+        return true;
+    }
+    return false;
+}
+
+// read a little endian field of size bytes
+static uint64_t delta_read_field(const uint8_t *p, uint8_t size)
+{
+    uint64_t v = 0;
+    for (uint8_t i=0; i<size; i++) {
+        v |= uint64_t(p[i]) << (8*i);
+    }
+    return v;
+}
+
+static void delta_write_field(uint8_t *p, uint8_t size, uint64_t v)
+{
+    for (uint8_t i=0; i<size; i++) {
+        p[i] = v >> (8*i);
+    }
+}
+
+// append v as a varint, returns false if it does not fit before end
+static bool delta_put_varint(uint8_t *&p, const uint8_t *end, uint64_t v)
+{
+    do {
+        if (p >= end) {
+            return false;
+        }
+        const uint8_t b = v & 0x7F;
+        v >>= 7;
+        *p++ = b | (v ? 0x80 : 0);
+    } while (v);
+    return true;
+}
+
+// read a varint, returns false if it runs past end
+static bool delta_get_varint(const uint8_t *&p, const uint8_t *end, uint64_t &v)
+{
+    v = 0;
+    for (uint8_t shift=0; shift<64; shift+=7) {
+        if (p >= end) {
+            return false;
+        }
+        const uint8_t b = *p++;
+        v |= uint64_t(b & 0x7F) << shift;
+        if ((b & 0x80) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// sign extend the low size bytes of v
+static int64_t delta_sign_extend(uint64_t v, uint8_t size)
+{
+    const uint8_t shift = 64 - 8*size;
+    return int64_t(v << shift) >> shift;
+}
+
+// forget all formats and reference messages
+void LogDeltaCodec::reset()
+{
+    for (Type *&t : _types) {
+        if (t != nullptr) {
+            delete[] t->reference;
+            delete t;
+            t = nullptr;
+        }
+    }
+}
+
+// returns the full length of messages of type msg_type or zero if its format is unknown
+uint8_t LogDeltaCodec::message_length(uint8_t msg_type) const
+{
+    const Type *t = _types[msg_type];
+    return (t == nullptr) ? 0 : t->length;
+}
+
+// update the state with a message which has been written or read
+void LogDeltaCodec::update(const uint8_t *msg, uint16_t size)
+{
+    if (size < 3) {
+        return;
+    }
+    if (msg[2] == LOG_FORMAT_MSG) {
+        if (size != sizeof(log_Format)) {
+            return;
+        }
+        log_Format fmt;
+        memcpy(&fmt, msg, sizeof(fmt));
+
+        // a new format replaces any previous format for the type
+        Type *&t = _types[fmt.type];
+        if (t != nullptr) {
+            delete[] t->reference;
+            delete t;
+            t = nullptr;
+        }
+
+        // only track types whose format describes their length
+        uint16_t length = sizeof(log_Format::head1) + sizeof(log_Format::head2) + sizeof(log_Format::msgid);
+        for (uint8_t i=0; i<sizeof(fmt.format) && fmt.format[i] != 0; i++) {
+            uint8_t field_size;
+            DeltaFieldKind kind;
+            if (!delta_field_info(fmt.format[i], field_size, kind)) {
+                return;
+            }
+            length += field_size;
+        }
+        if ((length != fmt.length) || (fmt.type == LOG_FORMAT_MSG)) {
+            return;
+        }
+
+        t = new Type;
+        if (t == nullptr) {
+            return;
+        }
+        t->reference = new uint8_t[length];
+        if (t->reference == nullptr) {
+            delete t;
+            t = nullptr;
+            return;
+        }
+        t->length = length;
+        memcpy(t->format, fmt.format, sizeof(t->format));
+        t->have_reference = false;
+        return;
+    }
+
+    Type *t = _types[msg[2]];
+    if ((t == nullptr) || (t->length != size)) {
+        return;
+    }
+    memcpy(t->reference, msg, size);
+    t->have_reference = true;
+}
+
+// delta encode a message against the previous message of the same type
+uint16_t LogDeltaCodec::encode(const uint8_t *msg, uint16_t size, uint8_t *out) const
+{
+    if ((size < 3) || (msg[0] != HEAD_BYTE1) || (msg[1] != HEAD_BYTE2)) {
+        return 0;
+    }
+    const Type *t = _types[msg[2]];
+    if ((t == nullptr) || !t->have_reference || (t->length != size)) {
+        return 0;
+    }
+
+    // the encoded message must be shorter than the original and its length fit in the header
+    const uint16_t max_encoded_size = (size - 1 < LOG_DELTA_HEADER_LEN + UINT8_MAX) ? size - 1 : LOG_DELTA_HEADER_LEN + UINT8_MAX;
+    const uint8_t *end = out + max_encoded_size;
+    uint8_t *p = out + LOG_DELTA_HEADER_LEN;
+    uint16_t ofs = 3;
+    for (uint8_t i=0; i<sizeof(t->format) && t->format[i] != 0; i++) {
+        uint8_t field_size;
+        DeltaFieldKind kind;
+        delta_field_info(t->format[i], field_size, kind);
+        const uint8_t *cur = &msg[ofs];
+        const uint8_t *prev = &t->reference[ofs];
+        ofs += field_size;
+
+        switch (kind) {
+        case DeltaFieldKind::INTEGER: {
+            const int64_t delta = delta_sign_extend(delta_read_field(cur, field_size) - delta_read_field(prev, field_size), field_size);
+            const uint64_t zigzag = (uint64_t(delta) << 1) ^ uint64_t(delta >> 63);
+            if (!delta_put_varint(p, end, zigzag)) {
+                return 0;
+            }
+            break;
+        }
+        case DeltaFieldKind::FLOAT:
+            if (!delta_put_varint(p, end, delta_read_field(cur, field_size) ^ delta_read_field(prev, field_size))) {
+                return 0;
+            }
+            break;
+        case DeltaFieldKind::BYTES:
+            if (p >= end) {
+                return 0;
+            }
+            if (memcmp(cur, prev, field_size) == 0) {
+                *p++ = 0;
+                break;
+            }
+            *p++ = 1;
+            if (end - p < field_size) {
+                return 0;
+            }
+            memcpy(p, cur, field_size);
+            p += field_size;
+            break;
+        }
+    }
+
+    out[0] = HEAD_BYTE1;
+    out[1] = HEAD_BYTE2_DELTA;
+    out[2] = msg[2];
+    out[3] = (p - out) - LOG_DELTA_HEADER_LEN;
+    return p - out;
+}
+
+// decode a delta encoded message against the previous message of the same type
+uint16_t LogDeltaCodec::decode(const uint8_t *encoded, uint16_t encoded_size, uint8_t *out) const
+{
+    if ((encoded_size < LOG_DELTA_HEADER_LEN) ||
+        (encoded[0] != HEAD_BYTE1) || (encoded[1] != HEAD_BYTE2_DELTA) ||
+        (encoded[3] != encoded_size - LOG_DELTA_HEADER_LEN)) {
+        return 0;
+    }
+    const Type *t = _types[encoded[2]];
+    if ((t == nullptr) || !t->have_reference) {
+        return 0;
+    }
+
+    const uint8_t *p = encoded + LOG_DELTA_HEADER_LEN;
+    const uint8_t *end = encoded + encoded_size;
+    out[0] = HEAD_BYTE1;
+    out[1] = HEAD_BYTE2;
+    out[2] = encoded[2];
+    uint16_t ofs = 3;
+    for (uint8_t i=0; i<sizeof(t->format) && t->format[i] != 0; i++) {
+        uint8_t field_size;
+        DeltaFieldKind kind;
+        delta_field_info(t->format[i], field_size, kind);
+        const uint8_t *prev = &t->reference[ofs];
+        uint8_t *cur = &out[ofs];
+        ofs += field_size;
+
+        uint64_t v;
+        switch (kind) {
+        case DeltaFieldKind::INTEGER: {
+            if (!delta_get_varint(p, end, v)) {
+                return 0;
+            }
+            const uint64_t delta = (v >> 1) ^ (~(v & 1) + 1);
+            delta_write_field(cur, field_size, delta_read_field(prev, field_size) + delta);
+            break;
+        }
+        case DeltaFieldKind::FLOAT:
+            if (!delta_get_varint(p, end, v)) {
+                return 0;
+            }
+            delta_write_field(cur, field_size, delta_read_field(prev, field_size) ^ v);
+            break;
+        case DeltaFieldKind::BYTES:
+            if (p >= end) {
+                return 0;
+            }
+            if (*p++ == 0) {
+                memcpy(cur, prev, field_size);
+                break;
+            }
+            if (end - p < field_size) {
+                return 0;
+            }
+            memcpy(cur, p, field_size);
+            p += field_size;
+            break;
+        }
+    }
+    if (p != end) {
+        return 0;
+    }
+    return t->length;
+}
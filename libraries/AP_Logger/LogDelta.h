@@ -0,0 +1,69 @@
+#pragma once
+
+/*
+  delta encoding of log messages
+
+  A delta encoded message starts with HEAD_BYTE1, HEAD_BYTE2_DELTA,
+  the message type and the length of the encoded fields which follow.
+  Each field is encoded against the same field of the previous message
+  of the same type:
+
+   - integers are the zigzag varint of the difference
+   - floats and doubles are the varint of their bits xor'd with the previous bits
+   - strings and arrays are a zero byte if unchanged, otherwise a one
+     byte followed by the field
+
+  so a timestamp advancing by a few milliseconds takes two bytes and an
+  unchanged field takes one.
+
+  Formats are learnt from the FMT messages passed to update(), so an
+  encoder and a decoder which see the same stream of messages hold the
+  same state.  Messages which are not delta encoded, including FMT
+  messages and the first message of each type, are written unchanged
+  and become the reference for the next message of their type.
+ */
+
+#include <AP_Common/AP_Common.h>
+#include "LogStructure.h"
+
+#define HEAD_BYTE2_DELTA 0x96   // Decimal 150, replaces HEAD_BYTE2 in delta encoded messages
+#define LOG_DELTA_HEADER_LEN 4  // header bytes of a delta encoded message, including the encoded length
+
+class LogDeltaCodec {
+public:
+    LogDeltaCodec() {}
+    ~LogDeltaCodec() { reset(); }
+
+    /* Do not allow copies */
+    LogDeltaCodec(const LogDeltaCodec &other) = delete;
+    LogDeltaCodec &operator=(const LogDeltaCodec&) = delete;
+
+    // forget all formats and reference messages, e.g. at the start of a new log
+    void reset();
+
+    // delta encode the message msg of size bytes into out, which must hold at least size bytes
+    // returns the encoded size or zero if the message should be written unchanged
+    uint16_t encode(const uint8_t *msg, uint16_t size, uint8_t *out) const;
+
+    // decode the delta encoded message in encoded of encoded_size bytes into out,
+    // which must hold the full length of the message
+    // returns the decoded size or zero if the message could not be decoded
+    uint16_t decode(const uint8_t *encoded, uint16_t encoded_size, uint8_t *out) const;
+
+    // update the state with a message which has been written or read,
+    // msg is the message as it was before encoding or after decoding
+    void update(const uint8_t *msg, uint16_t size);
+
+    // returns the full length of messages of type msg_type or zero if its format is unknown
+    uint8_t message_length(uint8_t msg_type) const;
+
+private:
+
+    struct Type {
+        uint8_t length;         // full length of the message including header
+        char format[16];        // format characters, not null terminated if all 16 are used
+        bool have_reference;    // true once a message of this type has been seen
+        uint8_t *reference;     // previous message of this type
+    };
+    Type *_types[256] {};
+};
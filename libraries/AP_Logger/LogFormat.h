@@ -0,0 +1,100 @@
+#pragma once
+
+/*
+  compile time support for messages written with AP_Logger::Write(MessageDef&, ...)
+
+  each format character maps to the type stored in the log so a
+  message's length can be calculated and its arguments packed without
+  parsing the format string at runtime.  Unknown format characters and
+  arguments which cannot be stored in the field's type without
+  narrowing (e.g. a double for 'f' or an int for 'B') fail to compile.
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <type_traits>
+#include <utility>
+
+// true if a U can be stored in a T without narrowing
+template <typename T, typename U, typename = void>
+struct log_fmt_converts : std::false_type {};
+template <typename T, typename U>
+struct log_fmt_converts<T, U, decltype(void(T{std::declval<U>()}))> : std::true_type {};
+
+// numeric fields are stored as their C type
+template <typename T>
+struct log_fmt_numeric {
+    static constexpr uint8_t size = sizeof(T);
+    template <typename U>
+    static void pack(uint8_t *dst, U value) {
+        static_assert(log_fmt_converts<T, U>::value, "log argument would be narrowed to its field's type");
+        const T v = value;
+        memcpy(dst, &v, sizeof(T));
+    }
+};
+
+// fixed length character fields, shorter strings are zero padded
+template <uint8_t N>
+struct log_fmt_chars {
+    static constexpr uint8_t size = N;
+    static void pack(uint8_t *dst, const char *value) {
+        for (uint8_t i=0; i<N; i++) {
+            dst[i] = value[i];
+            if (value[i] == '\0') {
+                memset(&dst[i], 0, N-i);
+                break;
+            }
+        }
+    }
+};
+
+// array of 32 int16_t
+struct log_fmt_int16_array {
+    static constexpr uint8_t size = sizeof(int16_t[32]);
+    static void pack(uint8_t *dst, const int16_t *value) { memcpy(dst, value, size); }
+};
+
+// format characters as listed in LogStructure.h
+template <char C> struct log_fmt_field;
+template <> struct log_fmt_field<'a'> : log_fmt_int16_array {};
+template <> struct log_fmt_field<'b'> : log_fmt_numeric<int8_t> {};
+template <> struct log_fmt_field<'c'> : log_fmt_numeric<int16_t> {};
+template <> struct log_fmt_field<'d'> : log_fmt_numeric<double> {};
+template <> struct log_fmt_field<'e'> : log_fmt_numeric<int32_t> {};
+template <> struct log_fmt_field<'f'> : log_fmt_numeric<float> {};
+template <> struct log_fmt_field<'h'> : log_fmt_numeric<int16_t> {};
+template <> struct log_fmt_field<'i'> : log_fmt_numeric<int32_t> {};
+template <> struct log_fmt_field<'n'> : log_fmt_chars<4> {};
+template <> struct log_fmt_field<'B'> : log_fmt_numeric<uint8_t> {};
+template <> struct log_fmt_field<'C'> : log_fmt_numeric<uint16_t> {};
+template <> struct log_fmt_field<'E'> : log_fmt_numeric<uint32_t> {};
+template <> struct log_fmt_field<'H'> : log_fmt_numeric<uint16_t> {};
+template <> struct log_fmt_field<'I'> : log_fmt_numeric<uint32_t> {};
+template <> struct log_fmt_field<'L'> : log_fmt_numeric<int32_t> {};
+template <> struct log_fmt_field<'M'> : log_fmt_numeric<uint8_t> {};
+template <> struct log_fmt_field<'N'> : log_fmt_chars<16> {};
+template <> struct log_fmt_field<'Z'> : log_fmt_chars<64> {};
+template <> struct log_fmt_field<'q'> : log_fmt_numeric<int64_t> {};
+template <> struct log_fmt_field<'Q'> : log_fmt_numeric<uint64_t> {};
+
+// total size of all fields, excluding the message header
+template <char... FMT> struct log_fmt_length;
+template <> struct log_fmt_length<> {
+    static constexpr uint16_t value = 0;
+};
+template <char C, char... FMT> struct log_fmt_length<C, FMT...> {
+    static constexpr uint16_t value = log_fmt_field<C>::size + log_fmt_length<FMT...>::value;
+};
+
+// pack one argument per field into dst
+template <char... FMT> struct log_fmt_packer;
+template <> struct log_fmt_packer<> {
+    static void pack(uint8_t *) {}
+};
+template <char C, char... FMT> struct log_fmt_packer<C, FMT...> {
+    template <typename T, typename... Args>
+    static void pack(uint8_t *dst, T value, Args... args) {
+        log_fmt_field<C>::pack(dst, value);
+        log_fmt_packer<FMT...>::pack(dst + log_fmt_field<C>::size, args...);
+    }
+};
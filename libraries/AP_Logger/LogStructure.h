@@ -1163,6 +1163,16 @@ struct PACKED log_Performance {
     uint32_t extra_loop_us;
 };
 
+struct PACKED log_MemTag {
+    LOG_PACKET_HEADER;
+    uint64_t time_us;
+    uint8_t tag;
+    uint32_t current;
+    uint32_t high_water;
+    uint32_t count;
+    uint32_t failures;
+};
+
 struct PACKED log_SRTL {
     LOG_PACKET_HEADER;
     uint64_t time_us;
@@ -1419,7 +1429,9 @@ struct PACKED log_Arm_Disarm {
     { LOG_OA_BENDYRULER_MSG, sizeof(log_OABendyRuler), \
       "OABR","QBHHfLLLL","TimeUS,Active,DesYaw,Yaw,Mar,DLat,DLng,OALat,OALng", "sbddmDUDU", "F----GGGG" }, \
     { LOG_OA_DIJKSTRA_MSG, sizeof(log_OADijkstra), \
-      "OADJ","QBBBBLLLL","TimeUS,State,Err,CurrPoint,TotPoints,DLat,DLng,OALat,OALng", "sbbbbDUDU", "F----GGGG" }
+      "OADJ","QBBBBLLLL","TimeUS,State,Err,CurrPoint,TotPoints,DLat,DLng,OALat,OALng", "sbbbbDUDU", "F----GGGG" }, \
+    { LOG_MEM_TAG_MSG, sizeof(log_MemTag), \
+      "MEMT","QBIIII","TimeUS,Tag,Cur,Max,Cnt,Fail", "s#bb--", "F-00--" }
 
 // messages for more advanced boards
 #define LOG_EXTRA_STRUCTURES \
@@ -1800,6 +1812,7 @@ enum LogMessages : uint8_t {
     LOG_ARM_DISARM_MSG,
     LOG_OA_BENDYRULER_MSG,
     LOG_OA_DIJKSTRA_MSG,
+    LOG_MEM_TAG_MSG,
 
     _LOG_LAST_MSG_
 };
@@ -0,0 +1,185 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_Math/AP_Math.h>
+#include <AP_Logger/LogDelta.h>
+
+/*
+  compression ratio and cost of delta encoding for a few message types
+  with synthetic data shaped like a vehicle's.  The ratio counter is
+  the raw size over the encoded size, reported as the label.
+ */
+
+static void delta_add_format(LogDeltaCodec &codec, uint8_t type, uint8_t length, const char *name, const char *format)
+{
+    log_Format fmt {};
+    fmt.head1 = HEAD_BYTE1;
+    fmt.head2 = HEAD_BYTE2;
+    fmt.msgid = LOG_FORMAT_MSG;
+    fmt.type = type;
+    fmt.length = length;
+    strncpy(fmt.name, name, sizeof(fmt.name));
+    strncpy(fmt.format, format, sizeof(fmt.format));
+    codec.update((const uint8_t *)&fmt, sizeof(fmt));
+}
+
+// fast changing sensor data
+static void delta_fill(log_IMU &pkt, uint32_t i)
+{
+    pkt.time_us = 1000000 + i * 2500ULL;
+    pkt.gyro_x = sinf(i * 0.01f) * 0.1f;
+    pkt.gyro_y = cosf(i * 0.01f) * 0.1f;
+    pkt.gyro_z = 0.001f * (i % 7);
+    pkt.accel_x = 0.05f * sinf(i * 0.1f);
+    pkt.accel_y = -0.02f;
+    pkt.accel_z = -9.8f + 0.01f * (i % 11);
+    pkt.temperature = 45.0f;
+    pkt.gyro_health = 1;
+    pkt.accel_health = 1;
+    pkt.gyro_rate = 1000;
+    pkt.accel_rate = 1000;
+}
+
+// integer attitude in centi-degrees
+static void delta_fill(log_Attitude &pkt, uint32_t i)
+{
+    pkt.time_us = 1000000 + i * 2500ULL + (i % 3);
+    pkt.control_roll = 500 * sinf(i * 0.01f);
+    pkt.roll = pkt.control_roll + (i % 5) - 2;
+    pkt.control_pitch = -300 * cosf(i * 0.01f);
+    pkt.pitch = pkt.control_pitch + (i % 3) - 1;
+    pkt.control_yaw = (i / 4) % 36000;
+    pkt.yaw = pkt.control_yaw;
+    pkt.error_rp = 10;
+    pkt.error_yaw = 20 + (i % 2);
+}
+
+// slowly changing battery state
+static void delta_fill(log_Current &pkt, uint32_t i)
+{
+    pkt.time_us = 1000000 + i * 100000ULL;
+    pkt.voltage = 16.8f - i * 0.0001f;
+    pkt.voltage_resting = 16.9f - i * 0.0001f;
+    pkt.current_amps = 10.0f + (i % 10) * 0.1f;
+    pkt.current_total = i * 0.3f;
+    pkt.consumed_wh = i * 0.005f;
+    pkt.temperature = 2500;
+    pkt.resistance = 0.02f;
+}
+
+#define DELTA_NUM_MESSAGES 1024
+
+template <typename T>
+static void delta_setup(LogDeltaCodec &codec, uint8_t type, const char *name, const char *format, T *pkts)
+{
+    delta_add_format(codec, type, sizeof(T), name, format);
+    for (uint32_t i=0; i<DELTA_NUM_MESSAGES; i++) {
+        T &pkt = pkts[i];
+        memset(&pkt, 0, sizeof(pkt));
+        pkt.head1 = HEAD_BYTE1;
+        pkt.head2 = HEAD_BYTE2;
+        pkt.msgid = type;
+        delta_fill(pkt, i);
+    }
+    codec.update((const uint8_t *)&pkts[0], sizeof(T));
+}
+
+template <typename T>
+static void delta_encode(benchmark::State& state, uint8_t type, const char *name, const char *format)
+{
+    LogDeltaCodec codec;
+    static T pkts[DELTA_NUM_MESSAGES];
+    delta_setup(codec, type, name, format, pkts);
+
+    uint8_t encoded[sizeof(T)];
+    uint32_t i = 1;
+    uint64_t raw_bytes = 0;
+    uint64_t encoded_bytes = 0;
+    while (state.KeepRunning()) {
+        const T &pkt = pkts[i];
+        uint16_t size = codec.encode((const uint8_t *)&pkt, sizeof(T), encoded);
+        gbenchmark_escape(encoded);
+        codec.update((const uint8_t *)&pkt, sizeof(T));
+        raw_bytes += sizeof(T);
+        encoded_bytes += (size == 0) ? sizeof(T) : size;
+        i = (i + 1) % DELTA_NUM_MESSAGES;
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(raw_bytes);
+    char label[32];
+    snprintf(label, sizeof(label), "ratio %.2f", encoded_bytes ? double(raw_bytes) / encoded_bytes : 0.0);
+    state.SetLabel(label);
+}
+
+template <typename T>
+static void delta_decode(benchmark::State& state, uint8_t type, const char *name, const char *format)
+{
+    LogDeltaCodec encoder;
+    LogDeltaCodec decoder;
+    static T pkts[DELTA_NUM_MESSAGES];
+    delta_setup(encoder, type, name, format, pkts);
+    delta_setup(decoder, type, name, format, pkts);
+
+    // encode every message up front so the loop only measures decoding
+    static uint8_t encoded[DELTA_NUM_MESSAGES][sizeof(T)];
+    static uint16_t encoded_size[DELTA_NUM_MESSAGES];
+    for (uint32_t i=1; i<DELTA_NUM_MESSAGES; i++) {
+        encoded_size[i] = encoder.encode((const uint8_t *)&pkts[i], sizeof(T), encoded[i]);
+        encoder.update((const uint8_t *)&pkts[i], sizeof(T));
+    }
+
+    T decoded;
+    uint32_t i = 1;
+    while (state.KeepRunning()) {
+        if (encoded_size[i] == 0 ||
+            decoder.decode(encoded[i], encoded_size[i], (uint8_t *)&decoded) == 0) {
+            memcpy(&decoded, &pkts[i], sizeof(T));
+        }
+        gbenchmark_escape(&decoded);
+        decoder.update((const uint8_t *)&decoded, sizeof(T));
+        // wrap back to the message after the reference so the decoder stays in step
+        if (++i == DELTA_NUM_MESSAGES) {
+            i = 1;
+            decoder.update((const uint8_t *)&pkts[0], sizeof(T));
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+static void BM_LogDeltaEncodeIMU(benchmark::State& state)
+{
+    delta_encode<log_IMU>(state, LOG_IMU_MSG, "IMU", IMU_FMT);
+}
+
+static void BM_LogDeltaEncodeATT(benchmark::State& state)
+{
+    delta_encode<log_Attitude>(state, LOG_ATTITUDE_MSG, "ATT", "QccccCCCC");
+}
+
+static void BM_LogDeltaEncodeBAT(benchmark::State& state)
+{
+    delta_encode<log_Current>(state, LOG_CURRENT_MSG, "BAT", CURR_FMT);
+}
+
+static void BM_LogDeltaDecodeIMU(benchmark::State& state)
+{
+    delta_decode<log_IMU>(state, LOG_IMU_MSG, "IMU", IMU_FMT);
+}
+
+static void BM_LogDeltaDecodeATT(benchmark::State& state)
+{
+    delta_decode<log_Attitude>(state, LOG_ATTITUDE_MSG, "ATT", "QccccCCCC");
+}
+
+static void BM_LogDeltaDecodeBAT(benchmark::State& state)
+{
+    delta_decode<log_Current>(state, LOG_CURRENT_MSG, "BAT", CURR_FMT);
+}
+
+BENCHMARK(BM_LogDeltaEncodeIMU);
+BENCHMARK(BM_LogDeltaEncodeATT);
+BENCHMARK(BM_LogDeltaEncodeBAT);
+BENCHMARK(BM_LogDeltaDecodeIMU);
+BENCHMARK(BM_LogDeltaDecodeATT);
+BENCHMARK(BM_LogDeltaDecodeBAT);
+
+BENCHMARK_MAIN()
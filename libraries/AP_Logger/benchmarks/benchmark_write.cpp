@@ -0,0 +1,62 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_HAL/AP_HAL.h>
+#include <AP_Logger/AP_Logger.h>
+
+/*
+  compare the cost of writing a message with a runtime format string
+  against a MessageDef.  No backends are registered so this measures
+  the front end's message type lookup and argument handling, reported
+  as messages per second.
+ */
+
+static AP_Int32 log_bitmask;
+static AP_Logger logger{log_bitmask};
+
+// other messages registered ahead of the one being written, as on a vehicle
+static const char *other_names[] = {
+    "BM00", "BM01", "BM02", "BM03", "BM04", "BM05", "BM06", "BM07",
+    "BM08", "BM09", "BM10", "BM11", "BM12", "BM13", "BM14", "BM15",
+    "BM16", "BM17", "BM18", "BM19", "BM20", "BM21", "BM22", "BM23",
+};
+
+static void register_other_messages()
+{
+    for (const char *name : other_names) {
+        logger.Write(name, "TimeUS,V", "Qf", AP_HAL::micros64(), 1.0);
+    }
+}
+
+static void BM_LoggerWriteFormatString(benchmark::State& state)
+{
+    logger.Write("BMVA", "TimeUS,A,B,C,Id", "QfffB", AP_HAL::micros64(), 0.0, 0.0, 0.0, 0);
+    register_other_messages();
+
+    float a = 1.0f, b = 2.0f, c = 3.0f;
+    uint8_t id = 4;
+    while (state.KeepRunning()) {
+        gbenchmark_escape(&a);
+        logger.Write("BMVA", "TimeUS,A,B,C,Id", "QfffB", AP_HAL::micros64(), (double)a, (double)b, (double)c, id);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+static void BM_LoggerWriteMessageDef(benchmark::State& state)
+{
+    static AP_Logger::MessageDef<'Q','f','f','f','B'> msg{"BMMD", "TimeUS,A,B,C,Id"};
+    logger.Write(msg, AP_HAL::micros64(), 0.0f, 0.0f, 0.0f, uint8_t(0));
+    register_other_messages();
+
+    float a = 1.0f, b = 2.0f, c = 3.0f;
+    uint8_t id = 4;
+    while (state.KeepRunning()) {
+        gbenchmark_escape(&a);
+        logger.Write(msg, AP_HAL::micros64(), a, b, c, id);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_LoggerWriteFormatString);
+BENCHMARK(BM_LoggerWriteMessageDef);
+
+BENCHMARK_MAIN()
@@ -0,0 +1,323 @@
+#include <AP_gtest.h>
+
+#include <AP_HAL/AP_HAL.h>
+
+const AP_HAL::HAL& hal = AP_HAL::get_HAL();
+
+#if CONFIG_HAL_BOARD == HAL_BOARD_SITL
+
+#include <AP_Logger/AP_Logger.h>
+#include <AP_Logger/AP_Logger_SITL.h>
+#include <AP_RTC/AP_RTC.h>
+#include <GCS_MAVLink/GCS_Dummy.h>
+
+#include <unistd.h>
+#include <vector>
+
+static AP_Int32 log_bitmask;
+static AP_Logger logger{log_bitmask};
+static AP_RTC rtc;
+static GCS_Dummy _gcs;
+
+const AP_Param::GroupInfo GCS_MAVLINK_Parameters::var_info[] = {
+    AP_GROUPEND
+};
+
+// the byte written at offset ofs in the data of page file_page of a log
+static uint8_t log_byte(uint16_t log_num, uint32_t file_page, uint32_t ofs)
+{
+    return uint8_t(log_num * 31 + file_page * 7 + ofs);
+}
+
+/*
+  drives the block logger on the SITL flash chip, writing logs a page
+  at a time and looking up their boundaries both through the index and
+  by searching the chip
+ */
+class AP_Logger_Block_Test {
+public:
+    // open the chip as the previous logger left it, or erase it first
+    AP_Logger_Block_Test(bool erase)
+    {
+        if (erase) {
+            unlink(AP_Logger_SITL::filename);
+        }
+        // the scheduler keeps the IO process of each logger, so they are never freed
+        AP_Logger_SITL *sitl = new AP_Logger_SITL(logger, new LoggerMessageWriter_DFLogStart());
+        sitl->Init();
+        block = sitl;
+        if (erase) {
+            // finish the erase done when the chip was created without waiting for it
+            block->erase_started = true;
+            block->io_timer();
+        } else {
+            block->Prep();
+        }
+    }
+
+    uint32_t num_pages() const { return block->df_NumPages; }
+    uint32_t data_page_size() const { return block->df_PageSize - sizeof(AP_Logger_Block::PageHeader); }
+    bool index_valid() const { return block->index_valid; }
+    uint32_t index_next_record() const { return block->index_next_record; }
+    uint32_t index_num_records() const { return block->index_num_records(); }
+    uint32_t last_page() { return block->find_last_page(); }
+    void prep() { block->Prep(); }
+    uint16_t start_log() { return block->start_new_log(); }
+
+    void get_log_boundaries(uint16_t log_num, uint32_t &start_page, uint32_t &end_page) {
+        block->get_log_boundaries(log_num, start_page, end_page);
+    }
+
+    // write pages of data to the current log
+    void write_pages(uint32_t pages)
+    {
+        uint8_t data[AP_Logger_Block::page_size_max];
+        for (uint32_t i=0; i<pages; i++) {
+            for (uint16_t j=0; j<data_page_size(); j++) {
+                data[j] = log_byte(block->df_FileNumber, block->df_FilePage, j);
+            }
+            block->writebuf.write(data, data_page_size());
+            block->io_timer();
+        }
+    }
+
+    // write a log of pages pages and stop it
+    uint16_t write_log(uint32_t pages)
+    {
+        const uint16_t log_num = start_log();
+        write_pages(pages);
+        block->stop_logging();
+        return log_num;
+    }
+
+    // the first page after the last page written which holds log data
+    uint32_t oldest_data_page()
+    {
+        uint32_t page = last_page();
+        for (uint32_t i=0; i<num_pages(); i++) {
+            page = page % num_pages() + 1;
+            AP_Logger_Block::PageHeader ph;
+            block->read_page_header(page, ph);
+            if (ph.FileNumber != 0xFFFF) {
+                return page;
+            }
+        }
+        return 0;
+    }
+
+    /*
+      check the index gives the same logs as searching the chip. Once
+      the chip has wrapped the search starts the oldest log on the
+      erased pages after the last page written, so the index start of
+      that log is checked against the first page still holding data
+     */
+    void check_index_matches_search()
+    {
+        ASSERT_TRUE(block->index_valid);
+        const uint16_t num_logs = block->get_num_logs();
+        const uint16_t last_log = (num_logs == 0) ? 0 : block->find_last_log();
+        std::vector<uint32_t> start_pages, end_pages;
+        for (uint16_t log_num = last_log + 1 - num_logs; log_num <= last_log && num_logs != 0; log_num++) {
+            uint32_t start_page, end_page;
+            block->get_log_boundaries(log_num, start_page, end_page);
+            start_pages.push_back(start_page);
+            end_pages.push_back(end_page);
+        }
+
+        block->index_valid = false;
+        EXPECT_EQ(num_logs, block->get_num_logs());
+        if (num_logs != 0) {
+            EXPECT_EQ(last_log, block->find_last_log());
+        }
+        const bool wrapped = block->check_wrapped();
+        for (uint16_t i=0; i<start_pages.size(); i++) {
+            const uint16_t log_num = last_log + 1 - num_logs + i;
+            uint32_t start_page, end_page;
+            block->get_log_boundaries(log_num, start_page, end_page);
+            if (wrapped && i == 0) {
+                EXPECT_EQ(oldest_data_page(), start_pages[i]) << log_num;
+            } else {
+                EXPECT_EQ(start_page, start_pages[i]) << log_num;
+            }
+            EXPECT_EQ(end_page, end_pages[i]) << log_num;
+        }
+        block->index_valid = true;
+    }
+
+    /*
+      read a log in chunks of len bytes through the read cache and with
+      BlockRead, checking both give the bytes written
+     */
+    void check_cached_reads(uint16_t log_num, uint16_t len)
+    {
+        uint32_t start_page, end_page;
+        block->get_log_boundaries(log_num, start_page, end_page);
+        const uint32_t pages = (end_page >= start_page) ? end_page + 1 - start_page : num_pages() + end_page + 1 - start_page;
+        const uint32_t size = pages * data_page_size();
+
+        std::vector<uint8_t> cached(len), direct(len);
+        uint32_t page = start_page;
+        uint32_t offset = 0;
+        for (uint32_t ofs=0; ofs<size; ofs+=len) {
+            const uint16_t n = MIN(uint32_t(len), size - ofs);
+            ASSERT_TRUE(block->read_cached(page, offset, n, cached.data()));
+            block->StartRead(page);
+            block->df_Read_BufferIdx = offset + sizeof(AP_Logger_Block::PageHeader);
+            ASSERT_TRUE(block->ReadBlock(direct.data(), n));
+            ASSERT_EQ(0, memcmp(cached.data(), direct.data(), n)) << page;
+
+            AP_Logger_Block::PageHeader ph;
+            block->read_page_header(page, ph);
+            for (uint16_t i=0; i<n; i++) {
+                ASSERT_EQ(log_num, ph.FileNumber) << page;
+                ASSERT_EQ(log_byte(log_num, ph.FilePage, offset), cached[i]) << page;
+                if (++offset == data_page_size()) {
+                    offset = 0;
+                    page = page % num_pages() + 1;
+                    if (i + 1 < n) {
+                        block->read_page_header(page, ph);
+                    }
+                }
+            }
+        }
+    }
+
+private:
+    AP_Logger_Block *block;
+};
+
+TEST(AP_Logger_Block, EmptyChip)
+{
+    AP_Logger_Block_Test chip(true);
+    EXPECT_TRUE(chip.index_valid());
+    EXPECT_EQ(0U, chip.index_next_record());
+    chip.check_index_matches_search();
+
+    AP_Logger_Block_Test reopened(false);
+    EXPECT_TRUE(reopened.index_valid());
+    reopened.check_index_matches_search();
+}
+
+TEST(AP_Logger_Block, Logs)
+{
+    AP_Logger_Block_Test chip(true);
+    EXPECT_EQ(1U, chip.write_log(10));
+    EXPECT_EQ(2U, chip.write_log(300));
+    EXPECT_EQ(3U, chip.write_log(2));
+    chip.check_index_matches_search();
+
+    // a log too short to keep has its number reused
+    EXPECT_EQ(4U, chip.write_log(1));
+    EXPECT_EQ(4U, chip.write_log(700));
+    chip.check_index_matches_search();
+
+    // a log still being written when the power is lost
+    EXPECT_EQ(5U, chip.start_log());
+    chip.write_pages(50);
+    chip.check_index_matches_search();
+
+    AP_Logger_Block_Test reopened(false);
+    EXPECT_TRUE(reopened.index_valid());
+    reopened.check_index_matches_search();
+    EXPECT_EQ(6U, reopened.write_log(20));
+    reopened.check_index_matches_search();
+}
+
+TEST(AP_Logger_Block, WrappedChip)
+{
+    AP_Logger_Block_Test chip(true);
+
+    // a short first log so that pages read ahead run past the end of the chip
+    uint32_t pages_written = 5;
+    chip.write_log(pages_written);
+    const uint32_t log_pages = 2000;
+    uint16_t log_num;
+    do {
+        log_num = chip.write_log(log_pages);
+        pages_written += log_pages;
+    } while (pages_written < chip.num_pages());
+
+    // the newest log runs from the end of the chip to its start
+    uint32_t start_page, end_page;
+    chip.get_log_boundaries(log_num, start_page, end_page);
+    EXPECT_EQ(pages_written + 1 - log_pages, start_page);
+    EXPECT_EQ(pages_written - chip.num_pages(), end_page);
+    chip.check_index_matches_search();
+    chip.check_cached_reads(log_num, 90);
+
+    // the oldest log has lost its first pages
+    chip.get_log_boundaries(2, start_page, end_page);
+    EXPECT_EQ(chip.oldest_data_page(), start_page);
+    chip.check_cached_reads(2, 256);
+
+    AP_Logger_Block_Test reopened(false);
+    EXPECT_TRUE(reopened.index_valid());
+    reopened.check_index_matches_search();
+    reopened.check_cached_reads(log_num, 1000);
+
+    // write over the oldest logs with the chip reopened
+    EXPECT_EQ(log_num + 1, reopened.write_log(log_pages));
+    reopened.check_index_matches_search();
+}
+
+TEST(AP_Logger_Block, CompactedIndex)
+{
+    AP_Logger_Block_Test chip(true);
+
+    // a start and an end record for each log
+    const uint16_t num_logs = chip.index_num_records() * 3 / 8 + 10;
+    for (uint16_t i=0; i<num_logs; i++) {
+        chip.write_log(2);
+    }
+    EXPECT_TRUE(chip.index_valid());
+    EXPECT_EQ(2U * num_logs, chip.index_next_record());
+
+    // compacted to the most recent logs when disarmed
+    chip.prep();
+    EXPECT_TRUE(chip.index_valid());
+    EXPECT_GT(2U * num_logs, chip.index_next_record());
+    chip.check_index_matches_search();
+    chip.check_cached_reads(num_logs, 100);
+
+    AP_Logger_Block_Test reopened(false);
+    EXPECT_TRUE(reopened.index_valid());
+    reopened.check_index_matches_search();
+}
+
+TEST(AP_Logger_Block, FullIndex)
+{
+    AP_Logger_Block_Test chip(true);
+
+    // logs keep being found by searching the chip once the index is full
+    const uint16_t num_logs = chip.index_num_records() / 2 + 10;
+    for (uint16_t i=0; i<num_logs; i++) {
+        EXPECT_EQ(i + 1U, chip.write_log(2));
+    }
+    EXPECT_FALSE(chip.index_valid());
+
+    // rebuilt from a search of the chip when disarmed
+    chip.prep();
+    EXPECT_TRUE(chip.index_valid());
+    chip.check_index_matches_search();
+
+    AP_Logger_Block_Test reopened(false);
+    EXPECT_TRUE(reopened.index_valid());
+    reopened.check_index_matches_search();
+}
+
+TEST(AP_Logger_Block, CachedReadsSeeNewLogs)
+{
+    AP_Logger_Block_Test chip(true);
+    chip.write_log(20);
+    const uint16_t log_num = chip.write_log(3);
+    chip.check_cached_reads(log_num, 100);
+
+    // pages read ahead past the end of a log are read again once written
+    chip.write_log(10);
+    chip.check_cached_reads(log_num + 1, 100);
+    chip.check_cached_reads(log_num, 333);
+}
+
+#endif // CONFIG_HAL_BOARD == HAL_BOARD_SITL
+
+AP_GTEST_MAIN()
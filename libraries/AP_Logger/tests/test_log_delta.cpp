@@ -0,0 +1,134 @@
+#include <AP_gtest.h>
+
+#include <AP_Math/AP_Math.h>
+#include <AP_Logger/LogDelta.h>
+
+// a message using each kind of field
+struct PACKED log_Delta_Test {
+    LOG_PACKET_HEADER;
+    uint64_t time_us;
+    float value;
+    int16_t small;
+    uint8_t wraps;
+    uint32_t counter;
+    double position;
+    char name[16];
+};
+
+static const uint8_t LOG_DELTA_TEST_MSG = 200;
+
+static log_Format delta_test_format()
+{
+    log_Format fmt {};
+    fmt.head1 = HEAD_BYTE1;
+    fmt.head2 = HEAD_BYTE2;
+    fmt.msgid = LOG_FORMAT_MSG;
+    fmt.type = LOG_DELTA_TEST_MSG;
+    fmt.length = sizeof(log_Delta_Test);
+    memcpy(fmt.name, "DTST", 4);
+    strncpy(fmt.format, "QfhBIdN", sizeof(fmt.format));
+    strncpy(fmt.labels, "TimeUS,Val,Small,Wraps,Count,Pos,Name", sizeof(fmt.labels));
+    return fmt;
+}
+
+// encode a series of messages and check a second codec decodes them
+TEST(LogDeltaTest, RoundTrip)
+{
+    LogDeltaCodec encoder;
+    LogDeltaCodec decoder;
+    const log_Format fmt = delta_test_format();
+    encoder.update((const uint8_t *)&fmt, sizeof(fmt));
+    decoder.update((const uint8_t *)&fmt, sizeof(fmt));
+    EXPECT_EQ(sizeof(log_Delta_Test), encoder.message_length(LOG_DELTA_TEST_MSG));
+    EXPECT_EQ(0, encoder.message_length(LOG_DELTA_TEST_MSG + 1));
+
+    log_Delta_Test pkt {};
+    pkt.head1 = HEAD_BYTE1;
+    pkt.head2 = HEAD_BYTE2;
+    pkt.msgid = LOG_DELTA_TEST_MSG;
+    pkt.time_us = 123456789;
+    strncpy(pkt.name, "first", sizeof(pkt.name));
+
+    uint32_t raw_bytes = 0;
+    uint32_t encoded_bytes = 0;
+    for (uint16_t i = 0; i < 1000; i++) {
+        pkt.time_us += 2500 + (i % 3);
+        pkt.value = sinf(i * 0.01f) * 100.0f;
+        pkt.small = (i * 37) % 2000 - 1000;
+        pkt.wraps += 100;
+        pkt.counter = (i % 500 == 499) ? 0 : pkt.counter + 1;
+        pkt.position += 0.001;
+        if (i == 500) {
+            strncpy(pkt.name, "second", sizeof(pkt.name));
+        }
+
+        uint8_t encoded[sizeof(pkt)];
+        const uint16_t encoded_size = encoder.encode((const uint8_t *)&pkt, sizeof(pkt), encoded);
+        if (i == 0) {
+            // the first message is the reference for the rest
+            EXPECT_EQ(0, encoded_size);
+        } else {
+            EXPECT_GT(encoded_size, LOG_DELTA_HEADER_LEN);
+            EXPECT_LT(encoded_size, sizeof(pkt));
+        }
+        encoder.update((const uint8_t *)&pkt, sizeof(pkt));
+        raw_bytes += sizeof(pkt);
+
+        log_Delta_Test decoded {};
+        if (encoded_size == 0) {
+            memcpy(&decoded, &pkt, sizeof(pkt));
+            encoded_bytes += sizeof(pkt);
+        } else {
+            EXPECT_EQ(sizeof(pkt), decoder.decode(encoded, encoded_size, (uint8_t *)&decoded));
+            encoded_bytes += encoded_size;
+        }
+        decoder.update((const uint8_t *)&decoded, sizeof(decoded));
+        EXPECT_EQ(0, memcmp(&pkt, &decoded, sizeof(pkt)));
+    }
+    EXPECT_LT(encoded_bytes * 2, raw_bytes);
+}
+
+// messages without a known format or reference are written unchanged
+TEST(LogDeltaTest, Unencodable)
+{
+    LogDeltaCodec codec;
+    log_Delta_Test pkt {};
+    pkt.head1 = HEAD_BYTE1;
+    pkt.head2 = HEAD_BYTE2;
+    pkt.msgid = LOG_DELTA_TEST_MSG;
+    uint8_t encoded[sizeof(pkt)];
+
+    // no format
+    codec.update((const uint8_t *)&pkt, sizeof(pkt));
+    EXPECT_EQ(0, codec.encode((const uint8_t *)&pkt, sizeof(pkt), encoded));
+
+    // format length does not match its format string
+    log_Format fmt = delta_test_format();
+    fmt.length--;
+    codec.update((const uint8_t *)&fmt, sizeof(fmt));
+    codec.update((const uint8_t *)&pkt, sizeof(pkt));
+    EXPECT_EQ(0, codec.encode((const uint8_t *)&pkt, sizeof(pkt), encoded));
+
+    // valid format but no reference message
+    fmt = delta_test_format();
+    codec.update((const uint8_t *)&fmt, sizeof(fmt));
+    EXPECT_EQ(0, codec.encode((const uint8_t *)&pkt, sizeof(pkt), encoded));
+    codec.update((const uint8_t *)&pkt, sizeof(pkt));
+    EXPECT_NE(0, codec.encode((const uint8_t *)&pkt, sizeof(pkt), encoded));
+
+    // reset forgets formats
+    codec.reset();
+    EXPECT_EQ(0, codec.encode((const uint8_t *)&pkt, sizeof(pkt), encoded));
+
+    // truncated encoded messages are rejected
+    codec.update((const uint8_t *)&fmt, sizeof(fmt));
+    codec.update((const uint8_t *)&pkt, sizeof(pkt));
+    pkt.time_us = 1000000;
+    const uint16_t encoded_size = codec.encode((const uint8_t *)&pkt, sizeof(pkt), encoded);
+    EXPECT_NE(0, encoded_size);
+    encoded[3]--;
+    uint8_t decoded[sizeof(pkt)];
+    EXPECT_EQ(0, codec.decode(encoded, encoded_size - 1, decoded));
+}
+
+AP_GTEST_MAIN()
@@ -0,0 +1,41 @@
+#include <AP_gtest.h>
+
+#include <AP_Logger/LogFormat.h>
+
+// arguments must fit their field's type without narrowing
+static_assert(log_fmt_converts<float, float>::value, "float for 'f'");
+static_assert(log_fmt_converts<double, float>::value, "float for 'd'");
+static_assert(log_fmt_converts<int16_t, int8_t>::value, "int8_t for 'h'");
+static_assert(log_fmt_converts<uint64_t, uint32_t>::value, "uint32_t for 'Q'");
+static_assert(log_fmt_converts<uint8_t, bool>::value, "bool for 'B'");
+static_assert(!log_fmt_converts<float, double>::value, "double for 'f'");
+static_assert(!log_fmt_converts<uint8_t, int>::value, "int for 'B'");
+static_assert(!log_fmt_converts<int16_t, int32_t>::value, "int32_t for 'h'");
+static_assert(!log_fmt_converts<uint32_t, int32_t>::value, "int32_t for 'I'");
+static_assert(!log_fmt_converts<int32_t, float>::value, "float for 'i'");
+
+TEST(LogFormat, Length)
+{
+    EXPECT_EQ(8U+4+1, unsigned(log_fmt_length<'Q','f','B'>::value));
+    EXPECT_EQ(4U+16+64+64, unsigned(log_fmt_length<'n','N','Z','a'>::value));
+}
+
+TEST(LogFormat, Pack)
+{
+    uint8_t buf[log_fmt_length<'Q','f','h','n'>::value];
+    memset(buf, 0xff, sizeof(buf));
+    log_fmt_packer<'Q','f','h','n'>::pack(buf, uint64_t(123456789), 1.5f, int8_t(-3), "AB");
+
+    uint64_t q;
+    float f;
+    int16_t h;
+    memcpy(&q, &buf[0], sizeof(q));
+    memcpy(&f, &buf[8], sizeof(f));
+    memcpy(&h, &buf[12], sizeof(h));
+    EXPECT_EQ(123456789U, q);
+    EXPECT_FLOAT_EQ(1.5f, f);
+    EXPECT_EQ(-3, h);
+    EXPECT_EQ(0, memcmp(&buf[14], "AB\0\0", 4));
+}
+
+AP_GTEST_MAIN()
@@ -0,0 +1,418 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "AP_SegmentGrid.h"
+#include "polygon.h"
+
+// fraction of a cell by which segments are widened when finding the cells they pass through
+// so that segments running along or crossing at a cell boundary are found in both cells
+#define AP_SEGMENT_GRID_CELL_MARGIN 0.001f
+
+// returns true if the segment from p1 to p2 crosses the edge from a to b
+// an edge end lying exactly on the segment's line is treated as being on its right so a
+// segment passing through the vertex shared by two edges crosses exactly one of them
+static bool segment_crosses_edge(const Vector2f &p1, const Vector2f &p2, const Vector2f &a, const Vector2f &b)
+{
+    const Vector2f dir = p2 - p1;
+    if (((dir % (a - p1)) > 0) == ((dir % (b - p1)) > 0)) {
+        return false;
+    }
+    const Vector2f edge = b - a;
+    return ((edge % (p1 - a)) > 0) != ((edge % (p2 - a)) > 0);
+}
+
+// free all memory, intersects() will return false until rebuilt
+void AP_SegmentGrid::clear()
+{
+    delete[] _edges;
+    delete[] _cell_start;
+    delete[] _cell_edges;
+    delete[] _cell_state;
+    delete[] _cell_edge_inside;
+    _edges = nullptr;
+    _cell_start = nullptr;
+    _cell_edges = nullptr;
+    _cell_state = nullptr;
+    _cell_edge_inside = nullptr;
+    _max_edges = 0;
+    _num_edges = 0;
+    _num_polygons = 0;
+    _num_inclusion = 0;
+    _cols = 0;
+    _rows = 0;
+    _built = false;
+}
+
+// prepare to index up to max_edges edges, returns false if out of memory
+bool AP_SegmentGrid::init(uint16_t max_edges)
+{
+    clear();
+    if (max_edges == 0) {
+        return true;
+    }
+    _edges = new Edge[max_edges];
+    if (_edges == nullptr) {
+        return false;
+    }
+    _max_edges = max_edges;
+    return true;
+}
+
+// add the edges of a polygon of num_points points
+bool AP_SegmentGrid::add_polygon(const Vector2f *points, uint16_t num_points, bool inclusion)
+{
+    if ((points == nullptr) || (num_points < 2)) {
+        return true;
+    }
+    if (Polygon_complete(points, num_points)) {
+        // the closing edge is already present
+        num_points--;
+    }
+    if ((_num_edges + num_points > _max_edges) || (_num_polygons > UINT8_MAX)) {
+        return false;
+    }
+    for (uint16_t i = 0; i < num_points; i++) {
+        const uint16_t j = (i == num_points - 1) ? 0 : i + 1;
+        _edges[_num_edges++] = {points[i], points[j], (uint8_t)_num_polygons, inclusion};
+    }
+    _num_polygons++;
+    if (inclusion) {
+        _num_inclusion++;
+    }
+    _built = false;
+    return true;
+}
+
+// column or row of a coordinate, clamped to the grid
+uint8_t AP_SegmentGrid::cell_col(float x) const
+{
+    return (uint8_t)constrain_float((x - _min.x) / _cell_size.x, 0, _cols - 1);
+}
+
+uint8_t AP_SegmentGrid::cell_row(float y) const
+{
+    return (uint8_t)constrain_float((y - _min.y) / _cell_size.y, 0, _rows - 1);
+}
+
+// centre of a cell
+Vector2f AP_SegmentGrid::cell_centre(uint16_t cell) const
+{
+    return Vector2f(_min.x + ((cell % _cols) + 0.5f) * _cell_size.x,
+                    _min.y + ((cell / _cols) + 0.5f) * _cell_size.y);
+}
+
+// call fn with the index of every cell the segment from a to b passes through
+template <typename F>
+void AP_SegmentGrid::for_each_cell(const Vector2f &a, const Vector2f &b, F fn) const
+{
+    const float margin_x = _cell_size.x * AP_SEGMENT_GRID_CELL_MARGIN;
+    const float margin_y = _cell_size.y * AP_SEGMENT_GRID_CELL_MARGIN;
+    const float y_low = MIN(a.y, b.y);
+    const float y_high = MAX(a.y, b.y);
+    const uint8_t row_first = cell_row(y_low - margin_y);
+    const uint8_t row_last = cell_row(y_high + margin_y);
+    const float dy = b.y - a.y;
+
+    for (uint8_t row = row_first; row <= row_last; row++) {
+        // part of the segment within this row
+        const float row_y_low = MAX(y_low, _min.y + row * _cell_size.y - margin_y);
+        const float row_y_high = MIN(y_high, _min.y + (row + 1) * _cell_size.y + margin_y);
+        float x1 = a.x;
+        float x2 = b.x;
+        if (fabsf(dy) > FLT_EPSILON) {
+            x1 = a.x + (row_y_low - a.y) * (b.x - a.x) / dy;
+            x2 = a.x + (row_y_high - a.y) * (b.x - a.x) / dy;
+        }
+        const uint8_t col_first = cell_col(MIN(x1, x2) - margin_x);
+        const uint8_t col_last = cell_col(MAX(x1, x2) + margin_x);
+        for (uint8_t col = col_first; col <= col_last; col++) {
+            fn(row * _cols + col);
+        }
+    }
+}
+
+// sort the added edges into grid cells, returns false if out of memory
+bool AP_SegmentGrid::build()
+{
+    delete[] _cell_start;
+    delete[] _cell_edges;
+    delete[] _cell_state;
+    delete[] _cell_edge_inside;
+    _cell_start = nullptr;
+    _cell_edges = nullptr;
+    _cell_state = nullptr;
+    _cell_edge_inside = nullptr;
+    _built = false;
+
+    if (_num_edges == 0) {
+        return true;
+    }
+
+    // find extents of all edges
+    _min = _edges[0].start;
+    _max = _edges[0].start;
+    for (uint16_t i = 0; i < _num_edges; i++) {
+        const Vector2f *ends[] = {&_edges[i].start, &_edges[i].end};
+        for (const Vector2f *p : ends) {
+            _min.x = MIN(_min.x, p->x);
+            _min.y = MIN(_min.y, p->y);
+            _max.x = MAX(_max.x, p->x);
+            _max.y = MAX(_max.y, p->y);
+        }
+    }
+
+    // roughly one edge per cell, cells are kept square where possible
+    const uint8_t cells_per_side = constrain_int16((int16_t)ceilf(sqrtf(_num_edges)), 1, AP_SEGMENT_GRID_CELLS_MAX);
+    const float width = MAX(_max.x - _min.x, 1.0f);
+    const float height = MAX(_max.y - _min.y, 1.0f);
+    const float cell_size = MAX(width, height) / cells_per_side;
+    _cols = constrain_int16((int16_t)ceilf(width / cell_size), 1, cells_per_side);
+    _rows = constrain_int16((int16_t)ceilf(height / cell_size), 1, cells_per_side);
+    _cell_size.x = width / _cols;
+    _cell_size.y = height / _rows;
+    const uint16_t num_cells = _cols * _rows;
+
+    // count edges in each cell
+    _cell_start = new uint16_t[num_cells + 1];
+    if (_cell_start == nullptr) {
+        return false;
+    }
+    memset(_cell_start, 0, sizeof(uint16_t) * (num_cells + 1));
+    uint32_t total = 0;
+    for (uint16_t i = 0; i < _num_edges; i++) {
+        for_each_cell(_edges[i].start, _edges[i].end, [&](uint16_t cell) {
+            _cell_start[cell + 1]++;
+            total++;
+        });
+    }
+    if (total > UINT16_MAX) {
+        delete[] _cell_start;
+        _cell_start = nullptr;
+        return false;
+    }
+
+    // convert counts to start indexes
+    for (uint16_t c = 0; c < num_cells; c++) {
+        _cell_start[c + 1] += _cell_start[c];
+    }
+
+    // fill each cell's list, using a copy of the start indexes as insertion points
+    _cell_edges = new uint16_t[total];
+    uint16_t *fill = new uint16_t[num_cells];
+    if ((_cell_edges == nullptr) || (fill == nullptr)) {
+        delete[] fill;
+        delete[] _cell_edges;
+        delete[] _cell_start;
+        _cell_edges = nullptr;
+        _cell_start = nullptr;
+        return false;
+    }
+    memcpy(fill, _cell_start, sizeof(uint16_t) * num_cells);
+    for (uint16_t i = 0; i < _num_edges; i++) {
+        for_each_cell(_edges[i].start, _edges[i].end, [&](uint16_t cell) {
+            _cell_edges[fill[cell]++] = i;
+        });
+    }
+    delete[] fill;
+
+    if (!classify_cells(total)) {
+        delete[] _cell_edges;
+        delete[] _cell_start;
+        _cell_edges = nullptr;
+        _cell_start = nullptr;
+        return false;
+    }
+
+    _built = true;
+    return true;
+}
+
+// classify each cell and record whether each cell's centre is inside the polygons of the edges passing through it
+// memberships of a row of cell centres are found together by counting the edge crossings to the left of each centre
+bool AP_SegmentGrid::classify_cells(uint16_t num_cell_edges)
+{
+    const uint16_t num_cells = _cols * _rows;
+    _cell_state = new uint8_t[num_cells];
+    _cell_edge_inside = new uint8_t[(num_cell_edges + 7) / 8];
+    uint32_t *row_inside = new uint32_t[_num_polygons];  // bit per column set if that cell's centre is inside the polygon
+    bool *polygon_inclusion = new bool[_num_polygons];
+    if ((_cell_state == nullptr) || (_cell_edge_inside == nullptr) || (row_inside == nullptr) || (polygon_inclusion == nullptr)) {
+        delete[] _cell_state;
+        delete[] _cell_edge_inside;
+        delete[] row_inside;
+        delete[] polygon_inclusion;
+        _cell_state = nullptr;
+        _cell_edge_inside = nullptr;
+        return false;
+    }
+    memset(_cell_edge_inside, 0, (num_cell_edges + 7) / 8);
+    for (uint16_t i = 0; i < _num_edges; i++) {
+        polygon_inclusion[_edges[i].polygon] = _edges[i].inclusion;
+    }
+
+    static_assert(AP_SEGMENT_GRID_CELLS_MAX <= 32, "row_inside holds one bit per column");
+
+    for (uint8_t row = 0; row < _rows; row++) {
+        const float y = cell_centre(row * _cols).y;
+
+        // each edge crossing the line through the row's centres toggles the membership of all centres to its right
+        memset(row_inside, 0, sizeof(uint32_t) * _num_polygons);
+        for (uint16_t i = 0; i < _num_edges; i++) {
+            const Edge &edge = _edges[i];
+            if ((edge.start.y > y) == (edge.end.y > y)) {
+                continue;
+            }
+            const float x = edge.start.x + (y - edge.start.y) * (edge.end.x - edge.start.x) / (edge.end.y - edge.start.y);
+            uint8_t col = cell_col(x);
+            if (cell_centre(row * _cols + col).x <= x) {
+                col++;
+            }
+            if (col < _cols) {
+                row_inside[edge.polygon] ^= ~((1U << col) - 1);
+            }
+        }
+
+        for (uint8_t col = 0; col < _cols; col++) {
+            const uint16_t cell = row * _cols + col;
+            const uint16_t end = _cell_start[cell + 1];
+            uint16_t entry = _cell_start[cell];
+            bool outside = false;
+            // entries are in edge order so the edges of each polygon are together
+            for (uint16_t p = 0; p < _num_polygons; p++) {
+                const bool inside = (row_inside[p] >> col) & 1U;
+                if ((entry < end) && (_edges[_cell_edges[entry]].polygon == p)) {
+                    for (; (entry < end) && (_edges[_cell_edges[entry]].polygon == p); entry++) {
+                        if (inside) {
+                            _cell_edge_inside[entry / 8] |= (1U << (entry % 8));
+                        }
+                    }
+                } else if (inside != polygon_inclusion[p]) {
+                    // polygon has no edges in this cell so the whole cell is on the same side of it as the centre
+                    outside = true;
+                }
+            }
+            if (outside) {
+                _cell_state[cell] = CELL_OUTSIDE;
+            } else if (_cell_start[cell] == end) {
+                _cell_state[cell] = CELL_INSIDE;
+            } else {
+                _cell_state[cell] = CELL_BOUNDARY;
+            }
+        }
+    }
+
+    delete[] row_inside;
+    delete[] polygon_inclusion;
+    return true;
+}
+
+// returns true if the segment from p1 to p2 crosses any indexed edge
+bool AP_SegmentGrid::intersects(const Vector2f &p1, const Vector2f &p2) const
+{
+    if (!_built) {
+        return false;
+    }
+
+    // nothing to hit if the segment is entirely outside the grid
+    if ((MAX(p1.x, p2.x) < _min.x) || (MIN(p1.x, p2.x) > _max.x) ||
+        (MAX(p1.y, p2.y) < _min.y) || (MIN(p1.y, p2.y) > _max.y)) {
+        return false;
+    }
+
+    bool found = false;
+    for_each_cell(p1, p2, [&](uint16_t cell) {
+        for (uint16_t i = _cell_start[cell]; !found && (i < _cell_start[cell + 1]); i++) {
+            const Edge &edge = _edges[_cell_edges[i]];
+            Vector2f intersection;
+            if (Vector2f::segment_intersection(edge.start, edge.end, p1, p2, intersection)) {
+                found = true;
+            }
+        }
+    });
+    return found;
+}
+
+// returns true if point is outside any inclusion polygon or inside any exclusion polygon
+bool AP_SegmentGrid::outside(const Vector2f &point) const
+{
+    if (!_built) {
+        return false;
+    }
+
+    // points beyond the grid are outside every polygon
+    if ((point.x < _min.x) || (point.x > _max.x) || (point.y < _min.y) || (point.y > _max.y)) {
+        return (_num_inclusion > 0);
+    }
+
+    const uint16_t cell = cell_row(point.y) * _cols + cell_col(point.x);
+    switch (_cell_state[cell]) {
+    case CELL_INSIDE:
+        return false;
+    case CELL_OUTSIDE:
+        return true;
+    default:
+        break;
+    }
+
+    // the segment from the centre to point lies within the cell so only this cell's edges can cross it,
+    // each crossing of a polygon's edges changes whether point is inside that polygon
+    const Vector2f centre = cell_centre(cell);
+    const uint16_t end = _cell_start[cell + 1];
+    uint16_t entry = _cell_start[cell];
+    while (entry < end) {
+        const Edge &first = _edges[_cell_edges[entry]];
+        bool inside = (_cell_edge_inside[entry / 8] >> (entry % 8)) & 1U;
+        for (; (entry < end) && (_edges[_cell_edges[entry]].polygon == first.polygon); entry++) {
+            const Edge &edge = _edges[_cell_edges[entry]];
+            if (segment_crosses_edge(centre, point, edge.start, edge.end)) {
+                inside = !inside;
+            }
+        }
+        if (inside != first.inclusion) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// returns true if any indexed edge is within radius of point
+bool AP_SegmentGrid::near_edge(const Vector2f &point, float radius) const
+{
+    if (!_built) {
+        return false;
+    }
+    if ((point.x + radius < _min.x) || (point.x - radius > _max.x) ||
+        (point.y + radius < _min.y) || (point.y - radius > _max.y)) {
+        return false;
+    }
+
+    const float radius_sq = sq(radius);
+    const uint8_t col_first = cell_col(point.x - radius);
+    const uint8_t col_last = cell_col(point.x + radius);
+    const uint8_t row_first = cell_row(point.y - radius);
+    const uint8_t row_last = cell_row(point.y + radius);
+    for (uint8_t row = row_first; row <= row_last; row++) {
+        for (uint8_t col = col_first; col <= col_last; col++) {
+            const uint16_t cell = row * _cols + col;
+            for (uint16_t i = _cell_start[cell]; i < _cell_start[cell + 1]; i++) {
+                const Edge &edge = _edges[_cell_edges[i]];
+                if (Vector2f::closest_distance_between_line_and_point_squared(edge.start, edge.end, point) <= radius_sq) {
+                    return true;
+                }
+            }
+        }
+    }
+    return false;
+}
@@ -0,0 +1,135 @@
+/*
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include "AP_Math.h"
+
+/*
+ * AP_SegmentGrid is a uniform grid index over the edges of a set of polygons.
+ *
+ * Each edge is listed in every grid cell it passes through so that a line
+ * segment only needs to be tested against the edges in the cells it passes
+ * through rather than against every edge.  The number of cells grows with the
+ * square root of the number of edges up to AP_SEGMENT_GRID_CELLS_MAX per side.
+ *
+ * Polygons are added as inclusion or exclusion polygons.  When built, each cell
+ * is classified by whether its centre is within the region (inside all
+ * inclusion polygons and outside all exclusion polygons), so testing if a point
+ * is outside the region only needs the edges crossed between the point and the
+ * centre of its cell.  Cells no edges pass through are answered without
+ * looking at any edges.
+ *
+ * usage is init(), add_polygon() for each polygon, then build()
+ */
+
+#ifndef AP_SEGMENT_GRID_CELLS_MAX
+#define AP_SEGMENT_GRID_CELLS_MAX 32    // maximum number of cells along each side of the grid
+#endif
+
+class AP_SegmentGrid {
+public:
+    AP_SegmentGrid() :
+        _max_edges(0),
+        _num_edges(0),
+        _num_polygons(0),
+        _num_inclusion(0),
+        _cols(0),
+        _rows(0),
+        _built(false)
+    {}
+    ~AP_SegmentGrid() { clear(); }
+
+    /* Do not allow copies */
+    AP_SegmentGrid(const AP_SegmentGrid &other) = delete;
+    AP_SegmentGrid &operator=(const AP_SegmentGrid&) = delete;
+
+    // free all memory, intersects() will return false until rebuilt
+    void clear();
+
+    // prepare to index up to max_edges edges, returns false if out of memory
+    bool init(uint16_t max_edges);
+
+    // add the edges of a polygon of num_points points
+    // the polygon may be closed (last point the same as the first) or unclosed
+    // points within the region must be inside inclusion polygons and outside exclusion polygons
+    // returns false if more edges are added than init() allowed for or there are too many polygons
+    bool add_polygon(const Vector2f *points, uint16_t num_points, bool inclusion = true);
+
+    // sort the added edges into grid cells, returns false if out of memory
+    bool build();
+
+    // returns true if the segment from p1 to p2 crosses any indexed edge
+    bool intersects(const Vector2f &p1, const Vector2f &p2) const;
+
+    // returns true if point is outside any inclusion polygon or inside any exclusion polygon
+    bool outside(const Vector2f &point) const;
+
+    // returns true if any indexed edge is within radius of point
+    bool near_edge(const Vector2f &point, float radius) const;
+
+    // true once build() has succeeded
+    bool built() const { return _built; }
+
+    // number of edges held
+    uint16_t num_edges() const { return _num_edges; }
+
+private:
+
+    struct Edge {
+        Vector2f start;
+        Vector2f end;
+        uint8_t polygon;        // index of the polygon this edge belongs to, in the order added
+        bool inclusion;         // true if the polygon is an inclusion polygon
+    };
+
+    // classification of a cell's centre
+    enum CellState : uint8_t {
+        CELL_INSIDE = 0,        // no edges pass through the cell and its centre is within the region
+        CELL_OUTSIDE,           // the whole cell is outside a polygon without edges in the cell
+        CELL_BOUNDARY,          // edges pass through the cell, whether the centre is inside each of their polygons is in _cell_edge_inside
+    };
+
+    // classify each cell and record whether each cell's centre is inside the polygons of the edges passing through it
+    bool classify_cells(uint16_t num_cell_edges);
+
+    // centre of a cell
+    Vector2f cell_centre(uint16_t cell) const;
+
+    // call fn with the index of every cell the segment from a to b passes through
+    // cells are visited a row at a time, each at most once
+    template <typename F>
+    void for_each_cell(const Vector2f &a, const Vector2f &b, F fn) const;
+
+    // column or row of a coordinate, clamped to the grid
+    uint8_t cell_col(float x) const;
+    uint8_t cell_row(float y) const;
+
+    Edge *_edges = nullptr;     // edges added with add_polygon
+    uint16_t _max_edges;        // size of _edges array
+    uint16_t _num_edges;        // number of edges added
+    uint16_t _num_polygons;     // number of polygons added
+    uint16_t _num_inclusion;    // number of inclusion polygons added
+
+    Vector2f _min;              // bottom left corner of the grid
+    Vector2f _max;              // top right corner of the grid
+    Vector2f _cell_size;        // size of each cell
+    uint8_t _cols;              // number of cells along x
+    uint8_t _rows;              // number of cells along y
+    uint16_t *_cell_start = nullptr; // index into _cell_edges of each cell's first edge, one extra element marks the end
+    uint16_t *_cell_edges = nullptr; // indexes into _edges, sorted by cell
+    uint8_t *_cell_state = nullptr;  // CellState of each cell
+    uint8_t *_cell_edge_inside = nullptr; // one bit per _cell_edges entry, set if the cell centre is inside the edge's polygon
+    bool _built;                // true once build() has succeeded
+};
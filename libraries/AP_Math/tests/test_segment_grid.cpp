@@ -0,0 +1,166 @@
+#include <AP_gtest.h>
+
+#include <AP_Math/AP_Math.h>
+#include <AP_Math/AP_SegmentGrid.h>
+
+// compare the grid against testing every edge for a set of random segments
+TEST(SegmentGridTest, MatchesBruteForce)
+{
+    // a fence with many points and a few exclusion zones inside it
+    const uint8_t num_fence_points = 120;
+    Vector2f fence[num_fence_points];
+    for (uint8_t i = 0; i < num_fence_points; i++) {
+        const float angle = M_2PI * i / num_fence_points;
+        const float radius = 10000.0f + ((i % 2) ? 1500.0f : 0.0f);
+        fence[i] = Vector2f(cosf(angle), sinf(angle)) * radius;
+    }
+    const Vector2f square[] = {{-500, -500}, {500, -500}, {500, 500}, {-500, 500}};
+    Vector2f zones[4][4];
+    for (uint8_t z = 0; z < 4; z++) {
+        for (uint8_t i = 0; i < 4; i++) {
+            zones[z][i] = square[i] + Vector2f(z * 3000.0f - 4500.0f, z * 1000.0f);
+        }
+    }
+
+    AP_SegmentGrid grid;
+    EXPECT_TRUE(grid.init(num_fence_points + 4 * 4));
+    EXPECT_TRUE(grid.add_polygon(fence, num_fence_points));
+    for (uint8_t z = 0; z < 4; z++) {
+        EXPECT_TRUE(grid.add_polygon(zones[z], 4));
+    }
+    EXPECT_TRUE(grid.build());
+    EXPECT_EQ(num_fence_points + 4 * 4, grid.num_edges());
+
+    uint32_t seed = 1;
+    uint16_t hits = 0;
+    for (uint16_t n = 0; n < 2000; n++) {
+        Vector2f p[2];
+        for (uint8_t k = 0; k < 2; k++) {
+            seed = seed * 1103515245 + 12345;
+            p[k].x = ((seed >> 8) % 30000) - 15000.0f;
+            seed = seed * 1103515245 + 12345;
+            p[k].y = ((seed >> 8) % 30000) - 15000.0f;
+        }
+        Vector2f intersection;
+        bool expected = Polygon_intersects(fence, num_fence_points, p[0], p[1], intersection);
+        for (uint8_t z = 0; z < 4; z++) {
+            expected |= Polygon_intersects(zones[z], 4, p[0], p[1], intersection);
+        }
+        EXPECT_EQ(expected, grid.intersects(p[0], p[1]));
+        hits += expected ? 1 : 0;
+    }
+    // make sure the test covered both cases
+    EXPECT_GT(hits, 100);
+    EXPECT_LT(hits, 1900);
+}
+
+// segments along cell boundaries and segments outside the grid
+TEST(SegmentGridTest, EdgeCases)
+{
+    AP_SegmentGrid grid;
+    EXPECT_FALSE(grid.intersects(Vector2f(0, 0), Vector2f(1, 1)));
+
+    const Vector2f square[] = {{0, 0}, {100, 0}, {100, 100}, {0, 100}, {0, 0}};
+    EXPECT_TRUE(grid.init(4));
+    EXPECT_TRUE(grid.add_polygon(square, ARRAY_SIZE(square)));
+    EXPECT_TRUE(grid.build());
+    EXPECT_EQ(4, grid.num_edges());
+
+    EXPECT_FALSE(grid.intersects(Vector2f(10, 10), Vector2f(90, 90)));
+    EXPECT_TRUE(grid.intersects(Vector2f(50, 50), Vector2f(150, 50)));
+    EXPECT_TRUE(grid.intersects(Vector2f(-50, 50), Vector2f(150, 50)));
+    EXPECT_TRUE(grid.intersects(Vector2f(50, -50), Vector2f(50, 150)));
+    EXPECT_FALSE(grid.intersects(Vector2f(200, 200), Vector2f(300, 300)));
+    EXPECT_FALSE(grid.intersects(Vector2f(-10, 110), Vector2f(-10, -10)));
+
+    // too many edges
+    EXPECT_FALSE(grid.add_polygon(square, ARRAY_SIZE(square)));
+}
+
+// compare classifying points against testing every polygon
+TEST(SegmentGridTest, OutsideMatchesBruteForce)
+{
+    // an inclusion fence with many points and a few overlapping exclusion zones inside it
+    const uint8_t num_fence_points = 90;
+    Vector2f fence[num_fence_points];
+    for (uint8_t i = 0; i < num_fence_points; i++) {
+        const float angle = M_2PI * i / num_fence_points;
+        const float radius = 10000.0f + ((i % 3) ? 2000.0f : 0.0f);
+        fence[i] = Vector2f(cosf(angle), sinf(angle)) * radius;
+    }
+    const Vector2f triangle[] = {{-1500, -1000}, {1500, -1000}, {0, 1500}};
+    Vector2f zones[5][3];
+    for (uint8_t z = 0; z < 5; z++) {
+        for (uint8_t i = 0; i < 3; i++) {
+            zones[z][i] = triangle[i] + Vector2f(z * 1200.0f - 2400.0f, z * 700.0f - 1400.0f);
+        }
+    }
+    // a second inclusion fence overlapping the first
+    const Vector2f box[] = {{-13000, -13000}, {13000, -13000}, {13000, 6000}, {-13000, 6000}};
+
+    AP_SegmentGrid grid;
+    EXPECT_TRUE(grid.init(num_fence_points + 5 * 3 + 4));
+    EXPECT_TRUE(grid.add_polygon(fence, num_fence_points, true));
+    EXPECT_TRUE(grid.add_polygon(box, ARRAY_SIZE(box), true));
+    for (uint8_t z = 0; z < 5; z++) {
+        EXPECT_TRUE(grid.add_polygon(zones[z], 3, false));
+    }
+    EXPECT_TRUE(grid.build());
+
+    uint32_t seed = 1;
+    uint16_t breaches = 0;
+    uint16_t near = 0;
+    for (uint16_t n = 0; n < 5000; n++) {
+        Vector2f p;
+        seed = seed * 1103515245 + 12345;
+        p.x = ((seed >> 8) % 32000) - 16000.0f + 0.25f;
+        seed = seed * 1103515245 + 12345;
+        p.y = ((seed >> 8) % 32000) - 16000.0f + 0.25f;
+
+        bool expected = Polygon_outside(p, fence, num_fence_points) || Polygon_outside(p, box, ARRAY_SIZE(box));
+        bool expected_near = false;
+        for (uint8_t i = 0; i < num_fence_points; i++) {
+            expected_near |= Vector2f::closest_distance_between_line_and_point(fence[i], fence[(i + 1) % num_fence_points], p) <= 500.0f;
+        }
+        for (uint8_t i = 0; i < ARRAY_SIZE(box); i++) {
+            expected_near |= Vector2f::closest_distance_between_line_and_point(box[i], box[(i + 1) % ARRAY_SIZE(box)], p) <= 500.0f;
+        }
+        for (uint8_t z = 0; z < 5; z++) {
+            expected |= !Polygon_outside(p, zones[z], 3);
+            for (uint8_t i = 0; i < 3; i++) {
+                expected_near |= Vector2f::closest_distance_between_line_and_point(zones[z][i], zones[z][(i + 1) % 3], p) <= 500.0f;
+            }
+        }
+        EXPECT_EQ(expected, grid.outside(p));
+        EXPECT_EQ(expected_near, grid.near_edge(p, 500.0f));
+        breaches += expected ? 1 : 0;
+        near += expected_near ? 1 : 0;
+    }
+    // make sure the test covered both cases
+    EXPECT_GT(breaches, 500);
+    EXPECT_LT(breaches, 4500);
+    EXPECT_GT(near, 500);
+    EXPECT_LT(near, 4500);
+}
+
+// a single exclusion polygon, points beyond the grid are not outside the region
+TEST(SegmentGridTest, OutsideExclusionOnly)
+{
+    AP_SegmentGrid grid;
+    EXPECT_FALSE(grid.outside(Vector2f(0, 0)));
+
+    const Vector2f square[] = {{0, 0}, {100, 0}, {100, 100}, {0, 100}};
+    EXPECT_TRUE(grid.init(4));
+    EXPECT_TRUE(grid.add_polygon(square, ARRAY_SIZE(square), false));
+    EXPECT_TRUE(grid.build());
+
+    EXPECT_TRUE(grid.outside(Vector2f(50, 50)));
+    EXPECT_TRUE(grid.outside(Vector2f(1, 99)));
+    EXPECT_FALSE(grid.outside(Vector2f(-1, 50)));
+    EXPECT_FALSE(grid.outside(Vector2f(500, 500)));
+    EXPECT_TRUE(grid.near_edge(Vector2f(-1, 50), 2));
+    EXPECT_FALSE(grid.near_edge(Vector2f(50, 50), 20));
+    EXPECT_FALSE(grid.near_edge(Vector2f(500, 500), 20));
+}
+
+AP_GTEST_MAIN()
@@ -54,6 +54,21 @@ TEST(Vector2Test, reflect)
     EXPECT_EQ(reflected3, Vector2f(-3, -3));
 }
 
+TEST(Vector2Test, rotate)
+{
+    Vector2f v1(1, 0);
+    v1.rotate(M_PI/2);
+    EXPECT_NEAR(0.0f, v1.x, 1e-6);
+    EXPECT_NEAR(1.0f, v1.y, 1e-6);
+
+    Vector2f v2(3, 4);
+    v2.rotate(radians(-30));
+    EXPECT_FLOAT_EQ(5.0f, v2.length());
+    v2.rotate(radians(30));
+    EXPECT_NEAR(3.0f, v2.x, 1e-5);
+    EXPECT_NEAR(4.0f, v2.y, 1e-5);
+}
+
 TEST(Vector2Test, closest_point)
 {
     // closest_point is (p, v,w)
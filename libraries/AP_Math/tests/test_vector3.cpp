@@ -211,6 +211,15 @@ TEST(Vector3Test, Offset_bearing)
     EXPECT_EQ(Vector3f(2.0f, 0.0f), v_float1);
 }
 
+TEST(Vector3Test, rotate_xy)
+{
+    Vector3f v1(1, 1, 7);
+    v1.rotate_xy(M_PI);
+    EXPECT_NEAR(-1.0f, v1.x, 1e-6);
+    EXPECT_NEAR(-1.0f, v1.y, 1e-6);
+    EXPECT_FLOAT_EQ(7.0f, v1.z);
+}
+
 TEST(Vector3Test, Perpendicular)
 {
     Vector3f v_float1(1.0f, 1.0f);
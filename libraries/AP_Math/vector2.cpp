@@ -293,6 +293,18 @@ void Vector2<T>::offset_bearing(float bearing, float distance)
     y += sinf(radians(bearing)) * distance;
 }
 
+// rotate vector by angle in radians, positive is counter clockwise
+template <typename T>
+void Vector2<T>::rotate(float angle_rad)
+{
+    const float cs = cosf(angle_rad);
+    const float sn = sinf(angle_rad);
+    const T rx = x * cs - y * sn;
+    const T ry = x * sn + y * cs;
+    x = rx;
+    y = ry;
+}
+
 // given a position pos_delta and a velocity v1 produce a vector
 // perpendicular to v1 maximising distance from p1
 template <typename T>
@@ -444,6 +456,7 @@ template bool Vector2<float>::is_inf(void) const;
 template float Vector2<float>::angle(const Vector2<float> &v) const;
 template float Vector2<float>::angle(void) const;
 template void Vector2<float>::offset_bearing(float bearing, float distance);
+template void Vector2<float>::rotate(float angle_rad);
 template bool Vector2<float>::segment_intersection(const Vector2<float>& seg1_start, const Vector2<float>& seg1_end, const Vector2<float>& seg2_start, const Vector2<float>& seg2_end, Vector2<float>& intersection);
 template bool Vector2<float>::circle_segment_intersection(const Vector2<float>& seg_start, const Vector2<float>& seg_end, const Vector2<float>& circle_center, float radius, Vector2<float>& intersection);
 template Vector2<float> Vector2<float>::perpendicular(const Vector2<float> &pos_delta, const Vector2<float> &v1);
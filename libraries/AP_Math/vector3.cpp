@@ -278,6 +278,18 @@ void Vector3<T>::rotate_inverse(enum Rotation rotation)
     (*this) = M.mul_transpose(*this);
 }
 
+// rotate vector by angle in radians in the xy plane leaving z untouched
+template <typename T>
+void Vector3<T>::rotate_xy(float angle_rad)
+{
+    const float cs = cosf(angle_rad);
+    const float sn = sinf(angle_rad);
+    const T rx = x * cs - y * sn;
+    const T ry = x * sn + y * cs;
+    x = rx;
+    y = ry;
+}
+
 // vector cross product
 template <typename T>
 Vector3<T> Vector3<T>::operator %(const Vector3<T> &v) const
@@ -452,6 +464,7 @@ float Vector3<T>::distance_to_segment(const Vector3<T> &seg_start, const Vector3
 // define for float
 template void Vector3<float>::rotate(enum Rotation);
 template void Vector3<float>::rotate_inverse(enum Rotation);
+template void Vector3<float>::rotate_xy(float angle_rad);
 template float Vector3<float>::length(void) const;
 template Vector3<float> Vector3<float>::operator %(const Vector3<float> &v) const;
 template float Vector3<float>::operator *(const Vector3<float> &v) const;
@@ -478,6 +491,7 @@ template Vector3<int32_t> &Vector3<int32_t>::operator +=(const Vector3<int32_t>
 
 template void Vector3<double>::rotate(enum Rotation);
 template void Vector3<double>::rotate_inverse(enum Rotation);
+template void Vector3<double>::rotate_xy(float angle_rad);
 template float Vector3<double>::length(void) const;
 template Vector3<double> Vector3<double>::operator %(const Vector3<double> &v) const;
 template double Vector3<double>::operator *(const Vector3<double> &v) const;
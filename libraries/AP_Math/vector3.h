@@ -173,6 +173,9 @@ public:
     void rotate(enum Rotation rotation);
     void rotate_inverse(enum Rotation rotation);
 
+    // rotate vector by angle in radians in the xy plane leaving z untouched
+    void rotate_xy(float angle_rad);
+
     // gets the length of this vector squared
     T  length_squared() const
     {
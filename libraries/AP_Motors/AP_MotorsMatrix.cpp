@@ -195,29 +195,33 @@ void AP_MotorsMatrix::output_armed_stabilizing()
 
     // calculate amount of yaw we can fit into the throttle range
     // this is always equal to or less than the requested yaw from the pilot or rate controller
+    // the mixer works on the packed matrix of enabled motors. The lost
+    // motor's packed index is AP_MOTORS_MAX_NUM_MOTORS if it is not
+    // enabled, and excluded is the packed index left out of the limits
+    const uint8_t num_motors = _mix_num_motors;
+    const uint8_t lost = _mix_index[_motor_lost_index];
+    const uint8_t excluded = _thrust_boost ? lost : AP_MOTORS_MAX_NUM_MOTORS;
     float rp_low = 1.0f;    // lowest thrust value
     float rp_high = -1.0f;  // highest thrust value
-    for (i = 0; i < AP_MOTORS_MAX_NUM_MOTORS; i++) {
-        if (motor_enabled[i]) {
-            // calculate the thrust outputs for roll and pitch
-            _thrust_rpyt_out[i] = roll_thrust * _roll_factor[i] + pitch_thrust * _pitch_factor[i];
-            // record lowest roll + pitch command
-            if (_thrust_rpyt_out[i] < rp_low) {
-                rp_low = _thrust_rpyt_out[i];
-            }
-            // record highest roll + pitch command
-            if (_thrust_rpyt_out[i] > rp_high && (!_thrust_boost || i != _motor_lost_index)) {
-                rp_high = _thrust_rpyt_out[i];
-            }
+    for (i = 0; i < num_motors; i++) {
+        // calculate the thrust outputs for roll and pitch
+        _mix_out[i] = roll_thrust * _mix_roll[i] + pitch_thrust * _mix_pitch[i];
+        // record lowest roll + pitch command
+        if (_mix_out[i] < rp_low) {
+            rp_low = _mix_out[i];
+        }
+        // record highest roll + pitch command
+        if (_mix_out[i] > rp_high && i != excluded) {
+            rp_high = _mix_out[i];
+        }
 
-            // Check the maximum yaw control that can be used on this channel
-            // Exclude any lost motors if thrust boost is enabled
-            if (!is_zero(_yaw_factor[i]) && (!_thrust_boost || i != _motor_lost_index)){
-                if (is_positive(yaw_thrust * _yaw_factor[i])) {
-                    yaw_allowed = MIN(yaw_allowed, fabsf(MAX(1.0f - (throttle_thrust_best_rpy + _thrust_rpyt_out[i]), 0.0f)/_yaw_factor[i]));
-                } else {
-                    yaw_allowed = MIN(yaw_allowed, fabsf(MAX(throttle_thrust_best_rpy + _thrust_rpyt_out[i], 0.0f)/_yaw_factor[i]));
-                }
+        // Check the maximum yaw control that can be used on this channel
+        // Exclude any lost motors if thrust boost is enabled
+        if (!is_zero(_mix_yaw[i]) && i != excluded) {
+            if (is_positive(yaw_thrust * _mix_yaw[i])) {
+                yaw_allowed = MIN(yaw_allowed, fabsf(MAX(1.0f - (throttle_thrust_best_rpy + _mix_out[i]), 0.0f)/_mix_yaw[i]));
+            } else {
+                yaw_allowed = MIN(yaw_allowed, fabsf(MAX(throttle_thrust_best_rpy + _mix_out[i], 0.0f)/_mix_yaw[i]));
             }
         }
     }
@@ -233,19 +237,19 @@ void AP_MotorsMatrix::output_armed_stabilizing()
     yaw_allowed = MAX(yaw_allowed, yaw_allowed_min);
 
     // Include the lost motor scaled by _thrust_boost_ratio to smoothly transition this motor in and out of the calculation
-    if (_thrust_boost && motor_enabled[_motor_lost_index]) {
+    if (_thrust_boost && lost < num_motors) {
         // record highest roll + pitch command
-        if (_thrust_rpyt_out[_motor_lost_index] > rp_high) {
-            rp_high = _thrust_boost_ratio * rp_high + (1.0f - _thrust_boost_ratio) * _thrust_rpyt_out[_motor_lost_index];
+        if (_mix_out[lost] > rp_high) {
+            rp_high = _thrust_boost_ratio * rp_high + (1.0f - _thrust_boost_ratio) * _mix_out[lost];
         }
 
         // Check the maximum yaw control that can be used on this channel
         // Exclude any lost motors if thrust boost is enabled
-        if (!is_zero(_yaw_factor[_motor_lost_index])){
-            if (is_positive(yaw_thrust * _yaw_factor[_motor_lost_index])) {
-                yaw_allowed = _thrust_boost_ratio * yaw_allowed + (1.0f - _thrust_boost_ratio) * MIN(yaw_allowed, fabsf(MAX(1.0f - (throttle_thrust_best_rpy + _thrust_rpyt_out[_motor_lost_index]), 0.0f)/_yaw_factor[_motor_lost_index]));
+        if (!is_zero(_mix_yaw[lost])){
+            if (is_positive(yaw_thrust * _mix_yaw[lost])) {
+                yaw_allowed = _thrust_boost_ratio * yaw_allowed + (1.0f - _thrust_boost_ratio) * MIN(yaw_allowed, fabsf(MAX(1.0f - (throttle_thrust_best_rpy + _mix_out[lost]), 0.0f)/_mix_yaw[lost]));
             } else {
-                yaw_allowed = _thrust_boost_ratio * yaw_allowed + (1.0f - _thrust_boost_ratio) * MIN(yaw_allowed, fabsf(MAX(throttle_thrust_best_rpy + _thrust_rpyt_out[_motor_lost_index], 0.0f)/_yaw_factor[_motor_lost_index]));
+                yaw_allowed = _thrust_boost_ratio * yaw_allowed + (1.0f - _thrust_boost_ratio) * MIN(yaw_allowed, fabsf(MAX(throttle_thrust_best_rpy + _mix_out[lost], 0.0f)/_mix_yaw[lost]));
             }
         }
     }
@@ -259,26 +263,24 @@ void AP_MotorsMatrix::output_armed_stabilizing()
     // add yaw control to thrust outputs
     float rpy_low = 1.0f;   // lowest thrust value
     float rpy_high = -1.0f; // highest thrust value
-    for (i = 0; i < AP_MOTORS_MAX_NUM_MOTORS; i++) {
-        if (motor_enabled[i]) {
-            _thrust_rpyt_out[i] = _thrust_rpyt_out[i] + yaw_thrust * _yaw_factor[i];
+    for (i = 0; i < num_motors; i++) {
+        _mix_out[i] = _mix_out[i] + yaw_thrust * _mix_yaw[i];
 
-            // record lowest roll + pitch + yaw command
-            if (_thrust_rpyt_out[i] < rpy_low) {
-                rpy_low = _thrust_rpyt_out[i];
-            }
-            // record highest roll + pitch + yaw command
-            // Exclude any lost motors if thrust boost is enabled
-            if (_thrust_rpyt_out[i] > rpy_high && (!_thrust_boost || i != _motor_lost_index)) {
-                rpy_high = _thrust_rpyt_out[i];
-            }
+        // record lowest roll + pitch + yaw command
+        if (_mix_out[i] < rpy_low) {
+            rpy_low = _mix_out[i];
+        }
+        // record highest roll + pitch + yaw command
+        // Exclude any lost motors if thrust boost is enabled
+        if (_mix_out[i] > rpy_high && i != excluded) {
+            rpy_high = _mix_out[i];
         }
     }
     // Include the lost motor scaled by _thrust_boost_ratio to smoothly transition this motor in and out of the calculation
-    if (_thrust_boost) {
+    if (_thrust_boost && lost < num_motors) {
         // record highest roll + pitch + yaw command
-        if (_thrust_rpyt_out[_motor_lost_index] > rpy_high && motor_enabled[_motor_lost_index]) {
-            rpy_high = _thrust_boost_ratio * rpy_high + (1.0f - _thrust_boost_ratio) * _thrust_rpyt_out[_motor_lost_index];
+        if (_mix_out[lost] > rpy_high) {
+            rpy_high = _thrust_boost_ratio * rpy_high + (1.0f - _thrust_boost_ratio) * _mix_out[lost];
         }
     }
 
@@ -317,10 +319,8 @@ void AP_MotorsMatrix::output_armed_stabilizing()
     }
 
     // add scaled roll, pitch, constrained yaw and throttle for each motor
-    for (i = 0; i < AP_MOTORS_MAX_NUM_MOTORS; i++) {
-        if (motor_enabled[i]) {
-            _thrust_rpyt_out[i] = throttle_thrust_best_rpy + thr_adj + (rpy_scale * _thrust_rpyt_out[i]);
-        }
+    for (i = 0; i < num_motors; i++) {
+        _thrust_rpyt_out[_mix_motor[i]] = throttle_thrust_best_rpy + thr_adj + (rpy_scale * _mix_out[i]);
     }
 
     // determine throttle thrust for harmonic notch
@@ -449,6 +449,8 @@ void AP_MotorsMatrix::add_motor_raw(int8_t motor_num, float roll_fac, float pitc
         // set order that motor appears in test
         _test_order[motor_num] = testing_order;
 
+        update_mix_matrix();
+
         // call parent class method
         add_motor_num(motor_num);
     }
@@ -481,6 +483,7 @@ void AP_MotorsMatrix::remove_motor(int8_t motor_num)
         _roll_factor[motor_num] = 0;
         _pitch_factor[motor_num] = 0;
         _yaw_factor[motor_num] = 0;
+        update_mix_matrix();
     }
 }
 
@@ -866,6 +869,26 @@ void AP_MotorsMatrix::normalise_rpy_factors()
             }
         }
     }
+
+    update_mix_matrix();
+}
+
+// update_mix_matrix - pack the factors of the enabled motors for the mixer
+void AP_MotorsMatrix::update_mix_matrix()
+{
+    _mix_num_motors = 0;
+    for (uint8_t i = 0; i < AP_MOTORS_MAX_NUM_MOTORS; i++) {
+        if (motor_enabled[i]) {
+            _mix_index[i] = _mix_num_motors;
+            _mix_motor[_mix_num_motors] = i;
+            _mix_roll[_mix_num_motors] = _roll_factor[i];
+            _mix_pitch[_mix_num_motors] = _pitch_factor[i];
+            _mix_yaw[_mix_num_motors] = _yaw_factor[i];
+            _mix_num_motors++;
+        } else {
+            _mix_index[i] = AP_MOTORS_MAX_NUM_MOTORS;
+        }
+    }
 }
 
 
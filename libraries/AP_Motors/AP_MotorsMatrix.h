@@ -12,6 +12,7 @@
 
 /// @class      AP_MotorsMatrix
 class AP_MotorsMatrix : public AP_MotorsMulticopter {
+    friend class AP_MotorsMatrix_Test;
 public:
 
     /// Constructor
@@ -80,6 +81,9 @@ protected:
     // normalizes the roll, pitch and yaw factors so maximum magnitude is 0.5
     void                normalise_rpy_factors();
 
+    // packs the factors of the enabled motors for the mixer, must be called when factors change
+    void                update_mix_matrix();
+
     // call vehicle supplied thrust compensation if set
     void                thrust_compensation(void) override;
 
@@ -88,6 +92,15 @@ protected:
     float               _yaw_factor[AP_MOTORS_MAX_NUM_MOTORS];  // each motors contribution to yaw (normally 1 or -1)
     float               _thrust_rpyt_out[AP_MOTORS_MAX_NUM_MOTORS]; // combined roll, pitch, yaw and throttle outputs to motors in 0~1 range
     uint8_t             _test_order[AP_MOTORS_MAX_NUM_MOTORS];  // order of the motors in the test sequence
+
+    // mixing matrix packed to the enabled motors
+    uint8_t             _mix_num_motors;                            // number of enabled motors
+    uint8_t             _mix_motor[AP_MOTORS_MAX_NUM_MOTORS];       // motor number of each packed row
+    uint8_t             _mix_index[AP_MOTORS_MAX_NUM_MOTORS];       // packed row of each motor, AP_MOTORS_MAX_NUM_MOTORS if not enabled
+    float               _mix_roll[AP_MOTORS_MAX_NUM_MOTORS];        // roll factor of each packed row
+    float               _mix_pitch[AP_MOTORS_MAX_NUM_MOTORS];       // pitch factor of each packed row
+    float               _mix_yaw[AP_MOTORS_MAX_NUM_MOTORS];         // yaw factor of each packed row
+    float               _mix_out[AP_MOTORS_MAX_NUM_MOTORS];         // roll, pitch and yaw output of each packed row
     motor_frame_class   _last_frame_class; // most recently requested frame class (i.e. quad, hexa, octa, etc)
     motor_frame_type    _last_frame_type; // most recently requested frame type (i.e. plus, x, v, etc)
 
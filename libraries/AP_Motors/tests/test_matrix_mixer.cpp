@@ -0,0 +1,288 @@
+#include <AP_gtest.h>
+
+#include <AP_Motors/AP_MotorsMatrix.h>
+
+const AP_HAL::HAL &hal = AP_HAL::get_HAL();
+
+/*
+  checks the mixer over the matrix packed to the enabled motors gives
+  the same outputs, limits and throttle as the mixer it replaced, which
+  looped over every motor slot. The previous mixer is kept here as the
+  reference
+ */
+class AP_MotorsMatrix_Test
+{
+public:
+    struct Result {
+        float out[AP_MOTORS_MAX_NUM_MOTORS];
+        AP_Motors::AP_Motors_limit limit;
+        float throttle_out;
+    };
+
+    AP_MotorsMatrix_Test() :
+        // allocated as the vehicles do, with its memory zeroed
+        m(*new AP_MotorsMatrix(400))
+    {}
+
+    // a frame of num_motors evenly spaced, leaving a gap of two motor
+    // numbers after the third motor if gap is true
+    void set_frame(uint8_t num_motors, bool gap)
+    {
+        for (uint8_t i = 0; i < AP_MOTORS_MAX_NUM_MOTORS; i++) {
+            m.motor_enabled[i] = false;
+            m._roll_factor[i] = m._pitch_factor[i] = m._yaw_factor[i] = 0.0f;
+        }
+        for (uint8_t i = 0; i < num_motors; i++) {
+            const uint8_t motor = (gap && i >= 3) ? i + 2 : i;
+            const float angle = radians(360.0f * i / num_motors + 45.0f);
+            m.motor_enabled[motor] = true;
+            m._roll_factor[motor] = 0.5f * cosf(angle + radians(90));
+            m._pitch_factor[motor] = 0.5f * cosf(angle);
+            m._yaw_factor[motor] = (i & 1) ? 0.5f : -0.5f;
+        }
+        m.update_mix_matrix();
+    }
+
+    void set_inputs(float roll, float pitch, float yaw, float throttle, float lift_max, uint8_t boost, uint8_t lost)
+    {
+        m._roll_in = roll;
+        m._roll_in_ff = 0.01f * pitch;
+        m._pitch_in = pitch;
+        m._pitch_in_ff = 0.0f;
+        m._yaw_in = yaw;
+        m._yaw_in_ff = -0.02f * roll;
+        m._throttle_filter.reset(throttle);
+        m._lift_max = lift_max;
+        m._air_density_ratio = 1.0f;
+        m._throttle_avg_max = 0.5f;
+        m._throttle_thrust_max = 1.0f;
+        m._yaw_headroom.set(boost == 2 ? 300 : 200);
+        m._thrust_boost = boost != 0;
+        m._thrust_boost_ratio = (boost == 1) ? 0.4f : ((boost == 2) ? 1.0f : 0.0f);
+        m._motor_lost_index = lost;
+        m.limit = {};
+        for (uint8_t i = 0; i < AP_MOTORS_MAX_NUM_MOTORS; i++) {
+            m._thrust_rpyt_out[i] = 0.0f;
+        }
+    }
+
+    Result mix()
+    {
+        m.output_armed_stabilizing();
+        Result r;
+        memcpy(r.out, m._thrust_rpyt_out, sizeof(r.out));
+        r.limit = m.limit;
+        r.throttle_out = m._throttle_out;
+        return r;
+    }
+
+    // the mixer as it was before the matrix was packed
+    Result reference_mix()
+    {
+        Result r {};
+        float *_thrust_rpyt_out = r.out;
+        AP_Motors::AP_Motors_limit &limit = r.limit;
+        const bool *motor_enabled = m.motor_enabled;
+        const float *_roll_factor = m._roll_factor;
+        const float *_pitch_factor = m._pitch_factor;
+        const float *_yaw_factor = m._yaw_factor;
+        const bool _thrust_boost = m._thrust_boost;
+        const float _thrust_boost_ratio = m._thrust_boost_ratio;
+        const uint8_t _motor_lost_index = m._motor_lost_index;
+
+        uint8_t i;
+        float   roll_thrust;
+        float   pitch_thrust;
+        float   yaw_thrust;
+        float   throttle_thrust;
+        float   throttle_avg_max;
+        float   throttle_thrust_max;
+        float   throttle_thrust_best_rpy;
+        float   rpy_scale = 1.0f;
+        float   yaw_allowed = 1.0f;
+        float   thr_adj;
+
+        const float compensation_gain = m.get_compensation_gain();
+        roll_thrust = (m._roll_in + m._roll_in_ff) * compensation_gain;
+        pitch_thrust = (m._pitch_in + m._pitch_in_ff) * compensation_gain;
+        yaw_thrust = (m._yaw_in + m._yaw_in_ff) * compensation_gain;
+        throttle_thrust = m.get_throttle() * compensation_gain;
+        throttle_avg_max = m._throttle_avg_max * compensation_gain;
+
+        throttle_thrust_max = _thrust_boost_ratio + (1.0f - _thrust_boost_ratio) * m._throttle_thrust_max * compensation_gain;
+
+        if (throttle_thrust <= 0.0f) {
+            throttle_thrust = 0.0f;
+            limit.throttle_lower = true;
+        }
+        if (throttle_thrust >= throttle_thrust_max) {
+            throttle_thrust = throttle_thrust_max;
+            limit.throttle_upper = true;
+        }
+
+        throttle_avg_max = constrain_float(throttle_avg_max, throttle_thrust, throttle_thrust_max);
+        throttle_thrust_best_rpy = MIN(0.5f, throttle_avg_max);
+
+        float rp_low = 1.0f;
+        float rp_high = -1.0f;
+        for (i = 0; i < AP_MOTORS_MAX_NUM_MOTORS; i++) {
+            if (motor_enabled[i]) {
+                _thrust_rpyt_out[i] = roll_thrust * _roll_factor[i] + pitch_thrust * _pitch_factor[i];
+                if (_thrust_rpyt_out[i] < rp_low) {
+                    rp_low = _thrust_rpyt_out[i];
+                }
+                if (_thrust_rpyt_out[i] > rp_high && (!_thrust_boost || i != _motor_lost_index)) {
+                    rp_high = _thrust_rpyt_out[i];
+                }
+                if (!is_zero(_yaw_factor[i]) && (!_thrust_boost || i != _motor_lost_index)){
+                    if (is_positive(yaw_thrust * _yaw_factor[i])) {
+                        yaw_allowed = MIN(yaw_allowed, fabsf(MAX(1.0f - (throttle_thrust_best_rpy + _thrust_rpyt_out[i]), 0.0f)/_yaw_factor[i]));
+                    } else {
+                        yaw_allowed = MIN(yaw_allowed, fabsf(MAX(throttle_thrust_best_rpy + _thrust_rpyt_out[i], 0.0f)/_yaw_factor[i]));
+                    }
+                }
+            }
+        }
+
+        float yaw_allowed_min = (float)m._yaw_headroom / 1000.0f;
+        yaw_allowed_min = _thrust_boost_ratio * 0.5f + (1.0f - _thrust_boost_ratio) * yaw_allowed_min;
+        yaw_allowed = MAX(yaw_allowed, yaw_allowed_min);
+
+        if (_thrust_boost && motor_enabled[_motor_lost_index]) {
+            if (_thrust_rpyt_out[_motor_lost_index] > rp_high) {
+                rp_high = _thrust_boost_ratio * rp_high + (1.0f - _thrust_boost_ratio) * _thrust_rpyt_out[_motor_lost_index];
+            }
+            if (!is_zero(_yaw_factor[_motor_lost_index])){
+                if (is_positive(yaw_thrust * _yaw_factor[_motor_lost_index])) {
+                    yaw_allowed = _thrust_boost_ratio * yaw_allowed + (1.0f - _thrust_boost_ratio) * MIN(yaw_allowed, fabsf(MAX(1.0f - (throttle_thrust_best_rpy + _thrust_rpyt_out[_motor_lost_index]), 0.0f)/_yaw_factor[_motor_lost_index]));
+                } else {
+                    yaw_allowed = _thrust_boost_ratio * yaw_allowed + (1.0f - _thrust_boost_ratio) * MIN(yaw_allowed, fabsf(MAX(throttle_thrust_best_rpy + _thrust_rpyt_out[_motor_lost_index], 0.0f)/_yaw_factor[_motor_lost_index]));
+                }
+            }
+        }
+
+        if (fabsf(yaw_thrust) > yaw_allowed) {
+            yaw_thrust = constrain_float(yaw_thrust, -yaw_allowed, yaw_allowed);
+            limit.yaw = true;
+        }
+
+        float rpy_low = 1.0f;
+        float rpy_high = -1.0f;
+        for (i = 0; i < AP_MOTORS_MAX_NUM_MOTORS; i++) {
+            if (motor_enabled[i]) {
+                _thrust_rpyt_out[i] = _thrust_rpyt_out[i] + yaw_thrust * _yaw_factor[i];
+                if (_thrust_rpyt_out[i] < rpy_low) {
+                    rpy_low = _thrust_rpyt_out[i];
+                }
+                if (_thrust_rpyt_out[i] > rpy_high && (!_thrust_boost || i != _motor_lost_index)) {
+                    rpy_high = _thrust_rpyt_out[i];
+                }
+            }
+        }
+        if (_thrust_boost) {
+            if (_thrust_rpyt_out[_motor_lost_index] > rpy_high && motor_enabled[_motor_lost_index]) {
+                rpy_high = _thrust_boost_ratio * rpy_high + (1.0f - _thrust_boost_ratio) * _thrust_rpyt_out[_motor_lost_index];
+            }
+        }
+
+        if (rpy_high - rpy_low > 1.0f) {
+            rpy_scale = 1.0f / (rpy_high - rpy_low);
+        }
+        if (throttle_avg_max + rpy_low < 0) {
+            rpy_scale = MIN(rpy_scale, -throttle_avg_max / rpy_low);
+        }
+
+        rpy_high *= rpy_scale;
+        rpy_low *= rpy_scale;
+        throttle_thrust_best_rpy = -rpy_low;
+        thr_adj = throttle_thrust - throttle_thrust_best_rpy;
+        if (rpy_scale < 1.0f) {
+            limit.roll = true;
+            limit.pitch = true;
+            limit.yaw = true;
+            if (thr_adj > 0.0f) {
+                limit.throttle_upper = true;
+            }
+            thr_adj = 0.0f;
+        } else {
+            if (thr_adj < 0.0f) {
+                thr_adj = 0.0f;
+            } else if (thr_adj > 1.0f - (throttle_thrust_best_rpy + rpy_high)) {
+                thr_adj = 1.0f - (throttle_thrust_best_rpy + rpy_high);
+                limit.throttle_upper = true;
+            }
+        }
+
+        for (i = 0; i < AP_MOTORS_MAX_NUM_MOTORS; i++) {
+            if (motor_enabled[i]) {
+                _thrust_rpyt_out[i] = throttle_thrust_best_rpy + thr_adj + (rpy_scale * _thrust_rpyt_out[i]);
+            }
+        }
+
+        r.throttle_out = (throttle_thrust_best_rpy + thr_adj) / compensation_gain;
+        return r;
+    }
+
+    bool enabled(uint8_t i) const { return m.motor_enabled[i]; }
+
+private:
+    AP_MotorsMatrix &m;
+};
+
+static bool same_limits(const AP_Motors::AP_Motors_limit &a, const AP_Motors::AP_Motors_limit &b)
+{
+    return a.roll == b.roll && a.pitch == b.pitch && a.yaw == b.yaw &&
+           a.throttle_lower == b.throttle_lower && a.throttle_upper == b.throttle_upper;
+}
+
+TEST(AP_MotorsMatrix, PackedMixerMatchesReference)
+{
+    static AP_MotorsMatrix_Test motors;
+
+    struct {
+        uint8_t num_motors;
+        bool gap;
+    } frames[] = {
+        { 4, false },
+        { 6, false },
+        { 8, false },
+        { 12, false },
+        { 8, true },
+    };
+    const float steps[] = { -1.0f, -0.4f, -0.05f, 0.0f, 0.05f, 0.4f, 1.0f };
+
+    uint32_t cases = 0;
+    uint32_t failures = 0;
+    for (const auto &frame : frames) {
+        motors.set_frame(frame.num_motors, frame.gap);
+        for (const float roll : steps)
+        for (const float pitch : steps)
+        for (const float yaw : steps)
+        for (const float throttle : { 0.0f, 0.2f, 0.5f, 0.8f, 1.0f })
+        for (const float lift_max : { 1.0f, 0.85f })
+        for (uint8_t boost = 0; boost < 3; boost++)
+        for (const uint8_t lost : { 0, 4, 7 }) {
+            motors.set_inputs(roll, pitch, yaw, throttle, lift_max, boost, lost);
+            const AP_MotorsMatrix_Test::Result expected = motors.reference_mix();
+            const AP_MotorsMatrix_Test::Result result = motors.mix();
+            cases++;
+
+            bool same = same_limits(expected.limit, result.limit) &&
+                        memcmp(&expected.throttle_out, &result.throttle_out, sizeof(float)) == 0;
+            for (uint8_t i = 0; i < AP_MOTORS_MAX_NUM_MOTORS; i++) {
+                if (motors.enabled(i) && memcmp(&expected.out[i], &result.out[i], sizeof(float)) != 0) {
+                    same = false;
+                }
+            }
+            if (!same && failures++ < 10) {
+                ADD_FAILURE() << unsigned(frame.num_motors) << (frame.gap ? " gapped" : "") << " motors"
+                              << " roll " << roll << " pitch " << pitch << " yaw " << yaw
+                              << " throttle " << throttle << " lift_max " << lift_max
+                              << " boost " << unsigned(boost) << " lost " << unsigned(lost);
+            }
+        }
+    }
+    EXPECT_EQ(0U, failures) << "of " << cases;
+}
+
+AP_GTEST_MAIN()
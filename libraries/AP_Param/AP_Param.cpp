@@ -77,6 +77,12 @@ const AP_Param::Info *AP_Param::_var_info;
 struct AP_Param::param_override *AP_Param::param_overrides = nullptr;
 uint16_t AP_Param::num_param_overrides = 0;
 uint16_t AP_Param::num_read_only = 0;
+bool AP_Param::defaults_before_storage;
+
+#if HAL_OS_POSIX_IO == 1
+struct AP_Param::parsed_default *AP_Param::parsed_defaults = nullptr;
+uint16_t AP_Param::num_parsed_defaults = 0;
+#endif
 
 ObjectBuffer<AP_Param::param_save> AP_Param::save_queue{30};
 bool AP_Param::registered_save_handler;
@@ -1391,13 +1397,30 @@ bool AP_Param::load_all()
     struct Param_header phdr;
     uint16_t ofs = sizeof(AP_Param::EEPROM_header);
 
+    // time taken to load, shown with the other perf counters
+    static AP_HAL::Util::perf_counter_t perf_load;
+    if (perf_load == nullptr) {
+        perf_load = hal.util->perf_alloc(AP_HAL::Util::PC_ELAPSED, "param_load");
+    }
+    hal.util->perf_begin(perf_load);
+
+    // the values in storage are loaded after the defaults and
+    // replace them, so the defaults don't need to scan storage
+    defaults_before_storage = true;
     reload_defaults_file(false);
+    defaults_before_storage = false;
 
     if (!registered_save_handler) {
         registered_save_handler = true;
         hal.scheduler->register_io_process(FUNCTOR_BIND((&save_dummy), &AP_Param::save_io_handler, void));
     }
-    
+
+#if AP_PARAM_LOAD_INDEX
+    uint16_t index_count = 0;
+    header_index_entry *index = build_header_index(index_count);
+#endif
+
+    bool found_sentinal = false;
     while (ofs < _storage.size()) {
         _storage.read_block(&phdr, ofs, sizeof(phdr));
         // note that this is an || not an && for robustness
@@ -1405,24 +1428,227 @@ bool AP_Param::load_all()
         if (is_sentinal(phdr)) {
             // we've reached the sentinal
             sentinal_offset = ofs;
-            return true;
+            found_sentinal = true;
+            break;
         }
 
-        const struct AP_Param::Info *info;
-        void *ptr;
-
-        info = find_by_header(phdr, &ptr);
-        if (info != nullptr) {
+        void *ptr = nullptr;
+#if AP_PARAM_LOAD_INDEX
+        if (index != nullptr) {
+            ptr = header_index_find(index, index_count, phdr);
+        } else
+#endif
+        if (find_by_header(phdr, &ptr) == nullptr) {
+            ptr = nullptr;
+        }
+        if (ptr != nullptr) {
             _storage.read_block(ptr, ofs+sizeof(phdr), type_size((enum ap_var_type)phdr.type));
         }
 
         ofs += type_size((enum ap_var_type)phdr.type) + sizeof(phdr);
     }
 
-    // we didn't find the sentinal
-    Debug("no sentinal in load_all");
-    return false;
+#if AP_PARAM_LOAD_INDEX
+    delete[] index;
+#endif
+
+    hal.util->perf_end(perf_load);
+
+    if (!found_sentinal) {
+        // we didn't find the sentinal
+        Debug("no sentinal in load_all");
+        return false;
+    }
+
+    return true;
+}
+
+#if AP_PARAM_LOAD_INDEX
+/*
+  the header of a parameter packed so that sorting on it sorts on key,
+  group element and type. The entries of a group are added in the
+  order of their group elements, so they are close to sorted already
+ */
+uint32_t AP_Param::header_index_value(uint16_t key, uint8_t type, uint32_t group_element)
+{
+    return (uint32_t(key) << 23) | (group_element << 5) | type;
+}
+
+/*
+  add the elements of a group to the header index, or just count them
+  if index is nullptr. This follows the same rules as
+  find_by_header_group()
+ */
+void AP_Param::add_group_to_index(uint16_t vindex, const struct GroupInfo *group_info,
+                                  uint32_t group_base, uint8_t group_shift, ptrdiff_t group_offset,
+                                  struct header_index_entry *index, uint16_t &count)
+{
+    uint8_t type;
+    for (uint8_t i=0;
+         (type=group_info[i].type) != AP_PARAM_NONE;
+         i++) {
+        if (type == AP_PARAM_GROUP) {
+            // a nested group
+            if (group_shift + _group_level_shift >= _group_bits) {
+                continue;
+            }
+            const struct GroupInfo *ginfo = get_group_info(group_info[i]);
+            if (ginfo == nullptr) {
+                continue;
+            }
+            ptrdiff_t new_offset = group_offset;
+            if (!adjust_group_offset(vindex, group_info[i], new_offset)) {
+                continue;
+            }
+            add_group_to_index(vindex, ginfo,
+                               group_id(group_info, group_base, i, group_shift),
+                               group_shift + _group_level_shift, new_offset, index, count);
+            continue;
+        }
+        ptrdiff_t base;
+        if (!get_base(_var_info[vindex], base)) {
+            continue;
+        }
+        if (index != nullptr) {
+            index[count].header = header_index_value(_var_info[vindex].key, type,
+                                                     group_id(group_info, group_base, i, group_shift));
+            index[count].ptr = (void*)(base + group_info[i].offset + group_offset);
+        }
+        count++;
+    }
+}
+
+// insertion sort of the entries of one top level parameter
+void AP_Param::sort_header_index(struct header_index_entry *index, uint16_t count)
+{
+    for (uint16_t i=1; i<count; i++) {
+        const header_index_entry entry = index[i];
+        uint16_t j = i;
+        while (j > 0 && index[j-1].header > entry.header) {
+            index[j] = index[j-1];
+            j--;
+        }
+        index[j] = entry;
+    }
+}
+
+/*
+  build the sorted header index of all parameters, returning nullptr
+  if it could not be allocated. The top level parameters are taken in
+  key order and the few entries of each are sorted, which is much
+  cheaper than sorting the whole index
+ */
+struct AP_Param::header_index_entry *AP_Param::build_header_index(uint16_t &count)
+{
+    // the top level parameters in key order, leaving out any with the
+    // key of an earlier one as find_by_header() would not reach them
+    uint16_t *vars = new uint16_t[_num_vars];
+    if (vars == nullptr) {
+        return nullptr;
+    }
+    uint16_t num_vars = 0;
+    for (uint16_t i=0; i<_num_vars; i++) {
+        const uint16_t key = _var_info[i].key;
+        uint16_t j = num_vars;
+        while (j > 0 && _var_info[vars[j-1]].key > key) {
+            j--;
+        }
+        if (j > 0 && _var_info[vars[j-1]].key == key) {
+            continue;
+        }
+        memmove(&vars[j+1], &vars[j], (num_vars - j) * sizeof(vars[0]));
+        vars[j] = i;
+        num_vars++;
+    }
+
+    header_index_entry *index = nullptr;
+    // the first pass counts the entries, the second fills them in
+    for (uint8_t pass=0; pass<2; pass++) {
+        count = 0;
+        for (uint16_t v=0; v<num_vars; v++) {
+            const uint16_t i = vars[v];
+            const uint8_t type = _var_info[i].type;
+            if (type == AP_PARAM_GROUP) {
+                const struct GroupInfo *group_info = get_group_info(_var_info[i]);
+                if (group_info == nullptr) {
+                    continue;
+                }
+                const uint16_t start = count;
+                add_group_to_index(i, group_info, 0, 0, 0, index, count);
+                if (index != nullptr) {
+                    sort_header_index(&index[start], count - start);
+                }
+                continue;
+            }
+            ptrdiff_t base;
+            if (!get_base(_var_info[i], base)) {
+                continue;
+            }
+            if (index != nullptr) {
+                index[count].header = header_index_value(_var_info[i].key, type, 0);
+                index[count].ptr = (void*)base;
+            }
+            count++;
+        }
+        if (pass == 0) {
+            index = new header_index_entry[count];
+            if (index == nullptr) {
+                break;
+            }
+        }
+    }
+
+    delete[] vars;
+    return index;
+}
+
+// binary search the index for a packed header
+void *AP_Param::header_index_search(const struct header_index_entry *index, uint16_t count, uint32_t header)
+{
+    uint16_t low = 0;
+    uint16_t high = count;
+    while (low < high) {
+        const uint16_t mid = (low + high) / 2;
+        if (index[mid].header < header) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    if (low < count && index[low].header == header) {
+        return index[low].ptr;
+    }
+    return nullptr;
+}
+
+/*
+  find the storage for a parameter header in the index, returning
+  nullptr if it is not a known parameter. This gives the same
+  storage as find_by_header()
+ */
+void *AP_Param::header_index_find(const struct header_index_entry *index, uint16_t count,
+                                  const struct Param_header &phdr)
+{
+    const uint16_t key = get_key(phdr);
+    void *ptr = header_index_search(index, count, header_index_value(key, phdr.type, phdr.group_element));
+    if (ptr != nullptr || phdr.group_element == 0) {
+        return ptr;
+    }
+
+    // find_by_header() takes a top level parameter whatever the group
+    // element in its header. This only costs a scan of the top level
+    // on a miss
+    for (uint16_t i=0; i<_num_vars; i++) {
+        if (_var_info[i].key == key) {
+            if (_var_info[i].type == AP_PARAM_GROUP) {
+                return nullptr;
+            }
+            return header_index_search(index, count, header_index_value(key, phdr.type, 0));
+        }
+    }
+    return nullptr;
 }
+#endif // AP_PARAM_LOAD_INDEX
 
 /*
  * reload from hal.util defaults file or embedded param region
@@ -1986,18 +2212,18 @@ bool AP_Param::parse_param_line(char *line, char **vname, float &value, bool &re
 #if HAL_OS_POSIX_IO == 1
 #include <stdio.h>
 
-// increments num_defaults for each default found in filename
-bool AP_Param::count_defaults_in_file(const char *filename, uint16_t &num_defaults)
+/*
+  parse a defaults file, adding its parameters to parsed_defaults
+ */
+bool AP_Param::parse_defaults_file(const char *filename, uint8_t file_idx)
 {
     FILE *f = fopen(filename, "r");
     if (f == nullptr) {
         return false;
     }
-    char line[100];
 
-    /*
-      work out how many parameter default structures to allocate
-     */
+    uint16_t space = num_parsed_defaults;
+    char line[100];
     while (fgets(line, sizeof(line)-1, f)) {
         char *pname;
         float value;
@@ -2005,11 +2231,25 @@ bool AP_Param::count_defaults_in_file(const char *filename, uint16_t &num_defaul
         if (!parse_param_line(line, &pname, value, read_only)) {
             continue;
         }
-        enum ap_var_type var_type;
-        if (!find(pname, &var_type)) {
-            continue;
+        if (num_parsed_defaults == space) {
+            // grow the list
+            space = MAX(2U*space, 64U);
+            parsed_default *new_defaults = new parsed_default[space];
+            if (new_defaults == nullptr) {
+                AP_HAL::panic("AP_Param: Failed to allocate defaults");
+            }
+            if (parsed_defaults != nullptr) {
+                memcpy(new_defaults, parsed_defaults, num_parsed_defaults*sizeof(parsed_defaults[0]));
+                delete[] parsed_defaults;
+            }
+            parsed_defaults = new_defaults;
         }
-        num_defaults++;
+        parsed_default &d = parsed_defaults[num_parsed_defaults++];
+        strncpy(d.name, pname, AP_MAX_NAME_SIZE);
+        d.name[AP_MAX_NAME_SIZE] = 0;
+        d.value = value;
+        d.read_only = read_only;
+        d.file_idx = file_idx;
     }
 
     fclose(f);
@@ -2017,52 +2257,31 @@ bool AP_Param::count_defaults_in_file(const char *filename, uint16_t &num_defaul
     return true;
 }
 
-bool AP_Param::read_param_defaults_file(const char *filename, bool last_pass)
-{
-    FILE *f = fopen(filename, "r");
-    if (f == nullptr) {
-        AP_HAL::panic("AP_Param: Failed to re-open defaults file");
-        return false;
-    }
-
-    uint16_t idx = 0;
-    char line[100];
-    while (fgets(line, sizeof(line)-1, f)) {
-        char *pname;
-        float value;
-        bool read_only;
-        if (!parse_param_line(line, &pname, value, read_only)) {
-            continue;
-        }
-        enum ap_var_type var_type;
-        AP_Param *vp = find(pname, &var_type);
-        if (!vp) {
-            if (last_pass) {
-                ::printf("Ignored unknown param %s in defaults file %s\n",
-                         pname, filename);
-                hal.console->printf(
-                         "Ignored unknown param %s in defaults file %s\n",
-                         pname, filename);
-            }
-            continue;
-        }
-        param_overrides[idx].object_ptr = vp;
-        param_overrides[idx].value = value;
-        param_overrides[idx].read_only = read_only;
-        if (read_only) {
-            num_read_only++;
-        }
-        idx++;
-        if (!vp->configured_in_storage()) {
-            vp->set_float(value, var_type);
+/*
+  get the name of file number idx in a comma separated list of
+  defaults files, counting the files the way strtok_r() splits the list
+ */
+static void defaults_file_name(const char *filenames, uint8_t idx, char *name, size_t size)
+{
+    const char *p = filenames;
+    size_t len;
+    while (true) {
+        p += strspn(p, ",");
+        len = strcspn(p, ",");
+        if (idx == 0 || p[len] == 0) {
+            break;
         }
+        idx--;
+        p += len;
     }
-    fclose(f);
-    return true;
+    len = MIN(len, size-1);
+    memcpy(name, p, len);
+    name[len] = 0;
 }
 
 /*
-  load a default set of parameters from a file
+  load a default set of parameters from a file. The files are parsed
+  on the first call, later calls apply the parsed values again
  */
 bool AP_Param::load_defaults_file(const char *filename, bool last_pass)
 {
@@ -2070,53 +2289,68 @@ bool AP_Param::load_defaults_file(const char *filename, bool last_pass)
         return false;
     }
 
-    char *mutable_filename = strdup(filename);
-    if (mutable_filename == nullptr) {
-        AP_HAL::panic("AP_Param: Failed to allocate mutable string");
-    }
-
-    uint16_t num_defaults = 0;
-    char *saveptr = nullptr;
-    for (char *pname = strtok_r(mutable_filename, ",", &saveptr);
-         pname != nullptr;
-         pname = strtok_r(nullptr, ",", &saveptr)) {
-        if (!count_defaults_in_file(pname, num_defaults)) {
-            free(mutable_filename);
-            return false;
+    if (parsed_defaults == nullptr) {
+        char *mutable_filename = strdup(filename);
+        if (mutable_filename == nullptr) {
+            AP_HAL::panic("AP_Param: Failed to allocate mutable string");
+        }
+        char *saveptr = nullptr;
+        uint8_t file_idx = 0;
+        for (char *pname = strtok_r(mutable_filename, ",", &saveptr);
+             pname != nullptr;
+             pname = strtok_r(nullptr, ",", &saveptr)) {
+            if (!parse_defaults_file(pname, file_idx++)) {
+                // don't leave a partial list to be applied by later calls
+                free(mutable_filename);
+                delete[] parsed_defaults;
+                parsed_defaults = nullptr;
+                num_parsed_defaults = 0;
+                return false;
+            }
         }
+        free(mutable_filename);
     }
-    free(mutable_filename);
 
     delete[] param_overrides;
     num_param_overrides = 0;
     num_read_only = 0;
 
-    param_overrides = new param_override[num_defaults];
+    param_overrides = new param_override[num_parsed_defaults];
     if (param_overrides == nullptr) {
         AP_HAL::panic("AP_Param: Failed to allocate overrides");
         return false;
     }
 
-    if (num_defaults == 0) {
-        return true;
-    }
-
-    saveptr = nullptr;
-    mutable_filename = strdup(filename);
-    if (mutable_filename == nullptr) {
-        AP_HAL::panic("AP_Param: Failed to allocate mutable string");
-    }
-    for (char *pname = strtok_r(mutable_filename, ",", &saveptr);
-         pname != nullptr;
-         pname = strtok_r(nullptr, ",", &saveptr)) {
-        if (!read_param_defaults_file(pname, last_pass)) {
-            free(mutable_filename);
-            return false;
+    uint16_t idx = 0;
+    for (uint16_t i=0; i<num_parsed_defaults; i++) {
+        const parsed_default &d = parsed_defaults[i];
+        enum ap_var_type var_type;
+        AP_Param *vp = find(d.name, &var_type);
+        if (!vp) {
+            if (last_pass) {
+                char file[100];
+                defaults_file_name(filename, d.file_idx, file, sizeof(file));
+                ::printf("Ignored unknown param %s in defaults file %s\n",
+                         d.name, file);
+                hal.console->printf(
+                         "Ignored unknown param %s in defaults file %s\n",
+                         d.name, file);
+            }
+            continue;
+        }
+        param_overrides[idx].object_ptr = vp;
+        param_overrides[idx].value = d.value;
+        param_overrides[idx].read_only = d.read_only;
+        if (d.read_only) {
+            num_read_only++;
+        }
+        idx++;
+        if (defaults_before_storage || !vp->configured_in_storage()) {
+            vp->set_float(d.value, var_type);
         }
     }
-    free(mutable_filename);
 
-    num_param_overrides = num_defaults;
+    num_param_overrides = idx;
 
     return true;
 }
@@ -2249,7 +2483,7 @@ void AP_Param::load_embedded_param_defaults(bool last_pass)
             num_read_only++;
         }
         idx++;
-        if (!vp->configured_in_storage()) {
+        if (defaults_before_storage || !vp->configured_in_storage()) {
             vp->set_float(value, var_type);
         }
     }
@@ -42,6 +42,15 @@
 #define AP_PARAM_MAX_EMBEDDED_PARAM 8192
 #endif
 
+/*
+  build a sorted index of parameter headers in load_all(), so each
+  stored value is found with a binary search rather than by walking
+  var_info. The index is freed once loading is done
+ */
+#ifndef AP_PARAM_LOAD_INDEX
+#define AP_PARAM_LOAD_INDEX HAL_OS_POSIX_IO
+#endif
+
 /*
   flags for variables in var_info and group tables
  */
@@ -484,6 +493,8 @@ public:
 #endif // AP_PARAM_KEY_DUMP
 
 private:
+    friend class AP_Param_Test;
+
     /// EEPROM header
     ///
     /// This structure is placed at the head of the EEPROM to indicate
@@ -626,11 +637,43 @@ private:
     /*
       load a parameter defaults file. This happens as part of load_all()
      */
-    static bool count_defaults_in_file(const char *filename, uint16_t &num_defaults);
-    static bool read_param_defaults_file(const char *filename, bool last_pass);
+    static bool parse_defaults_file(const char *filename, uint8_t file_idx);
     static bool load_defaults_file(const char *filename, bool last_pass);
+
+    /*
+      defaults files are parsed once into this list, and the list is
+      applied on each load so the files are not parsed again
+     */
+    struct parsed_default {
+        char name[AP_MAX_NAME_SIZE+1];
+        float value;
+        bool read_only;
+        uint8_t file_idx;   // which of the comma separated files it came from
+    };
+    static struct parsed_default *parsed_defaults;
+    static uint16_t num_parsed_defaults;
 #endif
 
+#if AP_PARAM_LOAD_INDEX
+    struct header_index_entry {
+        uint32_t header;
+        void *ptr;
+    };
+    static uint32_t header_index_value(uint16_t key, uint8_t type, uint32_t group_element);
+    static void add_group_to_index(uint16_t vindex, const struct GroupInfo *group_info,
+                                   uint32_t group_base, uint8_t group_shift, ptrdiff_t group_offset,
+                                   struct header_index_entry *index, uint16_t &count);
+    static void sort_header_index(struct header_index_entry *index, uint16_t count);
+    static struct header_index_entry *build_header_index(uint16_t &count);
+    static void *header_index_search(const struct header_index_entry *index, uint16_t count, uint32_t header);
+    static void *header_index_find(const struct header_index_entry *index, uint16_t count,
+                                   const struct Param_header &phdr);
+#endif
+
+    // true while load_all() applies defaults before reading storage,
+    // so defaults need not check whether they are in storage
+    static bool defaults_before_storage;
+
     /*
       load defaults from embedded parameters
      */
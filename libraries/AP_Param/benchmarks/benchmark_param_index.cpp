@@ -0,0 +1,204 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_Math/AP_Math.h>
+#include <AP_Param/AP_Param.h>
+
+#include <vector>
+
+/*
+  cost of building the header index load_all() uses, and of finding
+  the storage of each header in it against the linear find_by_header()
+  it replaces, on a table about the size of a vehicle's
+ */
+
+const AP_HAL::HAL &hal = AP_HAL::get_HAL();
+
+#if AP_PARAM_LOAD_INDEX
+
+class ParamBenchInner {
+public:
+    static const struct AP_Param::GroupInfo var_info[];
+
+    AP_Float p[8];
+};
+
+const AP_Param::GroupInfo ParamBenchInner::var_info[] = {
+    AP_GROUPINFO("P0", 0, ParamBenchInner, p[0], 0),
+    AP_GROUPINFO("P1", 1, ParamBenchInner, p[1], 0),
+    AP_GROUPINFO("P2", 2, ParamBenchInner, p[2], 0),
+    AP_GROUPINFO("P3", 3, ParamBenchInner, p[3], 0),
+    AP_GROUPINFO("P4", 4, ParamBenchInner, p[4], 0),
+    AP_GROUPINFO("P5", 5, ParamBenchInner, p[5], 0),
+    AP_GROUPINFO("P6", 6, ParamBenchInner, p[6], 0),
+    AP_GROUPINFO("P7", 7, ParamBenchInner, p[7], 0),
+    AP_GROUPEND
+};
+
+class ParamBenchGroup {
+public:
+    static const struct AP_Param::GroupInfo var_info[];
+
+    AP_Int8 i8[4];
+    AP_Int16 i16[4];
+    AP_Float f[8];
+    ParamBenchInner inner;
+};
+
+const AP_Param::GroupInfo ParamBenchGroup::var_info[] = {
+    AP_GROUPINFO("I80", 0, ParamBenchGroup, i8[0], 0),
+    AP_GROUPINFO("I81", 1, ParamBenchGroup, i8[1], 0),
+    AP_GROUPINFO("I82", 2, ParamBenchGroup, i8[2], 0),
+    AP_GROUPINFO("I83", 3, ParamBenchGroup, i8[3], 0),
+    AP_GROUPINFO("I160", 4, ParamBenchGroup, i16[0], 0),
+    AP_GROUPINFO("I161", 5, ParamBenchGroup, i16[1], 0),
+    AP_GROUPINFO("I162", 6, ParamBenchGroup, i16[2], 0),
+    AP_GROUPINFO("I163", 7, ParamBenchGroup, i16[3], 0),
+    AP_GROUPINFO("F0", 8, ParamBenchGroup, f[0], 0),
+    AP_GROUPINFO("F1", 9, ParamBenchGroup, f[1], 0),
+    AP_GROUPINFO("F2", 10, ParamBenchGroup, f[2], 0),
+    AP_GROUPINFO("F3", 11, ParamBenchGroup, f[3], 0),
+    AP_GROUPINFO("F4", 12, ParamBenchGroup, f[4], 0),
+    AP_GROUPINFO("F5", 13, ParamBenchGroup, f[5], 0),
+    AP_GROUPINFO("F6", 14, ParamBenchGroup, f[6], 0),
+    AP_GROUPINFO("F7", 15, ParamBenchGroup, f[7], 0),
+    AP_SUBGROUPINFO(inner, "IN_", 16, ParamBenchGroup, ParamBenchInner),
+    AP_GROUPEND
+};
+
+/*
+  a top level scalar before each group, as a vehicle's table mixes
+  them, for 64 scalars and 64 groups of 24 parameters
+ */
+#define PARAM_BENCH_NUM_GROUPS 64
+
+static AP_Float scalars[PARAM_BENCH_NUM_GROUPS];
+static ParamBenchGroup groups[PARAM_BENCH_NUM_GROUPS];
+static std::vector<AP_Param::Info> var_info;
+
+class AP_Param_Test {
+public:
+    static void setup()
+    {
+        if (!var_info.empty()) {
+            return;
+        }
+        for (uint16_t i = 0; i < PARAM_BENCH_NUM_GROUPS; i++) {
+            var_info.push_back({ AP_PARAM_FLOAT, "S", uint16_t(2 * i + 1), &scalars[i], {def_value : 0}, 0 });
+            var_info.push_back({ AP_PARAM_GROUP, "G_", uint16_t(2 * i + 2), &groups[i], {group_info : ParamBenchGroup::var_info}, 0 });
+        }
+        var_info.push_back(AP_VAREND);
+        AP_Param param_loader(var_info.data());
+    }
+
+    static void build(benchmark::State& state)
+    {
+        setup();
+        while (state.KeepRunning()) {
+            uint16_t count;
+            AP_Param::header_index_entry *index = AP_Param::build_header_index(count);
+            gbenchmark_escape(index);
+            delete[] index;
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+
+    // the headers of every parameter, in the order of the index
+    static std::vector<AP_Param::Param_header> headers(const AP_Param::header_index_entry *index, uint16_t count)
+    {
+        std::vector<AP_Param::Param_header> phdrs;
+        for (uint16_t i = 0; i < count; i++) {
+            AP_Param::Param_header phdr {};
+            AP_Param::set_key(phdr, index[i].header >> 23);
+            phdr.type = index[i].header & 0x1F;
+            phdr.group_element = (index[i].header >> 5) & ((1U << AP_Param::_group_bits) - 1);
+            phdrs.push_back(phdr);
+        }
+        return phdrs;
+    }
+
+    static void find(benchmark::State& state, bool use_index)
+    {
+        setup();
+        uint16_t count;
+        AP_Param::header_index_entry *index = AP_Param::build_header_index(count);
+        const std::vector<AP_Param::Param_header> phdrs = headers(index, count);
+
+        uint16_t i = 0;
+        while (state.KeepRunning()) {
+            void *ptr = nullptr;
+            if (use_index) {
+                ptr = AP_Param::header_index_find(index, count, phdrs[i]);
+            } else {
+                AP_Param::find_by_header(phdrs[i], &ptr);
+            }
+            gbenchmark_escape(ptr);
+            i = (i + 1) % count;
+        }
+        state.SetItemsProcessed(state.iterations());
+
+        delete[] index;
+    }
+
+    // find every parameter once as load_all() does, with the index built for the load or without it
+    static void load(benchmark::State& state, bool use_index)
+    {
+        setup();
+        uint16_t count;
+        AP_Param::header_index_entry *all = AP_Param::build_header_index(count);
+        const std::vector<AP_Param::Param_header> phdrs = headers(all, count);
+        delete[] all;
+
+        while (state.KeepRunning()) {
+            AP_Param::header_index_entry *index = nullptr;
+            if (use_index) {
+                index = AP_Param::build_header_index(count);
+            }
+            for (const AP_Param::Param_header &phdr : phdrs) {
+                void *ptr = nullptr;
+                if (index != nullptr) {
+                    ptr = AP_Param::header_index_find(index, count, phdr);
+                } else {
+                    AP_Param::find_by_header(phdr, &ptr);
+                }
+                gbenchmark_escape(ptr);
+            }
+            delete[] index;
+        }
+        state.SetItemsProcessed(state.iterations() * phdrs.size());
+    }
+};
+
+static void BM_ParamIndexBuild(benchmark::State& state)
+{
+    AP_Param_Test::build(state);
+}
+
+static void BM_ParamIndexFind(benchmark::State& state)
+{
+    AP_Param_Test::find(state, true);
+}
+
+static void BM_ParamFindByHeader(benchmark::State& state)
+{
+    AP_Param_Test::find(state, false);
+}
+
+static void BM_ParamLoadIndexed(benchmark::State& state)
+{
+    AP_Param_Test::load(state, true);
+}
+
+static void BM_ParamLoadLinear(benchmark::State& state)
+{
+    AP_Param_Test::load(state, false);
+}
+
+BENCHMARK(BM_ParamIndexBuild);
+BENCHMARK(BM_ParamIndexFind);
+BENCHMARK(BM_ParamFindByHeader);
+BENCHMARK(BM_ParamLoadIndexed);
+BENCHMARK(BM_ParamLoadLinear);
+
+#endif // AP_PARAM_LOAD_INDEX
+
+BENCHMARK_MAIN()
@@ -0,0 +1,163 @@
+#include <AP_gtest.h>
+
+#include <AP_Math/AP_Math.h>
+#include <AP_Param/AP_Param.h>
+
+#include <set>
+
+const AP_HAL::HAL &hal = AP_HAL::get_HAL();
+
+#if AP_PARAM_LOAD_INDEX
+
+// the innermost object, nested two levels down in ParamIndexOuter
+class ParamIndexInner {
+public:
+    static const struct AP_Param::GroupInfo var_info[];
+
+    AP_Int8 a;
+    AP_Float b;
+    AP_Vector3f v;
+};
+
+const AP_Param::GroupInfo ParamIndexInner::var_info[] = {
+    AP_GROUPINFO("A", 1, ParamIndexInner, a, 1),
+    AP_GROUPINFO("B", 2, ParamIndexInner, b, 2.5f),
+    AP_GROUPINFO("V", 5, ParamIndexInner, v, 0),
+    AP_GROUPEND
+};
+
+class ParamIndexMiddle {
+public:
+    static const struct AP_Param::GroupInfo var_info[];
+
+    AP_Int32 e;
+    ParamIndexInner inner;
+};
+
+const AP_Param::GroupInfo ParamIndexMiddle::var_info[] = {
+    AP_GROUPINFO("E", 0, ParamIndexMiddle, e, 3),
+    AP_SUBGROUPINFO(inner, "IN_", 63, ParamIndexMiddle, ParamIndexInner),
+    AP_GROUPEND
+};
+
+class ParamIndexOuter {
+public:
+    static const struct AP_Param::GroupInfo var_info[];
+
+    AP_Int16 c;
+    ParamIndexMiddle middle;
+    AP_Float d;
+    ParamIndexInner inner;
+};
+
+const AP_Param::GroupInfo ParamIndexOuter::var_info[] = {
+    AP_GROUPINFO("C", 0, ParamIndexOuter, c, 4),
+    AP_SUBGROUPINFO(middle, "MID_", 1, ParamIndexOuter, ParamIndexMiddle),
+    AP_GROUPINFO("D", 2, ParamIndexOuter, d, 5),
+    AP_SUBGROUPINFO(inner, "IN_", 3, ParamIndexOuter, ParamIndexInner),
+    AP_GROUPEND
+};
+
+static AP_Int8 s8;
+static AP_Int16 s16;
+static AP_Int32 s32;
+static AP_Float sfloat;
+static AP_Vector3f svector;
+static ParamIndexOuter outer1;
+static ParamIndexOuter outer2;
+
+// a vehicle table with its keys out of order and one using the ninth key bit
+static const AP_Param::Info var_info[] = {
+    { AP_PARAM_INT8, "S8", 7, &s8, {def_value : 1}, 0 },
+    { AP_PARAM_GROUP, "O1_", 2, &outer1, {group_info : ParamIndexOuter::var_info}, 0 },
+    { AP_PARAM_INT16, "S16", 0, &s16, {def_value : 2}, 0 },
+    { AP_PARAM_FLOAT, "SF", 300, &sfloat, {def_value : 3}, 0 },
+    { AP_PARAM_GROUP, "O2_", 510, &outer2, {group_info : ParamIndexOuter::var_info}, 0 },
+    { AP_PARAM_INT32, "S32", 256, &s32, {def_value : 4}, 0 },
+    { AP_PARAM_VECTOR3F, "SV", 9, &svector, {def_value : 0}, 0 },
+    AP_VAREND
+};
+
+static AP_Param param_loader(var_info);
+
+class AP_Param_Test {
+public:
+    /*
+      check the index finds the same storage as find_by_header() for
+      every key and type, with each group element in use and some
+      next to them that are not, so misses are checked too
+     */
+    static void check_index_matches_find_by_header()
+    {
+        uint16_t count = 0;
+        AP_Param::header_index_entry *index = AP_Param::build_header_index(count);
+        ASSERT_NE(nullptr, index);
+
+        // the five top level parameters and nine in each object
+        EXPECT_EQ(23U, count);
+        for (uint16_t i = 1; i < count; i++) {
+            ASSERT_LT(index[i-1].header, index[i].header);
+        }
+
+        // each entry is the storage find_by_header() gives for its header
+        const uint32_t group_element_mask = (1U << AP_Param::_group_bits) - 1;
+        std::set<uint32_t> group_elements { 0, group_element_mask };
+        for (uint16_t i = 0; i < count; i++) {
+            AP_Param::Param_header phdr {};
+            AP_Param::set_key(phdr, index[i].header >> 23);
+            phdr.type = index[i].header & 0x1F;
+            phdr.group_element = (index[i].header >> 5) & group_element_mask;
+            void *ptr = nullptr;
+            EXPECT_NE(nullptr, AP_Param::find_by_header(phdr, &ptr));
+            EXPECT_EQ(ptr, index[i].ptr);
+            EXPECT_EQ(index[i].header, AP_Param::header_index_value(AP_Param::get_key(phdr), phdr.type, phdr.group_element));
+
+            const uint32_t group_element = phdr.group_element;
+            group_elements.insert(group_element);
+            group_elements.insert((group_element + 1) & group_element_mask);
+            group_elements.insert((group_element << AP_Param::_group_level_shift) & group_element_mask);
+        }
+
+        for (uint16_t key = 0; key <= AP_Param::_sentinal_key; key++) {
+            for (uint8_t type = 0; type < 32; type++) {
+                for (const uint32_t group_element : group_elements) {
+                    AP_Param::Param_header phdr {};
+                    AP_Param::set_key(phdr, key);
+                    phdr.type = type;
+                    phdr.group_element = group_element;
+
+                    void *ptr = nullptr;
+                    if (AP_Param::find_by_header(phdr, &ptr) == nullptr) {
+                        ptr = nullptr;
+                    }
+                    void *index_ptr = AP_Param::header_index_find(index, count, phdr);
+                    ASSERT_EQ(ptr, index_ptr) << key << " " << unsigned(type) << " " << group_element;
+                }
+            }
+        }
+        delete[] index;
+    }
+
+    // lookups in an index with no entries miss
+    static void check_empty_index()
+    {
+        AP_Param::Param_header phdr {};
+        AP_Param::set_key(phdr, 7);
+        phdr.type = AP_PARAM_INT8;
+        EXPECT_EQ(nullptr, AP_Param::header_index_find(nullptr, 0, phdr));
+    }
+};
+
+TEST(AP_Param, header_index_matches_find_by_header)
+{
+    AP_Param_Test::check_index_matches_find_by_header();
+}
+
+TEST(AP_Param, header_index_empty)
+{
+    AP_Param_Test::check_empty_index();
+}
+
+#endif // AP_PARAM_LOAD_INDEX
+
+AP_GTEST_MAIN()
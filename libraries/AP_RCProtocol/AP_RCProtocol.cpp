@@ -136,8 +136,26 @@ bool AP_RCProtocol::process_byte(uint8_t byte, uint32_t baudrate)
         return true;
     }
 
-    // otherwise scan all protocols
+    // at a frame gap work out which protocols the first byte could
+    // start a frame of, and only pass the bytes to those until the
+    // next gap
+    const uint32_t now_us = AP_HAL::micros();
+    const uint32_t gap_us = now_us - _last_byte_us;
+    _last_byte_us = now_us;
+    if (gap_us >= RC_FRAME_GAP_US) {
+        _byte_candidates = 0;
+        for (uint8_t i = 0; i < AP_RCProtocol::NONE; i++) {
+            if (backend[i] != nullptr && backend[i]->frame_candidate(byte, baudrate, gap_us)) {
+                _byte_candidates |= (1U << i);
+            }
+        }
+    }
+
+    // otherwise scan the candidate protocols
     for (uint8_t i = 0; i < AP_RCProtocol::NONE; i++) {
+        if (!(_byte_candidates & (1U << i))) {
+            continue;
+        }
         if (backend[i] != nullptr) {
             uint32_t frame_count = backend[i]->get_rc_frame_count();
             uint32_t input_count = backend[i]->get_rc_input_count();
@@ -21,6 +21,9 @@
 #define MAX_RCIN_CHANNELS 18
 #define MIN_RCIN_CHANNELS  5
 
+// shortest gap between bytes which starts a new frame in every byte protocol
+#define RC_FRAME_GAP_US 2000U
+
 class AP_RCProtocol_Backend;
 
 class AP_RCProtocol {
@@ -93,6 +96,12 @@ private:
     bool _valid_serial_prot = false;
     uint8_t _good_frames[NONE];
 
+    // time of the last byte while searching for a byte protocol
+    uint32_t _last_byte_us;
+    // mask of backends which may be receiving a frame, updated at
+    // each frame gap from the first byte after the gap
+    uint16_t _byte_candidates = (1U<<NONE)-1;
+
     enum config_phase {
         CONFIG_115200_8N1 = 0,
         CONFIG_115200_8N1I = 1,
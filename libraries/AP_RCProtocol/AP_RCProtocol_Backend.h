@@ -27,6 +27,12 @@ public:
     virtual ~AP_RCProtocol_Backend() {}
     virtual void process_pulse(uint32_t width_s0, uint32_t width_s1) {}
     virtual void process_byte(uint8_t byte, uint32_t baudrate) {}
+
+    // return true if byte, the first after a gap of gap_us in the
+    // input, may be part of a frame of this protocol. While searching
+    // for the protocol in use, bytes up to the next gap are only
+    // passed to backends which return true
+    virtual bool frame_candidate(uint8_t byte, uint32_t baudrate, uint32_t gap_us) const { return true; }
     uint16_t read(uint8_t chan);
     void read(uint16_t *pwm, uint8_t n);
     bool new_input();
@@ -479,3 +479,9 @@ void AP_RCProtocol_DSM::process_byte(uint8_t b, uint32_t baudrate)
     }
     _process_byte(AP_HAL::millis(), b);
 }
+
+// DSM frames have no header byte
+bool AP_RCProtocol_DSM::frame_candidate(uint8_t b, uint32_t baudrate, uint32_t gap_us) const
+{
+    return baudrate == 115200;
+}
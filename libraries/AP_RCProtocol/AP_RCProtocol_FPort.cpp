@@ -360,3 +360,9 @@ void AP_RCProtocol_FPort::process_byte(uint8_t b, uint32_t baudrate)
     }
     _process_byte(AP_HAL::micros(), b);
 }
+
+// FPort finds its frame head without needing a gap
+bool AP_RCProtocol_FPort::frame_candidate(uint8_t b, uint32_t baudrate, uint32_t gap_us) const
+{
+    return baudrate == 115200;
+}
@@ -104,3 +104,9 @@ void AP_RCProtocol_IBUS::process_byte(uint8_t b, uint32_t baudrate)
     }
     _process_byte(AP_HAL::micros(), b);
 }
+
+// a frame gap must be followed by the length byte
+bool AP_RCProtocol_IBUS::frame_candidate(uint8_t b, uint32_t baudrate, uint32_t gap_us) const
+{
+    return baudrate == 115200 && b == 0x20;
+}
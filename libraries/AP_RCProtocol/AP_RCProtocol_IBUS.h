@@ -28,6 +28,7 @@ public:
     AP_RCProtocol_IBUS(AP_RCProtocol &_frontend);
     void process_pulse(uint32_t width_s0, uint32_t width_s1) override;
     void process_byte(uint8_t byte, uint32_t baudrate) override;
+    bool frame_candidate(uint8_t byte, uint32_t baudrate, uint32_t gap_us) const override;
 private:
     void _process_byte(uint32_t timestamp_us, uint8_t byte);
     bool ibus_decode(const uint8_t frame[IBUS_FRAME_SIZE], uint16_t *values, bool *ibus_failsafe);
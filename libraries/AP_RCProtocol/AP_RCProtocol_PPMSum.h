@@ -22,6 +22,7 @@ class AP_RCProtocol_PPMSum : public AP_RCProtocol_Backend {
 public:
     AP_RCProtocol_PPMSum(AP_RCProtocol &_frontend) : AP_RCProtocol_Backend(_frontend) {}
     void process_pulse(uint32_t width_s0, uint32_t width_s1) override;
+    bool frame_candidate(uint8_t byte, uint32_t baudrate, uint32_t gap_us) const override { return false; }
 private:
     // state of ppm decoder
     struct {
@@ -267,3 +267,9 @@ void AP_RCProtocol_SBUS::process_byte(uint8_t b, uint32_t baudrate)
     }
     _process_byte(AP_HAL::micros(), b);
 }
+
+// a frame gap must be followed by the start byte
+bool AP_RCProtocol_SBUS::frame_candidate(uint8_t b, uint32_t baudrate, uint32_t gap_us) const
+{
+    return baudrate == 100000 && b == 0x0F;
+}
@@ -25,6 +25,7 @@ public:
     AP_RCProtocol_SBUS(AP_RCProtocol &_frontend, bool inverted);
     void process_pulse(uint32_t width_s0, uint32_t width_s1) override;
     void process_byte(uint8_t byte, uint32_t baudrate) override;
+    bool frame_candidate(uint8_t byte, uint32_t baudrate, uint32_t gap_us) const override;
 private:
     void _process_byte(uint32_t timestamp_us, uint8_t byte);
     bool sbus_decode(const uint8_t frame[25], uint16_t *values, uint16_t *num_values,
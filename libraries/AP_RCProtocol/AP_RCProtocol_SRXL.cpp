@@ -280,3 +280,14 @@ void AP_RCProtocol_SRXL::process_byte(uint8_t byte, uint32_t baudrate)
     }
     _process_byte(AP_HAL::micros(), byte);
 }
+
+// a gap of SRXL_MIN_FRAMESPACE_US must be followed by a header
+// byte, shorter gaps may be within a frame
+bool AP_RCProtocol_SRXL::frame_candidate(uint8_t byte, uint32_t baudrate, uint32_t gap_us) const
+{
+    if (baudrate != 115200) {
+        return false;
+    }
+    return gap_us < SRXL_MIN_FRAMESPACE_US ||
+        byte == SRXL_HEADER_V1 || byte == SRXL_HEADER_V2 || byte == SRXL_HEADER_V5;
+}
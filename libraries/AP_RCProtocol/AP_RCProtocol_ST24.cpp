@@ -231,3 +231,9 @@ void AP_RCProtocol_ST24::process_byte(uint8_t byte, uint32_t baudrate)
     }
     _process_byte(byte);
 }
+
+// ST24 finds its header without needing a gap
+bool AP_RCProtocol_ST24::frame_candidate(uint8_t byte, uint32_t baudrate, uint32_t gap_us) const
+{
+    return baudrate == 115200;
+}
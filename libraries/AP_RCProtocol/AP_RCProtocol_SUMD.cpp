@@ -330,3 +330,9 @@ void AP_RCProtocol_SUMD::process_byte(uint8_t byte, uint32_t baudrate)
     }
     _process_byte(AP_HAL::micros(), byte);
 }
+
+// SUMD finds its header without needing a gap
+bool AP_RCProtocol_SUMD::frame_candidate(uint8_t byte, uint32_t baudrate, uint32_t gap_us) const
+{
+    return baudrate == 115200;
+}
@@ -65,7 +65,9 @@ static bool check_result(const char *name, bool bytes, const uint16_t *values, u
 }
 
 /*
-  test a byte protocol handler
+  test a byte protocol handler, reporting the number of frames needed
+  to detect the protocol and the time taken per byte while searching
+  and once detected
  */
 static bool test_byte_protocol(const char *name, uint32_t baudrate,
                                const uint8_t *bytes, uint8_t nbytes,
@@ -73,15 +75,33 @@ static bool test_byte_protocol(const char *name, uint32_t baudrate,
                                uint8_t repeats)
 {
     bool ret = true;
+    uint8_t detect_frames = 0;
+    uint32_t search_us = 0, search_bytes = 0;
+    uint32_t detected_us = 0, detected_bytes = 0;
     for (uint8_t repeat=0; repeat<repeats+4; repeat++) {
+        const bool detected = rcprot->protocol_detected() != AP_RCProtocol::NONE;
+        const uint32_t start_us = AP_HAL::micros();
         for (uint8_t i=0; i<nbytes; i++) {
             rcprot->process_byte(bytes[i], baudrate);
         }
+        const uint32_t dt_us = AP_HAL::micros() - start_us;
+        if (detected) {
+            detected_us += dt_us;
+            detected_bytes += nbytes;
+        } else {
+            search_us += dt_us;
+            search_bytes += nbytes;
+            detect_frames = repeat+1;
+        }
         hal.scheduler->delay(10);
         if (repeat > repeats) {
             ret &= check_result(name, true, values, nvalues);
         }
     }
+    printf("%s(bytes): detected after %u frames, %.2fus/byte searching, %.2fus/byte detected\n",
+           name, detect_frames,
+           search_bytes?search_us/float(search_bytes):0.0,
+           detected_bytes?detected_us/float(detected_bytes):0.0);
     return ret;
 }
 
@@ -25,90 +25,254 @@
 const AP_ROMFS::embedded_file AP_ROMFS::files[] = {};
 #endif
 
+struct AP_ROMFS::cache_entry *AP_ROMFS::cache;
+uint32_t AP_ROMFS::cache_retained;
+HAL_Semaphore AP_ROMFS::cache_sem;
+
 /*
   find an embedded file
 */
-const uint8_t *AP_ROMFS::find_file(const char *name, uint32_t &size)
+const struct AP_ROMFS::embedded_file *AP_ROMFS::find_file(const char *name)
 {
     for (uint16_t i=0; i<ARRAY_SIZE(files); i++) {
         if (strcmp(name, files[i].filename) == 0) {
-            size = files[i].size;
-            return files[i].contents;
+            return &files[i];
         }
     }
     return nullptr;
 }
 
 /*
-  find a compressed file and uncompress it. Space for decompressed
-  data comes from malloc. Caller must be careful to free the resulting
+  parse the gzip header of a compressed file, ready for
+  uzlib_uncompress()
+*/
+bool AP_ROMFS::gzip_init(TINF_DATA *d, const struct embedded_file &f, uint32_t &decompressed_size)
+{
+    if (f.size < 4) {
+        return false;
+    }
+    // last 4 bytes of gzip file are length of decompressed data
+    const uint8_t *p = &f.contents[f.size-4];
+    decompressed_size = p[0] | p[1] << 8 | p[2] << 16 | p[3] << 24;
+
+    d->source = f.contents;
+    d->source_limit = f.contents + f.size - 4;
+
+    // assume gzip format
+    return uzlib_gzip_parse_header(d) == TINF_OK;
+}
+
+/*
+  find a compressed file and uncompress it. Decompressed files are
+  cached and shared, so each user must call free() on the returned
   data after use. The next byte after the file data is guaranteed to
   be null
 */
 const uint8_t *AP_ROMFS::find_decompress(const char *name, uint32_t &size)
 {
-    uint32_t compressed_size;
-    const uint8_t *compressed_data = find_file(name, compressed_size);
-    if (!compressed_data) {
+    const struct embedded_file *f = find_file(name);
+    if (!f) {
         return nullptr;
     }
 
+    if (!f->compressed) {
+        size = f->size;
+        return f->contents;
+    }
+
 #ifdef HAL_ROMFS_UNCOMPRESSED
-    return compressed_data;
+    return nullptr;
 #else
-    // last 4 bytes of gzip file are length of decompressed data
-    const uint8_t *p = &compressed_data[compressed_size-4];
-    uint32_t decompressed_size = p[0] | p[1] << 8 | p[2] << 16 | p[3] << 24;
-    
-    uint8_t *decompressed_data = (uint8_t *)malloc(decompressed_size + 1);
-    if (!decompressed_data) {
-        return nullptr;
-    }
+    WITH_SEMAPHORE(cache_sem);
 
-    // explicitly null terimnate the data
-    decompressed_data[decompressed_size] = 0;
+    for (struct cache_entry *e = cache; e; e = e->next) {
+        if (e->file == f) {
+            if (e->refcount++ == 0) {
+                cache_retained -= e->size;
+            }
+            size = e->size;
+            return cache_data(e);
+        }
+    }
 
     TINF_DATA *d = (TINF_DATA *)malloc(sizeof(TINF_DATA));
     if (!d) {
-        ::free(decompressed_data);
         return nullptr;
     }
     uzlib_uncompress_init(d, NULL, 0);
 
-    d->source = compressed_data;
-    d->source_limit = compressed_data + compressed_size - 4;
+    uint32_t decompressed_size;
+    if (!gzip_init(d, *f, decompressed_size)) {
+        ::free(d);
+        return nullptr;
+    }
 
-    // assume gzip format
-    int res = uzlib_gzip_parse_header(d);
-    if (res != TINF_OK) {
-        ::free(decompressed_data);
+    struct cache_entry *e = (struct cache_entry *)malloc(sizeof(struct cache_entry) + decompressed_size + 1);
+    if (!e) {
         ::free(d);
         return nullptr;
     }
+    uint8_t *decompressed_data = (uint8_t *)(e + 1);
+
+    // explicitly null terimnate the data
+    decompressed_data[decompressed_size] = 0;
 
     d->dest = decompressed_data;
     d->destSize = decompressed_size;
 
     // we don't check CRC, as it just wastes flash space for constant
     // ROMFS data
-    res = uzlib_uncompress(d);
+    int res = uzlib_uncompress(d);
 
     ::free(d);
-    
+
     if (res != TINF_OK) {
-        ::free(decompressed_data);
+        ::free(e);
         return nullptr;
     }
 
+    e->file = f;
+    e->size = decompressed_size;
+    e->refcount = 1;
+    e->next = cache;
+    cache = e;
+
     size = decompressed_size;
     return decompressed_data;
 #endif
 }
 
+/*
+  release decompressed files no longer in use until the retained data
+  fits in AP_ROMFS_CACHE_RETAIN, starting with the oldest
+*/
+void AP_ROMFS::cache_trim(void)
+{
+    while (cache_retained > AP_ROMFS_CACHE_RETAIN) {
+        struct cache_entry **unused = nullptr;
+        for (struct cache_entry **ep = &cache; *ep; ep = &(*ep)->next) {
+            if ((*ep)->refcount == 0) {
+                unused = ep;
+            }
+        }
+        if (unused == nullptr) {
+            return;
+        }
+        struct cache_entry *e = *unused;
+        *unused = e->next;
+        cache_retained -= e->size;
+        ::free(e);
+    }
+}
+
 // free returned data
 void AP_ROMFS::free(const uint8_t *data)
 {
-#ifndef HAL_ROMFS_UNCOMPRESSED
-    ::free(const_cast<uint8_t *>(data));
+    if (data == nullptr) {
+        return;
+    }
+    WITH_SEMAPHORE(cache_sem);
+    for (struct cache_entry *e = cache; e; e = e->next) {
+        if (cache_data(e) == data) {
+            if (e->refcount > 0 && --e->refcount == 0) {
+                cache_retained += e->size;
+                cache_trim();
+            }
+            return;
+        }
+    }
+    // files stored uncompressed are not allocated
+}
+
+/*
+  open a file for reading in pieces
+*/
+bool AP_ROMFS::Stream::open(const char *name)
+{
+    close();
+
+    const struct embedded_file *f = find_file(name);
+    if (!f) {
+        return false;
+    }
+
+    if (!f->compressed) {
+        contents = f->contents;
+        file_size = f->size;
+        return true;
+    }
+
+#ifdef HAL_ROMFS_UNCOMPRESSED
+    return false;
+#else
+    d = (TINF_DATA *)malloc(sizeof(TINF_DATA));
+    if (!d) {
+        return false;
+    }
+    uint32_t decompressed_size;
+    uzlib_uncompress_init(d, NULL, 0);
+    if (!gzip_init(d, *f, decompressed_size)) {
+        close();
+        return false;
+    }
+
+    // back references reach at most 32k, and never past the start of
+    // the file
+    const uint32_t window_size = decompressed_size < 32768U ? decompressed_size : 32768U;
+    window = (uint8_t *)malloc(window_size + 1);
+    if (!window) {
+        close();
+        return false;
+    }
+    d->dict_ring = window;
+    d->dict_size = window_size;
+    d->dict_idx = 0;
+
+    file_size = decompressed_size;
+    return true;
 #endif
 }
+
+/*
+  read the next part of a file
+*/
+int32_t AP_ROMFS::Stream::read(uint8_t *buf, uint32_t count)
+{
+    if (count > file_size - ofs) {
+        count = file_size - ofs;
+    }
+    if (count == 0) {
+        return 0;
+    }
+    if (contents != nullptr) {
+        memcpy(buf, &contents[ofs], count);
+        ofs += count;
+        return count;
+    }
+#ifdef HAL_ROMFS_UNCOMPRESSED
+    return -1;
+#else
+    if (d == nullptr) {
+        return -1;
+    }
+    d->dest = buf;
+    d->destSize = count;
+    if (uzlib_uncompress(d) != TINF_OK) {
+        close();
+        return -1;
+    }
+    ofs += count;
+    return count;
+#endif
+}
+
+void AP_ROMFS::Stream::close()
+{
+    ::free(d);
+    ::free(window);
+    d = nullptr;
+    window = nullptr;
+    contents = nullptr;
+    file_size = 0;
+    ofs = 0;
+}
@@ -5,25 +5,95 @@
 
 #include <AP_HAL/AP_HAL.h>
 
+/*
+  number of bytes of decompressed files kept once they are no longer
+  in use, so files which are opened repeatedly are only decompressed
+  once
+ */
+#ifndef AP_ROMFS_CACHE_RETAIN
+#if CONFIG_HAL_BOARD == HAL_BOARD_CHIBIOS
+#define AP_ROMFS_CACHE_RETAIN 0
+#else
+#define AP_ROMFS_CACHE_RETAIN 262144
+#endif
+#endif
+
+struct TINF_DATA;
+
 class AP_ROMFS {
+    friend class AP_ROMFS_Test;
 public:
     // find a file and de-compress, assumning gzip format. The
-    // decompressed data will be allocated with malloc(). You must
-    // call AP_ROMFS::free() on the return value after use. The next byte after
-    // the file data is guaranteed to be null.
+    // decompressed data is shared by all users of the file. You must
+    // call AP_ROMFS::free() on the return value after use. The next
+    // byte after the file data is guaranteed to be null. Files stored
+    // uncompressed are returned without a copy
     static const uint8_t *find_decompress(const char *name, uint32_t &size);
 
     // free returned data
     static void free(const uint8_t *data);
 
-private:
-    // find an embedded file
-    static const uint8_t *find_file(const char *name, uint32_t &size);
+    /*
+      read a file in pieces, decompressing as it is read. This needs
+      a decompression window of at most 32k rather than a buffer for
+      the whole file
+     */
+    class Stream {
+    public:
+        Stream() {}
+        ~Stream() { close(); }
+
+        /* Do not allow copies */
+        Stream(const Stream &other) = delete;
+        Stream &operator=(const Stream&) = delete;
+
+        bool open(const char *name);
+
+        // read up to count bytes, returning the number of bytes read,
+        // zero at the end of the file or -1 on error
+        int32_t read(uint8_t *buf, uint32_t count);
+
+        // decompressed size of the file
+        uint32_t size() const { return file_size; }
+
+        void close();
 
+    private:
+        const uint8_t *contents = nullptr;
+        uint32_t file_size = 0;
+        uint32_t ofs = 0;
+        struct TINF_DATA *d = nullptr;
+        uint8_t *window = nullptr;
+    };
+
+private:
     struct embedded_file {
         const char *filename;
         uint32_t size;
         const uint8_t *contents;
+        bool compressed;
     };
     static const struct embedded_file files[];
+
+    // find an embedded file
+    static const struct embedded_file *find_file(const char *name);
+
+    // start decompressing a file
+    static bool gzip_init(struct TINF_DATA *d, const struct embedded_file &f, uint32_t &decompressed_size);
+
+    // decompressed files, each followed by its data
+    struct cache_entry {
+        struct cache_entry *next;
+        const struct embedded_file *file;
+        uint32_t size;
+        uint16_t refcount;
+    };
+    static struct cache_entry *cache;
+    static uint32_t cache_retained;
+    static HAL_Semaphore cache_sem;
+
+    static const uint8_t *cache_data(const struct cache_entry *e) {
+        return (const uint8_t *)(e + 1);
+    }
+    static void cache_trim(void);
 };
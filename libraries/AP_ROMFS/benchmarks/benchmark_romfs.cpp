@@ -0,0 +1,154 @@
+#include <AP_gbenchmark.h>
+
+#include <AP_ROMFS/AP_ROMFS.h>
+
+/*
+  cost and heap use of decompressing an embedded file whole, of
+  another user of a file already in the cache, and of reading it in
+  pieces through AP_ROMFS::Stream
+ */
+
+const AP_HAL::HAL &hal = AP_HAL::get_HAL();
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+
+// bytes allocated from the heap
+static size_t heap_in_use()
+{
+#if __GLIBC_PREREQ(2, 33)
+    return mallinfo2().uordblks;
+#else
+    return mallinfo().uordblks;
+#endif
+}
+#else
+static size_t heap_in_use() { return 0; }
+#endif
+
+// files SITL builds embed, depending on the build options
+static const char *filenames[] = {
+    "sandbox.lua",
+    "font0.bin",
+    "font1.bin",
+    "font2.bin",
+    "font3.bin",
+    "font4.bin",
+};
+
+class AP_ROMFS_Test
+{
+public:
+    // the file to benchmark, or nullptr if it is not embedded
+    static const char *file(benchmark::State& state)
+    {
+        const char *name = filenames[state.range_x()];
+        if (AP_ROMFS::find_file(name) == nullptr) {
+            state.SetLabel(std::string(name) + " not embedded");
+            while (state.KeepRunning()) {
+            }
+            return nullptr;
+        }
+        return name;
+    }
+
+    // release all the decompressed files not in use
+    static void evict()
+    {
+        WITH_SEMAPHORE(AP_ROMFS::cache_sem);
+        AP_ROMFS::cache_retained += AP_ROMFS_CACHE_RETAIN + 1;
+        AP_ROMFS::cache_trim();
+        AP_ROMFS::cache_retained -= AP_ROMFS_CACHE_RETAIN + 1;
+    }
+
+    static void label(benchmark::State& state, const char *name, size_t heap)
+    {
+        char buf[64];
+        snprintf(buf, sizeof(buf), "%s heap %u", name, unsigned(heap));
+        state.SetLabel(buf);
+    }
+
+    static void decompress(benchmark::State& state)
+    {
+        const char *name = file(state);
+        if (name == nullptr) {
+            return;
+        }
+        uint32_t size = 0;
+        evict();
+        const size_t heap_before = heap_in_use();
+        size_t heap = 0;
+        while (state.KeepRunning()) {
+            evict();
+            const uint8_t *data = AP_ROMFS::find_decompress(name, size);
+            heap = heap_in_use() - heap_before;
+            benchmark::DoNotOptimize(data);
+            AP_ROMFS::free(data);
+        }
+        label(state, name, heap);
+        state.SetBytesProcessed(state.iterations() * size);
+    }
+
+    static void cached(benchmark::State& state)
+    {
+        const char *name = file(state);
+        if (name == nullptr) {
+            return;
+        }
+        uint32_t size = 0;
+        const uint8_t *first = AP_ROMFS::find_decompress(name, size);
+        const size_t heap_before = heap_in_use();
+        size_t heap = 0;
+        while (state.KeepRunning()) {
+            const uint8_t *data = AP_ROMFS::find_decompress(name, size);
+            heap = heap_in_use() - heap_before;
+            benchmark::DoNotOptimize(data);
+            AP_ROMFS::free(data);
+        }
+        AP_ROMFS::free(first);
+        label(state, name, heap);
+        state.SetBytesProcessed(state.iterations() * size);
+    }
+
+    static void stream(benchmark::State& state)
+    {
+        const char *name = file(state);
+        if (name == nullptr) {
+            return;
+        }
+        uint8_t buf[512];
+        uint32_t size = 0;
+        evict();
+        const size_t heap_before = heap_in_use();
+        size_t heap = 0;
+        while (state.KeepRunning()) {
+            AP_ROMFS::Stream stream;
+            stream.open(name);
+            heap = heap_in_use() - heap_before;
+            size = stream.size();
+            while (stream.read(buf, sizeof(buf)) > 0) {
+                benchmark::DoNotOptimize(buf[0]);
+            }
+        }
+        label(state, name, heap);
+        state.SetBytesProcessed(state.iterations() * size);
+    }
+};
+
+static void BM_ROMFSDecompress(benchmark::State& state)
+{
+    AP_ROMFS_Test::decompress(state);
+}
+static void BM_ROMFSCached(benchmark::State& state)
+{
+    AP_ROMFS_Test::cached(state);
+}
+static void BM_ROMFSStream(benchmark::State& state)
+{
+    AP_ROMFS_Test::stream(state);
+}
+BENCHMARK(BM_ROMFSDecompress)->DenseRange(0, ARRAY_SIZE(filenames) - 1);
+BENCHMARK(BM_ROMFSCached)->DenseRange(0, ARRAY_SIZE(filenames) - 1);
+BENCHMARK(BM_ROMFSStream)->DenseRange(0, ARRAY_SIZE(filenames) - 1);
+
+BENCHMARK_MAIN()
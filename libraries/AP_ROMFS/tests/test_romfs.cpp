@@ -0,0 +1,174 @@
+#include <AP_gtest.h>
+
+#include <AP_Math/AP_Math.h>
+#include <AP_ROMFS/AP_ROMFS.h>
+
+#include <vector>
+
+const AP_HAL::HAL &hal = AP_HAL::get_HAL();
+
+#if defined(HAL_HAVE_AP_ROMFS_EMBEDDED_H) && !defined(HAL_ROMFS_UNCOMPRESSED)
+
+// files SITL builds embed, depending on the build options
+static const char *filenames[] = {
+#if ENABLE_SCRIPTING
+    "sandbox.lua",
+#endif
+#ifdef WITH_SITL_OSD
+    "font0.bin",
+    "font1.bin",
+    "font2.bin",
+    "font3.bin",
+    "font4.bin",
+#endif
+};
+
+class AP_ROMFS_Test
+{
+public:
+    static bool embedded(const char *name) { return AP_ROMFS::find_file(name) != nullptr; }
+    static bool compressed(const char *name) { return AP_ROMFS::find_file(name)->compressed; }
+    static uint32_t retained() { return AP_ROMFS::cache_retained; }
+
+    // users of the decompressed data, or -1 if it is not in the cache
+    static int32_t refcount(const uint8_t *data)
+    {
+        for (const AP_ROMFS::cache_entry *e = AP_ROMFS::cache; e; e = e->next) {
+            if (AP_ROMFS::cache_data(e) == data) {
+                return e->refcount;
+            }
+        }
+        return -1;
+    }
+
+    // number of cached files still in use
+    static uint16_t num_in_use()
+    {
+        uint16_t count = 0;
+        for (const AP_ROMFS::cache_entry *e = AP_ROMFS::cache; e; e = e->next) {
+            if (e->refcount != 0) {
+                count++;
+            }
+        }
+        return count;
+    }
+};
+
+TEST(AP_ROMFS, MissingFile)
+{
+    uint32_t size = 123;
+    EXPECT_EQ(nullptr, AP_ROMFS::find_decompress("no-such-file", size));
+    EXPECT_EQ(123U, size);
+
+    AP_ROMFS::Stream stream;
+    EXPECT_FALSE(stream.open("no-such-file"));
+    uint8_t buf[8];
+    EXPECT_EQ(0, stream.read(buf, sizeof(buf)));
+
+    // releasing nothing is harmless
+    AP_ROMFS::free(nullptr);
+}
+
+TEST(AP_ROMFS, SharedFiles)
+{
+    for (const char *name : filenames) {
+        if (!AP_ROMFS_Test::embedded(name)) {
+            continue;
+        }
+        uint32_t size;
+        const uint8_t *data = AP_ROMFS::find_decompress(name, size);
+        ASSERT_NE(nullptr, data) << name;
+        EXPECT_EQ(0, data[size]) << name;
+
+        if (!AP_ROMFS_Test::compressed(name)) {
+            // used in place, without a copy
+            EXPECT_EQ(-1, AP_ROMFS_Test::refcount(data)) << name;
+            AP_ROMFS::free(data);
+            continue;
+        }
+        EXPECT_EQ(1, AP_ROMFS_Test::refcount(data)) << name;
+
+        // a second user shares the decompressed data
+        uint32_t size2;
+        const uint8_t *data2 = AP_ROMFS::find_decompress(name, size2);
+        EXPECT_EQ(data, data2) << name;
+        EXPECT_EQ(size, size2) << name;
+        EXPECT_EQ(2, AP_ROMFS_Test::refcount(data)) << name;
+
+        AP_ROMFS::free(data2);
+        EXPECT_EQ(1, AP_ROMFS_Test::refcount(data)) << name;
+        const uint32_t retained = AP_ROMFS_Test::retained();
+        AP_ROMFS::free(data);
+
+        if (size > AP_ROMFS_CACHE_RETAIN) {
+            // too big to keep once released
+            EXPECT_EQ(-1, AP_ROMFS_Test::refcount(data)) << name;
+            EXPECT_GE(AP_ROMFS_CACHE_RETAIN, AP_ROMFS_Test::retained()) << name;
+            continue;
+        }
+
+        // kept for the next user, who doesn't decompress it again
+        EXPECT_EQ(0, AP_ROMFS_Test::refcount(data)) << name;
+        EXPECT_EQ(retained + size, AP_ROMFS_Test::retained()) << name;
+        data2 = AP_ROMFS::find_decompress(name, size2);
+        EXPECT_EQ(data, data2) << name;
+        EXPECT_EQ(size, size2) << name;
+        EXPECT_EQ(1, AP_ROMFS_Test::refcount(data)) << name;
+        EXPECT_EQ(retained, AP_ROMFS_Test::retained()) << name;
+        AP_ROMFS::free(data2);
+        EXPECT_EQ(0, AP_ROMFS_Test::refcount(data)) << name;
+
+        // releasing it again doesn't take the count below zero
+        AP_ROMFS::free(data2);
+        EXPECT_EQ(0, AP_ROMFS_Test::refcount(data)) << name;
+        EXPECT_EQ(retained + size, AP_ROMFS_Test::retained()) << name;
+    }
+
+    EXPECT_EQ(0U, AP_ROMFS_Test::num_in_use());
+    EXPECT_GE(AP_ROMFS_CACHE_RETAIN, AP_ROMFS_Test::retained());
+}
+
+TEST(AP_ROMFS, StreamChunks)
+{
+    for (const char *name : filenames) {
+        if (!AP_ROMFS_Test::embedded(name)) {
+            continue;
+        }
+        uint32_t size;
+        const uint8_t *data = AP_ROMFS::find_decompress(name, size);
+        ASSERT_NE(nullptr, data) << name;
+
+        for (const uint32_t chunk_size : { 1U, 7U, 100U, 4096U, 40000U, size }) {
+            if (chunk_size == 0) {
+                continue;
+            }
+            AP_ROMFS::Stream stream;
+            ASSERT_TRUE(stream.open(name)) << name;
+            EXPECT_EQ(size, stream.size()) << name;
+
+            std::vector<uint8_t> contents;
+            std::vector<uint8_t> buf(chunk_size);
+            int32_t n;
+            while ((n = stream.read(buf.data(), chunk_size)) > 0) {
+                ASSERT_LE(uint32_t(n), chunk_size);
+                contents.insert(contents.end(), buf.begin(), buf.begin() + n);
+            }
+            EXPECT_EQ(0, n) << name << " " << chunk_size;
+            ASSERT_EQ(size, contents.size()) << name << " " << chunk_size;
+            EXPECT_EQ(0, memcmp(data, contents.data(), size)) << name << " " << chunk_size;
+
+            // reading from the start again after a reopen
+            ASSERT_TRUE(stream.open(name)) << name;
+            n = stream.read(buf.data(), MIN(chunk_size, 16U));
+            ASSERT_EQ(int32_t(MIN(chunk_size, MIN(size, 16U))), n) << name;
+            EXPECT_EQ(0, memcmp(data, buf.data(), n)) << name;
+        }
+
+        AP_ROMFS::free(data);
+    }
+    EXPECT_EQ(0U, AP_ROMFS_Test::num_in_use());
+}
+
+#endif // HAL_HAVE_AP_ROMFS_EMBEDDED_H
+
+AP_GTEST_MAIN()
@@ -26,6 +26,7 @@
 #include <AP_Logger/AP_Logger.h>
 #include <AP_InertialSensor/AP_InertialSensor.h>
 #include <AP_InternalError/AP_InternalError.h>
+#include <GCS_MAVLink/GCS.h>
 #if CONFIG_HAL_BOARD == HAL_BOARD_SITL
 #include <SITL/SITL.h>
 #endif
@@ -341,10 +342,12 @@ void AP_Scheduler::update_logging()
 {
     if (debug_flags()) {
         perf_info.update_logging();
+        send_memory_stats();
     }
     if (_log_performance_bit != (uint32_t)-1 &&
         AP::logger().should_log(_log_performance_bit)) {
         Log_Write_Performance();
+        Log_Write_Memory();
     }
     perf_info.set_loop_rate(get_loop_rate_hz());
     perf_info.reset();
@@ -372,6 +375,48 @@ void AP_Scheduler::Log_Write_Performance()
     AP::logger().WriteCriticalBlock(&pkt, sizeof(pkt));
 }
 
+// Write allocation statistics for each memory tag that has been used
+void AP_Scheduler::Log_Write_Memory()
+{
+    const uint64_t now = AP_HAL::micros64();
+    for (uint8_t i = 0; i < AP_HAL::Util::MEM_TAG_COUNT; i++) {
+        AP_HAL::Util::Memory_Stats stats;
+        if (!hal.util->memory_stats((AP_HAL::Util::Memory_Tag)i, stats) ||
+            (stats.high_water == 0 && stats.failures == 0)) {
+            continue;
+        }
+        struct log_MemTag pkt = {
+            LOG_PACKET_HEADER_INIT(LOG_MEM_TAG_MSG),
+            time_us    : now,
+            tag        : i,
+            current    : stats.current,
+            high_water : stats.high_water,
+            count      : stats.count,
+            failures   : stats.failures,
+        };
+        AP::logger().WriteBlock(&pkt, sizeof(pkt));
+    }
+}
+
+void AP_Scheduler::send_memory_stats()
+{
+    for (uint8_t i = 0; i < AP_HAL::Util::MEM_TAG_COUNT; i++) {
+        const AP_HAL::Util::Memory_Tag tag = (AP_HAL::Util::Memory_Tag)i;
+        AP_HAL::Util::Memory_Stats stats;
+        // only tags holding memory now, or that have failed to get it
+        if (!hal.util->memory_stats(tag, stats) ||
+            (stats.current == 0 && stats.failures == 0)) {
+            continue;
+        }
+        gcs().send_text(MAV_SEVERITY_INFO, "MEM %s: %lu/%lu n=%lu f=%lu",
+                        AP_HAL::Util::memory_tag_name(tag),
+                        (unsigned long)stats.current,
+                        (unsigned long)stats.high_water,
+                        (unsigned long)stats.count,
+                        (unsigned long)stats.failures);
+    }
+}
+
 namespace AP {
 
 AP_Scheduler &scheduler()
@@ -87,6 +87,9 @@ public:
     // write out PERF message to logger
     void Log_Write_Performance();
 
+    // write out MEMT messages for each memory tag in use
+    void Log_Write_Memory();
+
     // call when one tick has passed
     void tick(void);
 
@@ -151,6 +154,9 @@ public:
     AP::PerfInfo perf_info;
 
 private:
+    // send per-tag allocation statistics to the GCS
+    void send_memory_stats();
+
     // function that is called before anything in the scheduler table:
     scheduler_fastloop_fn_t _fastloop_fn;
 
@@ -65,6 +65,31 @@ const AP_Param::GroupInfo AP_Scripting::var_info[] = {
 
     AP_GROUPINFO("DEBUG_LVL", 4, AP_Scripting, _debug_level, 1),
 
+    // @Param: OPTIONS
+    // @DisplayName: Scripting options
+    // @Description: Bitmask of scripting options. The bytecode cache stores a compiled copy of each script next to it (script.luac), which is reused at boot while the script source is unchanged. Runtime logging records the CPU time and memory allocations of every script run in the SCR log message.
+    // @Bitmask: 0:Cache compiled bytecode,1:Log script runtime
+    // @User: Advanced
+    AP_GROUPINFO("OPTIONS", 5, AP_Scripting, _options, 0),
+
+    // @Param: GC_BUDGET
+    // @DisplayName: Scripting garbage collection time budget
+    // @Description: Maximum time spent on incremental garbage collection between script runs. Collection never runs inside a script unless the heap is exhausted.
+    // @Units: us
+    // @Range: 0 10000
+    // @Increment: 100
+    // @User: Advanced
+    AP_GROUPINFO("GC_BUDGET", 6, AP_Scripting, _gc_budget_us, 1000),
+
+    // @Param: MEM_QUOTA
+    // @DisplayName: Scripting memory quota
+    // @Description: Maximum net amount of heap memory a single run of a script may allocate. A script exceeding it is stopped. 0 disables the quota.
+    // @Units: B
+    // @Range: 0 1048576
+    // @Increment: 1024
+    // @User: Advanced
+    AP_GROUPINFO("MEM_QUOTA", 7, AP_Scripting, _mem_quota, 0),
+
     AP_GROUPEND
 };
 
@@ -93,7 +118,8 @@ void AP_Scripting::init(void) {
 }
 
 void AP_Scripting::thread(void) {
-    lua_scripts *lua = new lua_scripts(_script_vm_exec_count, _script_heap_size, _debug_level);
+    lua_scripts *lua = new lua_scripts(_script_vm_exec_count, _script_heap_size, _debug_level,
+                                       _options, _gc_budget_us, _mem_quota);
     if (lua == nullptr || !lua->heap_allocated()) {
         gcs().send_text(MAV_SEVERITY_CRITICAL, "Unable to allocate scripting memory");
         _init_failed = true;
@@ -0,0 +1,64 @@
+-- This script benchmarks vector maths that creates temporary objects against
+-- the same maths done in place with add_into/sub_into/rotate_into.
+-- Each run alternates between the two styles. Set bit 1 of SCR_OPTIONS to
+-- log the allocations of every run in the SCR message; dividing Alloc by the
+-- interval between runs gives the allocation rate of each style.
+
+local ITERATIONS = 200 -- vector operations per run
+local REPORT_RUNS = 50 -- runs of each style between reports
+
+local pos = Vector3f()
+local vel = Vector3f()
+local drift = Vector2f()
+local step = Vector2f()
+vel:x(0.1)
+vel:y(0.2)
+step:x(0.01)
+
+local use_in_place = false
+local runs = 0
+local time_alloc = 0
+local time_in_place = 0
+
+function with_temporaries()
+  for i = 1, ITERATIONS do
+    pos = pos + vel
+    pos = pos - vel
+    local rotated = Vector2f()
+    rotated:x(drift:x() * math.cos(0.01) - drift:y() * math.sin(0.01))
+    rotated:y(drift:x() * math.sin(0.01) + drift:y() * math.cos(0.01))
+    drift = rotated + step
+  end
+end
+
+function in_place()
+  for i = 1, ITERATIONS do
+    pos:add_into(vel)
+    pos:sub_into(vel)
+    drift:rotate_into(0.01)
+    drift:add_into(step)
+  end
+end
+
+function update()
+  local start = millis()
+  if use_in_place then
+    in_place()
+    time_in_place = time_in_place + (millis() - start):toint()
+  else
+    with_temporaries()
+    time_alloc = time_alloc + (millis() - start):toint()
+  end
+  use_in_place = not use_in_place
+
+  runs = runs + 1
+  if runs >= REPORT_RUNS * 2 then
+    gcs:send_text(6, string.format("vec bench: temporaries %dms in place %dms", time_alloc, time_in_place))
+    runs = 0
+    time_alloc = 0
+    time_in_place = 0
+  end
+  return update, 10
+end
+
+return update()
@@ -16,6 +16,7 @@ char keyword_include[]   = "include";
 char keyword_method[]    = "method";
 char keyword_operator[]  = "operator";
 char keyword_read[]      = "read";
+char keyword_rename[]    = "rename";
 char keyword_semaphore[] = "semaphore";
 char keyword_singleton[] = "singleton";
 char keyword_userdata[]  = "userdata";
@@ -117,6 +118,8 @@ enum operator_type {
   OP_SUB  = (1U << 1),
   OP_MUL  = (1U << 2),
   OP_DIV  = (1U << 3),
+  OP_ADD_INTO = (1U << 4), // in place, exposed as a method
+  OP_SUB_INTO = (1U << 5), // in place, exposed as a method
   OP_LAST
 };
 
@@ -276,6 +279,7 @@ struct argument {
 struct method {
   struct method * next;
   char *name;
+  char *rename; // (optional) name the method is exposed to scripting as
   int line; // line declared on
   struct type return_type;
   struct argument * arguments;
@@ -646,6 +650,10 @@ void handle_operator(struct userdata *data) {
     operation = OP_MUL;
   } else if (strcmp(operator, "/") == 0) {
     operation = OP_DIV;
+  } else if (strcmp(operator, "+=") == 0) {
+    operation = OP_ADD_INTO;
+  } else if (strcmp(operator, "-=") == 0) {
+    operation = OP_SUB_INTO;
   } else {
     error(ERROR_USERDATA, "Unknown operation type: %s", operator);
   }
@@ -663,6 +671,32 @@ void handle_operator(struct userdata *data) {
   }
 }
 
+void handle_rename(struct userdata *data) {
+  trace(TRACE_USERDATA, "Renaming a method");
+
+  char *name = next_token();
+  if (name == NULL) {
+    error(ERROR_USERDATA, "Expected a method to rename for %s", data->name);
+  }
+
+  struct method *method = data->methods;
+  while (method != NULL && strcmp(method->name, name)) {
+    method = method->next;
+  }
+  if (method == NULL) {
+    error(ERROR_USERDATA, "Method %s must be declared on %s before it can be renamed", name, data->name);
+  }
+  if (method->rename != NULL) {
+    error(ERROR_USERDATA, "Method %s on %s was already renamed to %s", name, data->name, method->rename);
+  }
+
+  char *rename = next_token();
+  if (rename == NULL) {
+    error(ERROR_USERDATA, "Expected a new name for %s", name);
+  }
+  string_copy(&(method->rename), rename);
+}
+
 void handle_userdata(void) {
   trace(TRACE_USERDATA, "Adding a userdata");
 
@@ -702,6 +736,8 @@ void handle_userdata(void) {
     handle_method(node->name, &(node->methods));
   } else if (strcmp(type, keyword_enum) == 0) {
     handle_userdata_enum(node);
+  } else if (strcmp(type, keyword_rename) == 0) {
+    handle_rename(node);
   } else {
     error(ERROR_USERDATA, "Unknown or unsupported type for userdata: %s", type);
   }
@@ -1391,6 +1427,10 @@ const char * get_name_for_operation(enum operator_type op) {
     case OP_DIV:
       return "__div";
       break;
+    case OP_ADD_INTO:
+      return "add_into";
+    case OP_SUB_INTO:
+      return "sub_into";
     case OP_LAST:
       return NULL;
   }
@@ -1409,6 +1449,7 @@ void emit_operators(struct userdata *data) {
     }
 
     char op_sym;
+    int in_place = 0;
     switch ((data->operations) & i) {
       case OP_ADD:
         op_sym = '+';
@@ -1422,10 +1463,30 @@ void emit_operators(struct userdata *data) {
       case OP_DIV:
         op_sym = '/';
         break;
+      case OP_ADD_INTO:
+        op_sym = '+';
+        in_place = 1;
+        break;
+      case OP_SUB_INTO:
+        op_sym = '-';
+        in_place = 1;
+        break;
       case OP_LAST:
         return;
     }
 
+    if (in_place) {
+      // modifies the first argument, so no result needs to be allocated
+      fprintf(source, "static int %s_%s(lua_State *L) {\n", data->name, op_name);
+      fprintf(source, "    binding_argcheck(L, 2);\n");
+      fprintf(source, "    %s *ud = check_%s(L, 1);\n", data->name, data->name);
+      fprintf(source, "    %s *ud2 = check_%s(L, 2);\n", data->name, data->name);
+      fprintf(source, "    *ud %c= *ud2;\n", op_sym);
+      fprintf(source, "    return 0;\n");
+      fprintf(source, "}\n\n");
+      continue;
+    }
+
     fprintf(source, "static int %s_%s(lua_State *L) {\n", data->name, op_name);
     // check number of arguments
     fprintf(source, "    binding_argcheck(L, 2);\n");
@@ -1472,7 +1533,7 @@ void emit_userdata_metatables(void) {
 
     struct method *method = node->methods;
     while(method) {
-      fprintf(source, "    {\"%s\", %s_%s},\n", method->name, node->name, method->name);
+      fprintf(source, "    {\"%s\", %s_%s},\n", method->rename ? method->rename : method->name, node->name, method->name);
       method = method->next;
     }
 
@@ -268,6 +268,18 @@ static int Location_lat(lua_State *L) {
     }
 }
 
+static int Vector2f_rotate(lua_State *L) {
+    binding_argcheck(L, 2);
+    Vector2f * ud = check_Vector2f(L, 1);
+    const float raw_data_2 = luaL_checknumber(L, 2);
+    luaL_argcheck(L, ((raw_data_2 >= MAX(-FLT_MAX, -INFINITY)) && (raw_data_2 <= MIN(FLT_MAX, INFINITY))), 2, "argument out of range");
+    const float data_2 = raw_data_2;
+    ud->rotate(
+            data_2);
+
+    return 0;
+}
+
 static int Vector2f_is_zero(lua_State *L) {
     binding_argcheck(L, 1);
     Vector2f * ud = check_Vector2f(L, 1);
@@ -330,6 +342,34 @@ static int Vector2f___sub(lua_State *L) {
     return 1;
 }
 
+static int Vector2f_add_into(lua_State *L) {
+    binding_argcheck(L, 2);
+    Vector2f *ud = check_Vector2f(L, 1);
+    Vector2f *ud2 = check_Vector2f(L, 2);
+    *ud += *ud2;
+    return 0;
+}
+
+static int Vector2f_sub_into(lua_State *L) {
+    binding_argcheck(L, 2);
+    Vector2f *ud = check_Vector2f(L, 1);
+    Vector2f *ud2 = check_Vector2f(L, 2);
+    *ud -= *ud2;
+    return 0;
+}
+
+static int Vector3f_rotate_xy(lua_State *L) {
+    binding_argcheck(L, 2);
+    Vector3f * ud = check_Vector3f(L, 1);
+    const float raw_data_2 = luaL_checknumber(L, 2);
+    luaL_argcheck(L, ((raw_data_2 >= MAX(-FLT_MAX, -INFINITY)) && (raw_data_2 <= MIN(FLT_MAX, INFINITY))), 2, "argument out of range");
+    const float data_2 = raw_data_2;
+    ud->rotate_xy(
+            data_2);
+
+    return 0;
+}
+
 static int Vector3f_is_zero(lua_State *L) {
     binding_argcheck(L, 1);
     Vector3f * ud = check_Vector3f(L, 1);
@@ -392,6 +432,22 @@ static int Vector3f___sub(lua_State *L) {
     return 1;
 }
 
+static int Vector3f_add_into(lua_State *L) {
+    binding_argcheck(L, 2);
+    Vector3f *ud = check_Vector3f(L, 1);
+    Vector3f *ud2 = check_Vector3f(L, 2);
+    *ud += *ud2;
+    return 0;
+}
+
+static int Vector3f_sub_into(lua_State *L) {
+    binding_argcheck(L, 2);
+    Vector3f *ud = check_Vector3f(L, 1);
+    Vector3f *ud2 = check_Vector3f(L, 2);
+    *ud -= *ud2;
+    return 0;
+}
+
 static int Location_get_bearing(lua_State *L) {
     binding_argcheck(L, 2);
     Location * ud = check_Location(L, 1);
@@ -449,6 +505,7 @@ static int Location_get_distance(lua_State *L) {
 const luaL_Reg Vector2f_meta[] = {
     {"y", Vector2f_y},
     {"x", Vector2f_x},
+    {"rotate_into", Vector2f_rotate},
     {"is_zero", Vector2f_is_zero},
     {"is_inf", Vector2f_is_inf},
     {"is_nan", Vector2f_is_nan},
@@ -456,6 +513,8 @@ const luaL_Reg Vector2f_meta[] = {
     {"length", Vector2f_length},
     {"__add", Vector2f___add},
     {"__sub", Vector2f___sub},
+    {"add_into", Vector2f_add_into},
+    {"sub_into", Vector2f_sub_into},
     {NULL, NULL}
 };
 
@@ -463,6 +522,7 @@ const luaL_Reg Vector3f_meta[] = {
     {"z", Vector3f_z},
     {"y", Vector3f_y},
     {"x", Vector3f_x},
+    {"rotate_into", Vector3f_rotate_xy},
     {"is_zero", Vector3f_is_zero},
     {"is_inf", Vector3f_is_inf},
     {"is_nan", Vector3f_is_nan},
@@ -470,6 +530,8 @@ const luaL_Reg Vector3f_meta[] = {
     {"length", Vector3f_length},
     {"__add", Vector3f___add},
     {"__sub", Vector3f___sub},
+    {"add_into", Vector3f_add_into},
+    {"sub_into", Vector3f_sub_into},
     {NULL, NULL}
 };
 
@@ -18,6 +18,9 @@
 #include <GCS_MAVLink/GCS.h>
 #include "AP_Scripting.h"
 #include <AP_ROMFS/AP_ROMFS.h>
+#include <AP_Filesystem/AP_Filesystem.h>
+#include <AP_Logger/AP_Logger.h>
+#include <AP_Math/crc.h>
 
 #include "lua_generated_bindings.h"
 
@@ -31,12 +34,40 @@
 
 extern const AP_HAL::HAL& hal;
 
+// header of a bytecode cache file, followed by the output of lua_dump
+struct PACKED bytecode_cache_header {
+    uint32_t magic;
+    uint32_t source_crc;  // CRC32 of the script the bytecode was compiled from
+    uint32_t source_size;
+};
+static const uint32_t BYTECODE_CACHE_MAGIC = 0x4C424331; // LBC1
+
+// above this fraction of the heap a full collection is done between scripts
+#define SCRIPTING_GC_FULL_COLLECT_PCT 75
+
+// maximum number of free blocks held per size
+#ifndef SCRIPTING_BLOCK_POOL_DEPTH
+  #define SCRIPTING_BLOCK_POOL_DEPTH 16
+#endif
+
 bool lua_scripts::overtime;
 jmp_buf lua_scripts::panic_jmp;
 
-lua_scripts::lua_scripts(const AP_Int32 &vm_steps, const AP_Int32 &heap_size, const AP_Int8 &debug_level)
+bool lua_scripts::_accounting;
+int32_t lua_scripts::_run_quota;
+int32_t lua_scripts::_run_mem;
+uint32_t lua_scripts::_run_alloc;
+bool lua_scripts::_quota_exceeded;
+lua_scripts::block_pool lua_scripts::_pool[SCRIPTING_BLOCK_POOL_BINS];
+
+lua_scripts::lua_scripts(const AP_Int32 &vm_steps, const AP_Int32 &heap_size, const AP_Int8 &debug_level,
+                         const AP_Int16 &options, const AP_Int16 &gc_budget_us, const AP_Int32 &mem_quota)
     : _vm_steps(vm_steps),
-      _debug_level(debug_level) {
+      _debug_level(debug_level),
+      _options(options),
+      _gc_budget_us(gc_budget_us),
+      _mem_quota(mem_quota),
+      _heap_size(heap_size) {
     _heap = hal.util->allocate_heap_memory(heap_size);
 }
 
@@ -57,8 +88,118 @@ int lua_scripts::atpanic(lua_State *L) {
     return 0;
 }
 
+bool lua_scripts::hash_file(const char *filename, uint32_t &crc, uint32_t &size) {
+    const int fd = AP::FS().open(filename, O_RDONLY);
+    if (fd == -1) {
+        return false;
+    }
+    uint8_t buf[128];
+    crc = 0;
+    size = 0;
+    ssize_t n;
+    while ((n = AP::FS().read(fd, buf, sizeof(buf))) > 0) {
+        crc = crc_crc32(crc, buf, n);
+        size += n;
+    }
+    AP::FS().close(fd);
+    return n == 0;
+}
+
+namespace {
+struct cache_reader {
+    int fd;
+    char buf[128];
+};
+}
+
+static const char *read_cache(lua_State *L, void *ud, size_t *size) {
+    cache_reader *reader = (cache_reader *)ud;
+    const ssize_t n = AP::FS().read(reader->fd, reader->buf, sizeof(reader->buf));
+    if (n <= 0) {
+        *size = 0;
+        return nullptr;
+    }
+    *size = n;
+    return reader->buf;
+}
+
+static int write_cache(lua_State *L, const void *p, size_t sz, void *ud) {
+    const int fd = *(int *)ud;
+    return (AP::FS().write(fd, p, sz) == (ssize_t)sz) ? 0 : 1;
+}
+
+bool lua_scripts::load_cached(lua_State *L, const char *cache_name, uint32_t source_crc, uint32_t source_size) {
+    cache_reader reader;
+    reader.fd = AP::FS().open(cache_name, O_RDONLY);
+    if (reader.fd == -1) {
+        return false;
+    }
+    bytecode_cache_header header;
+    if (AP::FS().read(reader.fd, &header, sizeof(header)) != sizeof(header) ||
+        header.magic != BYTECODE_CACHE_MAGIC ||
+        header.source_crc != source_crc ||
+        header.source_size != source_size) {
+        AP::FS().close(reader.fd);
+        return false;
+    }
+    // the bytecode header is checked by lua against this VM build, so a
+    // cache written by a different firmware is rejected and rebuilt
+    const int error = lua_load(L, read_cache, &reader, cache_name, "b");
+    AP::FS().close(reader.fd);
+    if (error != LUA_OK) {
+        if (_debug_level > 1) {
+            gcs().send_text(MAV_SEVERITY_DEBUG, "Lua: Ignoring cache %s: %s", cache_name, lua_tostring(L, -1));
+        }
+        lua_pop(L, 1);
+        return false;
+    }
+    return true;
+}
+
+void lua_scripts::save_cached(lua_State *L, const char *cache_name, uint32_t source_crc, uint32_t source_size) {
+    int fd = AP::FS().open(cache_name, O_WRONLY|O_CREAT|O_TRUNC);
+    if (fd == -1) {
+        // read only filesystem, carry on without a cache
+        return;
+    }
+    const bytecode_cache_header header { BYTECODE_CACHE_MAGIC, source_crc, source_size };
+    // debug information is kept so error messages still carry line numbers
+    const bool ok = (AP::FS().write(fd, &header, sizeof(header)) == sizeof(header)) &&
+                    (lua_dump(L, write_cache, &fd, 0) == 0);
+    AP::FS().close(fd);
+    if (!ok) {
+        AP::FS().unlink(cache_name);
+    }
+}
+
 lua_scripts::script_info *lua_scripts::load_script(lua_State *L, char *filename) {
-    if (int error = luaL_loadfile(L, filename)) {
+    // look for a compiled copy of the script keyed by the source hash,
+    // this skips the parser and its transient allocations at boot
+    char *cache_name = nullptr;
+    uint32_t source_crc = 0;
+    uint32_t source_size = 0;
+    bool loaded = false;
+    if (option_is_set(Option::BYTECODE_CACHE) && hash_file(filename, source_crc, source_size)) {
+        const size_t size = strlen(filename) + 2;
+        cache_name = (char *)hal.util->heap_realloc(_heap, nullptr, size);
+        if (cache_name != nullptr) {
+            snprintf(cache_name, size, "%sc", filename);
+            loaded = load_cached(L, cache_name, source_crc, source_size);
+        }
+    }
+
+    int error = LUA_OK;
+    if (!loaded) {
+        error = luaL_loadfile(L, filename);
+        if (error == LUA_OK && cache_name != nullptr) {
+            save_cached(L, cache_name, source_crc, source_size);
+        }
+    }
+    if (cache_name != nullptr) {
+        hal.util->heap_realloc(_heap, cache_name, 0);
+    }
+
+    if (error != LUA_OK) {
         switch (error) {
             case LUA_ERRSYNTAX:
                 gcs().send_text(MAV_SEVERITY_CRITICAL, "Lua: Syntax error in %s", filename);
@@ -89,6 +230,7 @@ lua_scripts::script_info *lua_scripts::load_script(lua_State *L, char *filename)
         return nullptr;
     }
 
+    memset(new_script, 0, sizeof(script_info));
     new_script->name = filename;
     new_script->next = nullptr;
 
@@ -178,11 +320,33 @@ void lua_scripts::run_next_script(lua_State *L) {
     // pop the function to the top of the stack
     lua_rawgeti(L, LUA_REGISTRYINDEX, script->lua_ref);
 
-    if(lua_pcall(L, 0, LUA_MULTRET, 0)) {
+    // account allocations to this script while it runs
+    _run_quota = MAX(_mem_quota.get(), 0);
+    _run_mem = 0;
+    _run_alloc = 0;
+    _quota_exceeded = false;
+    _accounting = true;
+    const uint32_t start_us = AP_HAL::micros();
+
+    const int error = lua_pcall(L, 0, LUA_MULTRET, 0);
+
+    _accounting = false;
+    script->run_time_us = AP_HAL::micros() - start_us;
+    script->max_time_us = MAX(script->max_time_us, script->run_time_us);
+    script->total_time_us += script->run_time_us;
+    script->run_count++;
+    script->run_alloc = _run_alloc;
+    script->run_mem = _run_mem;
+    log_script_run(script);
+
+    if (error) {
         if (overtime) {
             // script has consumed an excessive amount of CPU time
             gcs().send_text(MAV_SEVERITY_CRITICAL, "Lua: %s exceeded time limit (%d)", script->name,  (int)vm_steps);
             remove_script(L, script);
+        } else if (error == LUA_ERRMEM && _quota_exceeded) {
+            gcs().send_text(MAV_SEVERITY_CRITICAL, "Lua: %s exceeded memory quota (%d)", script->name, (int)_run_quota);
+            remove_script(L, script);
         } else {
             gcs().send_text(MAV_SEVERITY_INFO, "Lua: %s", lua_tostring(L, -1));
             hal.console->printf("Lua: Error: %s\n", lua_tostring(L, -1));
@@ -296,11 +460,144 @@ void lua_scripts::reschedule_script(script_info *script) {
     previous->next = script;
 }
 
+void lua_scripts::idle_gc(lua_State *L, uint64_t next_run_ms) {
+    // the automatic collector is stopped so that it never runs inside a
+    // script, do the work here instead. Always take at least one step so
+    // collection keeps up even when there is no idle time
+    uint32_t budget_us = MAX(_gc_budget_us.get(), 0);
+    const uint64_t now_ms = AP_HAL::millis64();
+    if (next_run_ms <= now_ms) {
+        budget_us = 0;
+    } else if (next_run_ms - now_ms < budget_us / 1000U) {
+        budget_us = (next_run_ms - now_ms) * 1000U;
+    }
+    const uint32_t start_us = AP_HAL::micros();
+    do {
+        if (lua_gc(L, LUA_GCSTEP, 0)) {
+            // cycle complete
+            break;
+        }
+    } while (AP_HAL::micros() - start_us < budget_us);
+
+    // don't let a script that produces garbage faster than it can be
+    // collected run the heap dry, that would force an emergency
+    // collection inside the next script
+    const int32_t in_use = lua_gc(L, LUA_GCCOUNT, 0) * 1024 + lua_gc(L, LUA_GCCOUNTB, 0);
+    if (in_use > (_heap_size / 100) * SCRIPTING_GC_FULL_COLLECT_PCT) {
+        lua_gc(L, LUA_GCCOLLECT, 0);
+    }
+}
+
+void lua_scripts::log_script_run(const script_info *script) const {
+    if (_debug_level > 1) {
+        gcs().send_text(MAV_SEVERITY_DEBUG, "Lua: Time: %u Mem: %d + %d Alloc: %u",
+                                            (unsigned int)script->run_time_us,
+                                            (int)(lua_gc(lua_state, LUA_GCCOUNT, 0) * 1024 + lua_gc(lua_state, LUA_GCCOUNTB, 0)),
+                                            (int)script->run_mem,
+                                            (unsigned int)script->run_alloc);
+    }
+
+    if (!option_is_set(Option::LOG_RUNTIME)) {
+        return;
+    }
+    // the logger copies all 16 bytes of an N field, so give it a buffer that long
+    const char *base = strrchr(script->name, '/');
+    base = (base == nullptr) ? script->name : base + 1;
+    char name[16] {};
+    strncpy(name, base, sizeof(name));
+    AP::logger().Write("SCR", "TimeUS,Name,Runtime,MaxTime,AvgTime,Total,Dyn,Alloc", "QNIIIiiI",
+                       AP_HAL::micros64(),
+                       name,
+                       (uint32_t)script->run_time_us,
+                       (uint32_t)script->max_time_us,
+                       (uint32_t)(script->total_time_us / MAX(script->run_count, 1U)),
+                       (int32_t)(lua_gc(lua_state, LUA_GCCOUNT, 0) * 1024 + lua_gc(lua_state, LUA_GCCOUNTB, 0)),
+                       (int32_t)script->run_mem,
+                       (uint32_t)script->run_alloc);
+}
+
 void *lua_scripts::_heap;
 
+// returns the free list a block of this size belongs to, or SCRIPTING_BLOCK_POOL_BINS if it isn't pooled
+uint8_t lua_scripts::pool_bin(size_t size) {
+    if ((size == 0) || (size > SCRIPTING_BLOCK_POOL_MAX_SIZE)) {
+        return SCRIPTING_BLOCK_POOL_BINS;
+    }
+    return (size - 1) / SCRIPTING_BLOCK_POOL_ALIGN;
+}
+
+// return all the pooled blocks to the heap, returns true if anything was freed
+bool lua_scripts::pool_flush(void) {
+    bool freed = false;
+    for (uint8_t i = 0; i < SCRIPTING_BLOCK_POOL_BINS; i++) {
+        while (_pool[i].head != nullptr) {
+            void *block = _pool[i].head;
+            _pool[i].head = *(void **)block;
+            hal.util->heap_realloc(_heap, block, 0);
+            freed = true;
+        }
+        _pool[i].count = 0;
+    }
+    return freed;
+}
+
+void *lua_scripts::pool_realloc(void *ptr, size_t osize, size_t nsize) {
+    const uint8_t old_bin = (ptr == nullptr) ? SCRIPTING_BLOCK_POOL_BINS : pool_bin(osize);
+    const uint8_t new_bin = pool_bin(nsize);
+
+    if (nsize == 0) {
+        if (old_bin < SCRIPTING_BLOCK_POOL_BINS && _pool[old_bin].count < SCRIPTING_BLOCK_POOL_DEPTH) {
+            *(void **)ptr = _pool[old_bin].head;
+            _pool[old_bin].head = ptr;
+            _pool[old_bin].count++;
+            return nullptr;
+        }
+        return hal.util->heap_realloc(_heap, ptr, 0);
+    }
+
+    if (new_bin < SCRIPTING_BLOCK_POOL_BINS) {
+        if (ptr == nullptr && _pool[new_bin].head != nullptr) {
+            void *block = _pool[new_bin].head;
+            _pool[new_bin].head = *(void **)block;
+            _pool[new_bin].count--;
+            return block;
+        }
+        if (old_bin == new_bin) {
+            // the existing block is already big enough
+            return ptr;
+        }
+        // pooled blocks are always allocated at the full size of their bin
+        nsize = (new_bin + 1) * SCRIPTING_BLOCK_POOL_ALIGN;
+    }
+
+    void *ret = hal.util->heap_realloc(_heap, ptr, nsize);
+    if ((ret == nullptr) && pool_flush()) {
+        ret = hal.util->heap_realloc(_heap, ptr, nsize);
+    }
+    return ret;
+}
+
 void *lua_scripts::alloc(void *ud, void *ptr, size_t osize, size_t nsize) {
-    (void)ud; (void)osize;  /* not used */
-    return hal.util->heap_realloc(_heap, ptr, nsize);
+    (void)ud;  /* not used */
+    if (!_accounting) {
+        return pool_realloc(ptr, osize, nsize);
+    }
+
+    // osize holds the object type rather than a size for new objects
+    const int32_t delta = (int32_t)nsize - ((ptr == nullptr) ? 0 : (int32_t)osize);
+    if ((delta > 0) && (_run_quota > 0) && (_run_mem + delta > _run_quota)) {
+        // lua will do an emergency collection and retry before failing
+        _quota_exceeded = true;
+        return nullptr;
+    }
+    void *ret = pool_realloc(ptr, osize, nsize);
+    if ((ret != nullptr) || (nsize == 0)) {
+        _run_mem += delta;
+        if (delta > 0) {
+            _run_alloc += delta;
+        }
+    }
+    return ret;
 }
 
 void lua_scripts::run(void) {
@@ -349,6 +646,11 @@ void lua_scripts::run(void) {
     // Scan the filesystem in an appropriate manner and autostart scripts
     load_all_scripts_in_dir(L, SCRIPTING_DIRECTORY);
 
+    // clear out everything left over from compiling, then take over
+    // control of the collector so it only runs between scripts
+    lua_gc(L, LUA_GCCOLLECT, 0);
+    lua_gc(L, LUA_GCSTOP, 0);
+
     while (AP_Scripting::get_singleton()->enabled()) {
 #if defined(AP_SCRIPTING_CHECKS) && AP_SCRIPTING_CHECKS >= 1
         if (lua_gettop(L) != 0) {
@@ -378,22 +680,10 @@ void lua_scripts::run(void) {
                 gcs().send_text(MAV_SEVERITY_DEBUG, "Lua: Running %s", scripts->name);
             }
 
-            const int startMem = lua_gc(L, LUA_GCCOUNT, 0) * 1024 + lua_gc(L, LUA_GCCOUNTB, 0);
-            const uint32_t loadEnd = AP_HAL::micros();
-
             run_next_script(L);
 
-            const uint32_t runEnd = AP_HAL::micros();
-            const int endMem = lua_gc(L, LUA_GCCOUNT, 0) * 1024 + lua_gc(L, LUA_GCCOUNTB, 0);
-            if (_debug_level > 1) {
-                gcs().send_text(MAV_SEVERITY_DEBUG, "Lua: Time: %u Mem: %d + %d",
-                                                    (unsigned int)(runEnd - loadEnd),
-                                                    (int)endMem,
-                                                    (int)(endMem - startMem));
-            }
-
-            // garbage collect after each script, this shouldn't matter, but seems to resolve a memory leak
-            lua_gc(L, LUA_GCCOLLECT, 0);
+            // collect garbage in the gap before the next script is due
+            idle_gc(L, (scripts != nullptr) ? scripts->next_run_ms : 0);
 
         } else {
             gcs().send_text(MAV_SEVERITY_DEBUG, "Lua: No scripts to run");
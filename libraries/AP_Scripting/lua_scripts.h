@@ -21,10 +21,20 @@
 #include <AP_Filesystem/posix_compat.h>
 #include "lua_bindings.h"
 
+// blocks up to this size are rounded up to a multiple of SCRIPTING_BLOCK_POOL_ALIGN
+// and recycled through per size free lists, this covers the userdata behind
+// boxed numerics, vectors and locations as well as short strings
+#ifndef SCRIPTING_BLOCK_POOL_MAX_SIZE
+  #define SCRIPTING_BLOCK_POOL_MAX_SIZE 64
+#endif
+#define SCRIPTING_BLOCK_POOL_ALIGN 8
+#define SCRIPTING_BLOCK_POOL_BINS (SCRIPTING_BLOCK_POOL_MAX_SIZE / SCRIPTING_BLOCK_POOL_ALIGN)
+
 class lua_scripts
 {
 public:
-    lua_scripts(const AP_Int32 &vm_steps, const AP_Int32 &heap_size, const AP_Int8 &debug_level);
+    lua_scripts(const AP_Int32 &vm_steps, const AP_Int32 &heap_size, const AP_Int8 &debug_level,
+                const AP_Int16 &options, const AP_Int16 &gc_budget_us, const AP_Int32 &mem_quota);
 
     /* Do not allow copies */
     lua_scripts(const lua_scripts &other) = delete;
@@ -37,21 +47,55 @@ public:
     void run(void);
 
     static bool overtime; // script exceeded it's execution slot, and we are bailing out
+
+    // bits for SCR_OPTIONS
+    enum class Option : uint16_t {
+        BYTECODE_CACHE = (1U << 0), // cache compiled scripts next to the source
+        LOG_RUNTIME    = (1U << 1), // log CPU time and allocations of every script run
+    };
+
 private:
 
     typedef struct script_info {
        int lua_ref;          // reference to the loaded script object
        uint64_t next_run_ms; // time (in milliseconds) the script should next be run at
        char *name;           // filename for the script // FIXME: This information should be available from Lua
+       uint32_t run_count;   // number of times the script has been run
+       uint32_t run_time_us; // CPU time of the last run
+       uint32_t max_time_us; // longest run seen
+       uint64_t total_time_us; // CPU time of all runs
+       uint32_t run_alloc;   // bytes allocated during the last run
+       int32_t run_mem;      // net change in heap usage during the last run
        script_info *next;
     } script_info;
 
     script_info *load_script(lua_State *L, char *filename);
 
+    // load a compiled chunk from the bytecode cache, returns false if
+    // there is no valid cache entry for a source with the given hash
+    bool load_cached(lua_State *L, const char *cache_name, uint32_t source_crc, uint32_t source_size);
+
+    // write the chunk at the top of the stack to the bytecode cache
+    void save_cached(lua_State *L, const char *cache_name, uint32_t source_crc, uint32_t source_size);
+
+    // compute the CRC32 and size of a script source file
+    static bool hash_file(const char *filename, uint32_t &crc, uint32_t &size);
+
     void load_all_scripts_in_dir(lua_State *L, const char *dirname);
 
     void run_next_script(lua_State *L);
 
+    // run incremental garbage collection steps until the cycle completes
+    // or the time budget (limited by the start of the next script) is used
+    void idle_gc(lua_State *L, uint64_t next_run_ms);
+
+    // report CPU time and allocations of a script run
+    void log_script_run(const script_info *script) const;
+
+    bool option_is_set(Option option) const {
+        return (uint16_t(_options.get()) & uint16_t(option)) != 0;
+    }
+
     void remove_script(lua_State *L, script_info *script);
 
     // reschedule the script for execution. It is assumed the script is not in the list already
@@ -71,8 +115,29 @@ private:
 
     const AP_Int32 & _vm_steps;
     const AP_Int8 & _debug_level;
+    const AP_Int16 & _options;
+    const AP_Int16 & _gc_budget_us;
+    const AP_Int32 & _mem_quota;
+    const int32_t _heap_size;
 
     static void *alloc(void *ud, void *ptr, size_t osize, size_t nsize);
 
     static void *_heap;
+
+    // free lists of recently released small blocks
+    struct block_pool {
+        void *head;
+        uint8_t count;
+    };
+    static block_pool _pool[SCRIPTING_BLOCK_POOL_BINS];
+    static uint8_t pool_bin(size_t size);
+    static bool pool_flush(void);
+    static void *pool_realloc(void *ptr, size_t osize, size_t nsize);
+
+    // allocation accounting for the script currently being run
+    static bool _accounting;      // true while a script is running
+    static int32_t _run_quota;    // maximum net growth of a single run, 0 for unlimited
+    static int32_t _run_mem;      // net heap growth of the current run
+    static uint32_t _run_alloc;   // bytes allocated by the current run
+    static bool _quota_exceeded;  // an allocation was refused due to the quota
 };
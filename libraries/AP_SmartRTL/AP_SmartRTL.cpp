@@ -100,21 +100,24 @@ void AP_SmartRTL::init()
     }
 
     // allocate arrays
-    _path = (Vector3f*)calloc(_points_max, sizeof(Vector3f));
+    const size_t path_size = _points_max * sizeof(Vector3f);
+    _path = (Vector3f*)hal.util->malloc_type(path_size, AP_HAL::Util::MEM_NORMAL, AP_HAL::Util::MEM_TAG_SMARTRTL);
 
     _prune.loops_max = _points_max * SMARTRTL_PRUNING_LOOP_BUFFER_LEN_MULT;
-    _prune.loops = (prune_loop_t*)calloc(_prune.loops_max, sizeof(prune_loop_t));
+    const size_t loops_size = _prune.loops_max * sizeof(prune_loop_t);
+    _prune.loops = (prune_loop_t*)hal.util->malloc_type(loops_size, AP_HAL::Util::MEM_NORMAL, AP_HAL::Util::MEM_TAG_SMARTRTL);
 
     _simplify.stack_max = _points_max * SMARTRTL_SIMPLIFY_STACK_LEN_MULT;
-    _simplify.stack = (simplify_start_finish_t*)calloc(_simplify.stack_max, sizeof(simplify_start_finish_t));
+    const size_t stack_size = _simplify.stack_max * sizeof(simplify_start_finish_t);
+    _simplify.stack = (simplify_start_finish_t*)hal.util->malloc_type(stack_size, AP_HAL::Util::MEM_NORMAL, AP_HAL::Util::MEM_TAG_SMARTRTL);
 
     // check if memory allocation failed
     if (_path == nullptr || _prune.loops == nullptr || _simplify.stack == nullptr) {
         log_action(SRTL_DEACTIVATED_INIT_FAILED);
         gcs().send_text(MAV_SEVERITY_WARNING, "SmartRTL deactivated: init failed");
-        free(_path);
-        free(_prune.loops);
-        free(_simplify.stack);
+        hal.util->free_type(_path, path_size, AP_HAL::Util::MEM_NORMAL, AP_HAL::Util::MEM_TAG_SMARTRTL);
+        hal.util->free_type(_prune.loops, loops_size, AP_HAL::Util::MEM_NORMAL, AP_HAL::Util::MEM_TAG_SMARTRTL);
+        hal.util->free_type(_simplify.stack, stack_size, AP_HAL::Util::MEM_NORMAL, AP_HAL::Util::MEM_TAG_SMARTRTL);
         return;
     }
 
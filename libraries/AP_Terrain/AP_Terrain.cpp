@@ -395,7 +395,7 @@ bool AP_Terrain::allocate(void)
     if (cache != nullptr) {
         return true;
     }
-    cache = (struct grid_cache *)calloc(TERRAIN_GRID_BLOCK_CACHE_SIZE, sizeof(cache[0]));
+    cache = (struct grid_cache *)hal.util->malloc_type(TERRAIN_GRID_BLOCK_CACHE_SIZE * sizeof(cache[0]), AP_HAL::Util::MEM_NORMAL, AP_HAL::Util::MEM_TAG_TERRAIN);
     if (cache == nullptr) {
         gcs().send_text(MAV_SEVERITY_CRITICAL, "Terrain: Allocation failed");
         memory_alloc_failed = true;
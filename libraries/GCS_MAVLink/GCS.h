@@ -840,7 +840,7 @@ public:
     void send_to_active_channels(uint32_t msgid, const char *pkt);
 
     void send_text(MAV_SEVERITY severity, const char *fmt, ...) FMT_PRINTF(3, 4);
-    void send_textv(MAV_SEVERITY severity, const char *fmt, va_list arg_list);
+    void send_textv(MAV_SEVERITY severity, const char *fmt, va_list arg_list) FMT_PRINTF(3, 0);
     virtual void send_statustext(MAV_SEVERITY severity, uint8_t dest_bitmask, const char *text);
    
     void service_statustext(void);
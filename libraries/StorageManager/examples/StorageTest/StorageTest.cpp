@@ -94,6 +94,16 @@ void loop(void)
     count++;
     if (count % 10000 == 0) {
         hal.console->printf("%u ops\n", (unsigned)count);
+        AP_HAL::Storage::Stats stats;
+        if (hal.storage->get_stats(stats)) {
+            hal.console->printf("changed=%u written=%u writes=%u erases=%u erase_us=%u max=%u\n",
+                                (unsigned)stats.bytes_changed,
+                                (unsigned)stats.bytes_written,
+                                (unsigned)stats.backend_writes,
+                                (unsigned)stats.erase_count,
+                                (unsigned)stats.erase_time_us,
+                                (unsigned)stats.erase_max_us);
+        }
     }
 }
 